@@ -1,24 +1,215 @@
+#include "configs.h"
 #include "configs.hpp"
 #include "configs/include_configs.hpp"
 
+#include "iface/3m/mult.h"
+#include "util/time.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386) || defined(_M_IX86)
+#include "util/cpuid.hpp"
+#endif
+
+#include <fstream>
+#include <limits>
+#include <string>
+#include <sys/stat.h>
+
 namespace tblis
 {
 
 namespace
 {
 
-enum config_t
+struct config_list
 {
-#define FOREACH_CONFIG(config) config##_value,
-#include "configs/foreach_config.h"
-    num_configs
+    /*
+     * All registered configurations (including variants), in order of
+     * preference for configurations with the same priority.
+     */
+    std::vector<const config*> all;
+
+    /*
+     * Names of the usable configurations, NULL-terminated.
+     */
+    std::vector<const char*> names;
+
+    /*
+     * The name of each configuration with variants (e.g. "haswell"), along
+     * with its default variant (e.g. haswell_d6x8).
+     */
+    std::vector<std::pair<std::string,const config*>> bases;
+
+    /*
+     * Base names of the usable configurations, NULL-terminated.
+     */
+    std::vector<const char*> base_names;
+
+    config_list()
+    {
+        #define FOREACH_CONFIG(config) \
+            for (auto cfg : config::variants()) all.push_back(cfg); \
+            bases.emplace_back(#config, config::variants().front());
+        #include "configs/foreach_config.h"
+
+        for (auto& base : bases)
+            base.first.erase(base.first.size()-strlen("_config"));
+
+        for (auto cfg : all)
+        {
+            TBLIS_ASSERT(cfg->check);
+            if (cfg->check() >= 0) names.push_back(cfg->name);
+        }
+
+        names.push_back(nullptr);
+
+        for (auto& base : bases)
+        {
+            if (base.second->check() >= 0) base_names.push_back(base.first.c_str());
+        }
+
+        base_names.push_back(nullptr);
+    }
 };
 
-const config* const configs[num_configs] =
+const config_list& get_config_list()
 {
-#define FOREACH_CONFIG(config) &config::instance(),
-#include "configs/foreach_config.h"
-};
+    static config_list list;
+    return list;
+}
+
+const config* find_config(const char* name)
+{
+    for (auto cfg : get_config_list().all)
+    {
+        if (strcmp(cfg->name, name) == 0 && cfg->check() >= 0) return cfg;
+    }
+
+    for (auto& base : get_config_list().bases)
+    {
+        if (base.first == name && base.second->check() >= 0) return base.second;
+    }
+
+    return nullptr;
+}
+
+/*
+ * Identifies the machine and the set of usable configurations, so that a
+ * cached autotuning result is discarded when either changes.
+ */
+std::string autotune_key()
+{
+    std::string key;
+
+    #if defined(__x86_64__) || defined(_M_X64) || defined(__i386) || defined(_M_IX86)
+    int family, model, features;
+    int vendor = get_cpu_type(family, model, features);
+    key = std::to_string(vendor) + ":" + std::to_string(family) + ":" +
+          std::to_string(model) + ":" + std::to_string(features);
+    #else
+    key = "unknown";
+    #endif
+
+    for (auto name : get_config_list().names)
+    {
+        if (name) key += std::string(" ") + name;
+    }
+
+    return key;
+}
+
+std::string autotune_cache_path()
+{
+    std::string dir;
+
+    if (const char* xdg = getenv("XDG_CACHE_HOME"))
+    {
+        dir = xdg;
+    }
+    else if (const char* home = getenv("HOME"))
+    {
+        dir = std::string(home) + "/.cache";
+    }
+    else
+    {
+        return "";
+    }
+
+    mkdir(dir.c_str(), 0755);
+    dir += "/tblis";
+    mkdir(dir.c_str(), 0755);
+
+    return dir + "/config";
+}
+
+double autotune_time(const config& cfg)
+{
+    constexpr len_type n = 256;
+    constexpr int reps = 3;
+
+    std::vector<double> A(n*n, 1.0), B(n*n, 1.0), C(n*n, 0.0);
+
+    tblis_matrix A_s, B_s, C_s;
+    tblis_init_matrix_d(&A_s, n, n, A.data(), 1, n);
+    tblis_init_matrix_d(&B_s, n, n, B.data(), 1, n);
+    tblis_init_matrix_d(&C_s, n, n, C.data(), 1, n);
+
+    auto cfg_s = reinterpret_cast<const tblis_config*>(&cfg);
+
+    // Warm up the packing buffers
+    tblis_matrix_mult(tblis_single, cfg_s, &A_s, &B_s, &C_s);
+
+    double best = std::numeric_limits<double>::max();
+    for (int rep = 0;rep < reps;rep++)
+    {
+        double t0 = tic();
+        tblis_matrix_mult(tblis_single, cfg_s, &A_s, &B_s, &C_s);
+        best = std::min(best, tic()-t0);
+    }
+
+    return best;
+}
+
+const config* autotune_config()
+{
+    std::string path = autotune_cache_path();
+    std::string key = autotune_key();
+
+    if (!path.empty())
+    {
+        std::ifstream ifs(path);
+        std::string cached_key, name;
+
+        if (std::getline(ifs, cached_key) &&
+            std::getline(ifs, name) &&
+            cached_key == key)
+        {
+            if (auto cfg = find_config(name.c_str())) return cfg;
+        }
+    }
+
+    const config* best = nullptr;
+    double best_time = 0;
+
+    for (auto cfg : get_config_list().all)
+    {
+        if (cfg->check() < 0) continue;
+
+        double time = autotune_time(*cfg);
+        if (!best || time < best_time)
+        {
+            best = cfg;
+            best_time = time;
+        }
+    }
+
+    if (best && !path.empty())
+    {
+        std::ofstream ofs(path);
+        ofs << key << '\n' << best->name << '\n';
+    }
+
+    return best;
+}
 
 struct default_config
 {
@@ -26,16 +217,29 @@ struct default_config
 
     default_config()
     {
-        int priority = -1;
+        const char* name = getenv("TBLIS_CONFIG");
 
-        for (int cfg = 0;cfg < num_configs;cfg++)
+        if (name && *name)
         {
-            TBLIS_ASSERT(configs[cfg]->check);
-            int cur_prio = configs[cfg]->check();
-            if (cur_prio > priority)
+            value = lookup_config(name);
+
+            if (!value)
+                tblis_abort_with_message(nullptr,
+                    "tblis: Configuration %s requested by TBLIS_CONFIG "
+                    "is unknown or not usable, aborting!", name);
+        }
+        else
+        {
+            int priority = -1;
+
+            for (auto cfg : get_config_list().all)
             {
-                priority = cur_prio;
-                value = configs[cfg];
+                int cur_prio = cfg->check();
+                if (cur_prio > priority)
+                {
+                    priority = cur_prio;
+                    value = cfg;
+                }
             }
         }
 
@@ -47,6 +251,12 @@ struct default_config
 
 }
 
+const config* lookup_config(const char* name)
+{
+    if (strcmp(name, "autotune") == 0) return autotune_config();
+    return find_config(name);
+}
+
 const config& get_default_config()
 {
     static default_config def;
@@ -58,4 +268,24 @@ const config& get_config(const tblis_config* cfg)
     return (cfg ? *reinterpret_cast<const config*>(cfg) : get_default_config());
 }
 
+extern "C"
+{
+
+const char* const* tblis_list_configs()
+{
+    return get_config_list().names.data();
+}
+
+const char* const* tblis_list_base_configs()
+{
+    return get_config_list().base_names.data();
+}
+
+const tblis_config* tblis_get_config(const char* name)
+{
+    return reinterpret_cast<const tblis_config*>(find_config(name));
+}
+
+}
+
 }
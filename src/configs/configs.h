@@ -0,0 +1,51 @@
+#ifndef _TBLIS_CONFIGS_H_
+#define _TBLIS_CONFIGS_H_
+
+#include "../util/basic_types.h"
+
+#ifdef __cplusplus
+
+namespace tblis
+{
+
+extern "C"
+{
+
+#endif
+
+/*
+ * Return a NULL-terminated list of the names of all configurations which are
+ * usable on this machine, in the order in which they were registered.
+ */
+const char* const* tblis_list_configs();
+
+/*
+ * Return a NULL-terminated list of the base names of all configurations
+ * (e.g. "haswell") whose default variant is usable on this machine.
+ */
+const char* const* tblis_list_base_configs();
+
+/*
+ * Return the configuration with the given name, or NULL if there is no such
+ * configuration or if it cannot run on this machine. The name of a
+ * configuration with several kernel variants (e.g. "haswell") selects its
+ * default variant (e.g. "haswell_d6x8"). The result may be
+ * passed as the cfg argument of any tblis_* function.
+ *
+ * The default configuration (used when cfg is NULL) may be overridden by
+ * setting TBLIS_CONFIG to the name of a configuration, or to "autotune" to
+ * time a short GEMM with each usable configuration on first use and pick the
+ * fastest. The autotuned choice is cached in $XDG_CACHE_HOME/tblis/config
+ * (or ~/.cache/tblis/config).
+ */
+const tblis_config* tblis_get_config(const char* name);
+
+#ifdef __cplusplus
+}
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -7,6 +7,7 @@
 #include "kernels/1v/add.hpp"
 #include "kernels/1v/copy.hpp"
 #include "kernels/1v/dot.hpp"
+#include "kernels/1v/mult.hpp"
 #include "kernels/1v/reduce.hpp"
 #include "kernels/1v/scale.hpp"
 #include "kernels/1v/set.hpp"
@@ -24,19 +25,23 @@ namespace tblis
 //
 using check_fn_t = int (*)(void);
 
+/*
+ * int32_t is only used as the compute type of integer contractions.
+ */
 template <typename T> struct type_idx;
 
 template <> struct type_idx<   float> { constexpr static int value = 0; };
 template <> struct type_idx<  double> { constexpr static int value = 1; };
 template <> struct type_idx<scomplex> { constexpr static int value = 2; };
 template <> struct type_idx<dcomplex> { constexpr static int value = 3; };
+template <> struct type_idx< int32_t> { constexpr static int value = 4; };
 
 struct blocksize
 {
-    len_type    _def[4];
-    len_type    _max[4];
-    len_type   _iota[4];
-    len_type _extent[4];
+    len_type    _def[5];
+    len_type    _max[5];
+    len_type   _iota[5];
+    len_type _extent[5];
 
     template <typename T> len_type    def() const { return    _def[type_idx<T>::value]; }
     template <typename T> len_type    max() const { return    _max[type_idx<T>::value]; }
@@ -44,22 +49,23 @@ struct blocksize
     template <typename T> len_type extent() const { return _extent[type_idx<T>::value]; }
 
     template <template <typename> class BS, typename T> blocksize(const BS<T>&)
-    : _def   {BS<float>::def,    BS<double>::def,    BS<scomplex>::def,    BS<dcomplex>::def},
-      _max   {BS<float>::max,    BS<double>::max,    BS<scomplex>::max,    BS<dcomplex>::max},
-      _iota  {BS<float>::iota,   BS<double>::iota,   BS<scomplex>::iota,   BS<dcomplex>::iota},
-      _extent{BS<float>::extent, BS<double>::extent, BS<scomplex>::extent, BS<dcomplex>::extent} {}
+    : _def   {BS<float>::def,    BS<double>::def,    BS<scomplex>::def,    BS<dcomplex>::def,    BS<int32_t>::def},
+      _max   {BS<float>::max,    BS<double>::max,    BS<scomplex>::max,    BS<dcomplex>::max,    BS<int32_t>::max},
+      _iota  {BS<float>::iota,   BS<double>::iota,   BS<scomplex>::iota,   BS<dcomplex>::iota,   BS<int32_t>::iota},
+      _extent{BS<float>::extent, BS<double>::extent, BS<scomplex>::extent, BS<dcomplex>::extent, BS<int32_t>::extent} {}
 };
 
 template <template <typename> class ukr_t>
 struct microkernel
 {
-    void (*_ukr[4])(void);
+    void (*_ukr[5])(void);
 
     template <template <typename> class ukr, typename T> microkernel(const ukr<T>&)
     : _ukr{(void(*)(void))ukr<   float>::value,
            (void(*)(void))ukr<  double>::value,
            (void(*)(void))ukr<scomplex>::value,
-           (void(*)(void))ukr<dcomplex>::value} {}
+           (void(*)(void))ukr<dcomplex>::value,
+           (void(*)(void))ukr< int32_t>::value} {}
 
     template <typename T, typename... Args>
     void call(Args&&... args) const
@@ -71,13 +77,14 @@ struct microkernel
 template <typename U>
 struct parameter
 {
-    U _val[4];
+    U _val[5];
 
     template <template <typename> class param, typename T> parameter(const param<T>&)
     : _val{param<   float>::value,
            param<  double>::value,
            param<scomplex>::value,
-           param<dcomplex>::value} {}
+           param<dcomplex>::value,
+           param< int32_t>::value} {}
 
     template <typename T>
     U value() const
@@ -95,6 +102,7 @@ struct config
     microkernel<add_ukr_t> add_ukr;
     microkernel<copy_ukr_t> copy_ukr;
     microkernel<dot_ukr_t> dot_ukr;
+    microkernel<mult_ukr_t> mult_ukr;
     microkernel<reduce_ukr_t> reduce_ukr;
     microkernel<scale_ukr_t> scale_ukr;
     microkernel<set_ukr_t> set_ukr;
@@ -123,6 +131,7 @@ struct config
     blocksize gemm_kc;
 
     microkernel<gemm_ukr_t> gemm_ukr;
+    gemm_i16_ukr_t gemm_i16_ukr;
 
     parameter<bool> gemm_row_major;
 
@@ -151,6 +160,7 @@ struct config
     : add_ukr(typename Traits::template add_ukr<float>()),
       copy_ukr(typename Traits::template copy_ukr<float>()),
       dot_ukr(typename Traits::template dot_ukr<float>()),
+      mult_ukr(typename Traits::template mult_ukr<float>()),
       reduce_ukr(typename Traits::template reduce_ukr<float>()),
       scale_ukr(typename Traits::template scale_ukr<float>()),
       set_ukr(typename Traits::template set_ukr<float>()),
@@ -171,6 +181,7 @@ struct config
       gemm_kc(typename Traits::template gemm_kc<float>()),
 
       gemm_ukr(typename Traits::template gemm_ukr<float>()),
+      gemm_i16_ukr(Traits::gemm_i16_ukr),
 
       gemm_row_major(typename Traits::template gemm_row_major<float>()),
 
@@ -197,6 +208,13 @@ struct config
 
 const config& get_default_config();
 
+/*
+ * The configuration selected by a value of TBLIS_CONFIG: either a name as
+ * accepted by tblis_get_config, or "autotune". Returns nullptr if there is no
+ * such usable configuration.
+ */
+const config* lookup_config(const char* name);
+
 const config& get_config(const tblis_config* cfg);
 
 }
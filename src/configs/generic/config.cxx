@@ -0,0 +1,17 @@
+#include "config.hpp"
+
+namespace tblis
+{
+
+/*
+ * Usable everywhere, but any hand-tuned config which also reports priority 1
+ * is listed first by configure and so wins the tie.
+ */
+int generic_check()
+{
+    return 1;
+}
+
+TBLIS_CONFIG_INSTANTIATE(generic);
+
+}
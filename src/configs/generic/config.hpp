@@ -0,0 +1,43 @@
+#ifndef _TBLIS_CONFIGS_GENERIC_CONFIG_HPP_
+#define _TBLIS_CONFIGS_GENERIC_CONFIG_HPP_
+
+#include "configs/config_builder.hpp"
+#include "configs/generic/kernels.hpp"
+
+namespace tblis
+{
+
+extern int generic_check();
+
+TBLIS_BEGIN_CONFIG(generic)
+
+TBLIS_CONFIG_GEMM_MR(TBLIS_GENERIC_SMR, TBLIS_GENERIC_DMR, _, _)
+TBLIS_CONFIG_GEMM_NR(                6,                 6, _, _)
+TBLIS_CONFIG_GEMM_NC(             4080,              4080, _, _)
+
+TBLIS_CONFIG_TRANS_MR(TBLIS_GENERIC_SMR, TBLIS_GENERIC_DMR, _, _)
+TBLIS_CONFIG_TRANS_NR(TBLIS_GENERIC_SMR, TBLIS_GENERIC_DMR, _, _)
+
+TBLIS_CONFIG_UKR2(this_config, gemm_ukr, gemm_ukr_t, _,_,_,_, generic_gemm_ukr, generic_gemm_ukr)
+
+TBLIS_CONFIG_UKR3(this_config, matrix_constants::MAT_A, pack_nn_mr_ukr, pack_nn_ukr_t, _,_,_,_, generic_pack_nn_ukr, generic_pack_nn_ukr)
+TBLIS_CONFIG_UKR3(this_config, matrix_constants::MAT_B, pack_nn_nr_ukr, pack_nn_ukr_t, _,_,_,_, generic_pack_nn_ukr, generic_pack_nn_ukr)
+
+TBLIS_CONFIG_UKR2(this_config, add_ukr, add_ukr_t, _,_,_,_, generic_add_ukr, generic_add_ukr)
+TBLIS_CONFIG_UKR2(this_config, copy_ukr, copy_ukr_t, _,_,_,_, generic_copy_ukr, generic_copy_ukr)
+TBLIS_CONFIG_UKR2(this_config, dot_ukr, dot_ukr_t, _,_,_,_, generic_dot_ukr, generic_dot_ukr)
+TBLIS_CONFIG_UKR2(this_config, mult_ukr, mult_ukr_t, _,_,_,_, generic_mult_ukr, generic_mult_ukr)
+TBLIS_CONFIG_UKR2(this_config, reduce_ukr, reduce_ukr_t, _,_,_,_, generic_reduce_ukr, generic_reduce_ukr)
+TBLIS_CONFIG_UKR2(this_config, scale_ukr, scale_ukr_t, _,_,_,_, generic_scale_ukr, generic_scale_ukr)
+TBLIS_CONFIG_UKR2(this_config, set_ukr, set_ukr_t, _,_,_,_, generic_set_ukr, generic_set_ukr)
+
+TBLIS_CONFIG_UKR2(this_config, trans_add_ukr, trans_add_ukr_t, _,_,_,_, generic_trans_add_ukr, generic_trans_add_ukr)
+TBLIS_CONFIG_UKR2(this_config, trans_copy_ukr, trans_copy_ukr_t, _,_,_,_, generic_trans_copy_ukr, generic_trans_copy_ukr)
+
+TBLIS_CONFIG_CHECK(generic_check)
+
+TBLIS_END_CONFIG
+
+}
+
+#endif
@@ -0,0 +1,715 @@
+#ifndef _TBLIS_CONFIGS_GENERIC_KERNELS_HPP_
+#define _TBLIS_CONFIGS_GENERIC_KERNELS_HPP_
+
+#include "configs/configs.hpp"
+
+#include <type_traits>
+
+/*
+ * Vector width (in bytes) used by the generic kernels. This is picked from
+ * whatever the compiler is targeting, so building with e.g. -march=native
+ * automatically widens the kernels. GCC and clang lower vectors which are
+ * wider than the hardware supports to multiple native operations.
+ */
+#ifndef TBLIS_GENERIC_VECTOR_SIZE
+#if defined(__AVX512F__)
+#define TBLIS_GENERIC_VECTOR_SIZE 64
+#elif defined(__AVX__)
+#define TBLIS_GENERIC_VECTOR_SIZE 32
+#else
+#define TBLIS_GENERIC_VECTOR_SIZE 16
+#endif
+#endif
+
+/*
+ * The register blocksizes must be literals for TBLIS_CONFIG_GEMM_MR, so
+ * spell out MR = 2 vectors for each supported width. The transpose tiles are
+ * one vector square (VL x VL).
+ */
+#if TBLIS_GENERIC_VECTOR_SIZE == 64
+#define TBLIS_GENERIC_SMR 32
+#define TBLIS_GENERIC_DMR 16
+#define TBLIS_GENERIC_SVL 16
+#define TBLIS_GENERIC_DVL 8
+#elif TBLIS_GENERIC_VECTOR_SIZE == 32
+#define TBLIS_GENERIC_SMR 16
+#define TBLIS_GENERIC_DMR 8
+#define TBLIS_GENERIC_SVL 8
+#define TBLIS_GENERIC_DVL 4
+#elif TBLIS_GENERIC_VECTOR_SIZE == 16
+#define TBLIS_GENERIC_SMR 8
+#define TBLIS_GENERIC_DMR 4
+#define TBLIS_GENERIC_SVL 4
+#define TBLIS_GENERIC_DVL 2
+#else
+#error "Unsupported TBLIS_GENERIC_VECTOR_SIZE"
+#endif
+
+namespace tblis
+{
+
+/*
+ * Every config uses these kernels for int32_t, and each config is compiled
+ * for its own instruction set. The config is a template parameter so that
+ * each one gets its own copy of the (inline, but not always inlined) member
+ * functions, rather than the linker picking one instruction set for all of
+ * them.
+ */
+template <typename Config, typename T>
+struct generic_vector
+{
+    constexpr static len_type size = TBLIS_GENERIC_VECTOR_SIZE/sizeof(T);
+
+    typedef T type __attribute__((vector_size(TBLIS_GENERIC_VECTOR_SIZE)));
+
+    static type load(const T* p)
+    {
+        type v;
+        memcpy(&v, p, sizeof(type));
+        return v;
+    }
+
+    static void store(T* p, type v)
+    {
+        memcpy(p, &v, sizeof(type));
+    }
+
+    static type splat(T x)
+    {
+        return type{} + x;
+    }
+
+    static T sum(type v)
+    {
+        T s = T();
+        for (len_type i = 0;i < size;i++) s += v[i];
+        return s;
+    }
+
+    /*
+     * Element k of the result is a[k+Off] if bit H of k is clear, and
+     * b[k+Off-H] otherwise.
+     */
+    template <len_type H, len_type Off>
+    static type merge(type a, type b)
+    {
+#ifdef __clang__
+        type r;
+        for (len_type k = 0;k < size;k++)
+            r[k] = ((k & H) ? b[k+Off-H] : a[k+Off]);
+        return r;
+#else
+        typedef typename std::conditional<sizeof(T) == 8, int64_t,
+                typename std::conditional<sizeof(T) == 4, int32_t,
+                typename std::conditional<sizeof(T) == 2, int16_t,
+                                                          int8_t>::type>::type>::type
+            index;
+        typedef index mask __attribute__((vector_size(TBLIS_GENERIC_VECTOR_SIZE)));
+
+        mask m;
+        for (len_type k = 0;k < size;k++)
+            m[k] = ((k & H) ? size+k+Off-H : k+Off);
+        return __builtin_shuffle(a, b, m);
+#endif
+    }
+
+    /*
+     * Transpose the size x size block whose rows are v[0], ..., v[size-1] in
+     * place. Each round swaps the off-diagonal H x H blocks inside every
+     * 2H x 2H diagonal block, for H = size/2, ..., 1.
+     */
+    template <len_type H = size/2>
+    static typename std::enable_if<(H > 0)>::type transpose(type (&v)[size])
+    {
+        for (len_type i = 0;i < size;i++)
+        {
+            if (i & H) continue;
+            type lo = merge<H,0>(v[i], v[i+H]);
+            type hi = merge<H,H>(v[i], v[i+H]);
+            v[i] = lo;
+            v[i+H] = hi;
+        }
+
+        transpose<H/2>(v);
+    }
+
+    template <len_type H>
+    static typename std::enable_if<(H == 0)>::type transpose(type (&)[size]) {}
+};
+
+template <typename T>
+using generic_vectorizable = std::is_arithmetic<T>;
+
+/*
+ * GEMM micro-kernel: MR/NR come from the config, and the MR dimension is
+ * held in vector registers.
+ */
+
+template <typename Config, typename T, len_type MV, len_type NR>
+void generic_gemm_write_back(typename generic_vector<Config,T>::type (&ab)[MV][NR],
+                             const T* TBLIS_RESTRICT alpha,
+                             const T* TBLIS_RESTRICT beta,
+                             T* TBLIS_RESTRICT p_c, stride_type rs_c, stride_type cs_c)
+{
+    typedef generic_vector<Config,T> V;
+    typedef typename V::type vec;
+
+    constexpr len_type VL = V::size;
+    constexpr len_type MR = MV*VL;
+
+    vec alpha_v = V::splat(*alpha);
+
+    if (rs_c == 1)
+    {
+        if (*beta == T(0))
+        {
+            for (len_type j = 0;j < NR;j++)
+                for (len_type i = 0;i < MV;i++)
+                    V::store(p_c + i*VL + j*cs_c, alpha_v*ab[i][j]);
+        }
+        else
+        {
+            vec beta_v = V::splat(*beta);
+
+            for (len_type j = 0;j < NR;j++)
+                for (len_type i = 0;i < MV;i++)
+                    V::store(p_c + i*VL + j*cs_c,
+                             alpha_v*ab[i][j] +
+                             beta_v*V::load(p_c + i*VL + j*cs_c));
+        }
+    }
+    else
+    {
+        for (len_type j = 0;j < NR;j++)
+            for (len_type i = 0;i < MV;i++)
+                ab[i][j] *= alpha_v;
+
+        if (*beta == T(0))
+        {
+            for (len_type j = 0;j < NR;j++)
+                for (len_type i = 0;i < MR;i++)
+                    p_c[i*rs_c + j*cs_c] = ab[i/VL][j][i%VL];
+        }
+        else
+        {
+            for (len_type j = 0;j < NR;j++)
+                for (len_type i = 0;i < MR;i++)
+                    p_c[i*rs_c + j*cs_c] = ab[i/VL][j][i%VL] +
+                                           (*beta)*p_c[i*rs_c + j*cs_c];
+        }
+    }
+}
+
+template <typename Config, typename T>
+typename std::enable_if<generic_vectorizable<T>::value>::type
+generic_gemm_ukr(stride_type k,
+                 const T* TBLIS_RESTRICT alpha,
+                 const T* TBLIS_RESTRICT p_a, const T* TBLIS_RESTRICT p_b,
+                 const T* TBLIS_RESTRICT beta,
+                 T* TBLIS_RESTRICT p_c, stride_type rs_c, stride_type cs_c)
+{
+    typedef generic_vector<Config,T> V;
+    typedef typename V::type vec;
+
+    constexpr len_type MR = Config::template gemm_mr<T>::def;
+    constexpr len_type NR = Config::template gemm_nr<T>::def;
+    constexpr len_type VL = V::size;
+    constexpr len_type MV = MR/VL;
+
+    static_assert(MR%VL == 0, "MR must be a multiple of the vector length");
+
+    vec ab[MV][NR] = {};
+
+    while (k --> 0)
+    {
+        vec a[MV];
+        for (len_type i = 0;i < MV;i++) a[i] = V::load(p_a + i*VL);
+
+        for (len_type j = 0;j < NR;j++)
+        {
+            vec b = V::splat(p_b[j]);
+            for (len_type i = 0;i < MV;i++) ab[i][j] += a[i]*b;
+        }
+
+        p_a += MR;
+        p_b += NR;
+    }
+
+    generic_gemm_write_back<Config,T>(ab, alpha, beta, p_c, rs_c, cs_c);
+}
+
+template <typename Config, typename T>
+typename std::enable_if<!generic_vectorizable<T>::value>::type
+generic_gemm_ukr(stride_type k,
+                 const T* TBLIS_RESTRICT alpha,
+                 const T* TBLIS_RESTRICT p_a, const T* TBLIS_RESTRICT p_b,
+                 const T* TBLIS_RESTRICT beta,
+                 T* TBLIS_RESTRICT p_c, stride_type rs_c, stride_type cs_c)
+{
+    constexpr len_type MR = Config::template gemm_mr<T>::def;
+    constexpr len_type NR = Config::template gemm_nr<T>::def;
+
+    T p_ab[MR*NR] __attribute__((aligned(64))) = {};
+
+    while (k --> 0)
+    {
+        for (len_type j = 0;j < NR;j++)
+            for (len_type i = 0;i < MR;i++)
+                p_ab[i + MR*j] += p_a[i] * p_b[j];
+
+        p_a += MR;
+        p_b += NR;
+    }
+
+    if (*beta == T(0))
+    {
+        for (len_type j = 0;j < NR;j++)
+            for (len_type i = 0;i < MR;i++)
+                p_c[i*rs_c + j*cs_c] = (*alpha)*p_ab[i + MR*j];
+    }
+    else
+    {
+        for (len_type j = 0;j < NR;j++)
+            for (len_type i = 0;i < MR;i++)
+                p_c[i*rs_c + j*cs_c] = (*alpha)*p_ab[i + MR*j] +
+                                       (*beta)*p_c[i*rs_c + j*cs_c];
+    }
+}
+
+/*
+ * Integer GEMM on k-pair-interleaved int16_t panels (see gemm_i16_ukr_t).
+ * Each int32_t lane of an A vector holds one pair, which is split by shifts;
+ * the int32_t register blocksizes of the config apply.
+ */
+
+template <typename Config>
+void generic_gemm_i16_ukr(stride_type k,
+                          const int32_t* TBLIS_RESTRICT alpha,
+                          const int16_t* TBLIS_RESTRICT p_a,
+                          const int16_t* TBLIS_RESTRICT p_b,
+                          const int32_t* TBLIS_RESTRICT beta,
+                          int32_t* TBLIS_RESTRICT p_c, stride_type rs_c, stride_type cs_c)
+{
+    typedef generic_vector<Config,int32_t> V;
+    typedef typename V::type vec;
+
+    constexpr len_type MR = Config::template gemm_mr<int32_t>::def;
+    constexpr len_type NR = Config::template gemm_nr<int32_t>::def;
+    constexpr len_type VL = V::size;
+    constexpr len_type MV = MR/VL;
+
+    static_assert(MR%VL == 0, "MR must be a multiple of the vector length");
+
+    vec ab[MV][NR] = {};
+
+    for (k /= 2;k --> 0;)
+    {
+        vec a_lo[MV], a_hi[MV];
+        for (len_type i = 0;i < MV;i++)
+        {
+            vec a;
+            memcpy(&a, p_a + 2*i*VL, sizeof(vec));
+            a_lo[i] = (a << 16) >> 16;
+            a_hi[i] = a >> 16;
+        }
+
+        for (len_type j = 0;j < NR;j++)
+        {
+            vec b_lo = V::splat(p_b[2*j]);
+            vec b_hi = V::splat(p_b[2*j+1]);
+            for (len_type i = 0;i < MV;i++)
+                ab[i][j] += a_lo[i]*b_lo + a_hi[i]*b_hi;
+        }
+
+        p_a += 2*MR;
+        p_b += 2*NR;
+    }
+
+    generic_gemm_write_back<Config,int32_t>(ab, alpha, beta, p_c, rs_c, cs_c);
+}
+
+/*
+ * Packing: only the contiguous, full-panel case is vectorized.
+ */
+
+template <typename Config, typename T, int Mat>
+typename std::enable_if<generic_vectorizable<T>::value>::type
+generic_pack_nn_ukr(len_type m, len_type k,
+                    const T* TBLIS_RESTRICT p_a, stride_type rs_a, stride_type cs_a,
+                    T* TBLIS_RESTRICT p_ap)
+{
+    typedef generic_vector<Config,T> V;
+
+    using namespace matrix_constants;
+    constexpr len_type MR = (Mat == MAT_A ? Config::template gemm_mr<T>::def
+                                          : Config::template gemm_nr<T>::def);
+    constexpr len_type ME = (Mat == MAT_A ? Config::template gemm_mr<T>::extent
+                                          : Config::template gemm_nr<T>::extent);
+    constexpr len_type VL = V::size;
+
+    if (MR%VL == 0 && m == MR && rs_a == 1)
+    {
+        for (len_type p = 0;p < k;p++)
+        {
+            for (len_type i = 0;i < MR/VL;i++)
+                V::store(p_ap + i*VL, V::load(p_a + i*VL));
+
+            p_a += cs_a;
+            p_ap += ME;
+        }
+    }
+    else
+    {
+        pack_nn_ukr_def<Config,T,Mat>(m, k, p_a, rs_a, cs_a, p_ap);
+    }
+}
+
+template <typename Config, typename T, int Mat>
+typename std::enable_if<!generic_vectorizable<T>::value>::type
+generic_pack_nn_ukr(len_type m, len_type k,
+                    const T* TBLIS_RESTRICT p_a, stride_type rs_a, stride_type cs_a,
+                    T* TBLIS_RESTRICT p_ap)
+{
+    pack_nn_ukr_def<Config,T,Mat>(m, k, p_a, rs_a, cs_a, p_ap);
+}
+
+/*
+ * Level 1v kernels: unit-stride real data goes through vectors, everything
+ * else is forwarded to the default kernels.
+ */
+
+template <typename Config, typename T>
+typename std::enable_if<generic_vectorizable<T>::value>::type
+generic_add_ukr(len_type n,
+                T alpha, bool conj_A, const T* TBLIS_RESTRICT A, stride_type inc_A,
+                T  beta, bool conj_B,       T* TBLIS_RESTRICT B, stride_type inc_B)
+{
+    typedef generic_vector<Config,T> V;
+    constexpr len_type VL = V::size;
+
+    if (inc_A != 1 || inc_B != 1)
+        return add_ukr_def<Config,T>(n, alpha, conj_A, A, inc_A,
+                                         beta, conj_B, B, inc_B);
+
+    auto alpha_v = V::splat(alpha);
+    auto beta_v = V::splat(beta);
+
+    len_type i = 0;
+    for (;i <= n-VL;i += VL)
+        V::store(B+i, alpha_v*V::load(A+i) + beta_v*V::load(B+i));
+    for (;i < n;i++)
+        B[i] = alpha*A[i] + beta*B[i];
+}
+
+template <typename Config, typename T>
+typename std::enable_if<!generic_vectorizable<T>::value>::type
+generic_add_ukr(len_type n,
+                T alpha, bool conj_A, const T* TBLIS_RESTRICT A, stride_type inc_A,
+                T  beta, bool conj_B,       T* TBLIS_RESTRICT B, stride_type inc_B)
+{
+    add_ukr_def<Config,T>(n, alpha, conj_A, A, inc_A, beta, conj_B, B, inc_B);
+}
+
+template <typename Config, typename T>
+typename std::enable_if<generic_vectorizable<T>::value>::type
+generic_copy_ukr(len_type n,
+                 T alpha, bool conj_A, const T* TBLIS_RESTRICT A, stride_type inc_A,
+                                             T* TBLIS_RESTRICT B, stride_type inc_B)
+{
+    typedef generic_vector<Config,T> V;
+    constexpr len_type VL = V::size;
+
+    if (inc_A != 1 || inc_B != 1)
+        return copy_ukr_def<Config,T>(n, alpha, conj_A, A, inc_A, B, inc_B);
+
+    auto alpha_v = V::splat(alpha);
+
+    len_type i = 0;
+    for (;i <= n-VL;i += VL)
+        V::store(B+i, alpha_v*V::load(A+i));
+    for (;i < n;i++)
+        B[i] = alpha*A[i];
+}
+
+template <typename Config, typename T>
+typename std::enable_if<!generic_vectorizable<T>::value>::type
+generic_copy_ukr(len_type n,
+                 T alpha, bool conj_A, const T* TBLIS_RESTRICT A, stride_type inc_A,
+                                             T* TBLIS_RESTRICT B, stride_type inc_B)
+{
+    copy_ukr_def<Config,T>(n, alpha, conj_A, A, inc_A, B, inc_B);
+}
+
+template <typename Config, typename T>
+typename std::enable_if<generic_vectorizable<T>::value>::type
+generic_dot_ukr(len_type n,
+                bool conj_A, const T* TBLIS_RESTRICT A, stride_type inc_A,
+                bool conj_B, const T* TBLIS_RESTRICT B, stride_type inc_B, T& value)
+{
+    typedef generic_vector<Config,T> V;
+    constexpr len_type VL = V::size;
+
+    if (inc_A != 1 || inc_B != 1)
+        return dot_ukr_def<Config,T>(n, conj_A, A, inc_A, conj_B, B, inc_B, value);
+
+    typename V::type sum = {};
+
+    len_type i = 0;
+    for (;i <= n-VL;i += VL)
+        sum += V::load(A+i)*V::load(B+i);
+    for (;i < n;i++)
+        value += A[i]*B[i];
+
+    value += V::sum(sum);
+}
+
+template <typename Config, typename T>
+typename std::enable_if<!generic_vectorizable<T>::value>::type
+generic_dot_ukr(len_type n,
+                bool conj_A, const T* TBLIS_RESTRICT A, stride_type inc_A,
+                bool conj_B, const T* TBLIS_RESTRICT B, stride_type inc_B, T& value)
+{
+    dot_ukr_def<Config,T>(n, conj_A, A, inc_A, conj_B, B, inc_B, value);
+}
+
+template <typename Config, typename T>
+typename std::enable_if<generic_vectorizable<T>::value>::type
+generic_mult_ukr(len_type n,
+                 T alpha, bool conj_A, const T* TBLIS_RESTRICT A, stride_type inc_A,
+                          bool conj_B, const T* TBLIS_RESTRICT B, stride_type inc_B,
+                 T  beta, bool conj_C,       T* TBLIS_RESTRICT C, stride_type inc_C)
+{
+    typedef generic_vector<Config,T> V;
+    constexpr len_type VL = V::size;
+
+    if (inc_C != 1 || inc_A < 0 || inc_A > 1 || inc_B < 0 || inc_B > 1)
+        return mult_ukr_def<Config,T>(n, alpha, conj_A, A, inc_A,
+                                             conj_B, B, inc_B,
+                                       beta, conj_C, C, inc_C);
+
+    auto alpha_v = V::splat(alpha);
+    auto beta_v = V::splat(beta);
+
+    len_type i = 0;
+
+    TBLIS_SPECIAL_CASE(beta == T(0),
+    TBLIS_SPECIAL_CASE(inc_A == 1,
+    TBLIS_SPECIAL_CASE(inc_B == 1,
+    {
+        auto a_v = V::splat(*A);
+        auto b_v = V::splat(*B);
+
+        for (;i <= n-VL;i += VL)
+        {
+            auto ab = alpha_v*(inc_A ? V::load(A+i) : a_v)*
+                              (inc_B ? V::load(B+i) : b_v);
+            V::store(C+i, beta == T(0) ? ab : ab + beta_v*V::load(C+i));
+        }
+    }
+    )))
+
+    for (;i < n;i++)
+        C[i] = alpha*A[i*inc_A]*B[i*inc_B] + (beta == T(0) ? T(0) : beta*C[i]);
+}
+
+template <typename Config, typename T>
+typename std::enable_if<!generic_vectorizable<T>::value>::type
+generic_mult_ukr(len_type n,
+                 T alpha, bool conj_A, const T* TBLIS_RESTRICT A, stride_type inc_A,
+                          bool conj_B, const T* TBLIS_RESTRICT B, stride_type inc_B,
+                 T  beta, bool conj_C,       T* TBLIS_RESTRICT C, stride_type inc_C)
+{
+    mult_ukr_def<Config,T>(n, alpha, conj_A, A, inc_A,
+                                  conj_B, B, inc_B,
+                            beta, conj_C, C, inc_C);
+}
+
+template <typename Config, typename T>
+typename std::enable_if<generic_vectorizable<T>::value>::type
+generic_reduce_ukr(reduce_t op, len_type n,
+                   const T* A, stride_type inc_A, T& value, len_type& idx)
+{
+    typedef generic_vector<Config,T> V;
+    constexpr len_type VL = V::size;
+
+    if (inc_A != 1 || (op != REDUCE_SUM && op != REDUCE_NORM_2))
+        return reduce_ukr_def<Config,T>(op, n, A, inc_A, value, idx);
+
+    typename V::type sum = {};
+
+    len_type i = 0;
+    if (op == REDUCE_SUM)
+    {
+        for (;i <= n-VL;i += VL) sum += V::load(A+i);
+        for (;i < n;i++) value += A[i];
+    }
+    else
+    {
+        for (;i <= n-VL;i += VL) sum += V::load(A+i)*V::load(A+i);
+        for (;i < n;i++) value += A[i]*A[i];
+    }
+
+    value += V::sum(sum);
+}
+
+template <typename Config, typename T>
+typename std::enable_if<!generic_vectorizable<T>::value>::type
+generic_reduce_ukr(reduce_t op, len_type n,
+                   const T* A, stride_type inc_A, T& value, len_type& idx)
+{
+    reduce_ukr_def<Config,T>(op, n, A, inc_A, value, idx);
+}
+
+template <typename Config, typename T>
+typename std::enable_if<generic_vectorizable<T>::value>::type
+generic_scale_ukr(len_type n,
+                  T alpha, bool conj_A, T* A, stride_type inc_A)
+{
+    typedef generic_vector<Config,T> V;
+    constexpr len_type VL = V::size;
+
+    if (inc_A != 1)
+        return scale_ukr_def<Config,T>(n, alpha, conj_A, A, inc_A);
+
+    auto alpha_v = V::splat(alpha);
+
+    len_type i = 0;
+    for (;i <= n-VL;i += VL) V::store(A+i, alpha_v*V::load(A+i));
+    for (;i < n;i++) A[i] *= alpha;
+}
+
+template <typename Config, typename T>
+typename std::enable_if<!generic_vectorizable<T>::value>::type
+generic_scale_ukr(len_type n,
+                  T alpha, bool conj_A, T* A, stride_type inc_A)
+{
+    scale_ukr_def<Config,T>(n, alpha, conj_A, A, inc_A);
+}
+
+template <typename Config, typename T>
+typename std::enable_if<generic_vectorizable<T>::value>::type
+generic_set_ukr(len_type n,
+                T alpha, T* A, stride_type inc_A)
+{
+    typedef generic_vector<Config,T> V;
+    constexpr len_type VL = V::size;
+
+    if (inc_A != 1)
+        return set_ukr_def<Config,T>(n, alpha, A, inc_A);
+
+    auto alpha_v = V::splat(alpha);
+
+    len_type i = 0;
+    for (;i <= n-VL;i += VL) V::store(A+i, alpha_v);
+    for (;i < n;i++) A[i] = alpha;
+}
+
+template <typename Config, typename T>
+typename std::enable_if<!generic_vectorizable<T>::value>::type
+generic_set_ukr(len_type n,
+                T alpha, T* A, stride_type inc_A)
+{
+    set_ukr_def<Config,T>(n, alpha, A, inc_A);
+}
+
+/*
+ * Transpose kernels: a full tile with A unit-stride along n and B along m is
+ * moved as VL x VL blocks, each loaded as rows of A, transposed in registers
+ * and stored as columns of B. Everything else uses the default kernels.
+ */
+
+template <typename Config, typename T>
+typename std::enable_if<generic_vectorizable<T>::value>::type
+generic_trans_copy_ukr(len_type m, len_type n,
+                       T alpha, bool conj_A, const T* TBLIS_RESTRICT A, stride_type rs_A, stride_type cs_A,
+                                                   T* TBLIS_RESTRICT B, stride_type rs_B, stride_type cs_B)
+{
+    typedef generic_vector<Config,T> V;
+    typedef typename V::type vec;
+
+    constexpr len_type MR = Config::template trans_mr<T>::def;
+    constexpr len_type NR = Config::template trans_nr<T>::def;
+    constexpr len_type VL = V::size;
+
+    if (MR%VL != 0 || NR%VL != 0 || m != MR || n != NR ||
+        cs_A != 1 || rs_B != 1)
+        return trans_copy_ukr_def<Config,T>(m, n, alpha, conj_A, A, rs_A, cs_A,
+                                                                 B, rs_B, cs_B);
+
+    vec alpha_v = V::splat(alpha);
+
+    for (len_type i0 = 0;i0 < MR;i0 += VL)
+    for (len_type j0 = 0;j0 < NR;j0 += VL)
+    {
+        vec v[VL];
+        for (len_type i = 0;i < VL;i++)
+            v[i] = V::load(A + (i0+i)*rs_A + j0);
+
+        V::transpose(v);
+
+        for (len_type j = 0;j < VL;j++)
+            V::store(B + i0 + (j0+j)*cs_B, alpha_v*v[j]);
+    }
+}
+
+template <typename Config, typename T>
+typename std::enable_if<!generic_vectorizable<T>::value>::type
+generic_trans_copy_ukr(len_type m, len_type n,
+                       T alpha, bool conj_A, const T* TBLIS_RESTRICT A, stride_type rs_A, stride_type cs_A,
+                                                   T* TBLIS_RESTRICT B, stride_type rs_B, stride_type cs_B)
+{
+    trans_copy_ukr_def<Config,T>(m, n, alpha, conj_A, A, rs_A, cs_A,
+                                                      B, rs_B, cs_B);
+}
+
+template <typename Config, typename T>
+typename std::enable_if<generic_vectorizable<T>::value>::type
+generic_trans_add_ukr(len_type m, len_type n,
+                      T alpha, bool conj_A, const T* TBLIS_RESTRICT A, stride_type rs_A, stride_type cs_A,
+                      T  beta, bool conj_B,       T* TBLIS_RESTRICT B, stride_type rs_B, stride_type cs_B)
+{
+    typedef generic_vector<Config,T> V;
+    typedef typename V::type vec;
+
+    constexpr len_type MR = Config::template trans_mr<T>::def;
+    constexpr len_type NR = Config::template trans_nr<T>::def;
+    constexpr len_type VL = V::size;
+
+    if (MR%VL != 0 || NR%VL != 0 || m != MR || n != NR ||
+        cs_A != 1 || rs_B != 1)
+        return trans_add_ukr_def<Config,T>(m, n, alpha, conj_A, A, rs_A, cs_A,
+                                                  beta, conj_B, B, rs_B, cs_B);
+
+    vec alpha_v = V::splat(alpha);
+    vec beta_v = V::splat(beta);
+
+    for (len_type i0 = 0;i0 < MR;i0 += VL)
+    for (len_type j0 = 0;j0 < NR;j0 += VL)
+    {
+        vec v[VL];
+        for (len_type i = 0;i < VL;i++)
+            v[i] = V::load(A + (i0+i)*rs_A + j0);
+
+        V::transpose(v);
+
+        for (len_type j = 0;j < VL;j++)
+        {
+            T* B_j = B + i0 + (j0+j)*cs_B;
+            V::store(B_j, alpha_v*v[j] + beta_v*V::load(B_j));
+        }
+    }
+}
+
+template <typename Config, typename T>
+typename std::enable_if<!generic_vectorizable<T>::value>::type
+generic_trans_add_ukr(len_type m, len_type n,
+                      T alpha, bool conj_A, const T* TBLIS_RESTRICT A, stride_type rs_A, stride_type cs_A,
+                      T  beta, bool conj_B,       T* TBLIS_RESTRICT B, stride_type rs_B, stride_type cs_B)
+{
+    trans_add_ukr_def<Config,T>(m, n, alpha, conj_A, A, rs_A, cs_A,
+                                       beta, conj_B, B, rs_B, cs_B);
+}
+
+}
+
+#endif
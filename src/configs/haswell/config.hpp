@@ -21,12 +21,14 @@ EXTERN_GEMM_UKR(double, bli_dgemm_asm_4x12);
 namespace tblis
 {
 
+EXTERN_GEMM_I16_UKR(haswell_gemm_i16_ukr_16x6);
+
 extern int haswell_check();
 
 TBLIS_BEGIN_CONFIG(haswell_d12x4)
 
-    TBLIS_CONFIG_GEMM_MR(  24,   12, _, _)
-    TBLIS_CONFIG_GEMM_NR(   4,    4, _, _)
+    TBLIS_CONFIG_GEMM_MR(  24,   12, _, _, 16)
+    TBLIS_CONFIG_GEMM_NR(   4,    4, _, _,  6)
     TBLIS_CONFIG_GEMM_KR(   8,    4, _, _)
     TBLIS_CONFIG_GEMM_MC( 264,   96, _, _)
     TBLIS_CONFIG_GEMM_NC(4080, 4080, _, _)
@@ -37,14 +39,16 @@ TBLIS_BEGIN_CONFIG(haswell_d12x4)
                           _,
                           _)
 
+    TBLIS_CONFIG_GEMM_I16_UKR(haswell_gemm_i16_ukr_16x6)
+
     TBLIS_CONFIG_CHECK(haswell_check)
 
 TBLIS_END_CONFIG
 
 TBLIS_BEGIN_CONFIG(haswell_d4x12)
 
-    TBLIS_CONFIG_GEMM_MR(   4,    4, _, _)
-    TBLIS_CONFIG_GEMM_NR(  24,   12, _, _)
+    TBLIS_CONFIG_GEMM_MR(   4,    4, _, _, 16)
+    TBLIS_CONFIG_GEMM_NR(  24,   12, _, _,  6)
     TBLIS_CONFIG_GEMM_KR(   8,    4, _, _)
     TBLIS_CONFIG_GEMM_MC( 264,   96, _, _)
     TBLIS_CONFIG_GEMM_NC(4080, 4080, _, _)
@@ -55,6 +59,8 @@ TBLIS_BEGIN_CONFIG(haswell_d4x12)
                           _,
                           _)
 
+    TBLIS_CONFIG_GEMM_I16_UKR(haswell_gemm_i16_ukr_16x6)
+
     TBLIS_CONFIG_GEMM_ROW_MAJOR(true, true, _, _)
 
     TBLIS_CONFIG_CHECK(haswell_check)
@@ -63,8 +69,8 @@ TBLIS_END_CONFIG
 
 TBLIS_BEGIN_CONFIG(haswell_d8x6)
 
-    TBLIS_CONFIG_GEMM_MR(  16,    8, _, _)
-    TBLIS_CONFIG_GEMM_NR(   6,    6, _, _)
+    TBLIS_CONFIG_GEMM_MR(  16,    8, _, _, 16)
+    TBLIS_CONFIG_GEMM_NR(   6,    6, _, _,  6)
     TBLIS_CONFIG_GEMM_KR(   8,    4, _, _)
     TBLIS_CONFIG_GEMM_MC( 144,   72, _, _)
     TBLIS_CONFIG_GEMM_NC(4080, 4080, _, _)
@@ -75,14 +81,16 @@ TBLIS_BEGIN_CONFIG(haswell_d8x6)
                           _,
                           _)
 
+    TBLIS_CONFIG_GEMM_I16_UKR(haswell_gemm_i16_ukr_16x6)
+
     TBLIS_CONFIG_CHECK(haswell_check)
 
 TBLIS_END_CONFIG
 
 TBLIS_BEGIN_CONFIG(haswell_d6x8)
 
-    TBLIS_CONFIG_GEMM_MR(   6,    6, _, _)
-    TBLIS_CONFIG_GEMM_NR(  16,    8, _, _)
+    TBLIS_CONFIG_GEMM_MR(   6,    6, _, _, 16)
+    TBLIS_CONFIG_GEMM_NR(  16,    8, _, _,  6)
     TBLIS_CONFIG_GEMM_KR(   8,    4, _, _)
     TBLIS_CONFIG_GEMM_MC( 144,   72, _, _)
     TBLIS_CONFIG_GEMM_NC(4080, 4080, _, _)
@@ -93,13 +101,24 @@ TBLIS_BEGIN_CONFIG(haswell_d6x8)
                           _,
                           _)
 
+    TBLIS_CONFIG_GEMM_I16_UKR(haswell_gemm_i16_ukr_16x6)
+
     TBLIS_CONFIG_GEMM_ROW_MAJOR(true, true, _, _)
 
     TBLIS_CONFIG_CHECK(haswell_check)
 
 TBLIS_END_CONFIG
 
-typedef haswell_d6x8_config haswell_config;
+struct haswell_config : haswell_d6x8_config
+{
+    static std::vector<const config*> variants()
+    {
+        return {&haswell_d6x8_config::instance(),
+                &haswell_d8x6_config::instance(),
+                &haswell_d12x4_config::instance(),
+                &haswell_d4x12_config::instance()};
+    }
+};
 
 }
 
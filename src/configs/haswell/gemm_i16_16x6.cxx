@@ -0,0 +1,102 @@
+#include "config.hpp"
+
+#include <immintrin.h>
+
+namespace tblis
+{
+
+/*
+ * 16x6 integer GEMM micro-kernel on k-pair-interleaved int16_t panels. Each
+ * pair of k is one vpmaddwd per 8 rows and column, which leaves 12 int32_t
+ * accumulators.
+ */
+void haswell_gemm_i16_ukr_16x6(stride_type k,
+                               const int32_t* TBLIS_RESTRICT alpha,
+                               const int16_t* TBLIS_RESTRICT p_a,
+                               const int16_t* TBLIS_RESTRICT p_b,
+                               const int32_t* TBLIS_RESTRICT beta,
+                               int32_t* TBLIS_RESTRICT p_c, stride_type rs_c, stride_type cs_c)
+{
+    constexpr len_type MR = 16;
+    constexpr len_type NR = 6;
+
+    __m256i ab[2][NR];
+    for (len_type j = 0;j < NR;j++)
+        ab[0][j] = ab[1][j] = _mm256_setzero_si256();
+
+    for (k /= 2;k --> 0;)
+    {
+        __m256i a0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p_a));
+        __m256i a1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p_a+16));
+
+        for (len_type j = 0;j < NR;j++)
+        {
+            int32_t pair;
+            memcpy(&pair, p_b + 2*j, sizeof(pair));
+            __m256i b = _mm256_set1_epi32(pair);
+
+            ab[0][j] = _mm256_add_epi32(ab[0][j], _mm256_madd_epi16(a0, b));
+            ab[1][j] = _mm256_add_epi32(ab[1][j], _mm256_madd_epi16(a1, b));
+        }
+
+        p_a += 2*MR;
+        p_b += 2*NR;
+    }
+
+    __m256i alpha_v = _mm256_set1_epi32(*alpha);
+    for (len_type j = 0;j < NR;j++)
+    {
+        ab[0][j] = _mm256_mullo_epi32(ab[0][j], alpha_v);
+        ab[1][j] = _mm256_mullo_epi32(ab[1][j], alpha_v);
+    }
+
+    if (rs_c == 1)
+    {
+        if (*beta == 0)
+        {
+            for (len_type j = 0;j < NR;j++)
+                for (len_type i = 0;i < 2;i++)
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(p_c + 8*i + j*cs_c), ab[i][j]);
+        }
+        else
+        {
+            __m256i beta_v = _mm256_set1_epi32(*beta);
+
+            for (len_type j = 0;j < NR;j++)
+            {
+                for (len_type i = 0;i < 2;i++)
+                {
+                    __m256i* c = reinterpret_cast<__m256i*>(p_c + 8*i + j*cs_c);
+                    _mm256_storeu_si256(c, _mm256_add_epi32(ab[i][j],
+                        _mm256_mullo_epi32(beta_v, _mm256_loadu_si256(c))));
+                }
+            }
+        }
+    }
+    else
+    {
+        int32_t p_ab[MR*NR] __attribute__((aligned(32)));
+
+        for (len_type j = 0;j < NR;j++)
+        {
+            _mm256_store_si256(reinterpret_cast<__m256i*>(p_ab + MR*j    ), ab[0][j]);
+            _mm256_store_si256(reinterpret_cast<__m256i*>(p_ab + MR*j + 8), ab[1][j]);
+        }
+
+        if (*beta == 0)
+        {
+            for (len_type j = 0;j < NR;j++)
+                for (len_type i = 0;i < MR;i++)
+                    p_c[i*rs_c + j*cs_c] = p_ab[i + MR*j];
+        }
+        else
+        {
+            for (len_type j = 0;j < NR;j++)
+                for (len_type i = 0;i < MR;i++)
+                    p_c[i*rs_c + j*cs_c] = p_ab[i + MR*j] +
+                                           (*beta)*p_c[i*rs_c + j*cs_c];
+        }
+    }
+}
+
+}
@@ -119,7 +119,16 @@ TBLIS_BEGIN_CONFIG(knl_d8x24)
 
 TBLIS_END_CONFIG
 
-typedef knl_d24x8_config knl_config;
+struct knl_config : knl_d24x8_config
+{
+    static std::vector<const config*> variants()
+    {
+        return {&knl_d24x8_config::instance(),
+                &knl_d8x24_config::instance(),
+                &knl_d30x8_config::instance(),
+                &knl_d30x8_knc_config::instance()};
+    }
+};
 
 }
 
@@ -0,0 +1,250 @@
+#ifndef _MARRAY_MAPPED_VARRAY_HPP_
+#define _MARRAY_MAPPED_VARRAY_HPP_
+
+#include <cerrno>
+#include <cstdint>
+#include <functional>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "varray.hpp"
+
+namespace MArray
+{
+    enum Access {READ_ONLY, READ_WRITE};
+
+    namespace detail
+    {
+        /*
+         * The range of whole pages spanned by the elements of a view.
+         */
+        template <typename T>
+        std::pair<char*,size_t> page_range(const const_varray_view<T>& v)
+        {
+            auto lo = reinterpret_cast<uintptr_t>(v.data());
+            auto hi = lo + sizeof(T);
+
+            for (unsigned i = 0;i < v.dimension();i++)
+            {
+                if (v.length(i) == 0) return {nullptr, 0};
+
+                ptrdiff_t off = (v.length(i)-1)*v.stride(i)*sizeof(T);
+                if (off > 0) hi += off;
+                else lo += off;
+            }
+
+            uintptr_t page = sysconf(_SC_PAGESIZE);
+            lo = lo/page*page;
+            hi = (hi+page-1)/page*page;
+
+            return {reinterpret_cast<char*>(lo), hi-lo};
+        }
+    }
+
+    /*
+     * Tell the OS that the elements of a view (typically a slice of a
+     * mapped_varray) will be used soon, so that they can be read in ahead
+     * of time.
+     */
+    template <typename T>
+    void will_need(const_varray_view<T> v)
+    {
+        auto range = detail::page_range(v);
+        if (range.second) madvise(range.first, range.second, MADV_WILLNEED);
+    }
+
+    /*
+     * A tensor whose elements are stored (densely, at the given offset) in a
+     * memory-mapped file, so that it may be larger than main memory. Pages
+     * are read in when first touched and may be dropped again by the OS, so
+     * access should be arranged to touch one slice at a time.
+     *
+     * A READ_ONLY mapped_varray is a const_varray_view of the mapped
+     * elements, and so may only be used as an input. A READ_WRITE one is a
+     * varray_view, and can be passed wherever a view is expected; the file is
+     * created and/or extended as needed, and changes are written back to it.
+     *
+     * The advice (e.g. MADV_SEQUENTIAL or MADV_RANDOM) is applied to the
+     * whole mapping.
+     */
+    template <typename T, Access A=READ_ONLY>
+    class mapped_varray : public std::conditional<A == READ_ONLY,
+                                                  const_varray_view<T>,
+                                                  varray_view<T>>::type
+    {
+        protected:
+            typedef typename std::conditional<A == READ_ONLY,
+                                              const_varray_view<T>,
+                                              varray_view<T>>::type base;
+
+        public:
+            typedef typename base::idx_type idx_type;
+            typedef typename base::stride_type stride_type;
+            typedef typename base::pointer pointer;
+
+        protected:
+            void* map_ = nullptr;
+            size_t map_size_ = 0;
+
+        public:
+            mapped_varray() {}
+
+            mapped_varray(const mapped_varray&) = delete;
+
+            mapped_varray(mapped_varray&& other)
+            {
+                swap(other);
+            }
+
+            mapped_varray(const std::string& path, const std::vector<idx_type>& len,
+                          Layout layout=DEFAULT, off_t offset=0,
+                          int advice=MADV_NORMAL)
+            {
+                reset(path, len, layout, offset, advice);
+            }
+
+            template <typename U, typename=
+                detail::enable_if_integral_t<U>>
+            mapped_varray(const std::string& path, const std::vector<U>& len,
+                          Layout layout=DEFAULT, off_t offset=0,
+                          int advice=MADV_NORMAL)
+            {
+                reset(path, len, layout, offset, advice);
+            }
+
+            ~mapped_varray()
+            {
+                reset();
+            }
+
+            mapped_varray& operator=(mapped_varray&& other)
+            {
+                reset();
+                swap(other);
+                return *this;
+            }
+
+            using base::operator=;
+
+            void reset()
+            {
+                if (map_) munmap(map_, map_size_);
+                map_ = nullptr;
+                map_size_ = 0;
+
+                base::reset();
+            }
+
+            void reset(const std::string& path, const std::vector<idx_type>& len,
+                       Layout layout=DEFAULT, off_t offset=0,
+                       int advice=MADV_NORMAL)
+            {
+                reset<idx_type>(path, len, layout, offset, advice);
+            }
+
+            template <typename U>
+            detail::enable_if_integral_t<U>
+            reset(const std::string& path, const std::vector<U>& len,
+                  Layout layout=DEFAULT, off_t offset=0,
+                  int advice=MADV_NORMAL)
+            {
+                assert(offset >= 0 && offset%alignof(T) == 0);
+
+                reset();
+
+                size_t size = std::accumulate(len.begin(), len.end(), size_t(1),
+                                              std::multiplies<size_t>())*sizeof(T);
+
+                int fd = open(path.c_str(), A == READ_ONLY ? O_RDONLY : O_RDWR|O_CREAT, 0644);
+                if (fd < 0) throw std::system_error(errno, std::generic_category(), path);
+
+                struct stat st;
+                if (fstat(fd, &st) < 0)
+                {
+                    int err = errno;
+                    close(fd);
+                    throw std::system_error(err, std::generic_category(), path);
+                }
+
+                if (st.st_size < off_t(offset+size))
+                {
+                    if (A == READ_ONLY)
+                    {
+                        close(fd);
+                        throw std::length_error(path + ": file is too small");
+                    }
+
+                    if (ftruncate(fd, offset+size) < 0)
+                    {
+                        int err = errno;
+                        close(fd);
+                        throw std::system_error(err, std::generic_category(), path);
+                    }
+                }
+
+                if (size == 0)
+                {
+                    close(fd);
+                    base::reset(len, nullptr, layout);
+                    return;
+                }
+
+                /*
+                 * The mapping must start on a page boundary.
+                 */
+                off_t map_offset = offset/sysconf(_SC_PAGESIZE)*sysconf(_SC_PAGESIZE);
+                size_t map_size = size + (offset-map_offset);
+
+                void* ptr = mmap(nullptr, map_size,
+                                 A == READ_ONLY ? PROT_READ : PROT_READ|PROT_WRITE,
+                                 MAP_SHARED, fd, map_offset);
+                int err = errno;
+                close(fd);
+                if (ptr == MAP_FAILED) throw std::system_error(err, std::generic_category(), path);
+
+                map_ = ptr;
+                map_size_ = map_size;
+
+                if (advice != MADV_NORMAL) madvise(map_, map_size_, advice);
+
+                base::reset(len, reinterpret_cast<pointer>(static_cast<char*>(ptr) +
+                                                           (offset-map_offset)), layout);
+            }
+
+            void advise(int advice)
+            {
+                if (map_) madvise(map_, map_size_, advice);
+            }
+
+            /*
+             * Write any changes back to the file.
+             */
+            void sync()
+            {
+                if (map_) msync(map_, map_size_, MS_SYNC);
+            }
+
+            void swap(mapped_varray& other)
+            {
+                using std::swap;
+                base::swap(other);
+                swap(map_,      other.map_);
+                swap(map_size_, other.map_size_);
+            }
+
+            friend void swap(mapped_varray& a, mapped_varray& b)
+            {
+                a.swap(b);
+            }
+    };
+}
+
+#endif
@@ -9,6 +9,8 @@
 #include <type_traits>
 #include <utility>
 
+#include "utility.hpp"
+
 namespace MArray
 {
 
@@ -150,7 +152,7 @@ namespace detail
         template <typename stride_type>
         inc_offsets_helper(unsigned i,
                            Offset& off0,
-                           const std::array<std::vector<stride_type>,N>& strides)
+                           const std::array<dim_vector<stride_type>,N>& strides)
         {
             off0 += strides[N-1][i];
         }
@@ -171,7 +173,7 @@ namespace detail
         template <typename stride_type>
         inc_offsets_helper(unsigned i,
                            Offset& off0, Offsets&... off,
-                           const std::array<std::vector<stride_type>,N>& strides)
+                           const std::array<dim_vector<stride_type>,N>& strides)
         {
             off0 += strides[I-1][i];
             inc_offsets_helper<0, N, I+1, Offsets...>(i, off..., strides);
@@ -188,7 +190,7 @@ namespace detail
 
     template <typename stride_type, size_t N, typename... Offsets>
     void inc_offsets(unsigned i,
-                     const std::array<std::vector<stride_type>,N>& strides,
+                     const std::array<dim_vector<stride_type>,N>& strides,
                      Offsets&... off)
     {
         inc_offsets_helper<0, N, 1, Offsets...>(i, off..., strides);
@@ -212,8 +214,8 @@ namespace detail
         template <typename idx_type, typename stride_type>
         dec_offsets_helper(unsigned i,
                            Offset& off0,
-                           const std::vector<idx_type>& pos,
-                           const std::array<std::vector<stride_type>,N>& strides)
+                           const dim_vector<idx_type>& pos,
+                           const std::array<dim_vector<stride_type>,N>& strides)
         {
             off0 -= pos[i]*strides[N-1][i];
         }
@@ -235,8 +237,8 @@ namespace detail
         template <typename idx_type, typename stride_type>
         dec_offsets_helper(unsigned i,
                            Offset& off0, Offsets&... off,
-                           const std::vector<idx_type>& pos,
-                           const std::array<std::vector<stride_type>,N>& strides)
+                           const dim_vector<idx_type>& pos,
+                           const std::array<dim_vector<stride_type>,N>& strides)
         {
             off0 -= pos[i]*strides[I-1][i];
             dec_offsets_helper<0, N, I+1, Offsets...>(i, off..., pos, strides);
@@ -254,8 +256,8 @@ namespace detail
 
     template <typename idx_type, typename stride_type, size_t N, typename... Offsets>
     void dec_offsets(unsigned i,
-                     const std::vector<idx_type>& pos,
-                     const std::array<std::vector<stride_type>,N>& strides,
+                     const dim_vector<idx_type>& pos,
+                     const std::array<dim_vector<stride_type>,N>& strides,
                      Offsets&... off)
     {
         dec_offsets_helper<0, N, 1, Offsets...>(i, off..., pos, strides);
@@ -277,8 +279,8 @@ namespace detail
 
         template <typename idx_type, typename stride_type>
         move_offsets_helper(Offset& off0,
-                           const std::vector<idx_type>& pos,
-                           const std::array<std::vector<stride_type>,N>& strides)
+                           const dim_vector<idx_type>& pos,
+                           const std::array<dim_vector<stride_type>,N>& strides)
         {
             for (unsigned i = 0;i < pos.size();i++) off0 += pos[i]*strides[N-1][i];
         }
@@ -298,8 +300,8 @@ namespace detail
 
         template <typename idx_type, typename stride_type>
         move_offsets_helper(Offset& off0, Offsets&... off,
-                           const std::vector<idx_type>& pos,
-                           const std::array<std::vector<stride_type>,N>& strides)
+                           const dim_vector<idx_type>& pos,
+                           const std::array<dim_vector<stride_type>,N>& strides)
         {
             for (unsigned i = 0;i < pos.size();i++) off0 += pos[i]*strides[I-1][i];
             move_offsets_helper<0, N, I+1, Offsets...>(off..., pos, strides);
@@ -315,8 +317,8 @@ namespace detail
     }
 
     template <typename idx_type, typename stride_type, size_t N, typename... Offsets>
-    void move_offsets(const std::vector<idx_type>& pos,
-                     const std::array<std::vector<stride_type>,N>& strides,
+    void move_offsets(const dim_vector<idx_type>& pos,
+                     const std::array<dim_vector<stride_type>,N>& strides,
                      Offsets&... off)
     {
         move_offsets_helper<0, N, 1, Offsets...>(off..., pos, strides);
@@ -338,7 +340,7 @@ namespace detail
 
         template <typename stride_type>
         set_strides_helper(const Stride& stride0,
-                           std::array<std::vector<stride_type>,N>& _strides)
+                           std::array<dim_vector<stride_type>,N>& _strides)
         {
             _strides[N-1].assign(stride0.begin(), stride0.end());
         }
@@ -358,7 +360,7 @@ namespace detail
 
         template <typename stride_type>
         set_strides_helper(const Stride& stride0, const Strides&... strides,
-                           std::array<std::vector<stride_type>,N>& _strides)
+                           std::array<dim_vector<stride_type>,N>& _strides)
         {
             _strides[I-1].assign(stride0.begin(), stride0.end());
             set_strides_helper<0, N, I+1, Strides...>(strides..., _strides);
@@ -373,7 +375,7 @@ namespace detail
     }
 
     template <typename stride_type, size_t N, typename... Strides>
-    void set_strides(std::array<std::vector<stride_type>,N>& _strides,
+    void set_strides(std::array<dim_vector<stride_type>,N>& _strides,
                      const Strides&... strides)
     {
         set_strides_helper<0, N, 1, Strides...>(strides..., _strides);
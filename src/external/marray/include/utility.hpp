@@ -8,6 +8,13 @@
 #include <iterator>
 #include <cassert>
 #include <algorithm>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+
+#ifndef MARRAY_OPT_NDIM
+#define MARRAY_OPT_NDIM 8
+#endif
 
 namespace MArray
 {
@@ -244,6 +251,11 @@ namespace MArray
         return {from, to, delta};
     }
 
+    /*
+     * A vector which keeps up to N elements in place and only allocates
+     * when it grows beyond that, for short lists such as the lengths and
+     * strides of a tensor.
+     */
     template <typename T, size_t N, typename Allocator=std::allocator<T>>
     class short_vector
     {
@@ -257,133 +269,100 @@ namespace MArray
             typedef ptrdiff_t difference_type;
             typedef value_type& reference;
             typedef const value_type& const_reference;
-            typedef typename _alloc_traits::pointer pointer;
-            typedef typename _alloc_traits::const_pointer const_pointer;
+            typedef T* pointer;
+            typedef const T* const_pointer;
             typedef pointer iterator;
             typedef const_pointer const_iterator;
             typedef std::reverse_iterator<iterator> reverse_iterator;
             typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
 
             explicit short_vector(const Allocator& alloc = Allocator())
-            : _size(0), _alloc(alloc, _local_data()) {}
+            : _alloc(alloc, _local_data()) {}
 
             short_vector(size_type count, const T& value,
                          const Allocator& alloc = Allocator())
-            : _size(0), _alloc(alloc, _local_data())
+            : _alloc(alloc, _local_data())
             {
                 assign(count, value);
             }
 
             explicit short_vector(size_type count)
-            : _size(0), _alloc(Allocator(), _local_data())
+            : _alloc(Allocator(), _local_data())
             {
-                assign(count, T());
+                resize(count);
             }
 
-            template <typename Iterator>
+            template <typename Iterator, typename=decltype(*std::declval<Iterator>())>
             short_vector(Iterator first, Iterator last,
                          const Allocator& alloc = Allocator())
-            : _size(0), _alloc(alloc, _local_data())
+            : _alloc(alloc, _local_data())
             {
                 assign(first, last);
             }
 
             short_vector(const short_vector& other)
-            : _size(0), _alloc(_alloc_traits::select_on_container_copy_construction(other._alloc),
-                               _local_data())
+            : _alloc(_alloc_traits::select_on_container_copy_construction(other._alloc),
+                     _local_data())
             {
                 assign(other.begin(), other.end());
             }
 
             short_vector(const short_vector& other, const Allocator& alloc)
-            : _size(0), _alloc(alloc, _local_data())
+            : _alloc(alloc, _local_data())
             {
                 assign(other.begin(), other.end());
             }
 
             short_vector(short_vector&& other)
-            : _size(other._size), _alloc(std::move(other._alloc), _local_data())
+            : _alloc(std::move(other._alloc), _local_data())
             {
-                if (other._is_local())
-                {
-                    _uninitialized_move_n_if(other.data(), other.size(), data());
-                    other.clear();
-                }
-                else
-                {
-                    _capacity = other._capacity;
-                    _alloc._data = other._alloc._data;
-                    other._size = 0;
-                    other._alloc._data = other._local_data();
-                }
+                _steal(other);
             }
 
             short_vector(short_vector&& other, const Allocator& alloc)
-            : _size(other._size), _alloc(alloc, _local_data())
+            : _alloc(alloc, _local_data())
             {
-                if (other._is_local() || alloc != other._alloc)
-                {
-                    reserve(size());
-                    _uninitialized_move_n_if(other.data(), size(), data());
-                    other.clear();
-                }
-                else
-                {
-                    _capacity = other._capacity;
-                    _alloc._data = other._alloc._data;
-                    other._size = 0;
-                    other._alloc._data = other._local_data();
-                }
+                _steal(other);
             }
 
             short_vector(std::initializer_list<T> init,
                          const Allocator& alloc = Allocator())
-            : _size(0), _alloc(alloc, _local_data())
+            : _alloc(alloc, _local_data())
             {
                 assign(init.begin(), init.end());
             }
 
+            /*
+             * Conversion from other containers, e.g. std::vector.
+             */
+            template <typename U, typename=decltype(std::declval<const U&>().begin()),
+                      typename=typename std::enable_if<!std::is_same<U,short_vector>::value>::type>
+            short_vector(const U& other, const Allocator& alloc = Allocator())
+            : _alloc(alloc, _local_data())
+            {
+                assign(other.begin(), other.end());
+            }
+
             ~short_vector()
             {
-                _set_capacity(0);
+                clear();
+                _release();
             }
 
             short_vector& operator=(const short_vector& other)
             {
-                if (_alloc_traits::propagate_on_container_copy_assignment::value)
-                    _alloc = other._alloc;
-
-                assign(other.begin(), other.end());
-
+                if (this != &other) assign(other.begin(), other.end());
                 return *this;
             }
 
             short_vector& operator=(short_vector&& other)
             {
-                if (_alloc_traits::propagate_on_container_move_assignment::value)
-                    _alloc = std::move(other._alloc);
-
-                if (other._is_local() || (!_alloc_traits::propagate_on_container_move_assignment::value && _alloc != other._alloc))
-                {
-                    assign(other.begin(), other.end());
-                    other.clear();
-                }
-                else if (_is_local())
+                if (this != &other)
                 {
                     clear();
-                    _size = other._size;
-                    _capacity = other._capacity;
-                    _alloc._data = other._alloc._data;
-                    other._size = 0;
-                    other._alloc._data = other._local_data();
-                }
-                else
-                {
-                    swap(_size, other._size);
-                    swap(_capacity, other._capacity);
-                    swap(_alloc._data, other._alloc._data);
+                    _release();
+                    _steal(other);
                 }
-
                 return *this;
             }
 
@@ -395,26 +374,18 @@ namespace MArray
 
             void assign(size_type count, const T& value)
             {
-                if (capacity() < count)
-                {
-                    clear();
-                    reserve(count);
-                }
-
-                if (size() > count)
-                    erase(begin()+count, end());
-                std::fill_n(begin(), std::min(count, size()), value);
-                if (count > size())
-                    _construct_n(end(), count-size(), value);
-
+                clear();
+                reserve(count);
+                _construct_n(begin(), count, value);
                 _size = count;
             }
 
             template <typename Iterator>
             void assign(Iterator first, Iterator last)
             {
-                _assign(first, last, typename std::iterator_traits<Iterator>
-                                                 ::iterator_category());
+                clear();
+                _reserve_for(first, last, typename std::iterator_traits<Iterator>::iterator_category());
+                for (;first != last;++first) emplace_back(*first);
             }
 
             void assign(std::initializer_list<T> ilist)
@@ -427,6 +398,11 @@ namespace MArray
                 return _alloc;
             }
 
+            operator std::vector<T>() const
+            {
+                return std::vector<T>(begin(), end());
+            }
+
             reference at(size_type pos)
             {
                 if (pos >= size())
@@ -513,32 +489,32 @@ namespace MArray
 
             reverse_iterator rbegin()
             {
-                return end();
+                return reverse_iterator(end());
             }
 
             const_reverse_iterator rbegin() const
             {
-                return end();
+                return const_reverse_iterator(end());
             }
 
             const_reverse_iterator crbegin() const
             {
-                return end();
+                return const_reverse_iterator(end());
             }
 
             reverse_iterator rend()
             {
-                return begin();
+                return reverse_iterator(begin());
             }
 
             const_reverse_iterator rend() const
             {
-                return begin();
+                return const_reverse_iterator(begin());
             }
 
             const_reverse_iterator crend() const
             {
-                return begin();
+                return const_reverse_iterator(begin());
             }
 
             bool empty() const
@@ -553,49 +529,56 @@ namespace MArray
 
             size_type max_size() const
             {
-                return std::numeric_limits<size_type>::max();
+                return std::numeric_limits<size_type>::max()/sizeof(T);
             }
 
             void reserve(size_type new_cap)
             {
                 if (new_cap > capacity())
-                    _set_capacity(_new_capacity(capacity(), new_cap));
+                    _set_capacity(std::max(2*capacity(), new_cap));
             }
 
             size_type capacity() const
             {
-                return (_is_local() ? N : _capacity);
+                return _capacity;
             }
 
             void shrink_to_fit()
             {
-                _set_capacity(size());
+                if (!_is_local()) _set_capacity(std::max(size(), N));
             }
 
             void clear()
             {
-                erase(begin(), end());
+                _destroy(begin(), end());
+                _size = 0;
             }
 
             iterator insert(const_iterator pos, const T& value)
             {
-                return _emplace(pos, 1, value);
+                return insert(pos, size_type(1), value);
             }
 
             iterator insert(const_iterator pos, T&& value)
             {
-                return _emplace(pos, 1, std::move(value));
+                return emplace(pos, std::move(value));
             }
 
             iterator insert(const_iterator pos, size_type count, const T& value)
             {
-                return _emplace(pos, count, value);
+                T tmp(value);
+                size_type off = _make_gap(pos, count);
+                std::fill_n(begin()+off, count, tmp);
+                return begin()+off;
             }
 
-            template <typename Iterator>
+            template <typename Iterator, typename=decltype(*std::declval<Iterator>())>
             iterator insert(const_iterator pos, Iterator first, Iterator last)
             {
-                return _insert(pos, first, last, typename std::iterator_traits<Iterator>::iterator_category());
+                short_vector tmp(first, last);
+                size_type off = _make_gap(pos, tmp.size());
+                std::move(tmp.begin(), tmp.end(), begin()+off);
+                return begin()+off;
             }
 
             iterator insert(const_iterator pos, std::initializer_list<T> ilist)
@@ -606,7 +589,10 @@ namespace MArray
             template <typename... Args>
             iterator emplace(const_iterator pos, Args&&... args)
             {
-                return _emplace(pos, 1, std::forward<Args>(args)...);
+                T tmp(std::forward<Args>(args)...);
+                size_type off = _make_gap(pos, 1);
+                begin()[off] = std::move(tmp);
+                return begin()+off;
             }
 
             iterator erase(const_iterator pos)
@@ -616,27 +602,39 @@ namespace MArray
 
             iterator erase(const_iterator first, const_iterator last)
             {
-                size_type n = last-first;
-                std::move(last, end(), first);
-                _destroy(end()-n, end());
-                _size -= n;
-                return const_cast<iterator>(first);
+                iterator f = begin()+(first-cbegin());
+                iterator l = begin()+(last-cbegin());
+                if (f == l) return f;
+                iterator new_end = std::move(l, end(), f);
+                _destroy(new_end, end());
+                _size = new_end-begin();
+                return f;
             }
 
             void push_back(const T& value)
             {
-                _emplace(end(), 1, value);
+                emplace_back(value);
             }
 
             void push_back(T&& value)
             {
-                _emplace(end(), 1, std::move(value));
+                emplace_back(std::move(value));
             }
 
             template <typename... Args>
             void emplace_back(Args&&... args)
             {
-                _emplace(end(), 1, std::forward<Args>(args)...);
+                if (size() == capacity())
+                {
+                    T tmp(std::forward<Args>(args)...);
+                    reserve(size()+1);
+                    _alloc_traits::construct(_alloc, end(), std::move(tmp));
+                }
+                else
+                {
+                    _alloc_traits::construct(_alloc, end(), std::forward<Args>(args)...);
+                }
+                _size++;
             }
 
             void pop_back()
@@ -646,71 +644,38 @@ namespace MArray
 
             void resize(size_type count)
             {
-                resize(count, T());
-            }
-
-            void resize(size_type count, const value_type& value)
-            {
-                reserve(count);
                 if (count < size())
-                    _destroy(begin()+count, end());
-                else if (count > size())
-                    _construct_n(end(), count-size(), value);
-                _size = count;
-            }
-
-            void swap(short_vector& other)
-            {
-                using std::swap;
-
-                if (_alloc_traits::propagate_on_container_swap::value)
-                    swap(_alloc, other._alloc);
-
-                if ((_is_local() && other._is_local()) ||
-                    (!_alloc_traits::propagate_on_container_swap::value && _alloc != other._alloc))
                 {
-                    reserve(other.size());
-                    other.reserve(size());
-
-                    std::swap_ranges(begin(), begin()+std::min(size(), other.size()), other.begin());
-                    if (size() < other.size())
-                    {
-                        _unitialized_move_n_if(other.begin()+size(), other.size()-size(), end());
-                        _destroy(other.begin()+size(), other.end());
-                    }
-                    else if (size() > other.size())
-                    {
-                        _unitialized_move_n_if(begin()+other.size(), size()-other.size(), other.end());
-                        _destroy(begin()+other.size(), end());
-                    }
+                    erase(begin()+count, end());
                 }
-                else if (_is_local())
+                else
                 {
-                    size_type other_cap = other.capacity();
-                    pointer other_data = other.data();
-                    other._alloc._data = other._local_data();
-                    _unitialized_move_n_if(begin(), size(), other.begin());
-                    _destroy(begin(), end());
-                    _capacity = other_cap;
-                    _alloc._data = other_data;
+                    reserve(count);
+                    _construct_n(end(), count-size());
+                    _size = count;
                 }
-                else if (other._is_local())
+            }
+
+            void resize(size_type count, const value_type& value)
+            {
+                if (count < size())
                 {
-                    size_type this_cap = capacity();
-                    pointer this_data = data();
-                    _alloc._data = _local_data();
-                    _unitialized_move_n_if(other.begin(), other.size(), begin());
-                    _destroy(other.begin(), other.end());
-                    other._capacity = this_cap;
-                    other._alloc._data = this_data;
+                    erase(begin()+count, end());
                 }
                 else
                 {
-                    swap(_capacity, other._capacity);
-                    swap(_alloc._data, other._alloc._data);
+                    T tmp(value);
+                    reserve(count);
+                    _construct_n(end(), count-size(), tmp);
+                    _size = count;
                 }
+            }
 
-                swap(_size, other._size);
+            void swap(short_vector& other)
+            {
+                short_vector tmp(std::move(other));
+                other = std::move(*this);
+                *this = std::move(tmp);
             }
 
             friend void swap(short_vector& lhs, short_vector& rhs)
@@ -756,230 +721,150 @@ namespace MArray
                 return !(lhs < rhs);
             }
 
-        protected:
-            void _set_capacity(size_type new_cap)
+            /*
+             * Concatenation, as for std::vector in stl_ext.
+             */
+            friend short_vector operator+(short_vector lhs,
+                                          const short_vector& rhs)
             {
-                size_type old_cap = capacity();
-                pointer old_data = data();
-
-                if (new_cap <= N)
-                {
-                    if (_is_local()) return;
-                    _alloc._data = _local_data();
-                }
-                else
-                {
-                    _capacity = new_cap;
-                    _alloc._data = _alloc_traits::allocate(_alloc, _capacity);
-                }
-
-                if (new_cap < size()) _destroy(old_data+new_cap, old_data+size());
-                _uninitialized_move_n_if(old_data, std::min(new_cap, size()), data());
-                _alloc_traits::deallocate(_alloc, old_data, old_cap);
+                lhs.insert(lhs.end(), rhs.begin(), rhs.end());
+                return lhs;
             }
 
-            template <typename Iterator>
-            void _destroy(iterator first, iterator last)
+        protected:
+            /*
+             * Move the elements to new storage of new_cap elements (the
+             * local buffer if they fit), which must hold at least size().
+             */
+            void _set_capacity(size_type new_cap)
             {
-                if (first == last) return;
-                for (--last;last != first;--last)
-                    _alloc_traits::destroy(_alloc, last);
-            }
+                pointer old_data = data();
+                pointer new_data = (new_cap <= N ? _local_data() :
+                                    _alloc_traits::allocate(_alloc, new_cap));
 
-            template <typename Iterator>
-            iterator _construct(Iterator first, Iterator last, iterator result)
-            {
-                iterator cur = result;
+                if (new_data == old_data) return;
 
-                try
+                for (size_type i = 0;i < size();i++)
                 {
-                    for (;first != last;++first, ++cur)
-                        _alloc_traits::construct(_alloc, cur, *first);
-                }
-                catch (...)
-                {
-                    _destroy(result, cur);
-                    throw;
+                    _alloc_traits::construct(_alloc, new_data+i, std::move(old_data[i]));
+                    _alloc_traits::destroy(_alloc, old_data+i);
                 }
 
-                return result;
+                _release();
+                _alloc._data = new_data;
+                _capacity = std::max(new_cap, N);
             }
 
-            template <typename... Args>
-            iterator _construct_n(iterator result, size_type n, Args&&... args)
+            /*
+             * Free the heap storage, if any. The elements must already have
+             * been destroyed or moved out.
+             */
+            void _release()
             {
-                iterator last = result+n;
-                iterator cur = result;
+                if (!_is_local())
+                    _alloc_traits::deallocate(_alloc, data(), _capacity);
 
-                try
-                {
-                    for (;cur != last;++cur)
-                        _alloc_traits::construct(_alloc, cur, std::forward<Args>(args)...);
-                }
-                catch (...)
-                {
-                    _destroy(result, cur);
-                    throw;
-                }
-
-                return result;
+                _alloc._data = _local_data();
+                _capacity = N;
             }
 
-            iterator _uninitialized_move_n_if(iterator first, size_type n, iterator result)
+            /*
+             * Take the elements of other, which is left empty.
+             */
+            void _steal(short_vector& other)
             {
-                if (std::is_nothrow_move_constructible<T>::value ||
-                    !std::is_copy_constructible<T>::value)
+                if (other._is_local())
                 {
-                    auto it = std::make_move_iterator(first);
-                    return _construct(it, it+n, result);
+                    for (size_type i = 0;i < other.size();i++)
+                        _alloc_traits::construct(_alloc, data()+i, std::move(other[i]));
+                    _size = other.size();
+                    other.clear();
                 }
                 else
                 {
-                    return _construct(first, first+n, result);
+                    _alloc._data = other._alloc._data;
+                    _capacity = other._capacity;
+                    _size = other._size;
+                    other._alloc._data = other._local_data();
+                    other._capacity = N;
+                    other._size = 0;
                 }
             }
 
-            template <typename... Args>
-            iterator _emplace(const_iterator pos, size_type n, Args&&... args)
+            template <typename Iterator>
+            void _reserve_for(Iterator first, Iterator last, std::forward_iterator_tag)
             {
-                size_type off = pos-begin();
-                reserve(size()+n);
-                pos = begin()+off;
-
-                size_type n_tail = end()-pos;
-                size_type n_move = std::min(n, n_tail);
-                size_type n_ctr = (pos+n)-end();
-                _uninitialized_move_n_if(end()-n_move, n_move, end()+n_ctr);
-                try
-                {
-                    _construct_n(end(), n_ctr, std::forward<Args>(args)...);
-                }
-                catch (...)
-                {
-                    _destroy(end()+n_ctr, end()+n_ctr+n_move);
-                    throw;
-                }
-
-                n_move = n_tail-n_move;
-                n_ctr = n-n_ctr;
-                try
-                {
-                    std::move_backward(pos, pos+n_move, end());
-                    std::fill_n(pos, n_ctr, T(std::forward<Args>(args)...));
-                }
-                catch (...)
-                {
-                    _destroy(end(), end()+n);
-                    throw;
-                }
-
-                _size += n;
-                return begin()+off+n;
+                reserve(std::distance(first, last));
             }
 
             template <typename Iterator>
-            iterator _insert(const_iterator pos, Iterator first, Iterator last,
-                             std::input_iterator_tag)
+            void _reserve_for(Iterator, Iterator, std::input_iterator_tag) {}
+
+            void _destroy(iterator first, iterator last)
             {
                 for (;first != last;++first)
-                {
-                    pos = _emplace(pos, 1, *first);
-                }
+                    _alloc_traits::destroy(_alloc, first);
             }
 
-            template <typename Iterator>
-            void _insert(const_iterator pos, Iterator first, Iterator last,
-                         std::random_access_iterator_tag)
-            {
-                size_type n = last-first;
-                size_type off = pos-begin();
-                reserve(size()+n);
-                pos = begin()+off;
-
-                size_type n_tail = end()-pos;
-                size_type n_move = std::min(n, n_tail);
-                size_type n_ctr = (pos+n)-end();
-                _uninitialized_move_n_if(end()-n_move, n_move, end()+n_ctr);
-                try
-                {
-                    _construct(last-n_ctr, last, end());
-                }
-                catch (...)
-                {
-                    _destroy(end()+n_ctr, end()+n_ctr+n_move);
-                    throw;
-                }
-
-                n_move = n_tail-n_move;
-                n_ctr = n-n_ctr;
-                try
-                {
-                    std::move_backward(pos, pos+n_move, end());
-                    std::fill(first, first+n_ctr, pos);
-                }
-                catch (...)
-                {
-                    _destroy(end(), end()+n);
-                    throw;
-                }
-
-                _size += n;
-                return begin()+off+n;
+            template <typename... Args>
+            void _construct_n(iterator result, size_type n, const Args&... args)
+            {
+                for (size_type i = 0;i < n;i++)
+                    _alloc_traits::construct(_alloc, result+i, args...);
             }
 
-            static size_type _new_capacity(size_type capacity, size_type count)
+            /*
+             * Open up n default-constructed slots at pos, returning their
+             * offset from begin().
+             */
+            size_type _make_gap(const_iterator pos, size_type n)
             {
-                return std::max(2*capacity, count);
+                size_type off = pos-cbegin();
+                size_type old_size = size();
+                if (n == 0) return off;
+                resize(old_size+n);
+                std::move_backward(begin()+off, begin()+old_size, end());
+                return off;
             }
 
             pointer _local_data()
             {
-                return &_fixed[0];
+                return reinterpret_cast<pointer>(&_local);
             }
 
             const_pointer _local_data() const
             {
-                return &_fixed[0];
+                return reinterpret_cast<const_pointer>(&_local);
             }
 
             bool _is_local() const
             {
-                return _alloc._data == _local_data();
+                return data() == _local_data();
             }
 
-            size_type _size;
             struct _data_s : public Allocator
             {
-                _data_s(Allocator alloc, pointer data)
+                _data_s(const Allocator& alloc, pointer data)
                 : Allocator(alloc), _data(data) {}
 
-                _data_s(const _data_s& other, pointer data)
-                : Allocator(other), _data(data) {}
-
-                _data_s(_data_s&& other, pointer data)
-                : Allocator(std::move(other)), _data(data) {}
-
-                _data_s& operator=(const _data_s& other)
-                {
-                    Allocator::operator=(other);
-                    return *this;
-                }
-
-                _data_s& operator=(_data_s&& other)
-                {
-                    Allocator::operator=(std::move(other));
-                    return *this;
-                }
+                _data_s(Allocator&& alloc, pointer data)
+                : Allocator(std::move(alloc)), _data(data) {}
 
                 pointer _data;
             } _alloc;
 
-            union
-            {
-                std::array<T,N> _fixed;
-                size_type _capacity;
-            };
+            size_type _size = 0;
+            size_type _capacity = N;
+            typename std::aligned_storage<sizeof(T)*N, alignof(T)>::type _local;
     };
+
+    /*
+     * The lengths, strides, or position of a tensor with an arbitrary
+     * number of dimensions, stored in place for up to MARRAY_OPT_NDIM of
+     * them.
+     */
+    template <typename T>
+    using dim_vector = short_vector<T, MARRAY_OPT_NDIM>;
 }
 
 #endif
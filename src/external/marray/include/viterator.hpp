@@ -126,7 +126,7 @@ class viterator
             return _pos[dim];
         }
 
-        const std::vector<idx_type>& position() const
+        const dim_vector<idx_type>& position() const
         {
             return _pos;
         }
@@ -136,7 +136,7 @@ class viterator
             return _len[dim];
         }
 
-        const std::vector<idx_type>& lengths() const
+        const dim_vector<idx_type>& lengths() const
         {
             return _len;
         }
@@ -146,7 +146,7 @@ class viterator
             return _strides[i][dim];
         }
 
-        const std::vector<stride_type>& strides(unsigned i) const
+        const dim_vector<stride_type>& strides(unsigned i) const
         {
             return _strides[i];
         }
@@ -164,9 +164,9 @@ class viterator
 
     private:
         size_t _ndim = 0;
-        std::vector<idx_type> _pos;
-        std::vector<idx_type> _len;
-        std::array<std::vector<stride_type>,N> _strides;
+        dim_vector<idx_type> _pos;
+        dim_vector<idx_type> _len;
+        std::array<dim_vector<stride_type>,N> _strides;
         bool _first = true;
         bool _empty = true;
 };
@@ -82,6 +82,14 @@ int tci_comm_bcast_nowait(tci_comm* comm, void** object, unsigned root)
     }
 }
 
+int tci_comm_reduce(tci_comm* comm, void* data, size_t size,
+                    void (*op)(void*, const void*, void*), void* user)
+{
+    if (!comm->context) return 0;
+    return tci_context_reduce(comm->context, comm->nthread, comm->tid,
+                              data, size, op, user);
+}
+
 int tci_comm_gang(tci_comm* parent, tci_comm* child,
                   int type, unsigned n, unsigned bs)
 {
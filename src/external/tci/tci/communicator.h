@@ -44,6 +44,16 @@ int tci_comm_bcast(tci_comm* comm, void** object, unsigned root);
 
 int tci_comm_bcast_nowait(tci_comm* comm, void** object, unsigned root);
 
+/*
+ * Combine size bytes at data over all threads in the communicator. op(accum,
+ * other, user) must fold the partial result other into accum; it is applied
+ * along a binomial tree rooted at thread 0, in an order which depends only on
+ * the number of threads. On return, data holds the full result on every
+ * thread.
+ */
+int tci_comm_reduce(tci_comm* comm, void* data, size_t size,
+                    void (*op)(void*, const void*, void*), void* user);
+
 int tci_comm_gang(tci_comm* parent, tci_comm* child,
                   int type, unsigned n, unsigned bs);
 
@@ -162,6 +172,25 @@ class communicator
             tci_comm_bcast_nowait(*this, reinterpret_cast<void**>(&object), root);
         }
 
+        template <typename T, typename Op>
+        void reduce(T& value, Op op) const
+        {
+            if (!_comm.context) return;
+
+            struct wrapper
+            {
+                static void apply(void* accum, const void* other, void* user)
+                {
+                    (*static_cast<Op*>(user))(*static_cast<T*>(accum),
+                                              *static_cast<const T*>(other));
+                }
+            };
+
+            int ret = tci_comm_reduce(*this, &value, sizeof(T),
+                                      &wrapper::apply, &op);
+            if (ret != 0) throw std::system_error(ret, std::system_category());
+        }
+
         communicator gang(int type, unsigned n, unsigned bs=0) const
         {
             communicator child;
@@ -1,6 +1,7 @@
 #include "tci.h"
 
 #include <stdlib.h>
+#include <string.h>
 #include <errno.h>
 
 int tci_context_init(tci_context** context,
@@ -10,7 +11,27 @@ int tci_context_init(tci_context** context,
     if (!*context) return ENOMEM;
     (*context)->refcount = 0;
     (*context)->buffer = NULL;
-    return tci_barrier_init(&(*context)->barrier, nthread, group_size);
+    (*context)->reduce_buffer[0] = (*context)->reduce_buffer[1] = NULL;
+    (*context)->reduce_size[0] = (*context)->reduce_size[1] = 0;
+
+    void* slots;
+    if (posix_memalign(&slots, TCI_CACHE_LINE,
+                       sizeof(tci_reduce_slot)*nthread) != 0)
+    {
+        free(*context);
+        return ENOMEM;
+    }
+
+    (*context)->slots = (tci_reduce_slot*)slots;
+    memset(slots, 0, sizeof(tci_reduce_slot)*nthread);
+
+    int ret = tci_barrier_init(&(*context)->barrier, nthread, group_size);
+    if (ret != 0)
+    {
+        free(slots);
+        free(*context);
+    }
+    return ret;
 }
 
 int tci_context_attach(tci_context* context)
@@ -25,6 +46,9 @@ int tci_context_detach(tci_context* context)
     {
         __atomic_thread_fence(__ATOMIC_ACQUIRE);
         int ret = tci_barrier_destroy(&context->barrier);
+        free(context->reduce_buffer[0]);
+        free(context->reduce_buffer[1]);
+        free(context->slots);
         free(context);
         return ret;
     }
@@ -67,3 +91,70 @@ int tci_context_receive_nowait(tci_context* context,
     *object = context->buffer;
     return 0;
 }
+
+int tci_context_reduce(tci_context* context, unsigned nthread, unsigned tid,
+                       void* data, size_t size,
+                       void (*op)(void*, const void*, void*), void* user)
+{
+    tci_reduce_slot* slots = context->slots;
+    unsigned count = ++slots[tid].count;
+
+    /*
+     * Binomial tree: in round k, threads with bit k set hand their partial
+     * result to tid-2^k and drop out, while the others fold in the result of
+     * tid+2^k. The combination order depends only on nthread, so the result
+     * is reproducible from run to run.
+     */
+    unsigned step;
+    for (step = 1;step < nthread;step <<= 1)
+    {
+        if (tid & step)
+        {
+            slots[tid].data = data;
+            __atomic_store_n(&slots[tid].seq, count, __ATOMIC_RELEASE);
+            break;
+        }
+
+        unsigned child = tid+step;
+        if (child >= nthread) continue;
+
+        while (__atomic_load_n(&slots[child].seq, __ATOMIC_ACQUIRE) != count)
+            tci_yield();
+
+        op(data, slots[child].data, user);
+    }
+
+    /*
+     * The root publishes the result in one of two buffers selected by the
+     * parity of the call, so that the buffer being read by stragglers from
+     * this call is never the one written by the next call. A child's data
+     * stays untouched until the barrier, by which point its parent is done
+     * with it.
+     */
+    unsigned parity = count & 1;
+
+    if (tid == 0)
+    {
+        if (context->reduce_size[parity] < size)
+        {
+            void* buf = realloc(context->reduce_buffer[parity], size);
+            if (buf)
+            {
+                context->reduce_buffer[parity] = buf;
+                context->reduce_size[parity] = size;
+            }
+        }
+
+        if (context->reduce_size[parity] >= size)
+            memcpy(context->reduce_buffer[parity], data, size);
+    }
+
+    int ret = tci_context_barrier(context, tid);
+    if (ret != 0) return ret;
+
+    if (context->reduce_size[parity] < size) return ENOMEM;
+
+    if (tid != 0) memcpy(data, context->reduce_buffer[parity], size);
+
+    return 0;
+}
@@ -5,15 +5,35 @@
 
 #include "barrier.h"
 
+#include <stddef.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+#define TCI_CACHE_LINE 64
+
+/*
+ * Per-thread mailbox used by tci_comm_reduce. Each slot fills a cache line so
+ * that a thread publishing its partial result does not invalidate the line
+ * its siblings are polling.
+ */
+typedef struct
+{
+    void* volatile data;
+    volatile unsigned seq;
+    unsigned count;
+    char padding[TCI_CACHE_LINE-sizeof(void*)-2*sizeof(unsigned)];
+} tci_reduce_slot;
+
 typedef struct
 {
     tci_barrier barrier;
     void* buffer;
     volatile unsigned refcount;
+    tci_reduce_slot* slots;
+    void* reduce_buffer[2];
+    size_t reduce_size[2];
 } tci_context;
 
 int tci_context_init(tci_context** context,
@@ -35,6 +55,10 @@ int tci_context_receive(tci_context* context, unsigned tid, void** object);
 int tci_context_receive_nowait(tci_context* context,
                                unsigned tid, void** object);
 
+int tci_context_reduce(tci_context* context, unsigned nthread, unsigned tid,
+                       void* data, size_t size,
+                       void (*op)(void*, const void*, void*), void* user);
+
 #ifdef __cplusplus
 }
 #endif
@@ -6,9 +6,49 @@
 #include "internal/1t/scale.hpp"
 #include "internal/1t/set.hpp"
 
+#include <memory>
+
 namespace tblis
 {
 
+namespace
+{
+
+/*
+ * Append the strides of each of the n operands of tblis_tensor_add_many with
+ * a nonzero scalar to strides, and their positions to which. The type,
+ * lengths, and indices of each must match those of B.
+ */
+template <typename T>
+void gather_operands(type_t type, unsigned n, const tblis_tensor* A,
+                     const label_type* const* idx_A_,
+                     std::vector<std::vector<stride_type>>& strides,
+                     std::vector<unsigned>& which,
+                     const std::vector<len_type>& len_B,
+                     const std::vector<label_type>& idx_B)
+{
+    for (unsigned i = 0;i < n;i++)
+    {
+        TBLIS_ASSERT(A[i].type == type);
+
+        if (A[i].alpha<T>() == T(0)) continue;
+
+        unsigned ndim_A = A[i].ndim;
+        len_vector len_A;
+        stride_vector stride_A;
+        dim_vector<label_type> idx_A;
+        diagonal(ndim_A, A[i].len, A[i].stride, idx_A_[i], len_A, stride_A, idx_A);
+
+        TBLIS_ASSERT(idx_A == dim_vector<label_type>(idx_B.begin(), idx_B.end()));
+        TBLIS_ASSERT(len_A == len_vector(len_B.begin(), len_B.end()));
+
+        strides.emplace_back(stride_A.begin(), stride_A.end());
+        which.push_back(i);
+    }
+}
+
+}
+
 extern "C"
 {
 
@@ -19,35 +59,58 @@ void tblis_tensor_add(const tblis_comm* comm, const tblis_config* cfg,
     TBLIS_ASSERT(A->type == B->type);
 
     unsigned ndim_A = A->ndim;
-    std::vector<len_type> len_A;
-    std::vector<stride_type> stride_A;
-    std::vector<label_type> idx_A;
+    len_vector len_A;
+    stride_vector stride_A;
+    dim_vector<label_type> idx_A;
     diagonal(ndim_A, A->len, A->stride, idx_A_, len_A, stride_A, idx_A);
 
     unsigned ndim_B = B->ndim;
-    std::vector<len_type> len_B;
-    std::vector<stride_type> stride_B;
-    std::vector<label_type> idx_B;
+    len_vector len_B;
+    stride_vector stride_B;
+    dim_vector<label_type> idx_B;
     diagonal(ndim_B, B->len, B->stride, idx_B_, len_B, stride_B, idx_B);
 
+    /*
+     * Only the folded lengths and strides, which are passed on to the
+     * internal interface, are kept in std::vectors.
+     */
+    std::vector<len_type> len_AB, len_A_only, len_B_only;
+    std::vector<stride_type> stride_A_AB, stride_B_AB, stride_A_only, stride_B_only;
+
     auto idx_AB = stl_ext::intersection(idx_A, idx_B);
-    auto len_AB = stl_ext::select_from(len_A, idx_A, idx_AB);
-    TBLIS_ASSERT(len_AB == stl_ext::select_from(len_B, idx_B, idx_AB));
-    auto stride_A_AB = stl_ext::select_from(stride_A, idx_A, idx_AB);
-    auto stride_B_AB = stl_ext::select_from(stride_B, idx_B, idx_AB);
+    select_into(len_AB, len_A, idx_A, idx_AB);
+    TBLIS_ASSERT(stl_ext::select_from(len_A, idx_A, idx_AB) ==
+                 stl_ext::select_from(len_B, idx_B, idx_AB));
+    select_into(stride_A_AB, stride_A, idx_A, idx_AB);
+    select_into(stride_B_AB, stride_B, idx_B, idx_AB);
 
     auto idx_A_only = stl_ext::exclusion(idx_A, idx_AB);
-    auto len_A_only = stl_ext::select_from(len_A, idx_A, idx_A_only);
-    auto stride_A_only = stl_ext::select_from(stride_A, idx_A, idx_A_only);
+    select_into(len_A_only, len_A, idx_A, idx_A_only);
+    select_into(stride_A_only, stride_A, idx_A, idx_A_only);
 
     auto idx_B_only = stl_ext::exclusion(idx_B, idx_AB);
-    auto len_B_only = stl_ext::select_from(len_B, idx_B, idx_B_only);
-    auto stride_B_only = stl_ext::select_from(stride_B, idx_B, idx_B_only);
+    select_into(len_B_only, len_B, idx_B, idx_B_only);
+    select_into(stride_B_only, stride_B, idx_B, idx_B_only);
 
     fold(len_AB, idx_AB, stride_A_AB, stride_B_AB);
     fold(len_A_only, idx_A_only, stride_A_only);
     fold(len_B_only, idx_B_only, stride_B_only);
 
+    if (TBLIS_IS_NARROW_TYPE(A->type))
+    {
+        TBLIS_WITH_NARROW_TYPE_AS(A->type, T, TS,
+        {
+            parallelize_if(internal::add_mixed<T,TS>, comm, get_config(cfg),
+                           len_A_only, len_B_only, len_AB,
+                           A->alpha<T>(), A->conj, static_cast<const TS*>(A->data), stride_A_only, stride_A_AB,
+                           B->alpha<T>(), B->conj,       static_cast<TS*>(B->data), stride_B_only, stride_B_AB);
+
+            B->alpha<T>() = T(1);
+            B->conj = false;
+        })
+        return;
+    }
+
     TBLIS_WITH_TYPE_AS(A->type, T,
     {
         if (A->alpha<T>() == T(0))
@@ -78,6 +141,100 @@ void tblis_tensor_add(const tblis_comm* comm, const tblis_config* cfg,
     })
 }
 
+void tblis_tensor_add_many(const tblis_comm* comm, const tblis_config* cfg,
+                           unsigned n, const tblis_tensor* A,
+                           const label_type* const* idx_A_,
+                           tblis_tensor* B, const label_type* idx_B_)
+{
+    unsigned ndim_B = B->ndim;
+    std::vector<len_type> len_B;
+    std::vector<stride_type> stride_B;
+    std::vector<label_type> idx_B;
+    diagonal(ndim_B, B->len, B->stride, idx_B_, len_B, stride_B, idx_B);
+
+    /*
+     * The strides of B come first so that the indices are folded and
+     * ordered according to B.
+     */
+    std::vector<std::vector<stride_type>> strides(1, stride_B);
+    std::vector<unsigned> which;
+
+    if (TBLIS_IS_NARROW_TYPE(B->type))
+    {
+        TBLIS_WITH_NARROW_TYPE_AS(B->type, T, TS,
+        {
+            gather_operands<T>(B->type, n, A, idx_A_, strides, which, len_B, idx_B);
+            fold(len_B, idx_B, strides);
+
+            unsigned m = which.size();
+            std::vector<T> alpha(m);
+            std::unique_ptr<bool[]> conj_A(new bool[m]);
+            std::vector<const TS*> data_A(m);
+
+            for (unsigned k = 0;k < m;k++)
+            {
+                alpha[k] = A[which[k]].alpha<T>();
+                conj_A[k] = A[which[k]].conj;
+                data_A[k] = static_cast<const TS*>(A[which[k]].data);
+            }
+
+            parallelize_if(internal::add_many_mixed<T,TS>, comm, get_config(cfg),
+                           len_B, m, alpha.data(), conj_A.get(), data_A.data(),
+                           strides.data()+1,
+                           B->alpha<T>(), B->conj, static_cast<TS*>(B->data),
+                           strides[0]);
+
+            B->alpha<T>() = T(1);
+            B->conj = false;
+        })
+        return;
+    }
+
+    TBLIS_WITH_TYPE_AS(B->type, T,
+    {
+        gather_operands<T>(B->type, n, A, idx_A_, strides, which, len_B, idx_B);
+        fold(len_B, idx_B, strides);
+
+        if (which.empty())
+        {
+            if (B->alpha<T>() == T(0))
+            {
+                parallelize_if(internal::set<T>, comm, get_config(cfg),
+                               len_B, T(0), static_cast<T*>(B->data), strides[0]);
+            }
+            else
+            {
+                parallelize_if(internal::scale<T>, comm, get_config(cfg),
+                               len_B, B->alpha<T>(), B->conj,
+                               static_cast<T*>(B->data), strides[0]);
+            }
+        }
+        else
+        {
+            unsigned m = which.size();
+            std::vector<T> alpha(m);
+            std::unique_ptr<bool[]> conj_A(new bool[m]);
+            std::vector<const T*> data_A(m);
+
+            for (unsigned k = 0;k < m;k++)
+            {
+                alpha[k] = A[which[k]].alpha<T>();
+                conj_A[k] = A[which[k]].conj;
+                data_A[k] = static_cast<const T*>(A[which[k]].data);
+            }
+
+            parallelize_if(internal::add_many<T>, comm, get_config(cfg),
+                           len_B, m, alpha.data(), conj_A.get(), data_A.data(),
+                           strides.data()+1,
+                           B->alpha<T>(), B->conj, static_cast<T*>(B->data),
+                           strides[0]);
+        }
+
+        B->alpha<T>() = T(1);
+        B->conj = false;
+    })
+}
+
 }
 
 }
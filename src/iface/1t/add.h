@@ -18,6 +18,16 @@ void tblis_tensor_add(const tblis_comm* comm, const tblis_config* cfg,
                       const tblis_tensor* A, const label_type* idx_A,
                             tblis_tensor* B, const label_type* idx_B);
 
+/*
+ * Compute B = alpha_0*A[0] + ... + alpha_{n-1}*A[n-1] + beta*B, reading each
+ * tensor and writing B only once. Each A[i] must have the same indices as B,
+ * in any order, and must not overlap B.
+ */
+void tblis_tensor_add_many(const tblis_comm* comm, const tblis_config* cfg,
+                           unsigned n, const tblis_tensor* A,
+                           const label_type* const* idx_A,
+                           tblis_tensor* B, const label_type* idx_B);
+
 #ifdef __cplusplus
 }
 #endif
@@ -55,6 +65,43 @@ void add(const communicator& comm,
     tblis_tensor_add(comm, nullptr, &A_s, idx_A, &B_s, idx_B);
 }
 
+template <typename T>
+void add_many(unsigned n, const T* alpha, const const_tensor_view<T>* A,
+              const label_type* const* idx_A,
+              T beta, tensor_view<T> B, const label_type* idx_B)
+{
+    std::vector<tblis_tensor> A_s;
+    for (unsigned i = 0;i < n;i++) A_s.emplace_back(alpha[i], A[i]);
+    tblis_tensor B_s(beta, B);
+
+    tblis_tensor_add_many(nullptr, nullptr, n, A_s.data(), idx_A, &B_s, idx_B);
+}
+
+template <typename T>
+void add_many(single_t, unsigned n, const T* alpha, const const_tensor_view<T>* A,
+              const label_type* const* idx_A,
+              T beta, tensor_view<T> B, const label_type* idx_B)
+{
+    std::vector<tblis_tensor> A_s;
+    for (unsigned i = 0;i < n;i++) A_s.emplace_back(alpha[i], A[i]);
+    tblis_tensor B_s(beta, B);
+
+    tblis_tensor_add_many(tblis_single, nullptr, n, A_s.data(), idx_A, &B_s, idx_B);
+}
+
+template <typename T>
+void add_many(const communicator& comm,
+              unsigned n, const T* alpha, const const_tensor_view<T>* A,
+              const label_type* const* idx_A,
+              T beta, tensor_view<T> B, const label_type* idx_B)
+{
+    std::vector<tblis_tensor> A_s;
+    for (unsigned i = 0;i < n;i++) A_s.emplace_back(alpha[i], A[i]);
+    tblis_tensor B_s(beta, B);
+
+    tblis_tensor_add_many(comm, nullptr, n, A_s.data(), idx_A, &B_s, idx_B);
+}
+
 #endif
 
 #ifdef __cplusplus
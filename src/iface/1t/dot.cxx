@@ -48,12 +48,16 @@ void tblis_tensor_dot(const tblis_comm* comm, const tblis_config* cfg,
     fold(len_A_only, idx_A_only, stride_A_only);
     fold(len_B_only, idx_B_only, stride_B_only);
 
-    TBLIS_WITH_TYPE_AS(A->type, T,
+    /*
+     * Half-precision and bfloat16 tensors are widened to float as they are
+     * read, and the result is a float.
+     */
+    TBLIS_WITH_STORAGE_TYPE_AS(A->type, T, TS,
     {
-        parallelize_if(internal::dot<T>, comm, get_config(cfg),
+        parallelize_if(internal::dot_mixed<T,TS>, comm, get_config(cfg),
                        len_A_only, len_B_only, len_AB,
-                       A->conj, static_cast<const T*>(A->data), stride_A_only, stride_A_AB,
-                       B->conj, static_cast<const T*>(B->data), stride_B_only, stride_B_AB,
+                       A->conj, static_cast<const TS*>(A->data), stride_A_only, stride_A_AB,
+                       B->conj, static_cast<const TS*>(B->data), stride_B_only, stride_B_AB,
                        result->get<T>());
 
         result->get<T>() *= A->alpha<T>()*B->alpha<T>();
@@ -33,7 +33,7 @@ void dot(const_tensor_view<T> A, const label_type* idx_A,
     tblis_tensor B_s(B);
     tblis_scalar result_s(result);
     tblis_tensor_dot(nullptr, nullptr, &A_s, idx_A, &B_s, idx_B, &result_s);
-    result = result_s.get<T>();
+    result = result_s.get<scalar_type_t<T>>();
 }
 
 template <typename T>
@@ -44,7 +44,7 @@ void dot(single_t, const_tensor_view<T> A, const label_type* idx_A,
     tblis_tensor B_s(B);
     tblis_scalar result_s(result);
     tblis_tensor_dot(tblis_single, nullptr, &A_s, idx_A, &B_s, idx_B, &result_s);
-    result = result_s.get<T>();
+    result = result_s.get<scalar_type_t<T>>();
 }
 
 template <typename T>
@@ -56,7 +56,7 @@ void dot(const communicator& comm,
     tblis_tensor B_s(B);
     tblis_scalar result_s(result);
     tblis_tensor_dot(comm, nullptr, &A_s, idx_A, &B_s, idx_B, &result_s);
-    result = result_s.get<T>();
+    result = result_s.get<scalar_type_t<T>>();
 }
 
 template <typename T>
@@ -0,0 +1,272 @@
+#ifndef _TBLIS_IFACE_1T_MAP_H_
+#define _TBLIS_IFACE_1T_MAP_H_
+
+#include "../../util/thread.h"
+#include "../../util/basic_types.h"
+
+#if defined(__cplusplus) && !defined(TBLIS_DONT_USE_CXX11)
+
+#include "../../util/macros.h"
+#include "../../util/tensor.hpp"
+
+namespace tblis
+{
+
+/*
+ * Element-wise operations with a user functor:
+ *
+ *  map(f, A, idx_A):                 A = f(A)
+ *  map(f, A, idx_A, B, idx_B):       B = f(A)
+ *  zip(f, A, idx_A, B, idx_B, C, idx_C): C = f(A, B)
+ *
+ * All tensors must have the same set of indices (in any order), and repeated
+ * indices select a diagonal as elsewhere. Indices are folded and the loop is
+ * ordered by the strides of the output, with the unit-stride index innermost
+ * so that the functor is inlined into a vectorizable loop.
+ */
+
+namespace detail
+{
+
+struct map_operand
+{
+    std::vector<len_type> len;
+    std::vector<stride_type> stride;
+    std::vector<label_type> idx;
+
+    template <typename View>
+    map_operand(const View& A, const label_type* idx_A)
+    {
+        unsigned ndim = A.dimension();
+        diagonal(ndim, A.lengths().data(), A.strides().data(), idx_A,
+                 len, stride, idx);
+    }
+
+    void check(const map_operand& other) const
+    {
+        TBLIS_ASSERT(idx == other.idx);
+        TBLIS_ASSERT(len == other.len);
+    }
+};
+
+template <typename T>
+T pop_front(std::vector<T>& v, T def)
+{
+    if (v.empty()) return def;
+    T front = v.front();
+    v.erase(v.begin());
+    return front;
+}
+
+/*
+ * Distribute the fibers along the first index over the threads in both the
+ * fiber and outer directions, and call body(m_min, m_max, ptrs...) on each.
+ */
+template <unsigned N, typename Body, typename... Ptrs>
+void map_fibers(const communicator& comm, len_type len0,
+                MArray::viterator<N> iter, len_type n,
+                const Body& body, Ptrs... ptrs)
+{
+    len_type m_min, m_max, n_min, n_max;
+    std::tie(m_min, m_max, std::ignore,
+             n_min, n_max, std::ignore) =
+        comm.distribute_over_threads_2d(len0, n);
+
+    iter.position(n_min, ptrs...);
+
+    for (len_type i = n_min;i < n_max;i++)
+    {
+        iter.next(ptrs...);
+        body(m_min, m_max, ptrs...);
+    }
+
+    comm.barrier();
+}
+
+template <typename Func, typename T>
+void map(const tblis_comm* comm, Func f,
+         tensor_view<T> A, const label_type* idx_A)
+{
+    map_operand op_A(A, idx_A);
+
+    fold(op_A.len, op_A.idx, op_A.stride);
+
+    len_type len0 = pop_front(op_A.len, len_type(1));
+    stride_type stride_A0 = pop_front(op_A.stride, stride_type(0));
+
+    MArray::viterator<1> iter(op_A.len, op_A.stride);
+    len_type n = stl_ext::prod(op_A.len);
+
+    parallelize_if(
+    [&](const communicator& comm)
+    {
+        map_fibers(comm, len0, iter, n,
+        [&](len_type m_min, len_type m_max, T* A)
+        {
+            A += m_min*stride_A0;
+            len_type m = m_max-m_min;
+
+            TBLIS_SPECIAL_CASE(stride_A0 == 1,
+            {
+                for (len_type i = 0;i < m;i++)
+                    A[i*stride_A0] = f(A[i*stride_A0]);
+            })
+        },
+        A.data());
+    }, comm);
+}
+
+template <typename Func, typename T, typename U>
+void map(const tblis_comm* comm, Func f,
+         const_tensor_view<T> A, const label_type* idx_A,
+               tensor_view<U> B, const label_type* idx_B)
+{
+    map_operand op_A(A, idx_A);
+    map_operand op_B(B, idx_B);
+    op_B.check(op_A);
+
+    fold(op_B.len, op_B.idx, op_B.stride, op_A.stride);
+
+    len_type len0 = pop_front(op_B.len, len_type(1));
+    stride_type stride_A0 = pop_front(op_A.stride, stride_type(0));
+    stride_type stride_B0 = pop_front(op_B.stride, stride_type(0));
+
+    MArray::viterator<2> iter(op_B.len, op_A.stride, op_B.stride);
+    len_type n = stl_ext::prod(op_B.len);
+
+    parallelize_if(
+    [&](const communicator& comm)
+    {
+        map_fibers(comm, len0, iter, n,
+        [&](len_type m_min, len_type m_max, const T* A, U* B)
+        {
+            A += m_min*stride_A0;
+            B += m_min*stride_B0;
+            len_type m = m_max-m_min;
+
+            TBLIS_SPECIAL_CASE(stride_A0 == 1 && stride_B0 == 1,
+            {
+                for (len_type i = 0;i < m;i++)
+                    B[i*stride_B0] = f(A[i*stride_A0]);
+            })
+        },
+        A.data(), B.data());
+    }, comm);
+}
+
+template <typename Func, typename T, typename U, typename V>
+void zip(const tblis_comm* comm, Func f,
+         const_tensor_view<T> A, const label_type* idx_A,
+         const_tensor_view<U> B, const label_type* idx_B,
+               tensor_view<V> C, const label_type* idx_C)
+{
+    map_operand op_A(A, idx_A);
+    map_operand op_B(B, idx_B);
+    map_operand op_C(C, idx_C);
+    op_C.check(op_A);
+    op_C.check(op_B);
+
+    fold(op_C.len, op_C.idx, op_C.stride, op_A.stride, op_B.stride);
+
+    len_type len0 = pop_front(op_C.len, len_type(1));
+    stride_type stride_A0 = pop_front(op_A.stride, stride_type(0));
+    stride_type stride_B0 = pop_front(op_B.stride, stride_type(0));
+    stride_type stride_C0 = pop_front(op_C.stride, stride_type(0));
+
+    MArray::viterator<3> iter(op_C.len, op_A.stride, op_B.stride, op_C.stride);
+    len_type n = stl_ext::prod(op_C.len);
+
+    parallelize_if(
+    [&](const communicator& comm)
+    {
+        map_fibers(comm, len0, iter, n,
+        [&](len_type m_min, len_type m_max, const T* A, const U* B, V* C)
+        {
+            A += m_min*stride_A0;
+            B += m_min*stride_B0;
+            C += m_min*stride_C0;
+            len_type m = m_max-m_min;
+
+            TBLIS_SPECIAL_CASE(stride_A0 == 1 && stride_B0 == 1 && stride_C0 == 1,
+            {
+                for (len_type i = 0;i < m;i++)
+                    C[i*stride_C0] = f(A[i*stride_A0], B[i*stride_B0]);
+            })
+        },
+        A.data(), B.data(), C.data());
+    }, comm);
+}
+
+}
+
+template <typename Func, typename T>
+void map(Func f, tensor_view<T> A, const label_type* idx_A)
+{
+    detail::map(nullptr, f, A, idx_A);
+}
+
+template <typename Func, typename T>
+void map(single_t, Func f, tensor_view<T> A, const label_type* idx_A)
+{
+    detail::map(tblis_single, f, A, idx_A);
+}
+
+template <typename Func, typename T>
+void map(const communicator& comm, Func f,
+         tensor_view<T> A, const label_type* idx_A)
+{
+    detail::map(comm, f, A, idx_A);
+}
+
+template <typename Func, typename T, typename U>
+void map(Func f, const_tensor_view<T> A, const label_type* idx_A,
+                       tensor_view<U> B, const label_type* idx_B)
+{
+    detail::map(nullptr, f, A, idx_A, B, idx_B);
+}
+
+template <typename Func, typename T, typename U>
+void map(single_t, Func f, const_tensor_view<T> A, const label_type* idx_A,
+                                 tensor_view<U> B, const label_type* idx_B)
+{
+    detail::map(tblis_single, f, A, idx_A, B, idx_B);
+}
+
+template <typename Func, typename T, typename U>
+void map(const communicator& comm, Func f,
+         const_tensor_view<T> A, const label_type* idx_A,
+               tensor_view<U> B, const label_type* idx_B)
+{
+    detail::map(comm, f, A, idx_A, B, idx_B);
+}
+
+template <typename Func, typename T, typename U, typename V>
+void zip(Func f, const_tensor_view<T> A, const label_type* idx_A,
+                 const_tensor_view<U> B, const label_type* idx_B,
+                       tensor_view<V> C, const label_type* idx_C)
+{
+    detail::zip(nullptr, f, A, idx_A, B, idx_B, C, idx_C);
+}
+
+template <typename Func, typename T, typename U, typename V>
+void zip(single_t, Func f, const_tensor_view<T> A, const label_type* idx_A,
+                           const_tensor_view<U> B, const label_type* idx_B,
+                                 tensor_view<V> C, const label_type* idx_C)
+{
+    detail::zip(tblis_single, f, A, idx_A, B, idx_B, C, idx_C);
+}
+
+template <typename Func, typename T, typename U, typename V>
+void zip(const communicator& comm, Func f,
+         const_tensor_view<T> A, const label_type* idx_A,
+         const_tensor_view<U> B, const label_type* idx_B,
+               tensor_view<V> C, const label_type* idx_C)
+{
+    detail::zip(comm, f, A, idx_A, B, idx_B, C, idx_C);
+}
+
+}
+
+#endif
+
+#endif
@@ -16,6 +16,16 @@ void tblis_tensor_reduce(const tblis_comm* comm, const tblis_config* cfg,
 {
     TBLIS_ASSERT(A->type == result->type);
 
+    /*
+     * Half-precision and bfloat16 tensors are reduced in float, which
+     * tblis_tensor_reduce_multi handles.
+     */
+    if (TBLIS_IS_NARROW_TYPE(A->type))
+    {
+        tblis_tensor_reduce_multi(comm, cfg, 1, &op, A, idx_A_, result, idx);
+        return;
+    }
+
     unsigned ndim_A = A->ndim;
     std::vector<len_type> len_A;
     std::vector<stride_type> stride_A;
@@ -51,6 +61,65 @@ void tblis_tensor_reduce(const tblis_comm* comm, const tblis_config* cfg,
     })
 }
 
+void tblis_tensor_reduce_multi(const tblis_comm* comm, const tblis_config* cfg,
+                               unsigned nop, const reduce_t* op_,
+                               const tblis_tensor* A, const label_type* idx_A_,
+                               tblis_scalar* result, len_type* idx)
+{
+    for (unsigned i = 0;i < nop;i++)
+        TBLIS_ASSERT(A->type == result[i].type);
+
+    unsigned ndim_A = A->ndim;
+    std::vector<len_type> len_A;
+    std::vector<stride_type> stride_A;
+    std::vector<label_type> idx_A;
+    diagonal(ndim_A, A->len, A->stride, idx_A_, len_A, stride_A, idx_A);
+
+    fold(len_A, idx_A, stride_A);
+
+    std::vector<reduce_t> op(op_, op_+nop);
+
+    /*
+     * Half-precision and bfloat16 tensors are widened to float as they are
+     * read, and their results are floats.
+     */
+    TBLIS_WITH_STORAGE_TYPE_AS(A->type, T, TS,
+    {
+        if (A->alpha<T>() < T(0))
+        {
+            for (auto& o : op)
+            {
+                if (o == REDUCE_MIN) o = REDUCE_MAX;
+                else if (o == REDUCE_MAX) o = REDUCE_MIN;
+            }
+        }
+
+        std::vector<T> result_T(nop);
+
+        parallelize_if(internal::reduce_multi_mixed<T,TS>, comm, get_config(cfg),
+                       nop, op.data(), len_A, static_cast<const TS*>(A->data),
+                       stride_A, result_T.data(), idx);
+
+        for (unsigned i = 0;i < nop;i++)
+        {
+            T& res = result_T[i];
+
+            if (A->conj) res = conj(res);
+
+            if (op[i] == REDUCE_SUM)
+            {
+                res *= A->alpha<T>();
+            }
+            else if (op[i] == REDUCE_SUM_ABS || op[i] == REDUCE_NORM_2)
+            {
+                res *= std::abs(A->alpha<T>());
+            }
+
+            result[i].get<T>() = res;
+        }
+    })
+}
+
 }
 
 }
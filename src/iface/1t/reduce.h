@@ -18,6 +18,15 @@ void tblis_tensor_reduce(const tblis_comm* comm, const tblis_config* cfg,
                          reduce_t op, const tblis_tensor* A, const label_type* idx_A,
                          tblis_scalar* result, len_type* idx);
 
+/*
+ * Compute nop reductions of A in a single pass. result and idx must have
+ * room for nop values, and result[i] must have the type of A.
+ */
+void tblis_tensor_reduce_multi(const tblis_comm* comm, const tblis_config* cfg,
+                               unsigned nop, const reduce_t* op,
+                               const tblis_tensor* A, const label_type* idx_A,
+                               tblis_scalar* result, len_type* idx);
+
 #ifdef __cplusplus
 }
 #endif
@@ -30,7 +39,7 @@ void reduce(reduce_t op, const_tensor_view<T> A, const label_type* idx_A, T& res
     tblis_tensor A_s(A);
     tblis_scalar result_s(result);
     tblis_tensor_reduce(nullptr, nullptr, op, &A_s, idx_A, &result_s, &idx);
-    result = result_s.get<T>();
+    result = result_s.get<scalar_type_t<T>>();
 }
 
 template <typename T>
@@ -40,7 +49,7 @@ void reduce(single_t, reduce_t op, const_tensor_view<T> A, const label_type* idx
     tblis_tensor A_s(A);
     tblis_scalar result_s(result);
     tblis_tensor_reduce(tblis_single, nullptr, op, &A_s, idx_A, &result_s, &idx);
-    result = result_s.get<T>();
+    result = result_s.get<scalar_type_t<T>>();
 }
 
 template <typename T>
@@ -50,7 +59,7 @@ void reduce(const communicator& comm, reduce_t op, const_tensor_view<T> A, const
     tblis_tensor A_s(A);
     tblis_scalar result_s(result);
     tblis_tensor_reduce(comm, nullptr, op, &A_s, idx_A, &result_s, &idx);
-    result = result_s.get<T>();
+    result = result_s.get<scalar_type_t<T>>();
 }
 
 template <typename T>
@@ -78,6 +87,40 @@ std::pair<T,len_type> reduce(const communicator& comm, reduce_t op,
     return result;
 }
 
+template <typename T>
+void reduce(unsigned nop, const reduce_t* op, const_tensor_view<T> A,
+            const label_type* idx_A, T* result, len_type* idx)
+{
+    tblis_tensor A_s(A);
+    std::vector<tblis_scalar> result_s(nop, tblis_scalar(T()));
+    tblis_tensor_reduce_multi(nullptr, nullptr, nop, op, &A_s, idx_A,
+                              result_s.data(), idx);
+    for (unsigned i = 0;i < nop;i++) result[i] = result_s[i].get<scalar_type_t<T>>();
+}
+
+template <typename T>
+void reduce(single_t, unsigned nop, const reduce_t* op, const_tensor_view<T> A,
+            const label_type* idx_A, T* result, len_type* idx)
+{
+    tblis_tensor A_s(A);
+    std::vector<tblis_scalar> result_s(nop, tblis_scalar(T()));
+    tblis_tensor_reduce_multi(tblis_single, nullptr, nop, op, &A_s, idx_A,
+                              result_s.data(), idx);
+    for (unsigned i = 0;i < nop;i++) result[i] = result_s[i].get<scalar_type_t<T>>();
+}
+
+template <typename T>
+void reduce(const communicator& comm, unsigned nop, const reduce_t* op,
+            const_tensor_view<T> A, const label_type* idx_A,
+            T* result, len_type* idx)
+{
+    tblis_tensor A_s(A);
+    std::vector<tblis_scalar> result_s(nop, tblis_scalar(T()));
+    tblis_tensor_reduce_multi(comm, nullptr, nop, op, &A_s, idx_A,
+                              result_s.data(), idx);
+    for (unsigned i = 0;i < nop;i++) result[i] = result_s[i].get<scalar_type_t<T>>();
+}
+
 #endif
 
 #ifdef __cplusplus
@@ -22,6 +22,27 @@ void tblis_tensor_scale(const tblis_comm* comm, const tblis_config* cfg,
 
     fold(len_A, idx_A, stride_A);
 
+    if (TBLIS_IS_NARROW_TYPE(A->type))
+    {
+        TBLIS_WITH_NARROW_TYPE_AS(A->type, T, TS,
+        {
+            if (A->alpha<T>() == T(0))
+            {
+                parallelize_if(internal::set_mixed<T,TS>, comm, get_config(cfg), len_A,
+                               T(0), static_cast<TS*>(A->data), stride_A);
+            }
+            else if (A->alpha<T>() != T(1))
+            {
+                parallelize_if(internal::scale_mixed<T,TS>, comm, get_config(cfg), len_A,
+                               A->alpha<T>(), A->conj, static_cast<TS*>(A->data), stride_A);
+            }
+
+            A->alpha<T>() = T(1);
+            A->conj = false;
+        })
+        return;
+    }
+
     TBLIS_WITH_TYPE_AS(A->type, T,
     {
         if (A->alpha<T>() == T(0))
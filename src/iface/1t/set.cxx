@@ -23,6 +23,19 @@ void tblis_tensor_set(const tblis_comm* comm, const tblis_config* cfg,
 
     fold(len_A, idx_A, stride_A);
 
+    if (TBLIS_IS_NARROW_TYPE(A->type))
+    {
+        TBLIS_WITH_NARROW_TYPE_AS(A->type, T, TS,
+        {
+            parallelize_if(internal::set_mixed<T,TS>, comm, get_config(cfg), len_A,
+                           alpha->get<T>(), static_cast<TS*>(A->data), stride_A);
+
+            A->alpha<T>() = T(1);
+            A->conj = false;
+        })
+        return;
+    }
+
     TBLIS_WITH_TYPE_AS(A->type, T,
     {
         parallelize_if(internal::set<T>, comm, get_config(cfg), len_A,
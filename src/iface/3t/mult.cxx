@@ -5,10 +5,163 @@
 #include "internal/1t/scale.hpp"
 #include "internal/1t/set.hpp"
 #include "internal/3t/mult.hpp"
+#include "memory/workspace.hpp"
 
 namespace tblis
 {
 
+namespace
+{
+
+/*
+ * The lengths and strides of each group of indices of a tensor
+ * multiplication, after taking diagonals and folding. Everything is kept in
+ * short vectors, so that tblis_tensor_mult_ws does not touch the heap.
+ */
+struct mult_layout
+{
+    len_vector len_A_only, len_B_only, len_C_only;
+    len_vector len_AB, len_AC, len_BC, len_ABC;
+    stride_vector stride_A_only, stride_A_AB, stride_A_AC, stride_A_ABC;
+    stride_vector stride_B_only, stride_B_AB, stride_B_BC, stride_B_ABC;
+    stride_vector stride_C_only, stride_C_AC, stride_C_BC, stride_C_ABC;
+
+    mult_layout(const tblis_tensor* A, const label_type* idx_A_,
+                const tblis_tensor* B, const label_type* idx_B_,
+                const tblis_tensor* C, const label_type* idx_C_)
+    {
+        unsigned ndim_A = A->ndim;
+        len_vector len_A;
+        stride_vector stride_A;
+        dim_vector<label_type> idx_A;
+        diagonal(ndim_A, A->len, A->stride, idx_A_, len_A, stride_A, idx_A);
+
+        unsigned ndim_B = B->ndim;
+        len_vector len_B;
+        stride_vector stride_B;
+        dim_vector<label_type> idx_B;
+        diagonal(ndim_B, B->len, B->stride, idx_B_, len_B, stride_B, idx_B);
+
+        unsigned ndim_C = C->ndim;
+        len_vector len_C;
+        stride_vector stride_C;
+        dim_vector<label_type> idx_C;
+        diagonal(ndim_C, C->len, C->stride, idx_C_, len_C, stride_C, idx_C);
+
+        auto idx_ABC = stl_ext::intersection(idx_A, idx_B, idx_C);
+        select_into(len_ABC, len_A, idx_A, idx_ABC);
+        TBLIS_ASSERT(stl_ext::select_from(len_A, idx_A, idx_ABC) ==
+                     stl_ext::select_from(len_B, idx_B, idx_ABC));
+        TBLIS_ASSERT(stl_ext::select_from(len_A, idx_A, idx_ABC) ==
+                     stl_ext::select_from(len_C, idx_C, idx_ABC));
+        select_into(stride_A_ABC, stride_A, idx_A, idx_ABC);
+        select_into(stride_B_ABC, stride_B, idx_B, idx_ABC);
+        select_into(stride_C_ABC, stride_C, idx_C, idx_ABC);
+
+        auto idx_AB = stl_ext::exclusion(stl_ext::intersection(idx_A, idx_B), idx_ABC);
+        select_into(len_AB, len_A, idx_A, idx_AB);
+        TBLIS_ASSERT(stl_ext::select_from(len_A, idx_A, idx_AB) ==
+                     stl_ext::select_from(len_B, idx_B, idx_AB));
+        select_into(stride_A_AB, stride_A, idx_A, idx_AB);
+        select_into(stride_B_AB, stride_B, idx_B, idx_AB);
+
+        auto idx_AC = stl_ext::exclusion(stl_ext::intersection(idx_A, idx_C), idx_ABC);
+        select_into(len_AC, len_A, idx_A, idx_AC);
+        TBLIS_ASSERT(stl_ext::select_from(len_A, idx_A, idx_AC) ==
+                     stl_ext::select_from(len_C, idx_C, idx_AC));
+        select_into(stride_A_AC, stride_A, idx_A, idx_AC);
+        select_into(stride_C_AC, stride_C, idx_C, idx_AC);
+
+        auto idx_BC = stl_ext::exclusion(stl_ext::intersection(idx_B, idx_C), idx_ABC);
+        select_into(len_BC, len_B, idx_B, idx_BC);
+        TBLIS_ASSERT(stl_ext::select_from(len_B, idx_B, idx_BC) ==
+                     stl_ext::select_from(len_C, idx_C, idx_BC));
+        select_into(stride_B_BC, stride_B, idx_B, idx_BC);
+        select_into(stride_C_BC, stride_C, idx_C, idx_BC);
+
+        auto idx_A_only = stl_ext::exclusion(idx_A, idx_AB, idx_AC, idx_ABC);
+        select_into(len_A_only, len_A, idx_A, idx_A_only);
+        select_into(stride_A_only, stride_A, idx_A, idx_A_only);
+        auto idx_B_only = stl_ext::exclusion(idx_B, idx_AB, idx_BC, idx_ABC);
+        select_into(len_B_only, len_B, idx_B, idx_B_only);
+        select_into(stride_B_only, stride_B, idx_B, idx_B_only);
+        auto idx_C_only = stl_ext::exclusion(idx_C, idx_AC, idx_BC, idx_ABC);
+        select_into(len_C_only, len_C, idx_C, idx_C_only);
+        select_into(stride_C_only, stride_C, idx_C, idx_C_only);
+
+        TBLIS_ASSERT(stl_ext::intersection(idx_A_only, idx_B_only).empty());
+        TBLIS_ASSERT(stl_ext::intersection(idx_A_only, idx_C_only).empty());
+        TBLIS_ASSERT(stl_ext::intersection(idx_A_only, idx_AB).empty());
+        TBLIS_ASSERT(stl_ext::intersection(idx_A_only, idx_AC).empty());
+        TBLIS_ASSERT(stl_ext::intersection(idx_A_only, idx_BC).empty());
+        TBLIS_ASSERT(stl_ext::intersection(idx_A_only, idx_ABC).empty());
+        TBLIS_ASSERT(stl_ext::intersection(idx_B_only, idx_C_only).empty());
+        TBLIS_ASSERT(stl_ext::intersection(idx_B_only, idx_AB).empty());
+        TBLIS_ASSERT(stl_ext::intersection(idx_B_only, idx_AC).empty());
+        TBLIS_ASSERT(stl_ext::intersection(idx_B_only, idx_BC).empty());
+        TBLIS_ASSERT(stl_ext::intersection(idx_B_only, idx_ABC).empty());
+        TBLIS_ASSERT(stl_ext::intersection(idx_C_only, idx_AB).empty());
+        TBLIS_ASSERT(stl_ext::intersection(idx_C_only, idx_AC).empty());
+        TBLIS_ASSERT(stl_ext::intersection(idx_C_only, idx_BC).empty());
+        TBLIS_ASSERT(stl_ext::intersection(idx_C_only, idx_ABC).empty());
+        TBLIS_ASSERT(stl_ext::intersection(idx_AB, idx_AC).empty());
+        TBLIS_ASSERT(stl_ext::intersection(idx_AB, idx_BC).empty());
+        TBLIS_ASSERT(stl_ext::intersection(idx_AB, idx_ABC).empty());
+        TBLIS_ASSERT(stl_ext::intersection(idx_AC, idx_BC).empty());
+        TBLIS_ASSERT(stl_ext::intersection(idx_AC, idx_ABC).empty());
+        TBLIS_ASSERT(stl_ext::intersection(idx_BC, idx_ABC).empty());
+
+        fold(len_ABC, idx_ABC, stride_A_ABC, stride_B_ABC, stride_C_ABC);
+        fold(len_AB, idx_AB, stride_A_AB, stride_B_AB);
+        fold(len_AC, idx_AC, stride_A_AC, stride_C_AC);
+        fold(len_BC, idx_BC, stride_B_BC, stride_C_BC);
+        fold(len_A_only, idx_A_only, stride_A_only);
+        fold(len_B_only, idx_B_only, stride_B_only);
+        fold(len_C_only, idx_C_only, stride_C_only);
+    }
+};
+
+/*
+ * Add the memory pool blocks which tblis_tensor_mult takes for these
+ * operands on nt threads to blocks.
+ */
+void mult_blocks(const tblis_config* cfg, int nt,
+                 const tblis_tensor* A, const label_type* idx_A,
+                 const tblis_tensor* B, const label_type* idx_B,
+                 const tblis_tensor* C, const label_type* idx_C,
+                 internal::pool_blocks& blocks)
+{
+    TBLIS_ASSERT(A->type == B->type);
+
+    mult_layout l(A, idx_A, B, idx_B, C, idx_C);
+
+    if (A->type != C->type || C->type > TYPE_DCOMPLEX)
+    {
+        TBLIS_WITH_MIXED_TYPES_AS(A->type, C->type, T, TAB, TC,
+        {
+            (void)sizeof(TAB);
+
+            internal::mult_blocks<T>(get_config(cfg), nt,
+                                     l.len_A_only, l.len_B_only, l.len_C_only,
+                                     l.len_AB, l.len_AC, l.len_BC, l.len_ABC,
+                                     true, !std::is_same<T,TC>::value, blocks);
+        })
+    }
+    else
+    {
+        TBLIS_WITH_TYPE_AS(A->type, T,
+        {
+            if (A->alpha<T>()*B->alpha<T>() != T(0))
+                internal::mult_blocks<T>(get_config(cfg), nt,
+                                         l.len_A_only, l.len_B_only, l.len_C_only,
+                                         l.len_AB, l.len_AC, l.len_BC, l.len_ABC,
+                                         false, false, blocks);
+        })
+    }
+}
+
+}
+
 extern "C"
 {
 
@@ -18,91 +171,43 @@ void tblis_tensor_mult(const tblis_comm* comm, const tblis_config* cfg,
                              tblis_tensor* C, const label_type* idx_C_)
 {
     TBLIS_ASSERT(A->type == B->type);
-    TBLIS_ASSERT(A->type == C->type);
-
-    unsigned ndim_A = A->ndim;
-    std::vector<len_type> len_A;
-    std::vector<stride_type> stride_A;
-    std::vector<label_type> idx_A;
-    diagonal(ndim_A, A->len, A->stride, idx_A_, len_A, stride_A, idx_A);
-
-    unsigned ndim_B = B->ndim;
-    std::vector<len_type> len_B;
-    std::vector<stride_type> stride_B;
-    std::vector<label_type> idx_B;
-    diagonal(ndim_B, B->len, B->stride, idx_B_, len_B, stride_B, idx_B);
-
-    unsigned ndim_C = C->ndim;
-    std::vector<len_type> len_C;
-    std::vector<stride_type> stride_C;
-    std::vector<label_type> idx_C;
-    diagonal(ndim_C, C->len, C->stride, idx_C_, len_C, stride_C, idx_C);
-
-    auto idx_ABC = stl_ext::intersection(idx_A, idx_B, idx_C);
-    auto len_ABC = stl_ext::select_from(len_A, idx_A, idx_ABC);
-    TBLIS_ASSERT(len_ABC == stl_ext::select_from(len_B, idx_B, idx_ABC));
-    TBLIS_ASSERT(len_ABC == stl_ext::select_from(len_C, idx_C, idx_ABC));
-    auto stride_A_ABC = stl_ext::select_from(stride_A, idx_A, idx_ABC);
-    auto stride_B_ABC = stl_ext::select_from(stride_B, idx_B, idx_ABC);
-    auto stride_C_ABC = stl_ext::select_from(stride_C, idx_C, idx_ABC);
-
-    auto idx_AB = stl_ext::exclusion(stl_ext::intersection(idx_A, idx_B), idx_ABC);
-    auto len_AB = stl_ext::select_from(len_A, idx_A, idx_AB);
-    TBLIS_ASSERT(len_AB == stl_ext::select_from(len_B, idx_B, idx_AB));
-    auto stride_A_AB = stl_ext::select_from(stride_A, idx_A, idx_AB);
-    auto stride_B_AB = stl_ext::select_from(stride_B, idx_B, idx_AB);
-
-    auto idx_AC = stl_ext::exclusion(stl_ext::intersection(idx_A, idx_C), idx_ABC);
-    auto len_AC = stl_ext::select_from(len_A, idx_A, idx_AC);
-    TBLIS_ASSERT(len_AC == stl_ext::select_from(len_C, idx_C, idx_AC));
-    auto stride_A_AC = stl_ext::select_from(stride_A, idx_A, idx_AC);
-    auto stride_C_AC = stl_ext::select_from(stride_C, idx_C, idx_AC);
-
-    auto idx_BC = stl_ext::exclusion(stl_ext::intersection(idx_B, idx_C), idx_ABC);
-    auto len_BC = stl_ext::select_from(len_B, idx_B, idx_BC);
-    TBLIS_ASSERT(len_BC == stl_ext::select_from(len_C, idx_C, idx_BC));
-    auto stride_B_BC = stl_ext::select_from(stride_B, idx_B, idx_BC);
-    auto stride_C_BC = stl_ext::select_from(stride_C, idx_C, idx_BC);
-
-    auto idx_A_only = stl_ext::exclusion(idx_A, idx_AB, idx_AC, idx_ABC);
-    auto len_A_only = stl_ext::select_from(len_A, idx_A, idx_A_only);
-    auto stride_A_only = stl_ext::select_from(stride_A, idx_A, idx_A_only);
-    auto idx_B_only = stl_ext::exclusion(idx_B, idx_AB, idx_BC, idx_ABC);
-    auto len_B_only = stl_ext::select_from(len_B, idx_B, idx_B_only);
-    auto stride_B_only = stl_ext::select_from(stride_B, idx_B, idx_B_only);
-    auto idx_C_only = stl_ext::exclusion(idx_C, idx_AC, idx_BC, idx_ABC);
-    auto len_C_only = stl_ext::select_from(len_C, idx_C, idx_C_only);
-    auto stride_C_only = stl_ext::select_from(stride_C, idx_C, idx_C_only);
-
-    TBLIS_ASSERT(stl_ext::intersection(idx_A_only, idx_B_only).empty());
-    TBLIS_ASSERT(stl_ext::intersection(idx_A_only, idx_C_only).empty());
-    TBLIS_ASSERT(stl_ext::intersection(idx_A_only, idx_AB).empty());
-    TBLIS_ASSERT(stl_ext::intersection(idx_A_only, idx_AC).empty());
-    TBLIS_ASSERT(stl_ext::intersection(idx_A_only, idx_BC).empty());
-    TBLIS_ASSERT(stl_ext::intersection(idx_A_only, idx_ABC).empty());
-    TBLIS_ASSERT(stl_ext::intersection(idx_B_only, idx_C_only).empty());
-    TBLIS_ASSERT(stl_ext::intersection(idx_B_only, idx_AB).empty());
-    TBLIS_ASSERT(stl_ext::intersection(idx_B_only, idx_AC).empty());
-    TBLIS_ASSERT(stl_ext::intersection(idx_B_only, idx_BC).empty());
-    TBLIS_ASSERT(stl_ext::intersection(idx_B_only, idx_ABC).empty());
-    TBLIS_ASSERT(stl_ext::intersection(idx_C_only, idx_AB).empty());
-    TBLIS_ASSERT(stl_ext::intersection(idx_C_only, idx_AC).empty());
-    TBLIS_ASSERT(stl_ext::intersection(idx_C_only, idx_BC).empty());
-    TBLIS_ASSERT(stl_ext::intersection(idx_C_only, idx_ABC).empty());
-    TBLIS_ASSERT(stl_ext::intersection(idx_AB, idx_AC).empty());
-    TBLIS_ASSERT(stl_ext::intersection(idx_AB, idx_BC).empty());
-    TBLIS_ASSERT(stl_ext::intersection(idx_AB, idx_ABC).empty());
-    TBLIS_ASSERT(stl_ext::intersection(idx_AC, idx_BC).empty());
-    TBLIS_ASSERT(stl_ext::intersection(idx_AC, idx_ABC).empty());
-    TBLIS_ASSERT(stl_ext::intersection(idx_BC, idx_ABC).empty());
-
-    fold(len_ABC, idx_ABC, stride_A_ABC, stride_B_ABC, stride_C_ABC);
-    fold(len_AB, idx_AB, stride_A_AB, stride_B_AB);
-    fold(len_AC, idx_AC, stride_A_AC, stride_C_AC);
-    fold(len_BC, idx_BC, stride_B_BC, stride_C_BC);
-    fold(len_A_only, idx_A_only, stride_A_only);
-    fold(len_B_only, idx_B_only, stride_B_only);
-    fold(len_C_only, idx_C_only, stride_C_only);
+
+    mult_layout l(A, idx_A_, B, idx_B_, C, idx_C_);
+
+    if (A->type != C->type || C->type > TYPE_DCOMPLEX)
+    {
+        /*
+         * Integer and 16-bit floating point tensors are accumulated (and
+         * scaled) in a wider type, as are contractions where C is stored
+         * in a different precision than A and B. Conversion happens while
+         * packing A and B and when writing C, so no converted copies of the
+         * full tensors are made.
+         */
+        TBLIS_WITH_MIXED_TYPES_AS(A->type, C->type, T, TAB, TC,
+        {
+            typedef scalar_type_t<TAB> SAB;
+            typedef scalar_type_t<TC> SC;
+
+            T alpha = T(A->alpha<SAB>())*T(B->alpha<SAB>());
+            T beta = T(C->alpha<SC>());
+
+            parallelize_if(internal::mult_mixed<T, TAB, TAB, TC>,
+                           comm, get_config(cfg),
+                           l.len_A_only, l.len_B_only, l.len_C_only,
+                           l.len_AB, l.len_AC, l.len_BC, l.len_ABC,
+                           alpha, A->conj, static_cast<const TAB*>(A->data),
+                           l.stride_A_only, l.stride_A_AB, l.stride_A_AC, l.stride_A_ABC,
+                                  B->conj, static_cast<const TAB*>(B->data),
+                           l.stride_B_only, l.stride_B_AB, l.stride_B_BC, l.stride_B_ABC,
+                            beta, C->conj, static_cast<TC*>(C->data),
+                           l.stride_C_only, l.stride_C_AC, l.stride_C_BC, l.stride_C_ABC);
+
+            C->alpha<SC>() = SC(1);
+            C->conj = false;
+        })
+
+        return;
+    }
 
     TBLIS_WITH_TYPE_AS(A->type, T,
     {
@@ -114,29 +219,29 @@ void tblis_tensor_mult(const tblis_comm* comm, const tblis_config* cfg,
             if (beta == T(0))
             {
                 parallelize_if(internal::set<T>, comm, get_config(cfg),
-                               len_C_only+len_AC+len_BC+len_ABC,
+                               l.len_C_only+l.len_AC+l.len_BC+l.len_ABC,
                                T(0), static_cast<T*>(C->data),
-                               stride_C_only+stride_C_AC+stride_C_BC+stride_C_ABC);
+                               l.stride_C_only+l.stride_C_AC+l.stride_C_BC+l.stride_C_ABC);
             }
             else
             {
                 parallelize_if(internal::scale<T>, comm, get_config(cfg),
-                               len_C_only+len_AC+len_BC+len_ABC,
+                               l.len_C_only+l.len_AC+l.len_BC+l.len_ABC,
                                beta, C->conj, static_cast<T*>(C->data),
-                               stride_C_only+stride_C_AC+stride_C_BC+stride_C_ABC);
+                               l.stride_C_only+l.stride_C_AC+l.stride_C_BC+l.stride_C_ABC);
             }
         }
         else
         {
             parallelize_if(internal::mult<T>, comm, get_config(cfg),
-                           len_A_only, len_B_only, len_C_only,
-                           len_AB, len_AC, len_BC, len_ABC,
+                           l.len_A_only, l.len_B_only, l.len_C_only,
+                           l.len_AB, l.len_AC, l.len_BC, l.len_ABC,
                            alpha, A->conj, static_cast<const T*>(A->data),
-                           stride_A_only, stride_A_AB, stride_A_AC, stride_A_ABC,
+                           l.stride_A_only, l.stride_A_AB, l.stride_A_AC, l.stride_A_ABC,
                                   B->conj, static_cast<const T*>(B->data),
-                           stride_B_only, stride_B_AB, stride_B_BC, stride_B_ABC,
+                           l.stride_B_only, l.stride_B_AB, l.stride_B_BC, l.stride_B_ABC,
                             beta, C->conj,       static_cast<T*>(C->data),
-                           stride_C_only, stride_C_AC, stride_C_BC, stride_C_ABC);
+                           l.stride_C_only, l.stride_C_AC, l.stride_C_BC, l.stride_C_ABC);
         }
 
         C->alpha<T>() = T(1);
@@ -144,6 +249,62 @@ void tblis_tensor_mult(const tblis_comm* comm, const tblis_config* cfg,
     })
 }
 
+size_t tblis_tensor_mult_workspace_size(const tblis_comm* comm, const tblis_config* cfg,
+                                        const tblis_tensor* A, const label_type* idx_A,
+                                        const tblis_tensor* B, const label_type* idx_B,
+                                        const tblis_tensor* C, const label_type* idx_C)
+{
+    int nt = comm ? reinterpret_cast<const communicator*>(comm)->num_threads()
+                  : tblis_get_num_threads();
+
+    internal::pool_blocks blocks;
+    mult_blocks(cfg, nt, A, idx_A, B, idx_B, C, idx_C, blocks);
+
+    return internal::workspace_size(blocks);
+}
+
+void tblis_tensor_mult_warmup(const tblis_comm* comm, const tblis_config* cfg, unsigned n,
+                              const tblis_tensor* A, const label_type* const* idx_A,
+                              const tblis_tensor* B, const label_type* const* idx_B,
+                              const tblis_tensor* C, const label_type* const* idx_C)
+{
+    int nt = comm ? reinterpret_cast<const communicator*>(comm)->num_threads()
+                  : tblis_get_num_threads();
+
+    internal::pool_blocks blocks;
+    for (unsigned i = 0;i < n;i++)
+        mult_blocks(cfg, nt, &A[i], idx_A[i], &B[i], idx_B[i], &C[i], idx_C[i], blocks);
+
+    parallelize_if(internal::warm_up_pools, comm, blocks);
+}
+
+void tblis_tensor_mult_ws(const tblis_comm* comm, const tblis_config* cfg,
+                          const tblis_tensor* A, const label_type* idx_A,
+                          const tblis_tensor* B, const label_type* idx_B,
+                                tblis_tensor* C, const label_type* idx_C,
+                          void* workspace, size_t size)
+{
+    parallelize_if(
+    [&](const communicator& comm)
+    {
+        /*
+         * All of the threads carve their buffers from the master's
+         * workspace, which must outlive their use of it.
+         */
+        Workspace local(workspace, size);
+        Workspace* ws = &local;
+        comm.broadcast(ws);
+
+        {
+            Workspace::Scope scope(*ws);
+            tblis_tensor_mult(comm, cfg, A, idx_A, B, idx_B, C, idx_C);
+        }
+
+        comm.barrier();
+    },
+    comm);
+}
+
 }
 
 }
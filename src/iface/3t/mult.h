@@ -19,6 +19,46 @@ void tblis_tensor_mult(const tblis_comm* comm, const tblis_config* cfg,
                        const tblis_tensor* B, const label_type* idx_B,
                              tblis_tensor* C, const label_type* idx_C);
 
+/*
+ * The number of bytes of scratch space (packing, scatter, and transposition
+ * buffers) which tblis_tensor_mult can use for these operands, when run on
+ * comm or, if comm is NULL, on tblis_get_num_threads() threads.
+ */
+size_t tblis_tensor_mult_workspace_size(const tblis_comm* comm, const tblis_config* cfg,
+                                        const tblis_tensor* A, const label_type* idx_A,
+                                        const tblis_tensor* B, const label_type* idx_B,
+                                        const tblis_tensor* C, const label_type* idx_C);
+
+/*
+ * Fill the memory pools ahead of time with the packing, scatter, and
+ * transposition buffers which tblis_tensor_mult takes for each of the n
+ * multiplications A[i]*B[i] -> C[i], when run on comm or, if comm is NULL, on
+ * tblis_get_num_threads() threads. Only the lengths and types of the
+ * operands (and which of A and B have a scalar of zero) are used; their data
+ * are not touched.
+ *
+ * The blocks are allocated and their pages touched by the threads of comm,
+ * so that later calls do not allocate or take page faults, unless other
+ * work takes the blocks in the meantime or tblis_flush_memory_pools is
+ * called. The blocks needed by the different shapes overlap, so the total
+ * is only as large as the largest of them needs.
+ */
+void tblis_tensor_mult_warmup(const tblis_comm* comm, const tblis_config* cfg, unsigned n,
+                              const tblis_tensor* A, const label_type* const* idx_A,
+                              const tblis_tensor* B, const label_type* const* idx_B,
+                              const tblis_tensor* C, const label_type* const* idx_C);
+
+/*
+ * Like tblis_tensor_mult, but all scratch space is taken from workspace,
+ * which should be at least as large as tblis_tensor_mult_workspace_size
+ * returns. If it runs out, the remaining buffers come from the memory pools.
+ */
+void tblis_tensor_mult_ws(const tblis_comm* comm, const tblis_config* cfg,
+                          const tblis_tensor* A, const label_type* idx_A,
+                          const tblis_tensor* B, const label_type* idx_B,
+                                tblis_tensor* C, const label_type* idx_C,
+                          void* workspace, size_t size);
+
 #ifdef __cplusplus
 }
 #endif
@@ -63,6 +103,85 @@ void mult(const communicator& comm,
     tblis_tensor_mult(comm, nullptr, &A_s, idx_A, &B_s, idx_B, &C_s, idx_C);
 }
 
+template <typename T>
+size_t mult_workspace_size(const_tensor_view<T> A, const label_type* idx_A,
+                           const_tensor_view<T> B, const label_type* idx_B,
+                           const_tensor_view<T> C, const label_type* idx_C)
+{
+    tblis_tensor A_s(A);
+    tblis_tensor B_s(B);
+    tblis_tensor C_s(C);
+
+    return tblis_tensor_mult_workspace_size(nullptr, nullptr, &A_s, idx_A, &B_s, idx_B, &C_s, idx_C);
+}
+
+template <typename T>
+size_t mult_workspace_size(const communicator& comm,
+                           const_tensor_view<T> A, const label_type* idx_A,
+                           const_tensor_view<T> B, const label_type* idx_B,
+                           const_tensor_view<T> C, const label_type* idx_C)
+{
+    tblis_tensor A_s(A);
+    tblis_tensor B_s(B);
+    tblis_tensor C_s(C);
+
+    return tblis_tensor_mult_workspace_size(comm, nullptr, &A_s, idx_A, &B_s, idx_B, &C_s, idx_C);
+}
+
+template <typename T>
+void mult_warmup(const_tensor_view<T> A, const label_type* idx_A,
+                 const_tensor_view<T> B, const label_type* idx_B,
+                 const_tensor_view<T> C, const label_type* idx_C)
+{
+    tblis_tensor A_s(A);
+    tblis_tensor B_s(B);
+    tblis_tensor C_s(C);
+
+    tblis_tensor_mult_warmup(nullptr, nullptr, 1, &A_s, &idx_A, &B_s, &idx_B, &C_s, &idx_C);
+}
+
+template <typename T>
+void mult_warmup(const communicator& comm,
+                 const_tensor_view<T> A, const label_type* idx_A,
+                 const_tensor_view<T> B, const label_type* idx_B,
+                 const_tensor_view<T> C, const label_type* idx_C)
+{
+    tblis_tensor A_s(A);
+    tblis_tensor B_s(B);
+    tblis_tensor C_s(C);
+
+    tblis_tensor_mult_warmup(comm, nullptr, 1, &A_s, &idx_A, &B_s, &idx_B, &C_s, &idx_C);
+}
+
+template <typename T>
+void mult(T alpha, const_tensor_view<T> A, const label_type* idx_A,
+                   const_tensor_view<T> B, const label_type* idx_B,
+          T  beta,       tensor_view<T> C, const label_type* idx_C,
+          void* workspace, size_t size)
+{
+    tblis_tensor A_s(alpha, A);
+    tblis_tensor B_s(B);
+    tblis_tensor C_s(beta, C);
+
+    tblis_tensor_mult_ws(nullptr, nullptr, &A_s, idx_A, &B_s, idx_B, &C_s, idx_C,
+                         workspace, size);
+}
+
+template <typename T>
+void mult(const communicator& comm,
+          T alpha, const_tensor_view<T> A, const label_type* idx_A,
+                   const_tensor_view<T> B, const label_type* idx_B,
+          T  beta,       tensor_view<T> C, const label_type* idx_C,
+          void* workspace, size_t size)
+{
+    tblis_tensor A_s(alpha, A);
+    tblis_tensor B_s(B);
+    tblis_tensor C_s(beta, C);
+
+    tblis_tensor_mult_ws(comm, nullptr, &A_s, idx_A, &B_s, idx_B, &C_s, idx_C,
+                         workspace, size);
+}
+
 #endif
 
 #ifdef __cplusplus
@@ -0,0 +1,275 @@
+#include "mult_streamed.h"
+#include "mult.h"
+
+#include "iface/1t/scale.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <numeric>
+#include <system_error>
+#include <thread>
+
+#include <unistd.h>
+
+namespace tblis
+{
+
+namespace
+{
+
+using std::chrono::steady_clock;
+
+double seconds_since(steady_clock::time_point t0)
+{
+    return std::chrono::duration<double>(steady_clock::now() - t0).count();
+}
+
+/*
+ * Reads slices of A in turn into two alternating buffers on a helper
+ * thread. Slice i may be read once slice i-2 has been released.
+ *
+ * A is viewed as an inner x len x outer array, split along the middle
+ * index. Each slice is stored densely in its buffer, with the same layout.
+ */
+template <typename T>
+class slice_reader
+{
+    public:
+        slice_reader(int fd, off_t offset, len_type inner, len_type len,
+                     len_type outer, len_type slice_len)
+        : _fd(fd), _offset(offset), _inner(inner), _len(len), _outer(outer),
+          _slice_len(slice_len), _num_slices((len+slice_len-1)/slice_len)
+        {
+            _buffer[0].resize(inner*slice_len*outer);
+            _buffer[1].resize(_num_slices > 1 ? inner*slice_len*outer : 0);
+            _thread = std::thread(&slice_reader::run, this);
+        }
+
+        slice_reader(const slice_reader&) = delete;
+
+        ~slice_reader()
+        {
+            {
+                std::lock_guard<std::mutex> guard(_lock);
+                _cancel = true;
+            }
+            _cv.notify_all();
+            _thread.join();
+        }
+
+        slice_reader& operator=(const slice_reader&) = delete;
+
+        /*
+         * Wait until slice i has been read.
+         */
+        const T* acquire(len_type i)
+        {
+            std::unique_lock<std::mutex> guard(_lock);
+            _cv.wait(guard, [&] { return _filled[i%2] == i || _error; });
+            if (_error) throw std::system_error(_error, std::generic_category(), "pread");
+            return _buffer[i%2].data();
+        }
+
+        void release(len_type i)
+        {
+            {
+                std::lock_guard<std::mutex> guard(_lock);
+                _filled[i%2] = -1;
+            }
+            _cv.notify_all();
+        }
+
+        double read_time()
+        {
+            std::lock_guard<std::mutex> guard(_lock);
+            return _read_time;
+        }
+
+    protected:
+        void run()
+        {
+            for (len_type i = 0;i < _num_slices;i++)
+            {
+                {
+                    std::unique_lock<std::mutex> guard(_lock);
+                    _cv.wait(guard, [&] { return _filled[i%2] == -1 || _cancel; });
+                    if (_cancel) return;
+                }
+
+                auto t0 = steady_clock::now();
+                int err = read(i);
+                double dt = seconds_since(t0);
+
+                {
+                    std::lock_guard<std::mutex> guard(_lock);
+                    _read_time += dt;
+                    if (err) _error = err;
+                    else _filled[i%2] = i;
+                }
+                _cv.notify_all();
+
+                if (err) return;
+            }
+        }
+
+        int read(len_type i)
+        {
+            len_type first = i*_slice_len;
+            len_type n = std::min(_slice_len, _len-first);
+
+            char* buf = reinterpret_cast<char*>(_buffer[i%2].data());
+
+            for (len_type j = 0;j < _outer;j++)
+            {
+                size_t size = _inner*n*sizeof(T);
+                off_t pos = _offset + (j*_len + first)*_inner*sizeof(T);
+
+                while (size > 0)
+                {
+                    ssize_t ret = pread(_fd, buf, size, pos);
+                    if (ret < 0 && errno == EINTR) continue;
+                    if (ret < 0) return errno;
+                    if (ret == 0) return EIO; // the file is too short
+
+                    buf += ret;
+                    size -= ret;
+                    pos += ret;
+                }
+            }
+
+            return 0;
+        }
+
+        int _fd;
+        off_t _offset;
+        len_type _inner; // elements of A inside the split index
+        len_type _len;
+        len_type _outer; // values of the indices outside the split index
+        len_type _slice_len;
+        len_type _num_slices;
+        std::vector<T, aligned_allocator<T,64>> _buffer[2];
+        len_type _filled[2] = {-1, -1}; // the slice in each buffer, if any
+        int _error = 0;
+        bool _cancel = false;
+        double _read_time = 0;
+        std::mutex _lock;
+        std::condition_variable _cv;
+        std::thread _thread;
+};
+
+}
+
+template <typename T>
+mult_streamed_stats mult_streamed(T alpha, int fd, off_t offset,
+                                  const std::vector<len_type>& len_A,
+                                  const label_type* idx_A,
+                                  const_tensor_view<T> B, const label_type* idx_B,
+                                  T beta, tensor_view<T> C, const label_type* idx_C,
+                                  len_type slice_len)
+{
+    auto t0 = steady_clock::now();
+
+    unsigned ndim_A = len_A.size();
+    TBLIS_ASSERT(ndim_A > 0);
+
+    /*
+     * Split along the outermost index of A which is also in C, if there is
+     * one, so that the slices update disjoint parts of C.
+     */
+    unsigned dim_A = ndim_A-1;
+    for (unsigned i = ndim_A;i --> 0;)
+    {
+        if (len_A[i] > 1 &&
+            std::find(idx_C, idx_C+C.dimension(), idx_A[i]) != idx_C+C.dimension())
+        {
+            dim_A = i;
+            break;
+        }
+    }
+
+    label_type idx = idx_A[dim_A];
+    len_type len = len_A[dim_A];
+    len_type inner = std::accumulate(len_A.begin(), len_A.begin()+dim_A, len_type(1),
+                                     std::multiplies<len_type>());
+    len_type outer = std::accumulate(len_A.begin()+dim_A+1, len_A.end(), len_type(1),
+                                     std::multiplies<len_type>());
+    slice_len = std::max<len_type>(1, std::min(slice_len, len));
+
+    mult_streamed_stats stats = {};
+
+    if (len == 0 || inner == 0 || outer == 0)
+    {
+        scale(beta, C, idx_C);
+        stats.total_time = seconds_since(t0);
+        return stats;
+    }
+
+    unsigned dim_B = std::find(idx_B, idx_B+B.dimension(), idx) - idx_B;
+    unsigned dim_C = std::find(idx_C, idx_C+C.dimension(), idx) - idx_C;
+    bool in_B = dim_B < B.dimension();
+    bool in_C = dim_C < C.dimension();
+
+    auto len_A_i = len_A;
+    auto len_B_i = B.lengths();
+    auto len_C_i = C.lengths();
+
+    slice_reader<T> reader(fd, offset, inner, len, outer, slice_len);
+    stats.num_slices = (len+slice_len-1)/slice_len;
+
+    for (len_type i = 0;i < stats.num_slices;i++)
+    {
+        len_type first = i*slice_len;
+        len_type n = std::min(slice_len, len-first);
+
+        auto t1 = steady_clock::now();
+        const T* A_i = reader.acquire(i);
+        stats.wait_time += seconds_since(t1);
+
+        len_A_i[dim_A] = n;
+        const_tensor_view<T> A_v(len_A_i, A_i);
+
+        const T* B_i = B.data();
+        if (in_B)
+        {
+            B_i += first*B.stride(dim_B);
+            len_B_i[dim_B] = n;
+        }
+        const_tensor_view<T> B_v(len_B_i, B_i, B.strides());
+
+        T* C_i = C.data();
+        if (in_C)
+        {
+            C_i += first*C.stride(dim_C);
+            len_C_i[dim_C] = n;
+        }
+        tensor_view<T> C_v(len_C_i, C_i, C.strides());
+
+        /*
+         * If the index is summed over, the later slices accumulate into C.
+         */
+        auto t2 = steady_clock::now();
+        mult(alpha, A_v, idx_A, B_v, idx_B, in_C || i == 0 ? beta : T(1), C_v, idx_C);
+        stats.compute_time += seconds_since(t2);
+
+        reader.release(i);
+    }
+
+    stats.read_time = reader.read_time();
+    stats.total_time = seconds_since(t0);
+
+    return stats;
+}
+
+#define FOREACH_TYPE(T) \
+template mult_streamed_stats mult_streamed(T alpha, int fd, off_t offset, \
+                                           const std::vector<len_type>& len_A, \
+                                           const label_type* idx_A, \
+                                           const_tensor_view<T> B, const label_type* idx_B, \
+                                           T beta, tensor_view<T> C, const label_type* idx_C, \
+                                           len_type slice_len);
+#include "configs/foreach_type.h"
+
+}
@@ -0,0 +1,53 @@
+#ifndef _TBLIS_IFACE_3T_MULT_STREAMED_H_
+#define _TBLIS_IFACE_3T_MULT_STREAMED_H_
+
+#include "../../util/thread.h"
+#include "../../util/basic_types.h"
+
+#ifdef __cplusplus
+
+#include <sys/types.h>
+
+namespace tblis
+{
+
+struct mult_streamed_stats
+{
+    len_type num_slices;
+    double read_time;    /* seconds spent reading slices of A */
+    double compute_time; /* seconds spent in mult */
+    double wait_time;    /* seconds mult was kept waiting for a slice */
+    double total_time;
+};
+
+/*
+ * C = alpha*A*B + beta*C, where A is stored densely (column-major) in the
+ * file fd at the given byte offset, and is too large to keep in memory.
+ *
+ * The contraction is split into slices of up to slice_len values of one
+ * index of A. Each slice is read with pread by a helper thread into one of
+ * two buffers while mult runs on the previous slice, so at most two slices
+ * of A are held in memory at once.
+ *
+ * The index split is the outermost one of A (of length > 1) which also
+ * appears in C. Each slice then updates its own part of C, and the result
+ * is the same as from mult with all of A in memory. A slice is read as one
+ * contiguous piece per value of the indices of A outside the split index.
+ *
+ * If no index of A appears in C, the contraction is split along the
+ * outermost index of A instead, and the slices are summed into C in turn.
+ * This may round differently from mult with all of A in memory.
+ */
+template <typename T>
+mult_streamed_stats mult_streamed(T alpha, int fd, off_t offset,
+                                  const std::vector<len_type>& len_A,
+                                  const label_type* idx_A,
+                                  const_tensor_view<T> B, const label_type* idx_B,
+                                  T beta, tensor_view<T> C, const label_type* idx_C,
+                                  len_type slice_len);
+
+}
+
+#endif
+
+#endif
@@ -1,5 +1,7 @@
 #include "add.hpp"
 
+#include "kernels/1v/stream.hpp"
+
 namespace tblis
 {
 namespace internal
@@ -31,13 +33,22 @@ void add(const communicator& comm, const config& cfg, len_type m, len_type n,
              n_min, n_max, std::ignore) =
         comm.distribute_over_threads_2d(m, n, MR, NR);
 
+    const bool stream = beta == T(0) && std::min(rs_B, cs_B) == 1 &&
+                        use_stream_stores<T>(m*n);
+
     /*
      * If A is row-major and B is column-major or vice versa, use
      * the transpose microkernel.
      */
     if (TWOD)
     {
-        if (beta == T(0))
+        if (stream)
+        {
+            stream_trans_copy(m_max-m_min, n_max-n_min,
+                alpha, conj_A, A + m_min*rs_A + n_min*cs_A, rs_A, cs_A,
+                               B + m_min*rs_B + n_min*cs_B, rs_B, cs_B);
+        }
+        else if (beta == T(0))
         {
             for (len_type i = m_min;i < m_max;i += MR)
             {
@@ -71,7 +82,16 @@ void add(const communicator& comm, const config& cfg, len_type m, len_type n,
      */
     else
     {
-        if (beta == T(0))
+        if (stream && rs_B == 1)
+        {
+            for (len_type j = n_min;j < n_max;j++)
+            {
+                stream_copy(m_max-m_min,
+                    alpha, conj_A, A + m_min*rs_A + j*cs_A, rs_A,
+                                   B + m_min + j*cs_B);
+            }
+        }
+        else if (beta == T(0))
         {
             for (len_type j = n_min;j < n_max;j++)
             {
@@ -91,6 +111,8 @@ void add(const communicator& comm, const config& cfg, len_type m, len_type n,
         }
     }
 
+    if (stream) stream_fence();
+
     comm.barrier();
 }
 
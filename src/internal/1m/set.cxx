@@ -1,5 +1,7 @@
 #include "set.hpp"
 
+#include "kernels/1v/stream.hpp"
+
 namespace tblis
 {
 namespace internal
@@ -21,10 +23,20 @@ void set(const communicator& comm, const config& cfg, len_type m, len_type n,
     std::tie(m_min, m_max, std::ignore,
              n_min, n_max, std::ignore) = comm.distribute_over_threads_2d(m, n);
 
-    for (len_type j = n_min;j < n_max;j++)
+    if (rs_A == 1 && use_stream_stores<T>(m*n))
+    {
+        for (len_type j = n_min;j < n_max;j++)
+            stream_set(m_max-m_min, alpha, A + m_min + j*cs_A);
+
+        stream_fence();
+    }
+    else
     {
-        cfg.set_ukr.call<T>(m_max-m_min,
-                            alpha, A + m_min*rs_A + j*cs_A, rs_A);
+        for (len_type j = n_min;j < n_max;j++)
+        {
+            cfg.set_ukr.call<T>(m_max-m_min,
+                                alpha, A + m_min*rs_A + j*cs_A, rs_A);
+        }
     }
 
     comm.barrier();
@@ -1,37 +1,302 @@
 #include "add.hpp"
 
+#include "reduce.hpp"
+
+#include "kernels/1v/stream.hpp"
+
+#include "util/cpuid.hpp"
 #include "util/tensor.hpp"
 
+#include <cmath>
+
 namespace tblis
 {
 namespace internal
 {
 
+/*
+ * Add A to B (B = alpha*A + beta*B) using the vector microkernels along
+ * index idx0, with the remaining indices iterated in order of increasing
+ * stride in B. A may have a zero stride along some indices, in which case it
+ * is replicated. Threads are distributed over both idx0 and the other
+ * indices.
+ */
 template <typename T>
-void add(const communicator& comm, const config& cfg,
-         const std::vector<len_type>& len_A,
-         const std::vector<len_type>& len_B,
-         const std::vector<len_type>& len_AB,
-         T alpha, bool conj_A, const T* A,
-         const std::vector<stride_type>& stride_A,
-         const std::vector<stride_type>& stride_A_AB,
-         T  beta, bool conj_B,       T* B,
-         const std::vector<stride_type>& stride_B,
-         const std::vector<stride_type>& stride_B_AB)
+void add_vector(const communicator& comm, const config& cfg, unsigned idx0,
+                const len_vector& len_AB,
+                T alpha, bool conj_A, const T* A,
+                const stride_vector& stride_A_AB,
+                T  beta, bool conj_B,       T* B,
+                const stride_vector& stride_B_AB)
+{
+    len_type len0 = (len_AB.empty() ? 1 : len_AB[idx0]);
+    stride_type stride_A0 = (len_AB.empty() ? 0 : stride_A_AB[idx0]);
+    stride_type stride_B0 = (len_AB.empty() ? 1 : stride_B_AB[idx0]);
+
+    len_vector len1;
+    stride_vector stride_A1, stride_B1;
+    for (unsigned i : detail::sort_by_stride(stride_B_AB))
+    {
+        if (i == idx0) continue;
+        len1.push_back(len_AB[i]);
+        stride_A1.push_back(stride_A_AB[i]);
+        stride_B1.push_back(stride_B_AB[i]);
+    }
+
+    MArray::viterator<2> iter_AB(len1, stride_A1, stride_B1);
+    len_type n = stl_ext::prod(len1);
+
+    len_type m_min, m_max, n_min, n_max;
+    std::tie(m_min, m_max, std::ignore,
+             n_min, n_max, std::ignore) =
+        comm.distribute_over_threads_2d(len0, n);
+
+    iter_AB.position(n_min, A, B);
+    A += m_min*stride_A0;
+    B += m_min*stride_B0;
+
+    if (beta == T(0) && stride_B0 == 1 && use_stream_stores<T>(len0*n))
+    {
+        for (len_type i = n_min;i < n_max;i++)
+        {
+            iter_AB.next(A, B);
+            stream_copy(m_max-m_min, alpha, conj_A, A, stride_A0, B);
+        }
+
+        stream_fence();
+    }
+    else if (beta == T(0))
+    {
+        for (len_type i = n_min;i < n_max;i++)
+        {
+            iter_AB.next(A, B);
+            cfg.copy_ukr.call<T>(m_max-m_min,
+                                 alpha, conj_A, A, stride_A0,
+                                                B, stride_B0);
+        }
+    }
+    else
+    {
+        for (len_type i = n_min;i < n_max;i++)
+        {
+            iter_AB.next(A, B);
+            cfg.add_ukr.call<T>(m_max-m_min,
+                                alpha, conj_A, A, stride_A0,
+                                 beta, conj_B, B, stride_B0);
+        }
+    }
+
+    comm.barrier();
+}
+
+/*
+ * Edge length (in elements) of the blocks used by add_transpose, where stride
+ * is the larger of the non-unit strides of A and B. A block of A and a block
+ * of B should together fill at most half of the L1 cache, and should cover at
+ * least two cache lines along both dimensions. When the stride is a page or
+ * more, every row of the block of A and every column of the block of B is on
+ * its own page, so the block must also not touch more pages than the
+ * first-level data TLB holds.
+ */
+template <typename T>
+len_type transpose_block_size(stride_type stride)
 {
-    if (len_A.empty() && len_B.empty() && !len_AB.empty())
+    static const long page = []
     {
-        len_type len0 = len_AB[0];
-        std::vector<len_type> len1(len_AB.begin()+1, len_AB.end());
+        long size = get_page_size();
+        return (size > 0 ? size : 4096);
+    }();
 
-        stride_type stride_A0 = stride_A_AB[0];
-        std::vector<stride_type> stride_A1(stride_A_AB.begin()+1,
-                                           stride_A_AB.end());
+    static const long l1 = []
+    {
+        long size = get_l1d_size();
+        return (size > 0 ? size : 32*1024);
+    }();
+
+    static const long tlb = []
+    {
+        long entries = get_dtlb_entries();
+        return (entries > 0 ? entries : 64);
+    }();
 
-        stride_type stride_B0 = stride_B_AB[0];
-        std::vector<stride_type> stride_B1(stride_B_AB.begin()+1,
-                                           stride_B_AB.end());
+    len_type line = 128/sizeof(T);
+    len_type size = std::sqrt(double(l1)/(4*sizeof(T)));
+    if (stride*stride_type(sizeof(T)) >= page)
+        size = std::min<len_type>(size, tlb/2);
 
+    return std::max(line, size);
+}
+
+/*
+ * Add A to B where the unit-stride (smallest-stride) index of A differs from
+ * that of B, i.e. a general transpose. The two unit-stride indices form a
+ * matrix which is cut into blocks of several transpose microtiles, sized to
+ * stay in the L1 cache and TLB (see transpose_block_size). The remaining
+ * indices are iterated in order of increasing stride in B, and threads are
+ * distributed over all (outer index, block) pairs.
+ */
+template <typename T>
+void add_transpose(const communicator& comm, const config& cfg,
+                   unsigned idx_A0, unsigned idx_B0,
+                   const len_vector& len_AB,
+                   T alpha, bool conj_A, const T* A,
+                   const stride_vector& stride_A_AB,
+                   T  beta, bool conj_B,       T* B,
+                   const stride_vector& stride_B_AB)
+{
+    /*
+     * Column-major transpose microkernels are fastest when B has unit stride
+     * along m and A along n, and row-major microkernels the opposite.
+     */
+    bool row_major = cfg.trans_row_major.value<T>();
+    unsigned idx_m = (row_major ? idx_A0 : idx_B0);
+    unsigned idx_n = (row_major ? idx_B0 : idx_A0);
+
+    len_type m = len_AB[idx_m];
+    len_type n = len_AB[idx_n];
+    stride_type rs_A = stride_A_AB[idx_m];
+    stride_type cs_A = stride_A_AB[idx_n];
+    stride_type rs_B = stride_B_AB[idx_m];
+    stride_type cs_B = stride_B_AB[idx_n];
+
+    const len_type MR = cfg.trans_mr.def<T>();
+    const len_type NR = cfg.trans_nr.def<T>();
+
+    const len_type BS = transpose_block_size<T>(
+        std::max(std::abs(stride_A_AB[idx_B0]), std::abs(stride_B_AB[idx_A0])));
+    const len_type BM = MR*((BS+MR-1)/MR);
+    const len_type BN = NR*((BS+NR-1)/NR);
+
+    len_vector len_outer;
+    stride_vector stride_A_outer, stride_B_outer;
+
+    for (unsigned i : detail::sort_by_stride(stride_B_AB))
+    {
+        if (i == idx_m || i == idx_n) continue;
+        len_outer.push_back(len_AB[i]);
+        stride_A_outer.push_back(stride_A_AB[i]);
+        stride_B_outer.push_back(stride_B_AB[i]);
+    }
+
+    MArray::viterator<2> iter_outer(len_outer, stride_A_outer, stride_B_outer);
+    len_type n_outer = stl_ext::prod(len_outer);
+
+    len_type m_block = (m+BM-1)/BM;
+    len_type n_block = (n+BN-1)/BN;
+    len_type nblock = m_block*n_block;
+
+    len_type block_min, block_max;
+    std::tie(block_min, block_max, std::ignore) =
+        comm.distribute_over_threads(n_outer*nblock);
+
+    if (block_min == block_max)
+    {
+        comm.barrier();
+        return;
+    }
+
+    /*
+     * Large copies write B a whole block column (or row) at a time with
+     * non-temporal stores; the block of A stays in cache meanwhile.
+     */
+    bool stream = beta == T(0) && (rs_B == 1 || cs_B == 1) &&
+                  use_stream_stores<T>(m*n*n_outer);
+
+    len_type outer = block_min/nblock;
+    iter_outer.position(outer, A, B);
+    iter_outer.next(A, B);
+
+    for (len_type block = block_min;block < block_max;block++)
+    {
+        if (block/nblock != outer)
+        {
+            outer = block/nblock;
+            iter_outer.next(A, B);
+        }
+
+        len_type i0 = ((block%nblock)/n_block)*BM;
+        len_type j0 = ((block%nblock)%n_block)*BN;
+        len_type i1 = std::min(m, i0+BM);
+        len_type j1 = std::min(n, j0+BN);
+
+        if (stream)
+        {
+            stream_trans_copy(i1-i0, j1-j0,
+                              alpha, conj_A, A + i0*rs_A + j0*cs_A, rs_A, cs_A,
+                                             B + i0*rs_B + j0*cs_B, rs_B, cs_B);
+            continue;
+        }
+
+        for (len_type i = i0;i < i1;i += MR)
+        {
+            len_type m_loc = std::min(i1-i, MR);
+            for (len_type j = j0;j < j1;j += NR)
+            {
+                len_type n_loc = std::min(j1-j, NR);
+
+                if (beta == T(0))
+                {
+                    cfg.trans_copy_ukr.call<T>(m_loc, n_loc,
+                        alpha, conj_A, A + i*rs_A + j*cs_A, rs_A, cs_A,
+                                       B + i*rs_B + j*cs_B, rs_B, cs_B);
+                }
+                else
+                {
+                    cfg.trans_add_ukr.call<T>(m_loc, n_loc,
+                        alpha, conj_A, A + i*rs_A + j*cs_A, rs_A, cs_A,
+                         beta, conj_B, B + i*rs_B + j*cs_B, rs_B, cs_B);
+                }
+            }
+        }
+    }
+
+    if (stream) stream_fence();
+
+    comm.barrier();
+}
+
+/*
+ * Sum A over the A-only indices and add the result to B, replicated over the
+ * B-only indices. When A has a smaller stride along an AB index than along
+ * the A-only indices, whole fibers along that index are summed with the
+ * vector add microkernel (into B directly, or into a per-thread buffer when
+ * the sums are replicated). Otherwise each element of B is computed with the
+ * reduction microkernel along the A-only index of smallest stride.
+ */
+template <typename T>
+void add_trace(const communicator& comm, const config& cfg,
+               const len_vector& len_A,
+               const len_vector& len_B,
+               const len_vector& len_AB,
+               T alpha, bool conj_A, const T* A,
+               const stride_vector& stride_A,
+               const stride_vector& stride_A_AB,
+               T  beta, bool conj_B,       T* B,
+               const stride_vector& stride_B,
+               const stride_vector& stride_B_AB)
+{
+    unsigned idx_A0 = unit_index(len_A, stride_A);
+    unsigned idx_AB0 = unit_index(len_AB, stride_B_AB);
+
+    if (len_AB[idx_AB0] > 1 &&
+        std::abs(stride_A_AB[idx_AB0]) < std::abs(stride_A[idx_A0]))
+    {
+        len_type len0 = len_AB[idx_AB0];
+        stride_type stride_A0 = stride_A_AB[idx_AB0];
+        stride_type stride_B0 = stride_B_AB[idx_AB0];
+
+        len_vector len1;
+        stride_vector stride_A1, stride_B1;
+        for (unsigned i : detail::sort_by_stride(stride_B_AB))
+        {
+            if (i == idx_AB0) continue;
+            len1.push_back(len_AB[i]);
+            stride_A1.push_back(stride_A_AB[i]);
+            stride_B1.push_back(stride_B_AB[i]);
+        }
+
+        MArray::viterator<1> iter_A(len_A, stride_A);
+        MArray::viterator<1> iter_B(len_B, stride_B);
         MArray::viterator<2> iter_AB(len1, stride_A1, stride_B1);
         len_type n = stl_ext::prod(len1);
 
@@ -39,35 +304,77 @@ void add(const communicator& comm, const config& cfg,
         std::tie(m_min, m_max, std::ignore,
                  n_min, n_max, std::ignore) =
             comm.distribute_over_threads_2d(len0, n);
+        len_type m = m_max-m_min;
 
         iter_AB.position(n_min, A, B);
         A += m_min*stride_A0;
         B += m_min*stride_B0;
 
-        if (beta == T(0))
+        /*
+         * The sums are accumulated directly into B when there is nothing to
+         * replicate.
+         */
+        std::vector<T> sum_A(len_B.empty() ? 0 : m);
+        T* S = (len_B.empty() ? B : sum_A.data());
+        stride_type stride_S = (len_B.empty() ? stride_B0 : 1);
+        T beta_S = (len_B.empty() ? beta : T(0));
+        bool conj_S = (len_B.empty() ? conj_B : false);
+
+        for (len_type i = n_min;i < n_max;i++)
         {
-            for (len_type i = n_min;i < n_max;i++)
+            iter_AB.next(A, B);
+            if (len_B.empty()) S = B;
+
+            bool first = true;
+            while (iter_A.next(A))
             {
-                iter_AB.next(A, B);
-                cfg.copy_ukr.call<T>(m_max-m_min,
-                                     alpha, conj_A, A, stride_A0,
-                                                    B, stride_B0);
+                if (first && beta_S == T(0))
+                {
+                    cfg.copy_ukr.call<T>(m, alpha, conj_A, A, stride_A0,
+                                                           S, stride_S);
+                }
+                else
+                {
+                    cfg.add_ukr.call<T>(m, alpha, conj_A, A, stride_A0,
+                                           (first ? beta_S : T(1)),
+                                           first && conj_S, S, stride_S);
+                }
+
+                first = false;
             }
-        }
-        else
-        {
-            for (len_type i = n_min;i < n_max;i++)
+
+            if (len_B.empty()) continue;
+
+            while (iter_B.next(B))
             {
-                iter_AB.next(A, B);
-                cfg.add_ukr.call<T>(m_max-m_min,
-                                    alpha, conj_A, A, stride_A0,
-                                     beta, conj_B, B, stride_B0);
+                if (beta == T(0))
+                {
+                    cfg.copy_ukr.call<T>(m, T(1), false, S, 1,
+                                                         B, stride_B0);
+                }
+                else
+                {
+                    cfg.add_ukr.call<T>(m, T(1), false, S, 1,
+                                            beta, conj_B, B, stride_B0);
+                }
             }
         }
     }
     else
     {
-        MArray::viterator<1> iter_A(len_A, stride_A);
+        len_type len0 = len_A[idx_A0];
+        stride_type stride_A0 = stride_A[idx_A0];
+
+        len_vector len1;
+        stride_vector stride_A1;
+        for (unsigned i = 0;i < len_A.size();i++)
+        {
+            if (i == idx_A0) continue;
+            len1.push_back(len_A[i]);
+            stride_A1.push_back(stride_A[i]);
+        }
+
+        MArray::viterator<1> iter_A(len1, stride_A1);
         MArray::viterator<1> iter_B(len_B, stride_B);
         MArray::viterator<2> iter_AB(len_AB, stride_A_AB, stride_B_AB);
         len_type n = stl_ext::prod(len_AB);
@@ -82,35 +389,326 @@ void add(const communicator& comm, const config& cfg,
             iter_AB.next(A, B);
 
             T sum_A = T();
-            while (iter_A.next(A)) sum_A += *A;
+            len_type idx = -1;
+            while (iter_A.next(A))
+                cfg.reduce_ukr.call<T>(REDUCE_SUM, len0, A, stride_A0, sum_A, idx);
             sum_A = alpha*(conj_A ? conj(sum_A) : sum_A);
 
-            TBLIS_SPECIAL_CASE(is_complex<T>::value && conj_B,
-            TBLIS_SPECIAL_CASE(beta == T(0),
+            while (iter_B.next(B))
+            {
+                *B = sum_A + (beta == T(0) ? T(0) : beta*(conj_B ? conj(*B) : *B));
+            }
+        }
+    }
+
+    comm.barrier();
+}
+
+template <typename T>
+void add(const communicator& comm, const config& cfg,
+         const len_vector& len_A,
+         const len_vector& len_B,
+         const len_vector& len_AB,
+         T alpha, bool conj_A, const T* A,
+         const stride_vector& stride_A,
+         const stride_vector& stride_A_AB,
+         T  beta, bool conj_B,       T* B,
+         const stride_vector& stride_B,
+         const stride_vector& stride_B_AB)
+{
+    if (len_A.empty())
+    {
+        /*
+         * Treat the B-only indices as AB indices along which A has zero
+         * stride, so that replication is vectorized and parallelized in the
+         * same way as a plain addition or transpose.
+         */
+        auto len = len_AB + len_B;
+        auto stride_A_ = stride_A_AB + stride_vector(len_B.size());
+        auto stride_B_ = stride_B_AB + stride_B;
+
+        unsigned idx_B0 = unit_index(len, stride_B_);
+
+        if (!len_AB.empty() && idx_B0 < len_AB.size())
+        {
+            unsigned idx_A0 = unit_index(len_AB, stride_A_AB);
+
+            if (idx_A0 != idx_B0)
             {
-                while (iter_B.next(B))
+                add_transpose(comm, cfg, idx_A0, idx_B0, len,
+                              alpha, conj_A, A, stride_A_,
+                               beta, conj_B, B, stride_B_);
+                return;
+            }
+        }
+
+        add_vector(comm, cfg, idx_B0, len,
+                   alpha, conj_A, A, stride_A_,
+                    beta, conj_B, B, stride_B_);
+    }
+    else if (len_AB.empty())
+    {
+        /*
+         * A full trace: reduce A over all threads and then replicate the
+         * result into B.
+         */
+        T sum_A;
+        len_type idx;
+        reduce(comm, cfg, REDUCE_SUM, len_A, A, stride_A, sum_A, idx);
+
+        T* sum_ptr = &sum_A;
+        if (comm.master()) sum_A = alpha*(conj_A ? conj(sum_A) : sum_A);
+        comm.broadcast(sum_ptr);
+
+        add_vector(comm, cfg, unit_index(len_B, stride_B), len_B,
+                   T(1), false, sum_ptr, stride_vector(len_B.size()),
+                   beta, conj_B, B, stride_B);
+    }
+    else
+    {
+        add_trace(comm, cfg, len_A, len_B, len_AB,
+                  alpha, conj_A, A, stride_A, stride_A_AB,
+                   beta, conj_B, B, stride_B, stride_B_AB);
+    }
+}
+
+/*
+ * B = sum_i alpha[i]*A[i] + beta*B, where all tensors have the same indices.
+ * B is processed in cache-sized blocks along its unit-stride index, and each
+ * block is updated by all of the A[i] in turn before moving on, so that each
+ * tensor is read from memory only once and B is written only once.
+ */
+template <typename T>
+void add_many(const communicator& comm, const config& cfg,
+              const len_vector& len_AB, unsigned n,
+              const T* alpha, const bool* conj_A, const T* const* A,
+              const std::vector<stride_type>* stride_A_AB,
+              T  beta, bool conj_B, T* B,
+              const stride_vector& stride_B_AB)
+{
+    unsigned idx0 = unit_index(len_AB, stride_B_AB);
+
+    len_type len0 = (len_AB.empty() ? 1 : len_AB[idx0]);
+    stride_type stride_B0 = (len_AB.empty() ? 1 : stride_B_AB[idx0]);
+    std::vector<stride_type> stride_A0(n);
+    for (unsigned k = 0;k < n;k++)
+        stride_A0[k] = (len_AB.empty() ? 0 : stride_A_AB[k][idx0]);
+
+    len_vector len1;
+    stride_vector stride_B1;
+    std::vector<std::vector<stride_type>> stride_A1(n);
+    for (unsigned i : detail::sort_by_stride(stride_B_AB))
+    {
+        if (i == idx0) continue;
+        len1.push_back(len_AB[i]);
+        stride_B1.push_back(stride_B_AB[i]);
+        for (unsigned k = 0;k < n;k++)
+            stride_A1[k].push_back(stride_A_AB[k][i]);
+    }
+
+    /*
+     * The iterators all see the same lengths, so they stay in step.
+     */
+    MArray::viterator<1> iter_B(len1, stride_B1);
+    std::vector<MArray::viterator<1>> iter_A;
+    iter_A.reserve(n);
+    for (unsigned k = 0;k < n;k++) iter_A.emplace_back(len1, stride_A1[k]);
+    len_type n1 = stl_ext::prod(len1);
+
+    len_type m_min, m_max, n_min, n_max;
+    std::tie(m_min, m_max, std::ignore,
+             n_min, n_max, std::ignore) =
+        comm.distribute_over_threads_2d(len0, n1);
+
+    std::vector<const T*> A_(A, A+n);
+    iter_B.position(n_min, B);
+    B += m_min*stride_B0;
+    for (unsigned k = 0;k < n;k++)
+    {
+        iter_A[k].position(n_min, A_[k]);
+        A_[k] += m_min*stride_A0[k];
+    }
+
+    /*
+     * Keep the block of B in the L1 cache.
+     */
+    const len_type BS = 4096/sizeof(T);
+
+    for (len_type i = n_min;i < n_max;i++)
+    {
+        iter_B.next(B);
+        for (unsigned k = 0;k < n;k++) iter_A[k].next(A_[k]);
+
+        for (len_type i0 = 0;i0 < m_max-m_min;i0 += BS)
+        {
+            len_type m = std::min(m_max-m_min-i0, BS);
+            T* B_blk = B + i0*stride_B0;
+
+            for (unsigned k = 0;k < n;k++)
+            {
+                const T* A_blk = A_[k] + i0*stride_A0[k];
+
+                if (k == 0 && beta == T(0))
+                {
+                    cfg.copy_ukr.call<T>(m, alpha[k], conj_A[k], A_blk, stride_A0[k],
+                                                                 B_blk, stride_B0);
+                }
+                else
                 {
-                    *B = sum_A + beta*(conj_B ? conj(*B) : *B);
+                    cfg.add_ukr.call<T>(m, alpha[k], conj_A[k], A_blk, stride_A0[k],
+                                           (k == 0 ? beta : T(1)), k == 0 && conj_B,
+                                           B_blk, stride_B0);
                 }
             }
-            ))
         }
     }
 
     comm.barrier();
 }
 
+template <typename T, typename TS>
+void add_mixed(const communicator& comm, const config& cfg,
+               const len_vector& len_A,
+               const len_vector& len_B,
+               const len_vector& len_AB,
+               T alpha, bool conj_A, const TS* A,
+               const stride_vector& stride_A,
+               const stride_vector& stride_A_AB,
+               T  beta, bool conj_B,       TS* B,
+               const stride_vector& stride_B,
+               const stride_vector& stride_B_AB)
+{
+    (void)cfg;
+
+    /*
+     * As in add, the B-only indices are AB indices along which A has zero
+     * stride.
+     */
+    auto len = len_AB + len_B;
+    auto stride_A_ = stride_A_AB + stride_vector(len_B.size());
+    auto stride_B_ = stride_B_AB + stride_B;
+
+    len_vector len1;
+    stride_vector stride_A1, stride_B1;
+    for (unsigned i : detail::sort_by_stride(stride_B_))
+    {
+        len1.push_back(len[i]);
+        stride_A1.push_back(stride_A_[i]);
+        stride_B1.push_back(stride_B_[i]);
+    }
+
+    MArray::viterator<1> iter_A(len_A, stride_A);
+    MArray::viterator<2> iter_AB(len1, stride_A1, stride_B1);
+    len_type n = stl_ext::prod(len1);
+
+    len_type n_min, n_max;
+    std::tie(n_min, n_max, std::ignore) = comm.distribute_over_threads(n);
+
+    iter_AB.position(n_min, A, B);
+
+    for (len_type i = n_min;i < n_max;i++)
+    {
+        iter_AB.next(A, B);
+
+        T sum_A = T();
+        while (iter_A.next(A)) sum_A += T(*A);
+        sum_A = alpha*conj(conj_A, sum_A);
+
+        *B = TS(sum_A + (beta == T(0) ? T(0) : beta*conj(conj_B, T(*B))));
+    }
+
+    comm.barrier();
+}
+
+template <typename T, typename TS>
+void add_many_mixed(const communicator& comm, const config& cfg,
+                    const len_vector& len_AB, unsigned n,
+                    const T* alpha, const bool* conj_A, const TS* const* A,
+                    const std::vector<stride_type>* stride_A_AB,
+                    T  beta, bool conj_B, TS* B,
+                    const stride_vector& stride_B_AB)
+{
+    (void)cfg;
+
+    len_vector len1;
+    stride_vector stride_B1;
+    std::vector<std::vector<stride_type>> stride_A1(n);
+    for (unsigned i : detail::sort_by_stride(stride_B_AB))
+    {
+        len1.push_back(len_AB[i]);
+        stride_B1.push_back(stride_B_AB[i]);
+        for (unsigned k = 0;k < n;k++)
+            stride_A1[k].push_back(stride_A_AB[k][i]);
+    }
+
+    MArray::viterator<1> iter_B(len1, stride_B1);
+    std::vector<MArray::viterator<1>> iter_A;
+    iter_A.reserve(n);
+    for (unsigned k = 0;k < n;k++) iter_A.emplace_back(len1, stride_A1[k]);
+    len_type n1 = stl_ext::prod(len1);
+
+    len_type n_min, n_max;
+    std::tie(n_min, n_max, std::ignore) = comm.distribute_over_threads(n1);
+
+    std::vector<const TS*> A_(A, A+n);
+    iter_B.position(n_min, B);
+    for (unsigned k = 0;k < n;k++) iter_A[k].position(n_min, A_[k]);
+
+    for (len_type i = n_min;i < n_max;i++)
+    {
+        iter_B.next(B);
+
+        T sum = (beta == T(0) ? T(0) : beta*conj(conj_B, T(*B)));
+        for (unsigned k = 0;k < n;k++)
+        {
+            iter_A[k].next(A_[k]);
+            sum += alpha[k]*conj(conj_A[k], T(*A_[k]));
+        }
+
+        *B = TS(sum);
+    }
+
+    comm.barrier();
+}
+
+#define INSTANTIATE_ADD_MIXED(T, TS) \
+template void add_mixed(const communicator& comm, const config& cfg, \
+                        const len_vector& len_A, \
+                        const len_vector& len_B, \
+                        const len_vector& len_AB, \
+                        T alpha, bool conj_A, const TS* A, \
+                        const stride_vector& stride_A, \
+                        const stride_vector& stride_A_AB, \
+                        T  beta, bool conj_B,       TS* B, \
+                        const stride_vector& stride_B, \
+                        const stride_vector& stride_B_AB); \
+template void add_many_mixed(const communicator& comm, const config& cfg, \
+                             const len_vector& len_AB, unsigned n, \
+                             const T* alpha, const bool* conj_A, const TS* const* A, \
+                             const std::vector<stride_type>* stride_A_AB, \
+                             T  beta, bool conj_B, TS* B, \
+                             const stride_vector& stride_B_AB);
+
+INSTANTIATE_ADD_MIXED(float,     tblis_half);
+INSTANTIATE_ADD_MIXED(float, tblis_bfloat16);
+
 #define FOREACH_TYPE(T) \
 template void add(const communicator& comm, const config& cfg, \
-                  const std::vector<len_type>& len_A, \
-                  const std::vector<len_type>& len_B, \
-                  const std::vector<len_type>& len_AB, \
+                  const len_vector& len_A, \
+                  const len_vector& len_B, \
+                  const len_vector& len_AB, \
                   T alpha, bool conj_A, const T* A, \
-                  const std::vector<stride_type>& stride_A, \
-                  const std::vector<stride_type>& stride_A_AB, \
+                  const stride_vector& stride_A, \
+                  const stride_vector& stride_A_AB, \
                   T  beta, bool conj_B,       T* B, \
-                  const std::vector<stride_type>& stride_B, \
-                  const std::vector<stride_type>& stride_B_AB);
+                  const stride_vector& stride_B, \
+                  const stride_vector& stride_B_AB); \
+template void add_many(const communicator& comm, const config& cfg, \
+                       const len_vector& len_AB, unsigned n, \
+                       const T* alpha, const bool* conj_A, const T* const* A, \
+                       const std::vector<stride_type>* stride_A_AB, \
+                       T  beta, bool conj_B, T* B, \
+                       const stride_vector& stride_B_AB);
 #include "configs/foreach_type.h"
 
 }
@@ -12,15 +12,48 @@ namespace internal
 
 template <typename T>
 void add(const communicator& comm, const config& cfg,
-         const std::vector<len_type>& len_A,
-         const std::vector<len_type>& len_B,
-         const std::vector<len_type>& len_AB,
+         const len_vector& len_A,
+         const len_vector& len_B,
+         const len_vector& len_AB,
          T alpha, bool conj_A, const T* A,
-         const std::vector<stride_type>& stride_A,
-         const std::vector<stride_type>& stride_A_AB,
+         const stride_vector& stride_A,
+         const stride_vector& stride_A_AB,
          T  beta, bool conj_B,       T* B,
-         const std::vector<stride_type>& stride_B,
-         const std::vector<stride_type>& stride_B_AB);
+         const stride_vector& stride_B,
+         const stride_vector& stride_B_AB);
+
+template <typename T>
+void add_many(const communicator& comm, const config& cfg,
+              const len_vector& len_AB, unsigned n,
+              const T* alpha, const bool* conj_A, const T* const* A,
+              const std::vector<stride_type>* stride_A_AB,
+              T  beta, bool conj_B, T* B,
+              const stride_vector& stride_B_AB);
+
+/*
+ * Like add and add_many, but the tensors are stored as TS (half precision or
+ * bfloat16) and computed in T: elements are widened as they are read and
+ * each element of B is narrowed once, when it is stored.
+ */
+template <typename T, typename TS>
+void add_mixed(const communicator& comm, const config& cfg,
+               const len_vector& len_A,
+               const len_vector& len_B,
+               const len_vector& len_AB,
+               T alpha, bool conj_A, const TS* A,
+               const stride_vector& stride_A,
+               const stride_vector& stride_A_AB,
+               T  beta, bool conj_B,       TS* B,
+               const stride_vector& stride_B,
+               const stride_vector& stride_B_AB);
+
+template <typename T, typename TS>
+void add_many_mixed(const communicator& comm, const config& cfg,
+                    const len_vector& len_AB, unsigned n,
+                    const T* alpha, const bool* conj_A, const TS* const* A,
+                    const std::vector<stride_type>* stride_A_AB,
+                    T  beta, bool conj_B, TS* B,
+                    const stride_vector& stride_B_AB);
 
 }
 }
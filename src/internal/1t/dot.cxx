@@ -1,5 +1,7 @@
 #include "dot.hpp"
 
+#include "reduce.hpp"
+
 #include "util/tensor.hpp"
 
 namespace tblis
@@ -7,62 +9,342 @@ namespace tblis
 namespace internal
 {
 
+/*
+ * Set S[i] (0 <= i < m) to the sum of A over the trace indices, for fibers of
+ * A along an AB index with stride stride_A0. When the fibers have a smaller
+ * stride than the trace indices they are summed with the vector add kernel,
+ * otherwise each element is summed with the reduction kernel along the
+ * trace index of smallest stride.
+ */
 template <typename T>
-void dot(const communicator& comm, const config& cfg,
-         const std::vector<len_type>& len_A,
-         const std::vector<len_type>& len_B,
-         const std::vector<len_type>& len_AB,
-         bool conj_A, const T* A, const std::vector<stride_type>& stride_A,
-                                  const std::vector<stride_type>& stride_A_AB,
-         bool conj_B, const T* B, const std::vector<stride_type>& stride_B,
-                                  const std::vector<stride_type>& stride_B_AB,
-         T& result)
+void sum_fibers(const config& cfg, len_type m,
+                const std::vector<len_type>& len_A,
+                const T* A, stride_type stride_A0,
+                const std::vector<stride_type>& stride_A, T* S)
 {
-    (void)cfg;
+    unsigned idx_A0 = unit_index(len_A, stride_A);
+
+    if (std::abs(stride_A0) < std::abs(stride_A[idx_A0]))
+    {
+        MArray::viterator<1> iter_A(len_A, stride_A);
+
+        bool first = true;
+        while (iter_A.next(A))
+        {
+            if (first)
+            {
+                cfg.copy_ukr.call<T>(m, T(1), false, A, stride_A0, S, 1);
+            }
+            else
+            {
+                cfg.add_ukr.call<T>(m, T(1), false, A, stride_A0,
+                                       T(1), false, S, 1);
+            }
 
+            first = false;
+        }
+    }
+    else
+    {
+        len_vector len1;
+        stride_vector stride1;
+        for (unsigned i = 0;i < len_A.size();i++)
+        {
+            if (i == idx_A0) continue;
+            len1.push_back(len_A[i]);
+            stride1.push_back(stride_A[i]);
+        }
+
+        MArray::viterator<1> iter_A(len1, stride1);
+
+        for (len_type i = 0;i < m;i++)
+        {
+            const T* A1 = A + i*stride_A0;
+
+            T sum = T();
+            len_type idx = -1;
+            while (iter_A.next(A1))
+                cfg.reduce_ukr.call<T>(REDUCE_SUM, len_A[idx_A0],
+                                       A1, stride_A[idx_A0], sum, idx);
+            S[i] = sum;
+        }
+    }
+}
+
+/*
+ * The same for A stored in a narrower type TA, summing in T.
+ */
+template <typename T, typename TA>
+void sum_fibers(const config&, len_type m,
+                const std::vector<len_type>& len_A,
+                const TA* A, stride_type stride_A0,
+                const std::vector<stride_type>& stride_A, T* S)
+{
     MArray::viterator<1> iter_A(len_A, stride_A);
-    MArray::viterator<1> iter_B(len_B, stride_B);
-    MArray::viterator<2> iter_AB(len_AB, stride_A_AB, stride_B_AB);
 
-    len_type n = stl_ext::prod(len_AB);
+    for (len_type i = 0;i < m;i++)
+    {
+        const TA* A1 = A + i*stride_A0;
 
-    len_type n_min, n_max;
-    std::tie(n_min, n_max, std::ignore) = comm.distribute_over_threads(n);
+        T sum = T();
+        while (iter_A.next(A1)) sum += T(*A1);
+        S[i] = sum;
+    }
+}
 
-    T local_result = T();
+/*
+ * Return m elements of A with stride inc_A as they are when stored as T, or
+ * otherwise widen them into S and set inc_A to 1.
+ */
+template <typename T>
+const T* load_fiber(len_type, const T* A, stride_type&, T*)
+{
+    return A;
+}
 
-    if (conj_A) conj_B = !conj_B;
+template <typename T, typename TA>
+const T* load_fiber(len_type m, const TA* A, stride_type& inc_A, T* S)
+{
+    for (len_type i = 0;i < m;i++) S[i] = T(A[i*inc_A]);
+    inc_A = 1;
+    return S;
+}
 
-    iter_AB.position(n_min, A, B);
+template <typename T, typename TA>
+void dot_mixed(const communicator& comm, const config& cfg,
+               const std::vector<len_type>& len_A,
+               const std::vector<len_type>& len_B,
+               const std::vector<len_type>& len_AB,
+               bool conj_A, const TA* A, const std::vector<stride_type>& stride_A,
+                                         const std::vector<stride_type>& stride_A_AB,
+               bool conj_B, const TA* B, const std::vector<stride_type>& stride_B,
+                                         const std::vector<stride_type>& stride_B_AB,
+               T& result)
+{
+    constexpr bool widen = !std::is_same<T,TA>::value;
 
-    for (len_type i = n_min;i < n_max;i++)
+    if (len_AB.empty())
     {
-        iter_AB.next(A, B);
+        /*
+         * The product of two full traces.
+         */
+        T sum_A = T(1), sum_B = T(1);
+        len_type idx;
+
+        if (!len_A.empty())
+            reduce_mixed(comm, cfg, REDUCE_SUM, len_A, A, stride_A, sum_A, idx);
+        else if (comm.master())
+            sum_A = T(*A);
+
+        if (!len_B.empty())
+            reduce_mixed(comm, cfg, REDUCE_SUM, len_B, B, stride_B, sum_B, idx);
+        else if (comm.master())
+            sum_B = T(*B);
+
+        if (comm.master())
+            result = (conj_A ? conj(sum_A) : sum_A)*
+                     (conj_B ? conj(sum_B) : sum_B);
+
+        comm.barrier();
+        return;
+    }
+
+    /*
+     * Use the dot kernel along the AB index of smallest stride in A, and
+     * distribute threads over both that index and the remaining ones.
+     */
+    unsigned idx0 = unit_index(len_AB, stride_A_AB);
+
+    len_type len0 = len_AB[idx0];
+    stride_type stride_A0 = stride_A_AB[idx0];
+    stride_type stride_B0 = stride_B_AB[idx0];
+
+    len_vector len1;
+    stride_vector stride_A1, stride_B1;
+    for (unsigned i : detail::sort_by_stride(stride_A_AB))
+    {
+        if (i == idx0) continue;
+        len1.push_back(len_AB[i]);
+        stride_A1.push_back(stride_A_AB[i]);
+        stride_B1.push_back(stride_B_AB[i]);
+    }
+
+    MArray::viterator<2> iter_AB(len1, stride_A1, stride_B1);
+    len_type n = stl_ext::prod(len1);
+
+    /*
+     * Partial sums over the trace indices (or elements widened to T) are
+     * formed in chunks which stay in L1.
+     */
+    constexpr len_type chunk = 4096/sizeof(T);
+    std::vector<T> sum_A(len_A.empty() && !widen ? 0 : chunk);
+    std::vector<T> sum_B(len_B.empty() && !widen ? 0 : chunk);
+
+    auto dot_chunk = [&](len_type m, const TA* A, const TA* B, T& value)
+    {
+        stride_type inc_A = stride_A0;
+        stride_type inc_B = stride_B0;
+        const T* A_;
+        const T* B_;
 
-        T sum_A = T();
-        T sum_B = T();
-        while (iter_A.next(A)) sum_A += *A;
-        while (iter_B.next(B)) sum_B += *B;
+        if (!len_A.empty())
+        {
+            sum_fibers(cfg, m, len_A, A, stride_A0, stride_A, sum_A.data());
+            A_ = sum_A.data();
+            inc_A = 1;
+        }
+        else
+        {
+            A_ = load_fiber(m, A, inc_A, sum_A.data());
+        }
 
-        if (conj_B)
+        if (!len_B.empty())
         {
-            local_result += sum_A*conj(sum_B);
+            sum_fibers(cfg, m, len_B, B, stride_B0, stride_B, sum_B.data());
+            B_ = sum_B.data();
+            inc_B = 1;
         }
         else
         {
-            local_result += sum_A*sum_B;
+            B_ = load_fiber(m, B, inc_B, sum_B.data());
+        }
+
+        cfg.dot_ukr.call<T>(m, conj_A, A_, inc_A, conj_B, B_, inc_B, value);
+    };
+
+    if (tblis_get_reproducible())
+    {
+        /*
+         * Split the AB elements, in the order of the flattened index, into
+         * fixed-size blocks which may span several fibers, keep the result
+         * of each block, and add them up with a tree whose shape depends
+         * only on the number of blocks.
+         */
+        constexpr len_type block_size = 16*chunk;
+        len_type size = len0*n;
+        len_type nblock = std::max<len_type>(1, (size+block_size-1)/block_size);
+
+        std::vector<std::pair<T,len_type>> partial;
+        auto partial_ptr = partial.data();
+
+        if (comm.master())
+        {
+            partial.resize(nblock);
+            partial_ptr = partial.data();
+        }
+
+        comm.broadcast(partial_ptr);
+
+        len_type block_min, block_max;
+        std::tie(block_min, block_max, std::ignore) =
+            comm.distribute_over_threads(nblock);
+
+        for (len_type block = block_min;block < block_max;block++)
+        {
+            len_type first = block*block_size;
+            len_type last = std::min(first+block_size, size);
+
+            T value = T();
+
+            if (first < last)
+            {
+                const TA* A1 = A;
+                const TA* B1 = B;
+                iter_AB.position(first/len0, A1, B1);
+                iter_AB.next(A1, B1);
+
+                len_type m0 = first%len0;
+
+                while (true)
+                {
+                    len_type m = std::min(len0-m0, last-first);
+
+                    for (len_type m1 = 0;m1 < m;m1 += chunk)
+                        dot_chunk(std::min(chunk, m-m1),
+                                  A1 + (m0+m1)*stride_A0,
+                                  B1 + (m0+m1)*stride_B0, value);
+
+                    first += m;
+                    if (first == last) break;
+
+                    iter_AB.next(A1, B1);
+                    m0 = 0;
+                }
+            }
+
+            partial_ptr[block] = {value, 0};
         }
+
+        comm.barrier();
+
+        reduce_t op = REDUCE_SUM;
+        reduce_blocks(comm, 1, &op, nblock, partial_ptr);
+
+        if (comm.master()) result = partial_ptr[0].first;
+
+        comm.barrier();
+        return;
+    }
+
+    len_type m_min, m_max, n_min, n_max;
+    std::tie(m_min, m_max, std::ignore,
+             n_min, n_max, std::ignore) =
+        comm.distribute_over_threads_2d(len0, n);
+
+    T local_result = T();
+
+    iter_AB.position(n_min, A, B);
+    A += m_min*stride_A0;
+    B += m_min*stride_B0;
+
+    for (len_type i = n_min;i < n_max;i++)
+    {
+        iter_AB.next(A, B);
+
+        for (len_type m0 = 0;m0 < m_max-m_min;m0 += chunk)
+            dot_chunk(std::min(chunk, m_max-m_min-m0),
+                      A + m0*stride_A0, B + m0*stride_B0, local_result);
     }
 
     len_type dummy = 0;
     reduce(comm, REDUCE_SUM, local_result, dummy);
-    if (comm.master())
-        result = (conj_A ? conj(local_result) : local_result);
+    if (comm.master()) result = local_result;
 
     comm.barrier();
 }
 
+template <typename T>
+void dot(const communicator& comm, const config& cfg,
+         const std::vector<len_type>& len_A,
+         const std::vector<len_type>& len_B,
+         const std::vector<len_type>& len_AB,
+         bool conj_A, const T* A, const std::vector<stride_type>& stride_A,
+                                  const std::vector<stride_type>& stride_A_AB,
+         bool conj_B, const T* B, const std::vector<stride_type>& stride_B,
+                                  const std::vector<stride_type>& stride_B_AB,
+         T& result)
+{
+    dot_mixed(comm, cfg, len_A, len_B, len_AB,
+              conj_A, A, stride_A, stride_A_AB,
+              conj_B, B, stride_B, stride_B_AB, result);
+}
+
+#define INSTANTIATE_DOT_MIXED(T, TA) \
+template void dot_mixed(const communicator& comm, const config& cfg, \
+                        const std::vector<len_type>& len_A, \
+                        const std::vector<len_type>& len_B, \
+                        const std::vector<len_type>& len_AB, \
+                        bool conj_A, const TA* A, const std::vector<stride_type>& stride_A, \
+                                                  const std::vector<stride_type>& stride_A_AB, \
+                        bool conj_B, const TA* B, const std::vector<stride_type>& stride_B, \
+                                                  const std::vector<stride_type>& stride_B_AB, \
+                        T& result);
+
+INSTANTIATE_DOT_MIXED(float,     tblis_half);
+INSTANTIATE_DOT_MIXED(float, tblis_bfloat16);
+
 #define FOREACH_TYPE(T) \
+INSTANTIATE_DOT_MIXED(T, T) \
 template void dot(const communicator& comm, const config& cfg, \
                   const std::vector<len_type>& len_A, \
                   const std::vector<len_type>& len_B, \
@@ -21,6 +21,21 @@ void dot(const communicator& comm, const config& cfg,
                                   const std::vector<stride_type>& stride_B_AB,
          T& result);
 
+/*
+ * Like dot, but A and B are stored as TA (half precision or bfloat16) and
+ * widened to T a chunk at a time.
+ */
+template <typename T, typename TA>
+void dot_mixed(const communicator& comm, const config& cfg,
+               const std::vector<len_type>& len_A,
+               const std::vector<len_type>& len_B,
+               const std::vector<len_type>& len_AB,
+               bool conj_A, const TA* A, const std::vector<stride_type>& stride_A,
+                                         const std::vector<stride_type>& stride_A_AB,
+               bool conj_B, const TA* B, const std::vector<stride_type>& stride_B,
+                                         const std::vector<stride_type>& stride_B_AB,
+               T& result);
+
 }
 }
 
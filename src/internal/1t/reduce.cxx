@@ -7,64 +7,253 @@ namespace tblis
 namespace internal
 {
 
+/*
+ * Reduce one chunk of a fiber of A with each of the nop reductions, where A0
+ * is the origin used for the returned indices.
+ */
 template <typename T>
-void reduce(const communicator& comm, const config& cfg, reduce_t op,
-            const std::vector<len_type>& len_A,
-            const T* A, const std::vector<stride_type>& stride_A,
-            T& result, len_type& idx)
+void reduce_chunk(const config& cfg, unsigned nop, const reduce_t* op,
+                  len_type m, const T* A, stride_type stride, const T* A0,
+                  T* result, len_type* idx)
+{
+    for (unsigned k = 0;k < nop;k++)
+    {
+        auto old_idx = idx[k];
+        idx[k] = -1;
+
+        cfg.reduce_ukr.call<T>(op[k], m, A, stride, result[k], idx[k]);
+
+        if (idx[k] != -1) idx[k] += A-A0;
+        else idx[k] = old_idx;
+    }
+}
+
+/*
+ * The same for A stored in a narrower type TA: the chunk is widened into a
+ * buffer first.
+ */
+template <typename T, typename TA>
+void reduce_chunk(const config& cfg, unsigned nop, const reduce_t* op,
+                  len_type m, const TA* A, stride_type stride, const TA* A0,
+                  T* result, len_type* idx)
+{
+    T buf[8192/sizeof(T)];
+
+    for (len_type i = 0;i < m;i++) buf[i] = T(A[i*stride]);
+
+    for (unsigned k = 0;k < nop;k++)
+    {
+        auto old_idx = idx[k];
+        idx[k] = -1;
+
+        cfg.reduce_ukr.call<T>(op[k], m, buf, 1, result[k], idx[k]);
+
+        if (idx[k] != -1) idx[k] = idx[k]*stride + (A-A0);
+        else idx[k] = old_idx;
+    }
+}
+
+/*
+ * Compute several reductions of A in a single sweep. Each fiber is processed
+ * in chunks small enough to stay in L1, and every reduction is applied to a
+ * chunk before moving on to the next one, so that A is read from memory only
+ * once.
+ *
+ * In reproducible mode the elements, in the order of the flattened index,
+ * are split into fixed-size blocks which may span several fibers. The
+ * partial result of each block is kept and the blocks are combined with a
+ * tree whose shape depends only on the number of blocks.
+ */
+template <typename T, typename TA>
+void reduce_multi_mixed(const communicator& comm, const config& cfg,
+                        unsigned nop, const reduce_t* op,
+                        const std::vector<len_type>& len_A,
+                        const TA* A, const std::vector<stride_type>& stride_A,
+                        T* result, len_type* idx)
 {
+    constexpr len_type chunk = 8192/sizeof(T);
+
     bool empty = len_A.size() == 0;
 
     len_type len0 = (empty ? 1 : len_A[0]);
-    std::vector<len_type> len1(len_A.begin() + !empty, len_A.end());
+    len_vector len1(len_A.begin() + !empty, len_A.end());
 
     stride_type stride0 = (empty ? 1 : stride_A[0]);
-    std::vector<len_type> stride1(stride_A.begin() + !empty, stride_A.end());
+    stride_vector stride1(stride_A.begin() + !empty, stride_A.end());
 
     MArray::viterator<1> iter_A(len1, stride1);
     len_type n = stl_ext::prod(len1);
 
+    std::vector<T> local_result(nop);
+    std::vector<len_type> local_idx(nop);
+
+    auto A0 = A;
+
+    if (tblis_get_reproducible())
+    {
+        constexpr len_type block_size = 16*chunk;
+        len_type size = len0*n;
+        len_type nblock = std::max<len_type>(1, (size+block_size-1)/block_size);
+
+        std::vector<std::pair<T,len_type>> partial;
+        auto partial_ptr = partial.data();
+
+        if (comm.master())
+        {
+            partial.resize(nblock*nop);
+            partial_ptr = partial.data();
+        }
+
+        comm.broadcast(partial_ptr);
+
+        len_type block_min, block_max;
+        std::tie(block_min, block_max, std::ignore) =
+            comm.distribute_over_threads(nblock);
+
+        for (len_type block = block_min;block < block_max;block++)
+        {
+            len_type first = block*block_size;
+            len_type last = std::min(first+block_size, size);
+
+            for (unsigned k = 0;k < nop;k++)
+                reduce_init(op[k], local_result[k], local_idx[k]);
+
+            if (first < last)
+            {
+                /*
+                 * Walk the fibers covered by [first,last).
+                 */
+                const TA* A1 = A;
+                iter_A.position(first/len0, A1);
+                iter_A.next(A1);
+
+                len_type m0 = first%len0;
+
+                while (true)
+                {
+                    len_type m = std::min(len0-m0, last-first);
+
+                    for (len_type m1 = 0;m1 < m;m1 += chunk)
+                        reduce_chunk(cfg, nop, op, std::min(chunk, m-m1),
+                                     A1 + (m0+m1)*stride0, stride0, A0,
+                                     local_result.data(), local_idx.data());
+
+                    first += m;
+                    if (first == last) break;
+
+                    iter_A.next(A1);
+                    m0 = 0;
+                }
+            }
+
+            for (unsigned k = 0;k < nop;k++)
+                partial_ptr[block*nop+k] = {local_result[k], local_idx[k]};
+        }
+
+        comm.barrier();
+
+        reduce_blocks(comm, nop, op, nblock, partial_ptr);
+
+        if (comm.master())
+        {
+            for (unsigned k = 0;k < nop;k++)
+            {
+                result[k] = partial_ptr[k].first;
+                idx[k] = partial_ptr[k].second;
+            }
+        }
+
+        comm.barrier();
+        return;
+    }
+
     len_type m_min, m_max, n_min, n_max;
     std::tie(m_min, m_max, std::ignore,
              n_min, n_max, std::ignore) =
         comm.distribute_over_threads_2d(len0, n);
 
-    T local_result;
-    len_type local_idx;
-    reduce_init(op, local_result, local_idx);
+    for (unsigned k = 0;k < nop;k++)
+        reduce_init(op[k], local_result[k], local_idx[k]);
 
-    auto A0 = A;
     iter_A.position(n_min, A);
     A += m_min*stride0;
 
     for (len_type i = n_min;i < n_max;i++)
     {
-        auto old_idx = local_idx;
-        local_idx = -1;
-
         iter_A.next(A);
-        cfg.reduce_ukr.call<T>(op, m_max-m_min, A, stride0, local_result, local_idx);
 
-        if (local_idx != -1) local_idx += A-A0;
-        else local_idx = old_idx;
+        for (len_type m0 = 0;m0 < m_max-m_min;m0 += chunk)
+        {
+            len_type m = std::min(chunk, m_max-m_min-m0);
+            reduce_chunk(cfg, nop, op, m, A + m0*stride0, stride0, A0,
+                         local_result.data(), local_idx.data());
+        }
     }
 
-    reduce(comm, op, local_result, local_idx);
+    reduce(comm, nop, op, local_result.data(), local_idx.data());
 
     if (comm.master())
     {
-        result = local_result;
-        idx = local_idx;
+        std::copy_n(local_result.data(), nop, result);
+        std::copy_n(local_idx.data(), nop, idx);
     }
 
     comm.barrier();
 }
 
+template <typename T>
+void reduce_multi(const communicator& comm, const config& cfg,
+                  unsigned nop, const reduce_t* op,
+                  const std::vector<len_type>& len_A,
+                  const T* A, const std::vector<stride_type>& stride_A,
+                  T* result, len_type* idx)
+{
+    reduce_multi_mixed(comm, cfg, nop, op, len_A, A, stride_A, result, idx);
+}
+
+template <typename T>
+void reduce(const communicator& comm, const config& cfg, reduce_t op,
+            const std::vector<len_type>& len_A,
+            const T* A, const std::vector<stride_type>& stride_A,
+            T& result, len_type& idx)
+{
+    reduce_multi(comm, cfg, 1, &op, len_A, A, stride_A, &result, &idx);
+}
+
+template <typename T, typename TA>
+void reduce_mixed(const communicator& comm, const config& cfg, reduce_t op,
+                  const std::vector<len_type>& len_A,
+                  const TA* A, const std::vector<stride_type>& stride_A,
+                  T& result, len_type& idx)
+{
+    reduce_multi_mixed(comm, cfg, 1, &op, len_A, A, stride_A, &result, &idx);
+}
+
+#define INSTANTIATE_REDUCE_MIXED(T, TA) \
+template void reduce_mixed(const communicator& comm, const config& cfg, reduce_t op, \
+                           const std::vector<len_type>& len_A, \
+                           const TA* A, const std::vector<stride_type>& stride_A, \
+                           T& result, len_type& idx); \
+template void reduce_multi_mixed(const communicator& comm, const config& cfg, \
+                                 unsigned nop, const reduce_t* op, \
+                                 const std::vector<len_type>& len_A, \
+                                 const TA* A, const std::vector<stride_type>& stride_A, \
+                                 T* result, len_type* idx);
+
+INSTANTIATE_REDUCE_MIXED(float,     tblis_half);
+INSTANTIATE_REDUCE_MIXED(float, tblis_bfloat16);
+
 #define FOREACH_TYPE(T) \
+INSTANTIATE_REDUCE_MIXED(T, T) \
 template void reduce(const communicator& comm, const config& cfg, reduce_t op, \
                      const std::vector<len_type>& len_A, \
                      const T* A, const std::vector<stride_type>& stride_A, \
-                     T& result, len_type& idx);
+                     T& result, len_type& idx); \
+template void reduce_multi(const communicator& comm, const config& cfg, \
+                           unsigned nop, const reduce_t* op, \
+                           const std::vector<len_type>& len_A, \
+                           const T* A, const std::vector<stride_type>& stride_A, \
+                           T* result, len_type* idx);
 #include "configs/foreach_type.h"
 
 }
@@ -16,6 +16,30 @@ void reduce(const communicator& comm, const config& cfg, reduce_t op,
             const T* A, const std::vector<stride_type>& stride_A,
             T& result, len_type& idx);
 
+template <typename T>
+void reduce_multi(const communicator& comm, const config& cfg,
+                  unsigned nop, const reduce_t* op,
+                  const std::vector<len_type>& len_A,
+                  const T* A, const std::vector<stride_type>& stride_A,
+                  T* result, len_type* idx);
+
+/*
+ * Like reduce and reduce_multi, but A is stored as TA (half precision or
+ * bfloat16) and widened to T a chunk at a time.
+ */
+template <typename T, typename TA>
+void reduce_mixed(const communicator& comm, const config& cfg, reduce_t op,
+                  const std::vector<len_type>& len_A,
+                  const TA* A, const std::vector<stride_type>& stride_A,
+                  T& result, len_type& idx);
+
+template <typename T, typename TA>
+void reduce_multi_mixed(const communicator& comm, const config& cfg,
+                        unsigned nop, const reduce_t* op,
+                        const std::vector<len_type>& len_A,
+                        const TA* A, const std::vector<stride_type>& stride_A,
+                        T* result, len_type* idx);
+
 }
 }
 
@@ -9,16 +9,16 @@ namespace internal
 
 template <typename T>
 void scale(const communicator& comm, const config& cfg,
-           const std::vector<len_type>& len_A,
-           T alpha, bool conj_A, T* A, const std::vector<stride_type>& stride_A)
+           const len_vector& len_A,
+           T alpha, bool conj_A, T* A, const stride_vector& stride_A)
 {
     bool empty = len_A.size() == 0;
 
     len_type len0 = (empty ? 1 : len_A[0]);
-    std::vector<len_type> len1(len_A.begin() + !empty, len_A.end());
+    len_vector len1(len_A.begin() + !empty, len_A.end());
 
     stride_type stride0 = (empty ? 1 : stride_A[0]);
-    std::vector<len_type> stride1(stride_A.begin() + !empty, stride_A.end());
+    stride_vector stride1(stride_A.begin() + !empty, stride_A.end());
 
     MArray::viterator<1> iter_A(len1, stride1);
     len_type n = stl_ext::prod(len1);
@@ -41,10 +41,54 @@ void scale(const communicator& comm, const config& cfg,
     comm.barrier();
 }
 
+template <typename T, typename TS>
+void scale_mixed(const communicator& comm, const config& cfg,
+                 const len_vector& len_A,
+                 T alpha, bool conj_A, TS* A, const stride_vector& stride_A)
+{
+    (void)cfg;
+
+    bool empty = len_A.size() == 0;
+
+    len_type len0 = (empty ? 1 : len_A[0]);
+    len_vector len1(len_A.begin() + !empty, len_A.end());
+
+    stride_type stride0 = (empty ? 1 : stride_A[0]);
+    stride_vector stride1(stride_A.begin() + !empty, stride_A.end());
+
+    MArray::viterator<1> iter_A(len1, stride1);
+    len_type n = stl_ext::prod(len1);
+
+    len_type m_min, m_max, n_min, n_max;
+    std::tie(m_min, m_max, std::ignore,
+             n_min, n_max, std::ignore) =
+        comm.distribute_over_threads_2d(len0, n);
+
+    iter_A.position(n_min, A);
+    A += m_min*stride0;
+
+    for (len_type i = n_min;i < n_max;i++)
+    {
+        iter_A.next(A);
+        for (len_type j = 0;j < m_max-m_min;j++)
+            A[j*stride0] = TS(alpha*conj(conj_A, T(A[j*stride0])));
+    }
+
+    comm.barrier();
+}
+
+#define INSTANTIATE_SCALE_MIXED(T, TS) \
+template void scale_mixed(const communicator& comm, const config& cfg, \
+                          const len_vector& len_A, \
+                          T alpha, bool conj_A, TS* A, const stride_vector& stride_A);
+
+INSTANTIATE_SCALE_MIXED(float,     tblis_half);
+INSTANTIATE_SCALE_MIXED(float, tblis_bfloat16);
+
 #define FOREACH_TYPE(T) \
 template void scale(const communicator& comm, const config& cfg, \
-                    const std::vector<len_type>& len_A, \
-                    T alpha, bool conj_A, T* A, const std::vector<stride_type>& stride_A);
+                    const len_vector& len_A, \
+                    T alpha, bool conj_A, T* A, const stride_vector& stride_A);
 #include "configs/foreach_type.h"
 
 }
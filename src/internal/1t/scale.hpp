@@ -12,8 +12,17 @@ namespace internal
 
 template <typename T>
 void scale(const communicator& comm, const config& cfg,
-           const std::vector<len_type>& len_A,
-           T alpha, bool conj_A, T* A, const std::vector<stride_type>& stride_A);
+           const len_vector& len_A,
+           T alpha, bool conj_A, T* A, const stride_vector& stride_A);
+
+/*
+ * Like scale, but A is stored as TS (half precision or bfloat16) and each
+ * element is widened to T, scaled, and narrowed again.
+ */
+template <typename T, typename TS>
+void scale_mixed(const communicator& comm, const config& cfg,
+                 const len_vector& len_A,
+                 T alpha, bool conj_A, TS* A, const stride_vector& stride_A);
 
 }
 }
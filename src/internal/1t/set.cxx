@@ -2,23 +2,79 @@
 
 #include "util/tensor.hpp"
 
+#include "kernels/1v/stream.hpp"
+
 namespace tblis
 {
 namespace internal
 {
 
+/*
+ * The indices are expected to be folded and sorted by stride, so that the
+ * threads are distributed in the same way as in add_vector (and as by the
+ * first-touch NUMA policy for dense tensors), and each thread sets the part
+ * of A that it later reads or updates.
+ */
 template <typename T>
 void set(const communicator& comm, const config& cfg,
-         const std::vector<len_type>& len_A,
-         T alpha, T* A, const std::vector<stride_type>& stride_A)
+         const len_vector& len_A,
+         T alpha, T* A, const stride_vector& stride_A)
+{
+    bool empty = len_A.size() == 0;
+
+    len_type len0 = (empty ? 1 : len_A[0]);
+    len_vector len1(len_A.begin() + !empty, len_A.end());
+
+    stride_type stride0 = (empty ? 1 : stride_A[0]);
+    stride_vector stride1(stride_A.begin() + !empty, stride_A.end());
+
+    MArray::viterator<1> iter_A(len1, stride1);
+    len_type n = stl_ext::prod(len1);
+
+    len_type m_min, m_max, n_min, n_max;
+    std::tie(m_min, m_max, std::ignore,
+             n_min, n_max, std::ignore) =
+        comm.distribute_over_threads_2d(len0, n);
+
+    iter_A.position(n_min, A);
+    A += m_min*stride0;
+
+    if (stride0 == 1 && use_stream_stores<T>(len0*n))
+    {
+        for (len_type i = n_min;i < n_max;i++)
+        {
+            iter_A.next(A);
+            stream_set(m_max-m_min, alpha, A);
+        }
+
+        stream_fence();
+    }
+    else
+    {
+        for (len_type i = n_min;i < n_max;i++)
+        {
+            iter_A.next(A);
+            cfg.set_ukr.call<T>(m_max-m_min, alpha, A, stride0);
+        }
+    }
+
+    comm.barrier();
+}
+
+template <typename T, typename TS>
+void set_mixed(const communicator& comm, const config& cfg,
+               const len_vector& len_A,
+               T alpha, TS* A, const stride_vector& stride_A)
 {
+    (void)cfg;
+
     bool empty = len_A.size() == 0;
 
     len_type len0 = (empty ? 1 : len_A[0]);
-    std::vector<len_type> len1(len_A.begin() + !empty, len_A.end());
+    len_vector len1(len_A.begin() + !empty, len_A.end());
 
     stride_type stride0 = (empty ? 1 : stride_A[0]);
-    std::vector<len_type> stride1(stride_A.begin() + !empty, stride_A.end());
+    stride_vector stride1(stride_A.begin() + !empty, stride_A.end());
 
     MArray::viterator<1> iter_A(len1, stride1);
     len_type n = stl_ext::prod(len1);
@@ -31,19 +87,29 @@ void set(const communicator& comm, const config& cfg,
     iter_A.position(n_min, A);
     A += m_min*stride0;
 
+    TS value(alpha);
+
     for (len_type i = n_min;i < n_max;i++)
     {
         iter_A.next(A);
-        cfg.set_ukr.call<T>(m_max-m_min, alpha, A, stride0);
+        for (len_type j = 0;j < m_max-m_min;j++) A[j*stride0] = value;
     }
 
     comm.barrier();
 }
 
+#define INSTANTIATE_SET_MIXED(T, TS) \
+template void set_mixed(const communicator& comm, const config& cfg, \
+                        const len_vector& len_A, \
+                        T alpha, TS* A, const stride_vector& stride_A);
+
+INSTANTIATE_SET_MIXED(float,     tblis_half);
+INSTANTIATE_SET_MIXED(float, tblis_bfloat16);
+
 #define FOREACH_TYPE(T) \
 template void set(const communicator& comm, const config& cfg, \
-                  const std::vector<len_type>& len_A, \
-                  T alpha, T* A, const std::vector<stride_type>& stride_A);
+                  const len_vector& len_A, \
+                  T alpha, T* A, const stride_vector& stride_A);
 #include "configs/foreach_type.h"
 
 }
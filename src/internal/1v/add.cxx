@@ -1,5 +1,7 @@
 #include "add.hpp"
 
+#include "kernels/1v/stream.hpp"
+
 namespace tblis
 {
 namespace internal
@@ -13,7 +15,13 @@ void add(const communicator& comm, const config& cfg, len_type n,
     len_type n_min, n_max;
     std::tie(n_min, n_max, std::ignore) = comm.distribute_over_threads(n);
 
-    if (beta == T(0))
+    if (beta == T(0) && inc_B == 1 && use_stream_stores<T>(n))
+    {
+        stream_copy(n_max-n_min, alpha, conj_A, A + n_min*inc_A, inc_A,
+                                                B + n_min);
+        stream_fence();
+    }
+    else if (beta == T(0))
     {
         cfg.copy_ukr.call<T>(n_max-n_min,
                              alpha, conj_A, A + n_min*inc_A, inc_A,
@@ -10,6 +10,53 @@ void dot(const communicator& comm, const config& cfg, len_type n,
          bool conj_A, const T* A, stride_type inc_A,
          bool conj_B, const T* B, stride_type inc_B, T& result)
 {
+    if (tblis_get_reproducible())
+    {
+        /*
+         * Compute the dot product of fixed-size blocks and add them up in
+         * a fixed order, so that the result does not depend on the number
+         * of threads.
+         */
+        constexpr len_type block_size = 4096/sizeof(T);
+        len_type nblock = std::max<len_type>(1, (n+block_size-1)/block_size);
+
+        std::vector<std::pair<T,len_type>> partial;
+        auto partial_ptr = partial.data();
+
+        if (comm.master())
+        {
+            partial.resize(nblock);
+            partial_ptr = partial.data();
+        }
+
+        comm.broadcast(partial_ptr);
+
+        len_type block_min, block_max;
+        std::tie(block_min, block_max, std::ignore) =
+            comm.distribute_over_threads(nblock);
+
+        for (len_type block = block_min;block < block_max;block++)
+        {
+            len_type i0 = block*block_size;
+
+            T value = T();
+            cfg.dot_ukr.call<T>(std::min(block_size, n-i0),
+                                conj_A, A + i0*inc_A, inc_A,
+                                conj_B, B + i0*inc_B, inc_B, value);
+            partial_ptr[block] = {value, 0};
+        }
+
+        comm.barrier();
+
+        reduce_t op = REDUCE_SUM;
+        reduce_blocks(comm, 1, &op, nblock, partial_ptr);
+
+        if (comm.master()) result = partial_ptr[0].first;
+
+        comm.barrier();
+        return;
+    }
+
     len_type n_min, n_max;
     std::tie(n_min, n_max, std::ignore) = comm.distribute_over_threads(n);
 
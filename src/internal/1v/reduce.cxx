@@ -9,6 +9,58 @@ template <typename T>
 void reduce(const communicator& comm, const config& cfg, reduce_t op, len_type n,
             const T* A, stride_type inc_A, T& result, len_type& idx)
 {
+    if (tblis_get_reproducible())
+    {
+        /*
+         * Reduce fixed-size blocks and combine them in a fixed order, so
+         * that the result does not depend on the number of threads.
+         */
+        constexpr len_type block_size = 4096/sizeof(T);
+        len_type nblock = std::max<len_type>(1, (n+block_size-1)/block_size);
+
+        std::vector<std::pair<T,len_type>> partial;
+        auto partial_ptr = partial.data();
+
+        if (comm.master())
+        {
+            partial.resize(nblock);
+            partial_ptr = partial.data();
+        }
+
+        comm.broadcast(partial_ptr);
+
+        len_type block_min, block_max;
+        std::tie(block_min, block_max, std::ignore) =
+            comm.distribute_over_threads(nblock);
+
+        for (len_type block = block_min;block < block_max;block++)
+        {
+            len_type i0 = block*block_size;
+
+            auto& local = partial_ptr[block];
+            reduce_init(op, local.first, local.second);
+
+            cfg.reduce_ukr.call<T>(op, std::min(block_size, n-i0),
+                                   A + i0*inc_A, inc_A,
+                                   local.first, local.second);
+
+            if (local.second != -1) local.second += i0*inc_A;
+        }
+
+        comm.barrier();
+
+        reduce_blocks(comm, 1, &op, nblock, partial_ptr);
+
+        if (comm.master())
+        {
+            result = partial_ptr[0].first;
+            idx = partial_ptr[0].second;
+        }
+
+        comm.barrier();
+        return;
+    }
+
     len_type n_min, n_max;
     std::tie(n_min, n_max, std::ignore) = comm.distribute_over_threads(n);
 
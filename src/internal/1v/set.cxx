@@ -1,5 +1,7 @@
 #include "set.hpp"
 
+#include "kernels/1v/stream.hpp"
+
 namespace tblis
 {
 namespace internal
@@ -12,7 +14,15 @@ void set(const communicator& comm, const config& cfg, len_type n,
     len_type n_min, n_max;
     std::tie(n_min, n_max, std::ignore) = comm.distribute_over_threads(n);
 
-    cfg.set_ukr.call<T>(n_max-n_min, alpha, A + n_min*inc_A, inc_A);
+    if (inc_A == 1 && use_stream_stores<T>(n))
+    {
+        stream_set(n_max-n_min, alpha, A + n_min);
+        stream_fence();
+    }
+    else
+    {
+        cfg.set_ukr.call<T>(n_max-n_min, alpha, A + n_min*inc_A, inc_A);
+    }
 
     comm.barrier();
 }
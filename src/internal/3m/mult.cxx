@@ -12,8 +12,6 @@ namespace internal
 {
 
 extern MemoryPool BuffersForA, BuffersForB;
-MemoryPool BuffersForA(4096);
-MemoryPool BuffersForB(4096);
 
 using GotoGEMM = partition_gemm_nc<
                    partition_gemm_kc<
@@ -17,8 +17,7 @@ namespace internal
 
 impl_t impl = BLIS_BASED;
 
-extern MemoryPool BuffersForA, BuffersForB, BuffersForScatter;
-MemoryPool BuffersForScatter(4096);
+extern MemoryPool BuffersForA, BuffersForB, BuffersForScatter, BuffersForStaging;
 
 using TensorGEMM = partition_gemm_nc<
                      partition_gemm_kc<
@@ -30,78 +29,101 @@ using TensorGEMM = partition_gemm_nc<
                                  partition_gemm_mr<
                                    gemm_micro_kernel>>>>>>>>;
 
+/*
+ * View dense row-major storage for the indices len_m+len_n as an m x n
+ * matrix, as matricize does for a tensor_view, and return the tensor
+ * strides in stride. Only short vectors are used, so that nothing is taken
+ * from the heap.
+ */
+template <typename T>
+matrix_view<T> dense_matrix(const len_vector& len_m, const len_vector& len_n,
+                            T* data, stride_vector& stride)
+{
+    auto len = len_m + len_n;
+    stride.resize(len.size());
+
+    stride_type s = 1;
+    for (size_t i = len.size();i --> 0;)
+    {
+        stride[i] = s;
+        s *= len[i];
+    }
+
+    len_type m = stl_ext::prod(len_m);
+    len_type n = stl_ext::prod(len_n);
+
+    if (n == 1) return matrix_view<T>({m, n}, data, {1, m});
+    return matrix_view<T>({m, n}, data, {n, 1});
+}
+
 template <typename T>
 void contract_blas(const communicator& comm, const config& cfg,
-                   const std::vector<len_type>& len_AB,
-                   const std::vector<len_type>& len_AC,
-                   const std::vector<len_type>& len_BC,
+                   const len_vector& len_AB,
+                   const len_vector& len_AC,
+                   const len_vector& len_BC,
                    T alpha, const T* A,
-                   const std::vector<stride_type>& stride_A_AB,
-                   const std::vector<stride_type>& stride_A_AC,
+                   const stride_vector& stride_A_AB,
+                   const stride_vector& stride_A_AC,
                             const T* B,
-                   const std::vector<stride_type>& stride_B_AB,
-                   const std::vector<stride_type>& stride_B_BC,
+                   const stride_vector& stride_B_AB,
+                   const stride_vector& stride_B_BC,
                    T  beta,       T* C,
-                   const std::vector<stride_type>& stride_C_AC,
-                   const std::vector<stride_type>& stride_C_BC)
+                   const stride_vector& stride_C_AC,
+                   const stride_vector& stride_C_BC)
 {
-    tensor<T> ar, br, cr;
+    MemoryPool::Block ar, br, cr;
     T* ptrs_local[3];
     T** ptrs = &ptrs_local[0];
 
     if (comm.master())
     {
-        ar.reset(len_AC+len_AB);
-        br.reset(len_AB+len_BC);
-        cr.reset(len_AC+len_BC);
-        ptrs[0] = ar.data();
-        ptrs[1] = br.data();
-        ptrs[2] = cr.data();
+        ar = BuffersForStaging.allocate<T>(stl_ext::prod(len_AC)*stl_ext::prod(len_AB));
+        br = BuffersForStaging.allocate<T>(stl_ext::prod(len_AB)*stl_ext::prod(len_BC));
+        cr = BuffersForStaging.allocate<T>(stl_ext::prod(len_AC)*stl_ext::prod(len_BC));
+        ptrs[0] = ar.get<T>();
+        ptrs[1] = br.get<T>();
+        ptrs[2] = cr.get<T>();
     }
 
     comm.broadcast(ptrs);
 
-    tensor_view<T> arv(len_AC+len_AB, ptrs[0]);
-    tensor_view<T> brv(len_AB+len_BC, ptrs[1]);
-    tensor_view<T> crv(len_AC+len_BC, ptrs[2]);
-
-    matrix_view<T> am, bm, cm;
-    matricize<T>(arv, am, static_cast<unsigned>(len_AC.size()));
-    matricize<T>(brv, bm, static_cast<unsigned>(len_AB.size()));
-    matricize<T>(crv, cm, static_cast<unsigned>(len_AC.size()));
+    stride_vector stride_AT, stride_BT, stride_CT;
+    auto am = dense_matrix(len_AC, len_AB, ptrs[0], stride_AT);
+    auto bm = dense_matrix(len_AB, len_BC, ptrs[1], stride_BT);
+    auto cm = dense_matrix(len_AC, len_BC, ptrs[2], stride_CT);
 
-    add(comm, cfg, {}, {}, arv.lengths(),
-        T(1), false,          A, {}, stride_A_AC+stride_A_AB,
-        T(0), false, arv.data(), {},           arv.strides());
+    add(comm, cfg, {}, {}, len_AC+len_AB,
+        T(1), false,         A, {}, stride_A_AC+stride_A_AB,
+        T(0), false, am.data(), {},              stride_AT);
 
-    add(comm, cfg, {}, {}, brv.lengths(),
-        T(1), false,          B, {}, stride_B_AB+stride_B_BC,
-        T(0), false, brv.data(), {},           brv.strides());
+    add(comm, cfg, {}, {}, len_AB+len_BC,
+        T(1), false,         B, {}, stride_B_AB+stride_B_BC,
+        T(0), false, bm.data(), {},              stride_BT);
 
     mult(comm, cfg, cm.length(0), cm.length(1), am.length(1),
          alpha, false, am.data(), am.stride(0), am.stride(1),
                 false, bm.data(), bm.stride(0), bm.stride(1),
           T(0), false, cm.data(), cm.stride(0), cm.stride(1));
 
-    add(comm, cfg, {}, {}, crv.lengths(),
-        T(1), false, crv.data(), {},            crv.strides(),
-        beta, false,          C, {}, stride_C_AC+stride_C_BC);
+    add(comm, cfg, {}, {}, len_AC+len_BC,
+        T(1), false, cm.data(), {},               stride_CT,
+        beta, false,         C, {}, stride_C_AC+stride_C_BC);
 }
 
 template <typename T>
 void contract_ref(const communicator& comm, const config& cfg,
-                  const std::vector<len_type>& len_AB,
-                  const std::vector<len_type>& len_AC,
-                  const std::vector<len_type>& len_BC,
+                  const len_vector& len_AB,
+                  const len_vector& len_AC,
+                  const len_vector& len_BC,
                   T alpha, const T* A,
-                  const std::vector<stride_type>& stride_A_AB,
-                  const std::vector<stride_type>& stride_A_AC,
+                  const stride_vector& stride_A_AB,
+                  const stride_vector& stride_A_AC,
                            const T* B,
-                  const std::vector<stride_type>& stride_B_AB,
-                  const std::vector<stride_type>& stride_B_BC,
+                  const stride_vector& stride_B_AB,
+                  const stride_vector& stride_B_BC,
                   T  beta,       T* C,
-                  const std::vector<stride_type>& stride_C_AC,
-                  const std::vector<stride_type>& stride_C_BC)
+                  const stride_vector& stride_C_AC,
+                  const stride_vector& stride_C_BC)
 {
     (void)cfg;
 
@@ -155,42 +177,201 @@ void contract_ref(const communicator& comm, const config& cfg,
     }
 }
 
-template <typename T>
+template <typename T, typename MatrixA, typename MatrixB, typename MatrixC>
+void contract_blis_gemm(const communicator& comm, const config& cfg,
+                        T alpha, MatrixA& at, MatrixB& bt, T beta, MatrixC& ct)
+{
+    TensorGEMM gemm;
+
+    len_type m = ct.length(0);
+    len_type n = ct.length(1);
+    len_type k = at.length(1);
+
+    int nt = comm.num_threads();
+    auto tc = make_gemm_thread_config<T>(cfg, nt, m, n, k);
+    step<0>(gemm).distribute = tc.jc_nt;
+    step<4>(gemm).distribute = tc.ic_nt;
+    step<8>(gemm).distribute = tc.jr_nt;
+    step<9>(gemm).distribute = tc.ir_nt;
+
+    gemm(comm, cfg, alpha, at, bt, beta, ct);
+}
+
+template <typename T, typename TA, typename TB, typename TC>
 void contract_blis(const communicator& comm, const config& cfg,
-                   const std::vector<len_type>& len_AB,
-                   const std::vector<len_type>& len_AC,
-                   const std::vector<len_type>& len_BC,
-                   T alpha, const T* A,
-                   const std::vector<stride_type>& stride_A_AB,
-                   const std::vector<stride_type>& stride_A_AC,
-                            const T* B,
-                   const std::vector<stride_type>& stride_B_AB,
-                   const std::vector<stride_type>& stride_B_BC,
-                   T  beta,       T* C,
-                   const std::vector<stride_type>& stride_C_AC,
-                   const std::vector<stride_type>& stride_C_BC)
+                   const len_vector& len_AB,
+                   const len_vector& len_AC,
+                   const len_vector& len_BC,
+                   T alpha, bool conj_A, const TA* A,
+                   const stride_vector& stride_A_AB,
+                   const stride_vector& stride_A_AC,
+                            bool conj_B, const TB* B,
+                   const stride_vector& stride_B_AB,
+                   const stride_vector& stride_B_BC,
+                   T  beta, bool conj_C,       TC* C,
+                   const stride_vector& stride_C_AC,
+                   const stride_vector& stride_C_BC);
+
+/*
+ * Whether C must be accumulated in a temporary of the compute type T, i.e.
+ * whether it is stored in another type and the contracted dimension is
+ * split into more than one block.
+ */
+template <typename T, typename TC>
+bool stage_C(const config& cfg, len_type k)
+{
+    return !std::is_same<T,TC>::value && k > cfg.gemm_kc.max<T>();
+}
+
+/*
+ * Compute alpha*A*B into a dense temporary of type T and then C = temp +
+ * beta*C, so that C is rounded to TC only once.
+ */
+template <typename T, typename TA, typename TB, typename TC>
+void contract_blis_staged(const communicator& comm, const config& cfg,
+                          const len_vector& len_AB,
+                          const len_vector& len_AC,
+                          const len_vector& len_BC,
+                          T alpha, bool conj_A, const TA* A,
+                          const stride_vector& stride_A_AB,
+                          const stride_vector& stride_A_AC,
+                                   bool conj_B, const TB* B,
+                          const stride_vector& stride_B_AB,
+                          const stride_vector& stride_B_BC,
+                          T  beta, bool conj_C,       TC* C,
+                          const stride_vector& stride_C_AC,
+                          const stride_vector& stride_C_BC)
+{
+    len_type m = stl_ext::prod(len_AC);
+    len_type n = stl_ext::prod(len_BC);
+
+    stride_vector stride_T_AC(len_AC.size());
+    stride_vector stride_T_BC(len_BC.size());
+
+    stride_type stride = 1;
+    for (size_t i = 0;i < len_AC.size();i++)
+    {
+        stride_T_AC[i] = stride;
+        stride *= len_AC[i];
+    }
+    for (size_t i = 0;i < len_BC.size();i++)
+    {
+        stride_T_BC[i] = stride;
+        stride *= len_BC[i];
+    }
+
+    MemoryPool::Block tr;
+    T* ptr;
+
+    if (comm.master())
+    {
+        tr = BuffersForStaging.allocate<T>(m*n);
+        ptr = tr.get<T>();
+    }
+
+    comm.broadcast(ptr);
+
+    contract_blis(comm, cfg, len_AB, len_AC, len_BC,
+                  alpha, conj_A, A, stride_A_AB, stride_A_AC,
+                         conj_B, B, stride_B_AB, stride_B_BC,
+                   T(0),  false, ptr, stride_T_AC, stride_T_BC);
+
+    comm.barrier();
+
+    MArray::viterator<2> iter_AC(len_AC, stride_T_AC, stride_C_AC);
+    MArray::viterator<2> iter_BC(len_BC, stride_T_BC, stride_C_BC);
+
+    len_type m_min, m_max, n_min, n_max;
+    std::tie(m_min, m_max, std::ignore,
+             n_min, n_max, std::ignore) = comm.distribute_over_threads_2d(m, n);
+
+    const T* T0 = ptr;
+         TC* C0 = C;
+
+    iter_AC.position(m_min, T0, C0);
+
+    for (len_type i = m_min;i < m_max;i++)
+    {
+        iter_AC.next(T0, C0);
+
+        const T* Tp = T0;
+        TC* Cp = C0;
+
+        iter_BC.position(n_min, Tp, Cp);
+
+        for (len_type j = n_min;j < n_max;j++)
+        {
+            iter_BC.next(Tp, Cp);
+
+            if (beta == T(0))
+            {
+                *Cp = TC(*Tp);
+            }
+            else
+            {
+                *Cp = TC(*Tp + beta*conj(conj_C, T(*Cp)));
+            }
+        }
+    }
+
+    comm.barrier();
+}
+
+/*
+ * A, B, and C may be stored in types other than the compute type T. They are
+ * converted (and conjugated if requested) to T while packing and C is
+ * converted back on write-back, once all of the contracted dimension has
+ * been summed.
+ */
+template <typename T, typename TA, typename TB, typename TC>
+void contract_blis(const communicator& comm, const config& cfg,
+                   const len_vector& len_AB,
+                   const len_vector& len_AC,
+                   const len_vector& len_BC,
+                   T alpha, bool conj_A, const TA* A,
+                   const stride_vector& stride_A_AB,
+                   const stride_vector& stride_A_AC,
+                            bool conj_B, const TB* B,
+                   const stride_vector& stride_B_AB,
+                   const stride_vector& stride_B_BC,
+                   T  beta, bool conj_C,       TC* C,
+                   const stride_vector& stride_C_AC,
+                   const stride_vector& stride_C_BC)
 {
+    if (stage_C<T,TC>(cfg, stl_ext::prod(len_AB)))
+    {
+        contract_blis_staged(comm, cfg, len_AB, len_AC, len_BC,
+                             alpha, conj_A, A, stride_A_AB, stride_A_AC,
+                                    conj_B, B, stride_B_AB, stride_B_BC,
+                              beta, conj_C, C, stride_C_AC, stride_C_BC);
+        return;
+    }
+
     auto reorder_AC = detail::sort_by_stride(stride_C_AC, stride_A_AC);
     auto reorder_BC = detail::sort_by_stride(stride_C_BC, stride_B_BC);
     auto reorder_AB = detail::sort_by_stride(stride_A_AB, stride_B_AB);
 
-    tensor_matrix<T> at(stl_ext::permuted(len_AC, reorder_AC),
-                        stl_ext::permuted(len_AB, reorder_AB),
-                        const_cast<T*>(A),
-                        stl_ext::permuted(stride_A_AC, reorder_AC),
-                        stl_ext::permuted(stride_A_AB, reorder_AB));
+    tensor_matrix<TA> at(stl_ext::permuted(len_AC, reorder_AC),
+                         stl_ext::permuted(len_AB, reorder_AB),
+                         const_cast<TA*>(A),
+                         stl_ext::permuted(stride_A_AC, reorder_AC),
+                         stl_ext::permuted(stride_A_AB, reorder_AB));
+
+    tensor_matrix<TB> bt(stl_ext::permuted(len_AB, reorder_AB),
+                         stl_ext::permuted(len_BC, reorder_BC),
+                         const_cast<TB*>(B),
+                         stl_ext::permuted(stride_B_AB, reorder_AB),
+                         stl_ext::permuted(stride_B_BC, reorder_BC));
 
-    tensor_matrix<T> bt(stl_ext::permuted(len_AB, reorder_AB),
-                        stl_ext::permuted(len_BC, reorder_BC),
-                        const_cast<T*>(B),
-                        stl_ext::permuted(stride_B_AB, reorder_AB),
-                        stl_ext::permuted(stride_B_BC, reorder_BC));
+    tensor_matrix<TC> ct(stl_ext::permuted(len_AC, reorder_AC),
+                         stl_ext::permuted(len_BC, reorder_BC),
+                         C,
+                         stl_ext::permuted(stride_C_AC, reorder_AC),
+                         stl_ext::permuted(stride_C_BC, reorder_BC));
 
-    tensor_matrix<T> ct(stl_ext::permuted(len_AC, reorder_AC),
-                        stl_ext::permuted(len_BC, reorder_BC),
-                        C,
-                        stl_ext::permuted(stride_C_AC, reorder_AC),
-                        stl_ext::permuted(stride_C_BC, reorder_BC));
+    at.conj(conj_A);
+    bt.conj(conj_B);
+    ct.conj(conj_C);
 
     const bool row_major = cfg.gemm_row_major.value<T>();
 
@@ -199,42 +380,31 @@ void contract_blis(const communicator& comm, const config& cfg,
         /*
          * Compute C^T = B^T * A^T instead
          */
-        at.swap(bt);
         at.transpose();
         bt.transpose();
         ct.transpose();
+        contract_blis_gemm(comm, cfg, alpha, bt, at, beta, ct);
+    }
+    else
+    {
+        contract_blis_gemm(comm, cfg, alpha, at, bt, beta, ct);
     }
-
-    TensorGEMM gemm;
-
-    len_type m = ct.length(0);
-    len_type n = ct.length(1);
-    len_type k = at.length(1);
-
-    int nt = comm.num_threads();
-    auto tc = make_gemm_thread_config<T>(cfg, nt, m, n, k);
-    step<0>(gemm).distribute = tc.jc_nt;
-    step<4>(gemm).distribute = tc.ic_nt;
-    step<8>(gemm).distribute = tc.jr_nt;
-    step<9>(gemm).distribute = tc.ir_nt;
-
-    gemm(comm, cfg, alpha, at, bt, beta, ct);
 }
 
 #define INSTANTIATE_CONTRACT_BLIS(T) \
 template void contract_blis(const communicator& comm, const config& cfg, \
-                            const std::vector<len_type>& len_AB, \
-                            const std::vector<len_type>& len_AC, \
-                            const std::vector<len_type>& len_BC, \
-                            T alpha, const T* A, \
-                            const std::vector<stride_type>& stride_A_AB, \
-                            const std::vector<stride_type>& stride_A_AC, \
-                                     const T* B, \
-                            const std::vector<stride_type>& stride_B_AB, \
-                            const std::vector<stride_type>& stride_B_BC, \
-                            T  beta,       T* C, \
-                            const std::vector<stride_type>& stride_C_AC, \
-                            const std::vector<stride_type>& stride_C_BC);
+                            const len_vector& len_AB, \
+                            const len_vector& len_AC, \
+                            const len_vector& len_BC, \
+                            T alpha, bool conj_A, const T* A, \
+                            const stride_vector& stride_A_AB, \
+                            const stride_vector& stride_A_AC, \
+                                     bool conj_B, const T* B, \
+                            const stride_vector& stride_B_AB, \
+                            const stride_vector& stride_B_BC, \
+                            T  beta, bool conj_C,       T* C, \
+                            const stride_vector& stride_C_AC, \
+                            const stride_vector& stride_C_BC);
 
 INSTANTIATE_CONTRACT_BLIS(float);
 INSTANTIATE_CONTRACT_BLIS(double);
@@ -243,101 +413,97 @@ INSTANTIATE_CONTRACT_BLIS(dcomplex);
 
 template <typename T>
 void mult_blas(const communicator& comm, const config& cfg,
-               const std::vector<len_type>& len_A,
-               const std::vector<len_type>& len_B,
-               const std::vector<len_type>& len_C,
-               const std::vector<len_type>& len_AB,
-               const std::vector<len_type>& len_AC,
-               const std::vector<len_type>& len_BC,
-               const std::vector<len_type>& len_ABC,
+               const len_vector& len_A,
+               const len_vector& len_B,
+               const len_vector& len_C,
+               const len_vector& len_AB,
+               const len_vector& len_AC,
+               const len_vector& len_BC,
+               const len_vector& len_ABC,
                T alpha, const T* A,
-               const std::vector<stride_type>& stride_A_A,
-               const std::vector<stride_type>& stride_A_AB,
-               const std::vector<stride_type>& stride_A_AC,
-               const std::vector<stride_type>& stride_A_ABC,
+               const stride_vector& stride_A_A,
+               const stride_vector& stride_A_AB,
+               const stride_vector& stride_A_AC,
+               const stride_vector& stride_A_ABC,
                         const T* B,
-               const std::vector<stride_type>& stride_B_B,
-               const std::vector<stride_type>& stride_B_AB,
-               const std::vector<stride_type>& stride_B_BC,
-               const std::vector<stride_type>& stride_B_ABC,
+               const stride_vector& stride_B_B,
+               const stride_vector& stride_B_AB,
+               const stride_vector& stride_B_BC,
+               const stride_vector& stride_B_ABC,
                T  beta,       T* C,
-               const std::vector<stride_type>& stride_C_C,
-               const std::vector<stride_type>& stride_C_AC,
-               const std::vector<stride_type>& stride_C_BC,
-               const std::vector<stride_type>& stride_C_ABC)
+               const stride_vector& stride_C_C,
+               const stride_vector& stride_C_AC,
+               const stride_vector& stride_C_BC,
+               const stride_vector& stride_C_ABC)
 {
-    tensor<T> ar, br, cr;
+    MemoryPool::Block ar, br, cr;
     T* ptrs_local[3];
     T** ptrs = &ptrs_local[0];
 
     if (comm.master())
     {
-        ar.reset(len_AC+len_AB);
-        br.reset(len_AB+len_BC);
-        cr.reset(len_AC+len_BC);
-        ptrs[0] = ar.data();
-        ptrs[1] = br.data();
-        ptrs[2] = cr.data();
+        ar = BuffersForStaging.allocate<T>(stl_ext::prod(len_AC)*stl_ext::prod(len_AB));
+        br = BuffersForStaging.allocate<T>(stl_ext::prod(len_AB)*stl_ext::prod(len_BC));
+        cr = BuffersForStaging.allocate<T>(stl_ext::prod(len_AC)*stl_ext::prod(len_BC));
+        ptrs[0] = ar.get<T>();
+        ptrs[1] = br.get<T>();
+        ptrs[2] = cr.get<T>();
     }
 
     comm.broadcast(ptrs);
 
-    tensor_view<T> arv(len_AC+len_AB, ptrs[0]);
-    tensor_view<T> brv(len_AB+len_BC, ptrs[1]);
-    tensor_view<T> crv(len_AC+len_BC, ptrs[2]);
-
-    matrix_view<T> am, bm, cm;
-    matricize<T>(arv, am, static_cast<unsigned>(len_AC.size()));
-    matricize<T>(brv, bm, static_cast<unsigned>(len_AB.size()));
-    matricize<T>(crv, cm, static_cast<unsigned>(len_AC.size()));
+    stride_vector stride_AT, stride_BT, stride_CT;
+    auto am = dense_matrix(len_AC, len_AB, ptrs[0], stride_AT);
+    auto bm = dense_matrix(len_AB, len_BC, ptrs[1], stride_BT);
+    auto cm = dense_matrix(len_AC, len_BC, ptrs[2], stride_CT);
 
     MArray::viterator<3> it(len_ABC, stride_A_ABC, stride_B_ABC, stride_C_ABC);
 
     while (it.next(A, B, C))
     {
-        add(comm, cfg, len_A, {}, arv.lengths(),
-            T(1), false,          A, stride_A_A, stride_A_AC+stride_A_AB,
-            T(0), false, arv.data(),         {},           arv.strides());
+        add(comm, cfg, len_A, {}, len_AC+len_AB,
+            T(1), false,         A, stride_A_A, stride_A_AC+stride_A_AB,
+            T(0), false, am.data(),         {},              stride_AT);
 
-        add(comm, cfg, len_B, {}, brv.lengths(),
-            T(1), false,          B, stride_B_B, stride_B_AB+stride_B_BC,
-            T(0), false, brv.data(),         {},           brv.strides());
+        add(comm, cfg, len_B, {}, len_AB+len_BC,
+            T(1), false,         B, stride_B_B, stride_B_AB+stride_B_BC,
+            T(0), false, bm.data(),         {},              stride_BT);
 
         mult(comm, cfg, cm.length(0), cm.length(1), am.length(1),
              alpha, false, am.data(), am.stride(0), am.stride(1),
                     false, bm.data(), bm.stride(0), bm.stride(1),
               T(0), false, cm.data(), cm.stride(0), cm.stride(1));
 
-        add(comm, cfg, {}, len_C, crv.lengths(),
-            T(1), false, crv.data(),         {},            crv.strides(),
-            beta, false,          C, stride_C_C, stride_C_AC+stride_C_BC);
+        add(comm, cfg, {}, len_C, len_AC+len_BC,
+            T(1), false, cm.data(),         {},               stride_CT,
+            beta, false,         C, stride_C_C, stride_C_AC+stride_C_BC);
     }
 }
 
-template <typename T>
+template <typename T, typename TA, typename TB, typename TC>
 void mult_ref(const communicator& comm, const config& cfg,
-              const std::vector<len_type>& len_A,
-              const std::vector<len_type>& len_B,
-              const std::vector<len_type>& len_C,
-              const std::vector<len_type>& len_AB,
-              const std::vector<len_type>& len_AC,
-              const std::vector<len_type>& len_BC,
-              const std::vector<len_type>& len_ABC,
-              T alpha, const T* A,
-              const std::vector<stride_type>& stride_A_A,
-              const std::vector<stride_type>& stride_A_AB,
-              const std::vector<stride_type>& stride_A_AC,
-              const std::vector<stride_type>& stride_A_ABC,
-                       const T* B,
-              const std::vector<stride_type>& stride_B_B,
-              const std::vector<stride_type>& stride_B_AB,
-              const std::vector<stride_type>& stride_B_BC,
-              const std::vector<stride_type>& stride_B_ABC,
-              T  beta,       T* C,
-              const std::vector<stride_type>& stride_C_C,
-              const std::vector<stride_type>& stride_C_AC,
-              const std::vector<stride_type>& stride_C_BC,
-              const std::vector<stride_type>& stride_C_ABC)
+              const len_vector& len_A,
+              const len_vector& len_B,
+              const len_vector& len_C,
+              const len_vector& len_AB,
+              const len_vector& len_AC,
+              const len_vector& len_BC,
+              const len_vector& len_ABC,
+              T alpha, bool conj_A, const TA* A,
+              const stride_vector& stride_A_A,
+              const stride_vector& stride_A_AB,
+              const stride_vector& stride_A_AC,
+              const stride_vector& stride_A_ABC,
+                       bool conj_B, const TB* B,
+              const stride_vector& stride_B_B,
+              const stride_vector& stride_B_AB,
+              const stride_vector& stride_B_BC,
+              const stride_vector& stride_B_ABC,
+              T  beta, bool conj_C,       TC* C,
+              const stride_vector& stride_C_C,
+              const stride_vector& stride_C_AC,
+              const stride_vector& stride_C_BC,
+              const stride_vector& stride_C_ABC)
 {
     (void)cfg;
 
@@ -370,13 +536,13 @@ void mult_ref(const communicator& comm, const config& cfg,
                     T temp_A = T();
                     while (iter_A.next(A))
                     {
-                        temp_A += *A;
+                        temp_A += conj(conj_A, T(*A));
                     }
 
                     T temp_B = T();
                     while (iter_B.next(B))
                     {
-                        temp_B += *B;
+                        temp_B += conj(conj_B, T(*B));
                     }
 
                     temp += temp_A*temp_B;
@@ -388,14 +554,14 @@ void mult_ref(const communicator& comm, const config& cfg,
                 {
                     while (iter_C.next(C))
                     {
-                        *C = temp;
+                        *C = TC(temp);
                     }
                 }
                 else
                 {
                     while (iter_C.next(C))
                     {
-                        *C = temp + beta*(*C);
+                        *C = TC(temp + beta*conj(conj_C, T(*C)));
                     }
                 }
             }
@@ -405,70 +571,66 @@ void mult_ref(const communicator& comm, const config& cfg,
 
 template <typename T>
 void outer_prod_blas(const communicator& comm, const config& cfg,
-                     const std::vector<len_type>& len_AC,
-                     const std::vector<len_type>& len_BC,
+                     const len_vector& len_AC,
+                     const len_vector& len_BC,
                      T alpha, const T* A,
-                     const std::vector<stride_type>& stride_A_AC,
+                     const stride_vector& stride_A_AC,
                               const T* B,
-                     const std::vector<stride_type>& stride_B_BC,
+                     const stride_vector& stride_B_BC,
                      T  beta,       T* C,
-                     const std::vector<stride_type>& stride_C_AC,
-                     const std::vector<stride_type>& stride_C_BC)
+                     const stride_vector& stride_C_AC,
+                     const stride_vector& stride_C_BC)
 {
-    tensor<T> ar, br, cr;
+    MemoryPool::Block ar, br, cr;
     T* ptrs_local[3];
     T** ptrs = &ptrs_local[0];
 
     if (comm.master())
     {
-        ar.reset(len_AC);
-        br.reset(len_BC);
-        cr.reset(len_AC+len_BC);
-        ptrs[0] = ar.data();
-        ptrs[1] = br.data();
-        ptrs[2] = cr.data();
+        ar = BuffersForStaging.allocate<T>(stl_ext::prod(len_AC));
+        br = BuffersForStaging.allocate<T>(stl_ext::prod(len_BC));
+        cr = BuffersForStaging.allocate<T>(stl_ext::prod(len_AC)*stl_ext::prod(len_BC));
+        ptrs[0] = ar.get<T>();
+        ptrs[1] = br.get<T>();
+        ptrs[2] = cr.get<T>();
     }
 
     comm.broadcast(ptrs);
 
-    tensor_view<T> arv(len_AC, ptrs[0]);
-    tensor_view<T> brv(len_BC, ptrs[1]);
-    tensor_view<T> crv(len_AC+len_BC, ptrs[2]);
+    stride_vector stride_AT, stride_BT, stride_CT;
+    auto am = dense_matrix(len_AC, {}, ptrs[0], stride_AT);
+    auto bm = dense_matrix({}, len_BC, ptrs[1], stride_BT);
+    auto cm = dense_matrix(len_AC, len_BC, ptrs[2], stride_CT);
 
-    matrix_view<T> am, bm, cm;
-    matricize<T>(arv, am, static_cast<unsigned>(len_AC.size()));
-    matricize<T>(brv, bm, 0);
-    matricize<T>(crv, cm, static_cast<unsigned>(len_AC.size()));
+    add(comm, cfg, {}, {}, len_AC,
+        T(1), false,         A, {}, stride_A_AC,
+        T(0), false, am.data(), {},   stride_AT);
 
-    add(comm, cfg, {}, {}, arv.lengths(),
-        T(1), false,          A, {},   stride_A_AC,
-        T(0), false, arv.data(), {}, arv.strides());
-
-    add(comm, cfg, {}, {}, brv.lengths(),
-        T(1), false,          B, {},   stride_B_BC,
-        T(0), false, brv.data(), {}, brv.strides());
+    add(comm, cfg, {}, {}, len_BC,
+        T(1), false,         B, {}, stride_B_BC,
+        T(0), false, bm.data(), {},   stride_BT);
 
     mult(comm, cfg, cm.length(0), cm.length(1), am.length(1),
          alpha, false, am.data(), am.stride(0), am.stride(1),
                 false, bm.data(), bm.stride(0), bm.stride(1),
           T(0), false, cm.data(), cm.stride(0), cm.stride(1));
 
-    add(comm, cfg, {}, {}, crv.lengths(),
-        T(1), false, crv.data(), {},            crv.strides(),
-        beta, false,          C, {}, stride_C_AC+stride_C_BC);
+    add(comm, cfg, {}, {}, len_AC+len_BC,
+        T(1), false, cm.data(), {},               stride_CT,
+        beta, false,         C, {}, stride_C_AC+stride_C_BC);
 }
 
 template <typename T>
 void outer_prod_ref(const communicator& comm, const config& cfg,
-                    const std::vector<len_type>& len_AC,
-                    const std::vector<len_type>& len_BC,
+                    const len_vector& len_AC,
+                    const len_vector& len_BC,
                     T alpha, const T* A,
-                    const std::vector<stride_type>& stride_A_AC,
+                    const stride_vector& stride_A_AC,
                              const T* B,
-                    const std::vector<stride_type>& stride_B_BC,
+                    const stride_vector& stride_B_BC,
                     T  beta,       T* C,
-                    const std::vector<stride_type>& stride_C_AC,
-                    const std::vector<stride_type>& stride_C_BC)
+                    const stride_vector& stride_C_AC,
+                    const stride_vector& stride_C_BC)
 {
     (void)cfg;
 
@@ -516,85 +678,151 @@ void outer_prod_ref(const communicator& comm, const config& cfg,
     }
 }
 
+/*
+ * Weighting (and the pure Hadamard product when there are no AC or BC
+ * indices) as an element-wise product over all indices of C, where A has
+ * zero stride along the BC indices and B along the AC indices. The product
+ * is computed directly on the strided data with the mult microkernel along
+ * the unit-stride index of C, and threads are distributed over both that
+ * index and the others.
+ */
+template <typename T>
+void weight_vector(const communicator& comm, const config& cfg,
+                   const len_vector& len_AC,
+                   const len_vector& len_BC,
+                   const len_vector& len_ABC,
+                   T alpha, const T* A,
+                   const stride_vector& stride_A_AC,
+                   const stride_vector& stride_A_ABC,
+                            const T* B,
+                   const stride_vector& stride_B_BC,
+                   const stride_vector& stride_B_ABC,
+                   T  beta,       T* C,
+                   const stride_vector& stride_C_AC,
+                   const stride_vector& stride_C_BC,
+                   const stride_vector& stride_C_ABC)
+{
+    auto len = len_AC + len_BC + len_ABC;
+    auto stride_A = stride_A_AC + stride_vector(len_BC.size()) + stride_A_ABC;
+    auto stride_B = stride_vector(len_AC.size()) + stride_B_BC + stride_B_ABC;
+    auto stride_C = stride_C_AC + stride_C_BC + stride_C_ABC;
+
+    unsigned idx0 = unit_index(len, stride_C);
+
+    len_type len0 = (len.empty() ? 1 : len[idx0]);
+    stride_type stride_A0 = (len.empty() ? 0 : stride_A[idx0]);
+    stride_type stride_B0 = (len.empty() ? 0 : stride_B[idx0]);
+    stride_type stride_C0 = (len.empty() ? 1 : stride_C[idx0]);
+
+    len_vector len1;
+    stride_vector stride_A1, stride_B1, stride_C1;
+    for (unsigned i : detail::sort_by_stride(stride_C))
+    {
+        if (i == idx0) continue;
+        len1.push_back(len[i]);
+        stride_A1.push_back(stride_A[i]);
+        stride_B1.push_back(stride_B[i]);
+        stride_C1.push_back(stride_C[i]);
+    }
+
+    MArray::viterator<3> iter(len1, stride_A1, stride_B1, stride_C1);
+    len_type n = stl_ext::prod(len1);
+
+    len_type m_min, m_max, n_min, n_max;
+    std::tie(m_min, m_max, std::ignore,
+             n_min, n_max, std::ignore) =
+        comm.distribute_over_threads_2d(len0, n);
+
+    iter.position(n_min, A, B, C);
+    A += m_min*stride_A0;
+    B += m_min*stride_B0;
+    C += m_min*stride_C0;
+
+    for (len_type i = n_min;i < n_max;i++)
+    {
+        iter.next(A, B, C);
+        cfg.mult_ukr.call<T>(m_max-m_min,
+                             alpha, false, A, stride_A0,
+                                    false, B, stride_B0,
+                              beta, false, C, stride_C0);
+    }
+}
+
 template <typename T>
 void weight_blas(const communicator& comm, const config& cfg,
-                 const std::vector<len_type>& len_AC,
-                 const std::vector<len_type>& len_BC,
-                 const std::vector<len_type>& len_ABC,
+                 const len_vector& len_AC,
+                 const len_vector& len_BC,
+                 const len_vector& len_ABC,
                  T alpha, const T* A,
-                 const std::vector<stride_type>& stride_A_AC,
-                 const std::vector<stride_type>& stride_A_ABC,
+                 const stride_vector& stride_A_AC,
+                 const stride_vector& stride_A_ABC,
                           const T* B,
-                 const std::vector<stride_type>& stride_B_BC,
-                 const std::vector<stride_type>& stride_B_ABC,
+                 const stride_vector& stride_B_BC,
+                 const stride_vector& stride_B_ABC,
                  T  beta,       T* C,
-                 const std::vector<stride_type>& stride_C_AC,
-                 const std::vector<stride_type>& stride_C_BC,
-                 const std::vector<stride_type>& stride_C_ABC)
+                 const stride_vector& stride_C_AC,
+                 const stride_vector& stride_C_BC,
+                 const stride_vector& stride_C_ABC)
 {
-    tensor<T> ar, br, cr;
+    MemoryPool::Block ar, br, cr;
     T* ptrs_local[3];
     T** ptrs = &ptrs_local[0];
 
     if (comm.master())
     {
-        ar.reset(len_AC);
-        br.reset(len_BC);
-        cr.reset(len_AC+len_BC);
-        ptrs[0] = ar.data();
-        ptrs[1] = br.data();
-        ptrs[2] = cr.data();
+        ar = BuffersForStaging.allocate<T>(stl_ext::prod(len_AC));
+        br = BuffersForStaging.allocate<T>(stl_ext::prod(len_BC));
+        cr = BuffersForStaging.allocate<T>(stl_ext::prod(len_AC)*stl_ext::prod(len_BC));
+        ptrs[0] = ar.get<T>();
+        ptrs[1] = br.get<T>();
+        ptrs[2] = cr.get<T>();
     }
 
     comm.broadcast(ptrs);
 
-    tensor_view<T> arv(len_AC, ptrs[0]);
-    tensor_view<T> brv(len_BC, ptrs[1]);
-    tensor_view<T> crv(len_AC+len_BC, ptrs[2]);
-
-    matrix_view<T> am, bm, cm;
-    matricize<T>(arv, am, static_cast<unsigned>(len_AC.size()));
-    matricize<T>(brv, bm, 0);
-    matricize<T>(crv, cm, static_cast<unsigned>(len_AC.size()));
+    stride_vector stride_AT, stride_BT, stride_CT;
+    auto am = dense_matrix(len_AC, {}, ptrs[0], stride_AT);
+    auto bm = dense_matrix({}, len_BC, ptrs[1], stride_BT);
+    auto cm = dense_matrix(len_AC, len_BC, ptrs[2], stride_CT);
 
     MArray::viterator<3> it(len_ABC, stride_A_ABC, stride_B_ABC, stride_C_ABC);
 
     while (it.next(A, B, C))
     {
-        add(comm, cfg, {}, {}, arv.lengths(),
-            T(1), false,          A, {},   stride_A_AC,
-            T(0), false, arv.data(), {}, arv.strides());
+        add(comm, cfg, {}, {}, len_AC,
+            T(1), false,         A, {}, stride_A_AC,
+            T(0), false, am.data(), {},   stride_AT);
 
-        add(comm, cfg, {}, {}, brv.lengths(),
-            T(1), false,          B, {},   stride_B_BC,
-            T(0), false, brv.data(), {}, brv.strides());
+        add(comm, cfg, {}, {}, len_BC,
+            T(1), false,         B, {}, stride_B_BC,
+            T(0), false, bm.data(), {},   stride_BT);
 
         mult(comm, cfg, cm.length(0), cm.length(1), am.length(1),
              alpha, false, am.data(), am.stride(0), am.stride(1),
                     false, bm.data(), bm.stride(0), bm.stride(1),
               T(0), false, cm.data(), cm.stride(0), cm.stride(1));
 
-        add(comm, cfg, {}, {}, crv.lengths(),
-            T(1), false, crv.data(), {},            crv.strides(),
-            beta, false,          C, {}, stride_C_AC+stride_C_BC);
+        add(comm, cfg, {}, {}, len_AC+len_BC,
+            T(1), false, cm.data(), {},               stride_CT,
+            beta, false,         C, {}, stride_C_AC+stride_C_BC);
     }
 }
 
 template <typename T>
 void weight_ref(const communicator& comm, const config& cfg,
-                const std::vector<len_type>& len_AC,
-                const std::vector<len_type>& len_BC,
-                const std::vector<len_type>& len_ABC,
+                const len_vector& len_AC,
+                const len_vector& len_BC,
+                const len_vector& len_ABC,
                 T alpha, const T* A,
-                const std::vector<stride_type>& stride_A_AC,
-                const std::vector<stride_type>& stride_A_ABC,
+                const stride_vector& stride_A_AC,
+                const stride_vector& stride_A_ABC,
                          const T* B,
-                const std::vector<stride_type>& stride_B_BC,
-                const std::vector<stride_type>& stride_B_ABC,
+                const stride_vector& stride_B_BC,
+                const stride_vector& stride_B_ABC,
                 T  beta,       T* C,
-                const std::vector<stride_type>& stride_C_AC,
-                const std::vector<stride_type>& stride_C_BC,
-                const std::vector<stride_type>& stride_C_ABC)
+                const stride_vector& stride_C_AC,
+                const stride_vector& stride_C_BC,
+                const stride_vector& stride_C_ABC)
 {
     (void)cfg;
 
@@ -632,30 +860,264 @@ void weight_ref(const communicator& comm, const config& cfg,
     }
 }
 
+/*
+ * Add the blocks in other to those in blocks, so that there are enough for
+ * either. A pool only hands out a block for requests of at least
+ * 1/MemoryPool::max_oversize of its size, so two blocks are only merged
+ * into one (of the larger size) when that covers the requests of both.
+ */
+static void merge_blocks(pool_blocks& blocks, pool_blocks other)
+{
+    auto larger = [](const pool_block& x, const pool_block& y)
+    {
+        return x.size > y.size;
+    };
+
+    for (int pool = 0;pool < TBLIS_NUM_POOLS;pool++)
+    {
+        auto& a = blocks[pool];
+        auto& b = other[pool];
+
+        std::sort(a.begin(), a.end(), larger);
+        std::sort(b.begin(), b.end(), larger);
+
+        size_t na = a.size();
+        std::vector<bool> used(na, false);
+
+        for (auto& block : b)
+        {
+            size_t i = 0;
+            for (;i < na;i++)
+            {
+                if (used[i]) continue;
+
+                size_t min_size = std::min(a[i].min_size, block.min_size);
+                size_t size = std::max(a[i].size, block.size);
+                if (size <= min_size*MemoryPool::max_oversize) break;
+            }
+
+            if (i < na)
+            {
+                a[i].min_size = std::min(a[i].min_size, block.min_size);
+                a[i].size = std::max(a[i].size, block.size);
+                used[i] = true;
+            }
+            else
+            {
+                a.push_back(block);
+            }
+        }
+    }
+}
+
+/*
+ * The length of the first (and largest) block along a dimension of length m
+ * for each of ng gangs, following the partitioning in nodes/partm.hpp. Gangs
+ * with nothing to do are left out.
+ */
+template <typename T>
+std::vector<len_type> first_blocks(const blocksize& M, len_type m, int ng)
+{
+    const len_type M_def  = M.def<T>();
+    const len_type M_max  = M.max<T>();
+    const len_type M_iota = M.iota<T>();
+
+    std::vector<len_type> lens;
+
+    for (int g = 0;g < ng;g++)
+    {
+        uint64_t first, last;
+        tci_distribute(ng, g, m, M_iota, &first, &last, nullptr);
+        if (last <= first) continue;
+
+        len_type len = last-first;
+        len_type M_cur = (len%M_def <= M_max-M_def ? M_max : M_def);
+        lens.push_back(std::min(len, M_cur));
+    }
+
+    return lens;
+}
+
+/*
+ * The packing and scatter buffers of one GEMM, following the allocations in
+ * nodes/packm.hpp and nodes/matrify.hpp. The buffers are sized for the
+ * first (and largest) cache block of each gang of threads sharing a block
+ * of B or of A, since each such gang has its own.
+ */
+template <typename T>
+void gemm_blocks(const config& cfg, int nt,
+                 len_type m, len_type n, len_type k, bool tensor,
+                 pool_blocks& blocks)
+{
+    const len_type MR = cfg.gemm_mr.def<T>();
+    const len_type NR = cfg.gemm_nr.def<T>();
+    const len_type KR = cfg.gemm_kr.def<T>();
+    const len_type ME = cfg.gemm_mr.extent<T>();
+    const len_type NE = cfg.gemm_nr.extent<T>();
+
+    pool_blocks gemm;
+
+    /*
+     * Either C or C^T may be computed, depending on the layout of C.
+     */
+    for (int trans = 0;trans < 2;trans++)
+    {
+        auto tc = make_gemm_thread_config<T>(cfg, nt, m, n, k);
+
+        auto m_cs = first_blocks<T>(cfg.gemm_mc, m, tc.ic_nt);
+        auto n_cs = first_blocks<T>(cfg.gemm_nc, n, tc.jc_nt);
+        auto k_cs = first_blocks<T>(cfg.gemm_kc, k, 1);
+        len_type k_c = (k_cs.empty() ? 0 : k_cs[0]);
+
+        auto size_A = [&](len_type m_c) -> size_t
+        {
+            if (tensor)
+            {
+                len_type m_A = round_up(m_c, MR);
+                len_type k_A = round_up(k_c, KR);
+                return sizeof(T)*(m_A*k_A + std::max(m_A,k_A)*TBLIS_MAX_UNROLL +
+                                  size_as_type<stride_type,T>(2*m_A + 2*k_A));
+            }
+
+            len_type m_p = ceil_div(m_c, MR)*ME;
+            return sizeof(T)*(m_p*k_c + std::max(m_p,k_c)*TBLIS_MAX_UNROLL);
+        };
+
+        auto size_B = [&](len_type n_c) -> size_t
+        {
+            if (tensor)
+            {
+                len_type k_B = round_up(k_c, KR);
+                len_type n_B = round_up(n_c, NR);
+                return sizeof(T)*(k_B*n_B + std::max(k_B,n_B)*TBLIS_MAX_UNROLL +
+                                  size_as_type<stride_type,T>(2*k_B + 2*n_B));
+            }
+
+            len_type n_p = ceil_div(n_c, NR)*NE;
+            return sizeof(T)*(n_p*k_c + std::max(n_p,k_c)*TBLIS_MAX_UNROLL);
+        };
+
+        pool_blocks orientation;
+
+        for (len_type n_c : n_cs)
+        {
+            size_t b = size_B(n_c);
+            orientation[TBLIS_POOL_B].push_back({b, b});
+
+            for (len_type m_c : m_cs)
+            {
+                size_t a = size_A(m_c);
+                size_t c = sizeof(stride_type)*(2*m_c + 2*n_c);
+                orientation[TBLIS_POOL_A].push_back({a, a});
+                if (tensor) orientation[TBLIS_POOL_SCATTER].push_back({c, c});
+            }
+        }
+
+        merge_blocks(gemm, orientation);
+
+        std::swap(m, n);
+    }
+
+    for (int pool = 0;pool < TBLIS_NUM_POOLS;pool++)
+        blocks[pool].insert(blocks[pool].end(), gemm[pool].begin(), gemm[pool].end());
+}
+
+template <typename T>
+void mult_blocks(const config& cfg, int nt,
+                 const len_vector& len_A,
+                 const len_vector& len_B,
+                 const len_vector& len_C,
+                 const len_vector& len_AB,
+                 const len_vector& len_AC,
+                 const len_vector& len_BC,
+                 const len_vector& len_ABC,
+                 bool mixed, bool convert_C, pool_blocks& blocks)
+{
+    if (impl == REFERENCE) return;
+
+    len_type m = stl_ext::prod(len_AC);
+    len_type n = stl_ext::prod(len_BC);
+    len_type k = stl_ext::prod(len_AB);
+
+    bool contraction = len_A.empty() && len_B.empty() && len_C.empty();
+
+    pool_blocks call;
+
+    if (mixed)
+    {
+        if (contraction && !len_AB.empty())
+        {
+            if (convert_C && k > cfg.gemm_kc.max<T>())
+                call[TBLIS_POOL_STAGING].push_back({sizeof(T)*m*n, sizeof(T)*m*n});
+            gemm_blocks<T>(cfg, nt, m, n, k, true, call);
+        }
+    }
+    else if (contraction && !len_AB.empty() && len_ABC.empty() && impl == BLIS_BASED)
+    {
+        gemm_blocks<T>(cfg, nt, m, n, k, true, call);
+    }
+    else if (!(contraction && len_AB.empty() && !len_ABC.empty() && impl == BLIS_BASED))
+    {
+        /*
+         * Everything else is done by transposing A, B, and C into
+         * temporaries and calling matrix mult.
+         */
+        for (size_t size : {sizeof(T)*m*k, sizeof(T)*k*n, sizeof(T)*m*n})
+            call[TBLIS_POOL_STAGING].push_back({size, size});
+        gemm_blocks<T>(cfg, nt, m, n, k, false, call);
+    }
+
+    merge_blocks(blocks, call);
+}
+
+size_t workspace_size(const pool_blocks& blocks)
+{
+    MemoryPool* pools[] = {&BuffersForA, &BuffersForB, &BuffersForScatter, &BuffersForStaging};
+
+    size_t size = 0;
+    for (int pool = 0;pool < TBLIS_NUM_POOLS;pool++)
+        for (auto block : blocks[pool])
+            size += Workspace::footprint(block.size, pools[pool]->min_alignment());
+
+    return size;
+}
+
+void warm_up_pools(const communicator& comm, const pool_blocks& blocks)
+{
+    MemoryPool* pools[] = {&BuffersForA, &BuffersForB, &BuffersForScatter, &BuffersForStaging};
+
+    for (int pool = 0;pool < TBLIS_NUM_POOLS;pool++)
+    {
+        std::vector<size_t> sizes;
+        for (auto& block : blocks[pool]) sizes.push_back(block.size);
+        pools[pool]->warm_up(comm, sizes);
+    }
+}
+
 template <typename T>
 void mult(const communicator& comm, const config& cfg,
-          const std::vector<len_type>& len_A,
-          const std::vector<len_type>& len_B,
-          const std::vector<len_type>& len_C,
-          const std::vector<len_type>& len_AB,
-          const std::vector<len_type>& len_AC,
-          const std::vector<len_type>& len_BC,
-          const std::vector<len_type>& len_ABC,
+          const len_vector& len_A,
+          const len_vector& len_B,
+          const len_vector& len_C,
+          const len_vector& len_AB,
+          const len_vector& len_AC,
+          const len_vector& len_BC,
+          const len_vector& len_ABC,
           T alpha, bool conj_A, const T* A,
-          const std::vector<stride_type>& stride_A_A,
-          const std::vector<stride_type>& stride_A_AB,
-          const std::vector<stride_type>& stride_A_AC,
-          const std::vector<stride_type>& stride_A_ABC,
+          const stride_vector& stride_A_A,
+          const stride_vector& stride_A_AB,
+          const stride_vector& stride_A_AC,
+          const stride_vector& stride_A_ABC,
                    bool conj_B, const T* B,
-          const std::vector<stride_type>& stride_B_B,
-          const std::vector<stride_type>& stride_B_AB,
-          const std::vector<stride_type>& stride_B_BC,
-          const std::vector<stride_type>& stride_B_ABC,
+          const stride_vector& stride_B_B,
+          const stride_vector& stride_B_AB,
+          const stride_vector& stride_B_BC,
+          const stride_vector& stride_B_ABC,
           T  beta, bool conj_C,       T* C,
-          const std::vector<stride_type>& stride_C_C,
-          const std::vector<stride_type>& stride_C_AC,
-          const std::vector<stride_type>& stride_C_BC,
-          const std::vector<stride_type>& stride_C_ABC)
+          const stride_vector& stride_C_C,
+          const stride_vector& stride_C_AC,
+          const stride_vector& stride_C_BC,
+          const stride_vector& stride_C_ABC)
 {
     TBLIS_ASSERT(!conj_A && !conj_B && !conj_C);
 
@@ -690,13 +1152,20 @@ void mult(const communicator& comm, const config& cfg,
                                       B, stride_B_BC, stride_B_ABC,
                                 beta, C, stride_C_AC, stride_C_BC, stride_C_ABC);
                 }
-                else
+                else if (impl == BLAS_BASED)
                 {
                     weight_blas(comm, cfg, len_AC, len_BC, len_ABC,
                                 alpha, A, stride_A_AC, stride_A_ABC,
                                        B, stride_B_BC, stride_B_ABC,
                                  beta, C, stride_C_AC, stride_C_BC, stride_C_ABC);
                 }
+                else
+                {
+                    weight_vector(comm, cfg, len_AC, len_BC, len_ABC,
+                                  alpha, A, stride_A_AC, stride_A_ABC,
+                                         B, stride_B_BC, stride_B_ABC,
+                                   beta, C, stride_C_AC, stride_C_BC, stride_C_ABC);
+                }
             }
         }
         else
@@ -718,9 +1187,9 @@ void mult(const communicator& comm, const config& cfg,
             else
             {
                 contract_blis(comm, cfg, len_AB, len_AC, len_BC,
-                              alpha, A, stride_A_AB, stride_A_AC,
-                                     B, stride_B_AB, stride_B_BC,
-                               beta, C, stride_C_AC, stride_C_BC);
+                              alpha, conj_A, A, stride_A_AB, stride_A_AC,
+                                     conj_B, B, stride_B_AB, stride_B_BC,
+                               beta, conj_C, C, stride_C_AC, stride_C_BC);
             }
         }
     }
@@ -730,12 +1199,12 @@ void mult(const communicator& comm, const config& cfg,
         {
             mult_ref(comm, cfg, len_A, len_B, len_C,
                      len_AB, len_AC, len_BC, len_ABC,
-                     alpha, A, stride_A_A, stride_A_AB,
-                               stride_A_AC, stride_A_ABC,
-                            B, stride_B_B, stride_B_AB,
-                               stride_B_BC, stride_B_ABC,
-                      beta, C, stride_C_C, stride_C_AC,
-                               stride_C_BC, stride_C_ABC);
+                     alpha, conj_A, A, stride_A_A, stride_A_AB,
+                                       stride_A_AC, stride_A_ABC,
+                            conj_B, B, stride_B_B, stride_B_AB,
+                                       stride_B_BC, stride_B_ABC,
+                      beta, conj_C, C, stride_C_C, stride_C_AC,
+                                       stride_C_BC, stride_C_ABC);
         }
         else
         {
@@ -753,30 +1222,139 @@ void mult(const communicator& comm, const config& cfg,
     comm.barrier();
 }
 
+template <typename T, typename TA, typename TB, typename TC>
+void mult_mixed(const communicator& comm, const config& cfg,
+                const len_vector& len_A,
+                const len_vector& len_B,
+                const len_vector& len_C,
+                const len_vector& len_AB,
+                const len_vector& len_AC,
+                const len_vector& len_BC,
+                const len_vector& len_ABC,
+                T alpha, bool conj_A, const TA* A,
+                const stride_vector& stride_A_A,
+                const stride_vector& stride_A_AB,
+                const stride_vector& stride_A_AC,
+                const stride_vector& stride_A_ABC,
+                         bool conj_B, const TB* B,
+                const stride_vector& stride_B_B,
+                const stride_vector& stride_B_AB,
+                const stride_vector& stride_B_BC,
+                const stride_vector& stride_B_ABC,
+                T  beta, bool conj_C,       TC* C,
+                const stride_vector& stride_C_C,
+                const stride_vector& stride_C_AC,
+                const stride_vector& stride_C_BC,
+                const stride_vector& stride_C_ABC)
+{
+    /*
+     * Only contractions (possibly batched over the ABC indices) go through
+     * the converting GEMM, everything else uses the reference algorithm.
+     */
+    if (impl != REFERENCE && !len_AB.empty() &&
+        len_A.empty() && len_B.empty() && len_C.empty())
+    {
+        MArray::viterator<3> it(len_ABC, stride_A_ABC, stride_B_ABC, stride_C_ABC);
+
+        while (it.next(A, B, C))
+        {
+            contract_blis(comm, cfg, len_AB, len_AC, len_BC,
+                          alpha, conj_A, A, stride_A_AB, stride_A_AC,
+                                 conj_B, B, stride_B_AB, stride_B_BC,
+                           beta, conj_C, C, stride_C_AC, stride_C_BC);
+        }
+    }
+    else
+    {
+        mult_ref(comm, cfg, len_A, len_B, len_C,
+                 len_AB, len_AC, len_BC, len_ABC,
+                 alpha, conj_A, A, stride_A_A, stride_A_AB,
+                                   stride_A_AC, stride_A_ABC,
+                        conj_B, B, stride_B_B, stride_B_AB,
+                                   stride_B_BC, stride_B_ABC,
+                  beta, conj_C, C, stride_C_C, stride_C_AC,
+                                   stride_C_BC, stride_C_ABC);
+    }
+
+    comm.barrier();
+}
+
+#define INSTANTIATE_MULT_MIXED(T, TA, TB, TC) \
+template void mult_mixed(const communicator& comm, const config& cfg, \
+                         const len_vector& len_A, \
+                         const len_vector& len_B, \
+                         const len_vector& len_C, \
+                         const len_vector& len_AB, \
+                         const len_vector& len_AC, \
+                         const len_vector& len_BC, \
+                         const len_vector& len_ABC, \
+                         T alpha, bool conj_A, const TA* A, \
+                         const stride_vector& stride_A_A, \
+                         const stride_vector& stride_A_AB, \
+                         const stride_vector& stride_A_AC, \
+                         const stride_vector& stride_A_ABC, \
+                                  bool conj_B, const TB* B, \
+                         const stride_vector& stride_B_B, \
+                         const stride_vector& stride_B_AB, \
+                         const stride_vector& stride_B_BC, \
+                         const stride_vector& stride_B_ABC, \
+                         T  beta, bool conj_C,       TC* C, \
+                         const stride_vector& stride_C_C, \
+                         const stride_vector& stride_C_AC, \
+                         const stride_vector& stride_C_BC, \
+                         const stride_vector& stride_C_ABC);
+
+INSTANTIATE_MULT_MIXED( int32_t,         int8_t,         int8_t,        int32_t);
+INSTANTIATE_MULT_MIXED( int32_t,        int16_t,        int16_t,        int32_t);
+INSTANTIATE_MULT_MIXED( int32_t,        int32_t,        int32_t,        int32_t);
+INSTANTIATE_MULT_MIXED(   float,     tblis_half,     tblis_half,     tblis_half);
+INSTANTIATE_MULT_MIXED(   float, tblis_bfloat16, tblis_bfloat16, tblis_bfloat16);
+INSTANTIATE_MULT_MIXED(  double,          float,          float,         double);
+INSTANTIATE_MULT_MIXED(  double,         double,         double,          float);
+INSTANTIATE_MULT_MIXED(dcomplex,       scomplex,       scomplex,       dcomplex);
+INSTANTIATE_MULT_MIXED(dcomplex,       dcomplex,       dcomplex,       scomplex);
+
+#define INSTANTIATE_MULT_BLOCKS(T) \
+template void mult_blocks<T>(const config& cfg, int nt, \
+                             const len_vector& len_A, \
+                             const len_vector& len_B, \
+                             const len_vector& len_C, \
+                             const len_vector& len_AB, \
+                             const len_vector& len_AC, \
+                             const len_vector& len_BC, \
+                             const len_vector& len_ABC, \
+                             bool mixed, bool convert_C, pool_blocks& blocks);
+
+INSTANTIATE_MULT_BLOCKS( int32_t);
+INSTANTIATE_MULT_BLOCKS(   float);
+INSTANTIATE_MULT_BLOCKS(  double);
+INSTANTIATE_MULT_BLOCKS(scomplex);
+INSTANTIATE_MULT_BLOCKS(dcomplex);
+
 #define FOREACH_TYPE(T) \
 template void mult(const communicator& comm, const config& cfg, \
-                   const std::vector<len_type>& len_A, \
-                   const std::vector<len_type>& len_B, \
-                   const std::vector<len_type>& len_C, \
-                   const std::vector<len_type>& len_AB, \
-                   const std::vector<len_type>& len_AC, \
-                   const std::vector<len_type>& len_BC, \
-                   const std::vector<len_type>& len_ABC, \
+                   const len_vector& len_A, \
+                   const len_vector& len_B, \
+                   const len_vector& len_C, \
+                   const len_vector& len_AB, \
+                   const len_vector& len_AC, \
+                   const len_vector& len_BC, \
+                   const len_vector& len_ABC, \
                    T alpha, bool conj_A, const T* A, \
-                   const std::vector<stride_type>& stride_A_A, \
-                   const std::vector<stride_type>& stride_A_AB, \
-                   const std::vector<stride_type>& stride_A_AC, \
-                   const std::vector<stride_type>& stride_A_ABC, \
+                   const stride_vector& stride_A_A, \
+                   const stride_vector& stride_A_AB, \
+                   const stride_vector& stride_A_AC, \
+                   const stride_vector& stride_A_ABC, \
                             bool conj_B, const T* B, \
-                   const std::vector<stride_type>& stride_B_B, \
-                   const std::vector<stride_type>& stride_B_AB, \
-                   const std::vector<stride_type>& stride_B_BC, \
-                   const std::vector<stride_type>& stride_B_ABC, \
+                   const stride_vector& stride_B_B, \
+                   const stride_vector& stride_B_AB, \
+                   const stride_vector& stride_B_BC, \
+                   const stride_vector& stride_B_ABC, \
                    T  beta, bool conj_C,       T* C, \
-                   const std::vector<stride_type>& stride_C_C, \
-                   const std::vector<stride_type>& stride_C_AC, \
-                   const std::vector<stride_type>& stride_C_BC, \
-                   const std::vector<stride_type>& stride_C_ABC);
+                   const stride_vector& stride_C_C, \
+                   const stride_vector& stride_C_AC, \
+                   const stride_vector& stride_C_BC, \
+                   const stride_vector& stride_C_ABC);
 #include "configs/foreach_type.h"
 
 }
@@ -5,6 +5,10 @@
 #include "util/basic_types.h"
 #include "configs/configs.hpp"
 
+#include "memory/memory_pools.h"
+
+#include <array>
+
 namespace tblis
 {
 namespace internal
@@ -15,28 +19,101 @@ extern impl_t impl;
 
 template <typename T>
 void mult(const communicator& comm, const config& cfg,
-          const std::vector<len_type>& len_A,
-          const std::vector<len_type>& len_B,
-          const std::vector<len_type>& len_C,
-          const std::vector<len_type>& len_AB,
-          const std::vector<len_type>& len_AC,
-          const std::vector<len_type>& len_BC,
-          const std::vector<len_type>& len_ABC,
+          const len_vector& len_A,
+          const len_vector& len_B,
+          const len_vector& len_C,
+          const len_vector& len_AB,
+          const len_vector& len_AC,
+          const len_vector& len_BC,
+          const len_vector& len_ABC,
           T alpha, bool conj_A, const T* A,
-          const std::vector<stride_type>& stride_A_A,
-          const std::vector<stride_type>& stride_A_AB,
-          const std::vector<stride_type>& stride_A_AC,
-          const std::vector<stride_type>& stride_A_ABC,
+          const stride_vector& stride_A_A,
+          const stride_vector& stride_A_AB,
+          const stride_vector& stride_A_AC,
+          const stride_vector& stride_A_ABC,
                    bool conj_B, const T* B,
-          const std::vector<stride_type>& stride_B_B,
-          const std::vector<stride_type>& stride_B_AB,
-          const std::vector<stride_type>& stride_B_BC,
-          const std::vector<stride_type>& stride_B_ABC,
+          const stride_vector& stride_B_B,
+          const stride_vector& stride_B_AB,
+          const stride_vector& stride_B_BC,
+          const stride_vector& stride_B_ABC,
           T  beta, bool conj_C,       T* C,
-          const std::vector<stride_type>& stride_C_C,
-          const std::vector<stride_type>& stride_C_AC,
-          const std::vector<stride_type>& stride_C_BC,
-          const std::vector<stride_type>& stride_C_ABC);
+          const stride_vector& stride_C_C,
+          const stride_vector& stride_C_AC,
+          const stride_vector& stride_C_BC,
+          const stride_vector& stride_C_ABC);
+
+/*
+ * Like mult, but A, B, and C may each be stored in a type other than the
+ * compute type T. Integer tensors (int8_t, int16_t, int32_t) use int32_t.
+ */
+template <typename T, typename TA, typename TB, typename TC>
+void mult_mixed(const communicator& comm, const config& cfg,
+                const len_vector& len_A,
+                const len_vector& len_B,
+                const len_vector& len_C,
+                const len_vector& len_AB,
+                const len_vector& len_AC,
+                const len_vector& len_BC,
+                const len_vector& len_ABC,
+                T alpha, bool conj_A, const TA* A,
+                const stride_vector& stride_A_A,
+                const stride_vector& stride_A_AB,
+                const stride_vector& stride_A_AC,
+                const stride_vector& stride_A_ABC,
+                         bool conj_B, const TB* B,
+                const stride_vector& stride_B_B,
+                const stride_vector& stride_B_AB,
+                const stride_vector& stride_B_BC,
+                const stride_vector& stride_B_ABC,
+                T  beta, bool conj_C,       TC* C,
+                const stride_vector& stride_C_C,
+                const stride_vector& stride_C_AC,
+                const stride_vector& stride_C_BC,
+                const stride_vector& stride_C_ABC);
+
+/*
+ * A block which holds size bytes, and is used for requests of at least
+ * min_size bytes.
+ */
+struct pool_block
+{
+    size_t min_size;
+    size_t size;
+};
+
+/*
+ * The blocks which a call to mult (or mult_mixed, if mixed is true) takes
+ * from each memory pool at once, indexed by tblis_memory_pool.
+ */
+typedef std::array<std::vector<pool_block>,TBLIS_NUM_POOLS> pool_blocks;
+
+/*
+ * Add the blocks used by mult for the given lengths and number of threads
+ * to blocks, so that there are enough for this call or any of those already
+ * counted. If mixed is true, convert_C says whether C is stored in a type
+ * other than T.
+ */
+template <typename T>
+void mult_blocks(const config& cfg, int nt,
+                 const len_vector& len_A,
+                 const len_vector& len_B,
+                 const len_vector& len_C,
+                 const len_vector& len_AB,
+                 const len_vector& len_AC,
+                 const len_vector& len_BC,
+                 const len_vector& len_ABC,
+                 bool mixed, bool convert_C, pool_blocks& blocks);
+
+/*
+ * The most workspace (see memory/workspace.hpp) needed to hold the blocks.
+ */
+size_t workspace_size(const pool_blocks& blocks);
+
+/*
+ * Make sure that the blocks are free in the memory pools, allocating and
+ * pre-faulting any which are not on the threads of comm.
+ */
+void warm_up_pools(const communicator& comm, const pool_blocks& blocks);
 
 }
 }
@@ -32,8 +32,8 @@ void trans_add_ukr_def(len_type m, len_type n,
          {
             for (len_type j = 0;j < n;j++)
             {
-                B[j*rs_B + i*cs_B] = alpha*conj(conj_A, A[i*rs_A + j*cs_A]) +
-                                      beta*conj(conj_B, B[j*rs_B + i*cs_B]);
+                B[i*rs_B + j*cs_B] = alpha*conj(conj_A, A[i*rs_A + j*cs_A]) +
+                                      beta*conj(conj_B, B[i*rs_B + j*cs_B]);
             }
         }
     }
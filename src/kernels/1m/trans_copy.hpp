@@ -30,7 +30,7 @@ void trans_copy_ukr_def(len_type m, len_type n,
          {
             for (len_type j = 0;j < n;j++)
             {
-                B[j*rs_B + i*cs_B] = alpha*conj(conj_A, A[i*rs_A + j*cs_A]);
+                B[i*rs_B + j*cs_B] = alpha*conj(conj_A, A[i*rs_A + j*cs_A]);
             }
         }
     }
@@ -5,6 +5,8 @@
 #include "util/basic_types.h"
 #include "util/macros.h"
 
+#include "reduce.hpp"
+
 namespace tblis
 {
 
@@ -28,8 +30,10 @@ void dot_ukr_def(len_type n,
     TBLIS_SPECIAL_CASE(is_complex<T>::value && conj_B,
     TBLIS_SPECIAL_CASE(inc_A == 1 && inc_B == 1,
     {
-        for (len_type i = 0;i < n;i++)
-            value += A[i*inc_A] * (conj_B ? conj(B[i*inc_B]) : B[i*inc_B]);
+        detail::accumulate(n, value, [&](len_type i)
+        {
+            return A[i*inc_A] * (conj_B ? conj(B[i*inc_B]) : B[i*inc_B]);
+        });
     }
     ))
 
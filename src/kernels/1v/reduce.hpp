@@ -8,6 +8,35 @@
 namespace tblis
 {
 
+namespace detail
+{
+
+/*
+ * Add f(0) + ... + f(n-1) to value using several independent accumulators
+ * which are combined pairwise at the end. The loop vectorizes without
+ * reassociating floating-point math, and the result depends only on n and
+ * the values, not on the alignment of the data.
+ */
+template <typename T, typename Func>
+void accumulate(len_type n, T& value, Func f)
+{
+    constexpr len_type NA = 8;
+
+    T sum[NA] = {};
+
+    len_type i = 0;
+    for (;i <= n-NA;i += NA)
+        for (len_type k = 0;k < NA;k++) sum[k] += f(i+k);
+    for (len_type k = 0;i+k < n;k++) sum[k] += f(i+k);
+
+    for (len_type s = NA/2;s > 0;s /= 2)
+        for (len_type k = 0;k < s;k++) sum[k] += sum[k+s];
+
+    value += sum[0];
+}
+
+}
+
 template <typename T>
 using reduce_ukr_t =
     void (*)(reduce_t op, len_type n,
@@ -21,14 +50,14 @@ void reduce_ukr_def(reduce_t op, len_type n,
     {
         TBLIS_SPECIAL_CASE(inc_A == 1,
         {
-            for (len_type i = 0;i < n;i++) value += A[i*inc_A];
+            detail::accumulate(n, value, [&](len_type i) { return A[i*inc_A]; });
         })
     }
     else if (op == REDUCE_SUM_ABS)
     {
         TBLIS_SPECIAL_CASE(inc_A == 1,
         {
-            for (len_type i = 0;i < n;i++) value += std::abs(A[i*inc_A]);
+            detail::accumulate(n, value, [&](len_type i) { return T(std::abs(A[i*inc_A])); });
         })
     }
     else if (op == REDUCE_MAX)
@@ -91,7 +120,7 @@ void reduce_ukr_def(reduce_t op, len_type n,
     {
         TBLIS_SPECIAL_CASE(inc_A == 1,
         {
-            for (len_type i = 0;i < n;i++) value += norm2(A[i*inc_A]);
+            detail::accumulate(n, value, [&](len_type i) { return T(norm2(A[i*inc_A])); });
         })
     }
 }
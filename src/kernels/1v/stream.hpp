@@ -0,0 +1,151 @@
+#ifndef _TBLIS_KERNELS_1V_STREAM_HPP_
+#define _TBLIS_KERNELS_1V_STREAM_HPP_
+
+#include "util/basic_types.h"
+#include "util/cpuid.hpp"
+#include "util/macros.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+#include <string>
+
+#include "util/env.hpp"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace tblis
+{
+
+/*
+ * Outputs which are at least this many bytes are written with non-temporal
+ * stores: they cannot stay in the last-level cache anyway, so the
+ * read-for-ownership traffic and the eviction of useful lines are wasted.
+ * Defaults to the LLC size and may be overridden with
+ * TBLIS_STREAM_THRESHOLD (in bytes, 0 to disable).
+ */
+inline stride_type stream_threshold()
+{
+    static stride_type threshold = []
+    {
+        long llc = get_llc_size();
+        long value = envtol("TBLIS_STREAM_THRESHOLD",
+                            llc > 0 ? llc : 32*1024*1024);
+        return value > 0 ? stride_type(value) :
+                           std::numeric_limits<stride_type>::max();
+    }();
+
+    return threshold;
+}
+
+template <typename T>
+bool use_stream_stores(stride_type n)
+{
+    return n*stride_type(sizeof(T)) >= stream_threshold();
+}
+
+/*
+ * Write B[i] = value(i) for 0 <= i < n with non-temporal stores where the
+ * target supports them. The stores are weakly ordered; call stream_fence()
+ * before handing B to another thread.
+ */
+template <typename T, typename Func>
+void stream_fill(len_type n, T* TBLIS_RESTRICT B, Func value)
+{
+    len_type i = 0;
+
+    #if defined(__SSE2__)
+
+    /*
+     * Write a full cache line per iteration so that the write-combining
+     * buffers are flushed as complete lines.
+     */
+    static_assert(16 % sizeof(T) == 0, "Unsupported type size");
+    constexpr len_type VL = 16/sizeof(T);
+    constexpr len_type LL = 64/sizeof(T);
+
+    for (;i < n && (reinterpret_cast<uintptr_t>(B+i) & 63);i++)
+        B[i] = value(i);
+
+    if ((reinterpret_cast<uintptr_t>(B+i) & 63) == 0)
+    {
+        for (;i <= n-LL;i += LL)
+        {
+            T tmp[LL];
+            for (len_type k = 0;k < LL;k++) tmp[k] = value(i+k);
+
+            for (len_type k = 0;k < LL;k += VL)
+            {
+                __m128i v;
+                memcpy(&v, tmp+k, sizeof(v));
+                _mm_stream_si128(reinterpret_cast<__m128i*>(B+i+k), v);
+            }
+        }
+    }
+
+    #endif
+
+    for (;i < n;i++) B[i] = value(i);
+}
+
+inline void stream_fence()
+{
+    #if defined(__SSE2__)
+    _mm_sfence();
+    #endif
+}
+
+template <typename T>
+void stream_set(len_type n, T alpha, T* A)
+{
+    stream_fill(n, A, [&](len_type) { return alpha; });
+}
+
+template <typename T>
+void stream_copy(len_type n, T alpha, bool conj_A, const T* TBLIS_RESTRICT A,
+                 stride_type inc_A, T* TBLIS_RESTRICT B)
+{
+    if (conj_A)
+        stream_fill(n, B, [&](len_type i) { return alpha*conj(A[i*inc_A]); });
+    else if (inc_A != 1)
+        stream_fill(n, B, [&](len_type i) { return alpha*A[i*inc_A]; });
+    else if (alpha == T(1))
+        stream_fill(n, B, [&](len_type i) { return A[i]; });
+    else
+        stream_fill(n, B, [&](len_type i) { return alpha*A[i]; });
+}
+
+/*
+ * Non-temporal version of trans_copy_ukr, for a B with either rs_B == 1 or
+ * cs_B == 1. B is written in segments of 512 bytes along its unit-stride
+ * dimension so that the lines of A being read stay in cache.
+ */
+template <typename T>
+void stream_trans_copy(len_type m, len_type n,
+                       T alpha, bool conj_A, const T* TBLIS_RESTRICT A,
+                       stride_type rs_A, stride_type cs_A,
+                       T* TBLIS_RESTRICT B, stride_type rs_B, stride_type cs_B)
+{
+    if (rs_B != 1)
+    {
+        std::swap(m, n);
+        std::swap(rs_A, cs_A);
+        std::swap(rs_B, cs_B);
+    }
+
+    constexpr len_type BS = 512/sizeof(T);
+
+    for (len_type i = 0;i < m;i += BS)
+    {
+        len_type m_loc = std::min(m-i, BS);
+        for (len_type j = 0;j < n;j++)
+            stream_copy(m_loc, alpha, conj_A, A + i*rs_A + j*cs_A, rs_A,
+                                              B + i + j*cs_B);
+    }
+}
+
+}
+
+#endif
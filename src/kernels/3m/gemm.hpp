@@ -23,6 +23,30 @@ void (*)(stride_type k,
         const T* beta,
         T* c, stride_type rs_c, stride_type cs_c);
 
+/*
+ * Integer GEMM micro-kernel for int8_t and int16_t operands. The panels are
+ * packed as int16_t with pairs of consecutive k interleaved, i.e. element
+ * (i,p) of an A panel is at a[2*ME*(p/2) + 2*i + p%2], so that each pair
+ * multiplies into one int32_t lane (vpmaddwd and the like). k is always even
+ * and the packing pads odd k with zeros. The result is accumulated in
+ * int32_t, as is C.
+ */
+
+#define EXTERN_GEMM_I16_UKR(name) \
+extern void name(tblis::stride_type k, \
+                 const int32_t* alpha, \
+                 const int16_t* a, const int16_t* b, \
+                 const int32_t* beta, \
+                 int32_t* c, tblis::stride_type rs_c, \
+                             tblis::stride_type cs_c);
+
+using gemm_i16_ukr_t =
+void (*)(stride_type k,
+         const int32_t* alpha,
+         const int16_t* a, const int16_t* b,
+         const int32_t* beta,
+         int32_t* c, stride_type rs_c, stride_type cs_c);
+
 template <typename Config, typename T>
 void gemm_ukr_def(stride_type k,
                   const T* TBLIS_RESTRICT alpha,
@@ -28,6 +28,7 @@ class block_scatter_matrix
         std::array<scatter_type, 2> block_scatter_;
         std::array<scatter_type, 2> scatter_;
         std::array<len_type, 2> block_size_;
+        bool conj_;
 
     public:
         block_scatter_matrix()
@@ -55,6 +56,7 @@ class block_scatter_matrix
             block_scatter_[1] = nullptr;
             scatter_[0] = nullptr;
             scatter_[1] = nullptr;
+            conj_ = false;
         }
 
         void reset(const block_scatter_matrix& other)
@@ -66,6 +68,7 @@ class block_scatter_matrix
             block_scatter_[1] = other.block_scatter_[1];
             scatter_[0] = other.scatter_[0];
             scatter_[1] = other.scatter_[1];
+            conj_ = other.conj_;
         }
 
         void reset(len_type m, len_type n, pointer p,
@@ -81,6 +84,7 @@ class block_scatter_matrix
             scatter_[1] = cscat;
             block_size_[0] = MB;
             block_size_[1] = NB;
+            conj_ = false;
 
             for (len_type i = 0;i < m;i += MB)
             {
@@ -128,6 +132,17 @@ class block_scatter_matrix
             return *block_scatter_[dim];
         }
 
+        bool conj() const
+        {
+            return conj_;
+        }
+
+        bool conj(bool c)
+        {
+            std::swap(c, conj_);
+            return c;
+        }
+
         scatter_type scatter(unsigned dim) const
         {
             TBLIS_ASSERT(dim < 2);
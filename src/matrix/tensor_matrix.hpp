@@ -25,6 +25,7 @@ class tensor_matrix
         std::array<len_type, 2> leading_len_;
         std::array<stride_type, 2> leading_stride_;
         std::array<MArray::viterator<>, 2> iterator_;
+        bool conj_;
 
     public:
         tensor_matrix()
@@ -50,12 +51,12 @@ class tensor_matrix
             reset(std::move(other), row_inds, col_inds);
         }
 
-        template <typename U, typename V, typename W, typename X>
-        tensor_matrix(const std::vector<U>& len_m,
-                      const std::vector<V>& len_n,
+        template <typename LenM, typename LenN, typename StrideM, typename StrideN>
+        tensor_matrix(const LenM& len_m,
+                      const LenN& len_n,
                       pointer ptr,
-                      const std::vector<W>& stride_m,
-                      const std::vector<X>& stride_n)
+                      const StrideM& stride_m,
+                      const StrideN& stride_n)
         {
             reset(len_m, len_n, ptr, stride_m, stride_n);
         }
@@ -75,6 +76,7 @@ class tensor_matrix
             leading_stride_[1] = 0;
             iterator_[0] = MArray::viterator<>();
             iterator_[1] = MArray::viterator<>();
+            conj_ = false;
         }
 
         void reset(const tensor_matrix& other)
@@ -90,6 +92,7 @@ class tensor_matrix
             leading_stride_[1] = other.leading_stride_[1];
             iterator_[0] = other.iterator_[0];
             iterator_[1] = other.iterator_[1];
+            conj_ = other.conj_;
         }
 
         void reset(tensor_matrix&& other)
@@ -105,6 +108,7 @@ class tensor_matrix
             leading_stride_[1] = other.leading_stride_[1];
             iterator_[0] = std::move(other.iterator_[0]);
             iterator_[1] = std::move(other.iterator_[1]);
+            conj_ = other.conj_;
         }
 
         template <typename U, typename V>
@@ -112,10 +116,10 @@ class tensor_matrix
                    const std::vector<U>& row_inds,
                    const std::vector<V>& col_inds)
         {
-            std::vector<len_type> len_m(row_inds.size());
-            std::vector<len_type> len_n(col_inds.size());
-            std::vector<stride_type> stride_m(row_inds.size());
-            std::vector<stride_type> stride_n(col_inds.size());
+            len_vector len_m(row_inds.size());
+            len_vector len_n(col_inds.size());
+            stride_vector stride_m(row_inds.size());
+            stride_vector stride_n(col_inds.size());
 
             for (size_t i = 0;i < row_inds.size();i++)
             {
@@ -132,12 +136,12 @@ class tensor_matrix
             reset(len_m, len_n, other.data(), stride_m, stride_n);
         }
 
-        template <typename U, typename V, typename W, typename X>
-        void reset(const std::vector<U>& len_m,
-                   const std::vector<V>& len_n,
+        template <typename LenM, typename LenN, typename StrideM, typename StrideN>
+        void reset(const LenM& len_m,
+                   const LenN& len_n,
                    pointer ptr,
-                   const std::vector<W>& stride_m,
-                   const std::vector<X>& stride_n)
+                   const StrideM& stride_m,
+                   const StrideN& stride_n)
         {
             TBLIS_ASSERT(len_m.size() == stride_m.size());
             TBLIS_ASSERT(len_n.size() == stride_n.size());
@@ -149,9 +153,10 @@ class tensor_matrix
             leading_stride_[1] = (stride_n.empty() ? 1 : stride_n[0]);
             offset_[0] = 0;
             offset_[1] = 0;
+            conj_ = false;
 
-            std::vector<len_type> len_m_, len_n_;
-            std::vector<stride_type> stride_m_, stride_n_;
+            len_vector len_m_, len_n_;
+            stride_vector stride_m_, stride_n_;
             if (!len_m.empty()) len_m_.assign(len_m.begin()+1, len_m.end());
             if (!len_n.empty()) len_n_.assign(len_n.begin()+1, len_n.end());
             if (!stride_m.empty()) stride_m_.assign(stride_m.begin()+1, stride_m.end());
@@ -183,6 +188,7 @@ class tensor_matrix
             swap(leading_len_, other.leading_len_);
             swap(leading_stride_, other.leading_stride_);
             swap(iterator_, other.iterator_);
+            swap(conj_, other.conj_);
         }
 
         friend void swap(tensor_matrix& a, tensor_matrix& b)
@@ -209,6 +215,17 @@ class tensor_matrix
             return leading_stride_[dim];
         }
 
+        bool conj() const
+        {
+            return conj_;
+        }
+
+        bool conj(bool c)
+        {
+            std::swap(c, conj_);
+            return c;
+        }
+
         void shift(unsigned dim, len_type n)
         {
             TBLIS_ASSERT(dim < 2);
@@ -4,6 +4,9 @@
 #include <cstdlib>
 #include <new>
 
+#include "huge_pages.hpp"
+#include "numa_policy.h"
+
 #if TBLIS_HAVE_HBWMALLOC_H
 #include <hbwmalloc.h>
 #endif
@@ -28,21 +31,39 @@ template <typename T, size_t N=8> struct aligned_allocator
         if (n == 0) return nullptr;
 
         void* ptr;
+
+        if (use_huge_pages(n*sizeof(T)))
+        {
+            ptr = huge_page_alloc(n*sizeof(T));
+            if (!ptr) throw std::bad_alloc();
+        }
+        else
+        {
 #if TBLIS_HAVE_HBWMALLOC_H
-        int ret = hbw_posix_memalign(&ptr, N, n*sizeof(T));
+            int ret = hbw_posix_memalign(&ptr, N, n*sizeof(T));
+            if (ret != 0) throw std::bad_alloc();
+            return static_cast<T*>(ptr);
 #else
-        int ret = posix_memalign(&ptr, N, n*sizeof(T));
+            int ret = posix_memalign(&ptr, N, n*sizeof(T));
+            if (ret != 0) throw std::bad_alloc();
 #endif
-        if (ret != 0) throw std::bad_alloc();
+        }
+
+        if (n*sizeof(T) >= huge_page_size) numa_place(ptr, n, sizeof(T));
+
         return static_cast<T*>(ptr);
     }
 
     void deallocate(T* ptr, size_t n)
     {
-        (void)n;
-
         if (!ptr) return;
 
+        if (use_huge_pages(n*sizeof(T)))
+        {
+            huge_page_free(ptr, n*sizeof(T));
+            return;
+        }
+
 #if TBLIS_HAVE_HBWMALLOC_H
         hbw_free(ptr);
 #else
@@ -0,0 +1,120 @@
+#ifndef _TBLIS_HUGE_PAGES_HPP_
+#define _TBLIS_HUGE_PAGES_HPP_
+
+#include <cstdint>
+#include <cstdlib>
+
+#if TBLIS_HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#endif
+
+namespace tblis
+{
+
+enum huge_page_mode_t
+{
+    HUGE_PAGES_NONE    = 0,
+    HUGE_PAGES_MADVISE = 1,
+    HUGE_PAGES_HUGETLB = 2
+};
+
+constexpr size_t huge_page_size = 2*1024*1024;
+
+/*
+ * Large packing buffers and tensors may be backed by 2 MiB pages, which
+ * cuts the TLB misses incurred when streaming through them. The mode is
+ * taken from TBLIS_HUGE_PAGES when first needed and is fixed afterwards:
+ *
+ *  0: ordinary allocations (the default)
+ *  1: transparent huge pages, requested with madvise(MADV_HUGEPAGE)
+ *  2: explicit huge pages from mmap(MAP_HUGETLB), falling back to
+ *     transparent huge pages if none are reserved
+ *
+ * Only allocations of at least one huge page are affected.
+ */
+inline huge_page_mode_t huge_page_mode()
+{
+    static huge_page_mode_t mode = []
+    {
+        #if TBLIS_HAVE_SYS_MMAN_H
+        const char* str = getenv("TBLIS_HUGE_PAGES");
+        long value = str ? strtol(str, nullptr, 10) : 0;
+        if (value >= HUGE_PAGES_HUGETLB) return HUGE_PAGES_HUGETLB;
+        if (value == HUGE_PAGES_MADVISE) return HUGE_PAGES_MADVISE;
+        #endif
+        return HUGE_PAGES_NONE;
+    }();
+
+    return mode;
+}
+
+inline bool use_huge_pages(size_t size)
+{
+    return huge_page_mode() != HUGE_PAGES_NONE && size >= huge_page_size;
+}
+
+/*
+ * Map size bytes aligned to a huge page with the given mode, which must not
+ * be HUGE_PAGES_NONE. Returns nullptr on failure. The memory must be
+ * released with huge_page_free.
+ */
+inline void* huge_page_alloc(size_t size, huge_page_mode_t mode=huge_page_mode())
+{
+    #if TBLIS_HAVE_SYS_MMAN_H
+
+    size = (size+huge_page_size-1)/huge_page_size*huge_page_size;
+
+    #ifdef MAP_HUGETLB
+    if (mode == HUGE_PAGES_HUGETLB)
+    {
+        void* ptr = mmap(nullptr, size, PROT_READ|PROT_WRITE,
+                         MAP_PRIVATE|MAP_ANONYMOUS|MAP_HUGETLB, -1, 0);
+        if (ptr != MAP_FAILED) return ptr;
+    }
+    #endif
+
+    /*
+     * Over-allocate so that the region can be trimmed to a huge page
+     * boundary, which transparent huge pages need to cover it fully.
+     */
+    size_t mapped = size+huge_page_size;
+    void* base = mmap(nullptr, mapped, PROT_READ|PROT_WRITE,
+                      MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) return nullptr;
+
+    char* begin = static_cast<char*>(base);
+    char* ptr = begin + (huge_page_size - reinterpret_cast<uintptr_t>(begin)%huge_page_size)%huge_page_size;
+    char* end = ptr + size;
+
+    if (ptr > begin) munmap(begin, ptr-begin);
+    if (begin+mapped > end) munmap(end, begin+mapped-end);
+
+    #ifdef MADV_HUGEPAGE
+    madvise(ptr, size, MADV_HUGEPAGE);
+    #endif
+
+    return ptr;
+
+    #else
+
+    (void)size;
+    (void)mode;
+    return nullptr;
+
+    #endif
+}
+
+inline void huge_page_free(void* ptr, size_t size)
+{
+    #if TBLIS_HAVE_SYS_MMAN_H
+    size = (size+huge_page_size-1)/huge_page_size*huge_page_size;
+    munmap(ptr, size);
+    #else
+    (void)ptr;
+    (void)size;
+    #endif
+}
+
+}
+
+#endif
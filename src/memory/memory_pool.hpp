@@ -4,10 +4,22 @@
 #include "util/thread.h"
 #include "util/assert.h"
 
-#include <mutex>
-#include <list>
-#include <cstdlib>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "util/env.hpp"
+
+#include "huge_pages.hpp"
+#include "memory_pools.h"
+#include "workspace.hpp"
 
 #if TBLIS_HAVE_HBWMALLOC_H
 #include <hbwmalloc.h>
@@ -29,14 +41,18 @@ class MemoryPool
                 Block(const Block&) = delete;
 
                 Block(Block&& other)
-                : _pool(other._pool), _size(other._size), _ptr(other._ptr)
+                : _pool(other._pool), _ws(other._ws), _size(other._size),
+                  _ptr(other._ptr)
                 {
                     other._ptr = NULL;
                 }
 
                 ~Block()
                 {
-                    if (_ptr) _pool->release(_ptr, _size);
+                    if (!_ptr) return;
+
+                    if (_ws) _ws->release(_ptr);
+                    else _pool->release(_ptr, _size);
                 }
 
                 Block& operator=(Block other)
@@ -55,26 +71,51 @@ class MemoryPool
                 {
                     using std::swap;
                     swap(a._pool, b._pool);
+                    swap(a._ws, b._ws);
                     swap(a._size, b._size);
                     swap(a._ptr, b._ptr);
                 }
 
             protected:
+                /*
+                 * Blocks are carved from this thread's workspace if there
+                 * is one with enough space left.
+                 */
                 Block(MemoryPool* pool, size_t size, size_t alignment)
-                : _pool(pool), _size(size),
-                  _ptr(pool->acquire(size, alignment)) {}
+                : _pool(pool), _size(size)
+                {
+                    if ((_ws = Workspace::current()))
+                        _ptr = _ws->acquire(size, std::max(alignment, pool->_align));
+
+                    if (!_ptr)
+                    {
+                        _ws = nullptr;
+                        _ptr = pool->acquire(_size, alignment);
+                    }
+                }
 
                 MemoryPool* _pool = nullptr;
+                Workspace* _ws = nullptr;
                 size_t _size = 0;
                 void* _ptr = nullptr;
         };
 
-        MemoryPool(size_t min_alignment=1) : _align(min_alignment) {}
+        MemoryPool(size_t min_alignment=1)
+        : _align(min_alignment), _limit(default_limit()), _id(next_id()++)
+        {
+            if (_id < max_pools) registry()[_id] = this;
+        }
 
         MemoryPool(const MemoryPool&) = delete;
 
         ~MemoryPool()
         {
+            if (_id < max_pools)
+            {
+                std::lock_guard<mutex> guard(caches_lock());
+                registry()[_id] = nullptr;
+            }
+
             flush();
         }
 
@@ -87,83 +128,565 @@ class MemoryPool
                          std::max(alignment, std::alignment_of<T>::value));
         }
 
+        size_t min_alignment() const
+        {
+            return _align;
+        }
+
+        /*
+         * Free all unused blocks, including those cached by each thread.
+         */
         void flush()
         {
+            flush_magazines();
+            flush_shared();
+        }
+
+        /*
+         * The number of bytes which may be kept in free blocks, including
+         * those cached by each thread. Beyond this, the least recently
+         * released blocks are returned to the system.
+         */
+        size_t limit() const
+        {
+            return _limit;
+        }
+
+        void set_limit(size_t limit)
+        {
+            _limit = limit;
+
+            if (_cached_size > limit) flush_magazines();
+
             std::lock_guard<mutex> guard(_lock);
+            trim();
+        }
+
+        tblis_memory_pool_stats stats() const
+        {
+            tblis_memory_pool_stats stats;
+            stats.bytes_held = _bytes_held;
+            stats.bytes_in_use = _bytes_in_use;
+            stats.peak_in_use = _peak_in_use;
+            stats.num_acquires = _num_acquires;
+            stats.num_allocations = _num_allocations;
+            return stats;
+        }
+
+        void reset_peak()
+        {
+            _peak_in_use = _bytes_in_use.load();
+        }
+
+        /*
+         * Make sure that there are free blocks of (at least) the given
+         * sizes, so that acquiring them later does not allocate. The
+         * threads of comm share out the blocks and touch each of their
+         * pages, so that page faults are taken now and (with first-touch
+         * NUMA placement) the pages are spread over the threads. All of the
+         * blocks are left in the shared bins, where any thread can find them.
+         */
+        void warm_up(const communicator& comm, const std::vector<size_t>& sizes)
+        {
+            std::vector<std::pair<void*,size_t>> blocks;
+
+            for (size_t i = comm.thread_num();i < sizes.size();i += comm.num_threads())
+            {
+                size_t size = sizes[i];
+                void* ptr = acquire(size, 1);
+
+                for (size_t off = 0;off < size;off += 4096)
+                    static_cast<volatile char*>(ptr)[off] = 0;
+
+                blocks.emplace_back(ptr, size);
+            }
+
+            /*
+             * Hold on to the blocks until every thread has taken its own, so
+             * that no block is counted twice.
+             */
+            comm.barrier();
 
-            for (auto& entry : _free_list)
+            for (auto& block : blocks)
             {
-                #if TBLIS_HAVE_HBWMALLOC_H
-                hbw_free(entry.first);
-                #else
-                free(entry.first);
-                #endif
+                _bytes_in_use -= block.second;
+                release_shared(block.first, block.second);
             }
-            _free_list.clear();
         }
 
+        /*
+         * Round a request up to one of four size classes per power of two,
+         * so that blocks of similar size are interchangeable and at most a
+         * quarter of a block is wasted.
+         */
+        static size_t size_class(size_t size)
+        {
+            if (size <= 64) return 64;
+
+            size_t step = 16;
+            while (step*8 <= size-1) step *= 2;
+
+            return (size+step-1)/step*step;
+        }
+
+        /*
+         * Free blocks are only handed out for requests of at least
+         * 1/max_oversize of their size.
+         */
+        constexpr static size_t max_oversize = 2;
+
     protected:
-        void* acquire(size_t& size, size_t alignment)
+        constexpr static unsigned max_pools = 16;
+        constexpr static unsigned magazine_size = 4;
+        constexpr static size_t magazine_bytes = size_t(1) << 22;
+
+        /*
+         * A few blocks of one pool cached by one thread, at most
+         * magazine_size blocks and magazine_bytes bytes in all. A magazine
+         * belongs to the pool with the same id.
+         *
+         * Only the owning thread puts blocks in, and only into empty slots,
+         * so a release store publishes them. Blocks are taken out with an
+         * atomic exchange, either by the owner or by a thread flushing the
+         * pool, so that each block is taken exactly once without a lock.
+         * The owner keeps the sizes in size; the size is also written into
+         * the block itself for the other threads.
+         */
+        struct magazine
         {
-            std::lock_guard<mutex> guard(_lock);
+            std::atomic<void*> ptr[magazine_size] = {};
+            size_t size[magazine_size] = {};
 
-            alignment = std::max(alignment, _align);
-            void* ptr = NULL;
+            bool full(unsigned i) const
+            {
+                return ptr[i].load(std::memory_order_relaxed);
+            }
+
+            void put(unsigned i, void* p, size_t s)
+            {
+                *static_cast<size_t*>(p) = s;
+                size[i] = s;
+                ptr[i].store(p, std::memory_order_release);
+            }
 
-            if (!_free_list.empty())
+            /*
+             * Take the block in slot i and its size, or return nullptr if
+             * the slot is empty.
+             */
+            void* take(unsigned i, size_t& s)
             {
-                auto entry = _free_list.front();
-                _free_list.pop_front();
+                if (!full(i)) return nullptr;
 
-                /*
-                 * If the region is big enough and properly aligned, use it.
-                 * Otherwise, free it and allocate a new one.
-                 */
-                if (entry.second >= size &&
-                    reinterpret_cast<uintptr_t>(entry.first) % alignment == 0)
+                void* p = ptr[i].exchange(nullptr, std::memory_order_acquire);
+                if (p) s = *static_cast<size_t*>(p);
+                return p;
+            }
+        };
+
+        /*
+         * The magazines of one thread. Every thread's cache is registered,
+         * so that a pool can take back the blocks cached for it by any
+         * thread.
+         */
+        struct thread_cache
+        {
+            magazine mags[max_pools];
+
+            thread_cache()
+            {
+                std::lock_guard<mutex> guard(caches_lock());
+                caches().push_back(this);
+            }
+
+            ~thread_cache()
+            {
+                std::lock_guard<mutex> guard(caches_lock());
+                caches().erase(std::find(caches().begin(), caches().end(), this));
+
+                for (unsigned id = 0;id < max_pools;id++)
                 {
-                    TBLIS_ASSERT(entry.first);
-                    ptr = entry.first;
-                    size = entry.second;
+                    auto& mag = mags[id];
+                    MemoryPool* pool = registry()[id];
+
+                    for (unsigned i = 0;i < magazine_size;i++)
+                    {
+                        size_t size;
+                        void* ptr = mag.take(i, size);
+                        if (!ptr) continue;
+
+                        if (pool)
+                        {
+                            pool->_cached_size -= size;
+                            pool->release_shared(ptr, size);
+                        }
+                        else deallocate(ptr, size);
+                    }
                 }
-                else
+            }
+        };
+
+        /*
+         * Free blocks in the shared bins hold their own links: a list per
+         * size class, and a list of all of them from the most to the least
+         * recently released.
+         */
+        struct free_node
+        {
+            free_node* prev;
+            free_node* next;
+            free_node* older;
+            free_node* newer;
+            size_t size;
+        };
+
+        static std::atomic<unsigned>& next_id()
+        {
+            static std::atomic<unsigned> id(0);
+            return id;
+        }
+
+        static std::atomic<MemoryPool*>* registry()
+        {
+            static std::atomic<MemoryPool*> pools[max_pools];
+            return pools;
+        }
+
+        /*
+         * These are never destroyed, since threads may exit after static
+         * destruction has begun.
+         */
+        static std::vector<thread_cache*>& caches()
+        {
+            static auto caches = new std::vector<thread_cache*>;
+            return *caches;
+        }
+
+        static mutex& caches_lock()
+        {
+            static auto lock = new mutex;
+            return *lock;
+        }
+
+        thread_cache* local_cache()
+        {
+            if (_id >= max_pools) return nullptr;
+
+            static thread_local thread_cache cache;
+            return &cache;
+        }
+
+        /*
+         * Free the blocks cached for this pool by every thread.
+         */
+        void flush_magazines()
+        {
+            if (_id >= max_pools) return;
+
+            std::lock_guard<mutex> guard(caches_lock());
+
+            for (auto cache : caches())
+            {
+                auto& mag = cache->mags[_id];
+
+                for (unsigned i = 0;i < magazine_size;i++)
                 {
-                    #if TBLIS_HAVE_HBWMALLOC_H
-                    hbw_free(entry.first);
-                    #else
-                    free(entry.first);
-                    #endif
+                    size_t size;
+                    if (void* ptr = mag.take(i, size))
+                    {
+                        _cached_size -= size;
+                        free_block(ptr, size);
+                    }
                 }
             }
+        }
 
-            if (ptr == NULL)
+        static size_t default_limit()
+        {
+            /*
+             * As with set_limit, 0 keeps no free blocks at all.
+             */
+            long limit = envtol("TBLIS_MEMORY_POOL_LIMIT", -1);
+            return limit >= 0 ? size_t(limit) :
+                                std::numeric_limits<size_t>::max();
+        }
+
+        static void deallocate(void* ptr, size_t size)
+        {
+            if (use_huge_pages(size))
+            {
+                huge_page_free(ptr, size);
+                return;
+            }
+
+            #if TBLIS_HAVE_HBWMALLOC_H
+            hbw_free(ptr);
+            #else
+            free(ptr);
+            #endif
+        }
+
+        void* allocate_block(size_t size, size_t alignment)
+        {
+            void* ptr = NULL;
+
+            _bytes_held += size;
+            _num_allocations++;
+
+            if (use_huge_pages(size))
             {
-                #if TBLIS_HAVE_HBWMALLOC_H
-                int ret = hbw_posix_memalign(&ptr, alignment, size);
-                #else
-                int ret = posix_memalign(&ptr, alignment, size);
-                #endif
-                if (ret != 0)
+                ptr = huge_page_alloc(size);
+                if (!ptr)
                 {
-                    perror("posix_memalign");
+                    perror("mmap");
                     abort();
                 }
+                return ptr;
+            }
+
+            #if TBLIS_HAVE_HBWMALLOC_H
+            int ret = hbw_posix_memalign(&ptr, alignment, size);
+            #else
+            int ret = posix_memalign(&ptr, alignment, size);
+            #endif
+            if (ret != 0)
+            {
+                perror("posix_memalign");
+                abort();
             }
 
             return ptr;
         }
 
-        void release(void* ptr, size_t size)
+        void free_block(void* ptr, size_t size)
+        {
+            _bytes_held -= size;
+            deallocate(ptr, size);
+        }
+
+        static bool is_aligned(void* ptr, size_t alignment)
+        {
+            return reinterpret_cast<uintptr_t>(ptr) % alignment == 0;
+        }
+
+        void* acquire(size_t& size, size_t alignment)
         {
+            alignment = std::max(alignment, _align);
+            size = size_class(size);
+            if (use_huge_pages(size))
+                size = (size+huge_page_size-1)/huge_page_size*huge_page_size;
+
+            void* ptr = find_block(size, alignment);
+            if (!ptr) ptr = allocate_block(size, alignment);
+
+            _num_acquires++;
+            size_t in_use = (_bytes_in_use += size);
+            size_t peak = _peak_in_use.load(std::memory_order_relaxed);
+            while (in_use > peak &&
+                   !_peak_in_use.compare_exchange_weak(peak, in_use,
+                                                       std::memory_order_relaxed)) {}
+
+            return ptr;
+        }
+
+        /*
+         * Take the smallest properly aligned block which is big enough,
+         * first from this thread's magazine and then from the shared bins,
+         * and update size to the size of the block. Blocks more than
+         * max_oversize times the requested size are not used, so that a
+         * small request cannot tie up a large buffer; a new block is
+         * allocated instead.
+         */
+        void* find_block(size_t& size, size_t alignment)
+        {
+            size_t max_size = size*max_oversize;
+
+            if (auto cache = local_cache())
+            {
+                auto& mag = cache->mags[_id];
+                unsigned best = magazine_size;
+
+                for (unsigned i = 0;i < magazine_size;i++)
+                {
+                    if (mag.full(i) &&
+                        mag.size[i] >= size && mag.size[i] <= max_size &&
+                        is_aligned(mag.ptr[i].load(std::memory_order_relaxed), alignment) &&
+                        (best == magazine_size || mag.size[i] < mag.size[best]))
+                        best = i;
+                }
+
+                /*
+                 * The block may have been flushed since, in which case the
+                 * shared bins are searched instead.
+                 */
+                if (best != magazine_size)
+                {
+                    if (void* ptr = mag.take(best, size))
+                    {
+                        _cached_size -= size;
+                        return ptr;
+                    }
+                }
+            }
+
             std::lock_guard<mutex> guard(_lock);
 
+            for (auto bin = _free_blocks.lower_bound(size);
+                 bin != _free_blocks.end() && bin->first <= max_size;++bin)
+            {
+                for (auto node = bin->second;node;node = node->next)
+                {
+                    if (!is_aligned(node, alignment)) continue;
+
+                    size = node->size;
+                    unlink(node);
+                    return node;
+                }
+            }
+
+            return nullptr;
+        }
+
+        void release(void* ptr, size_t size)
+        {
             TBLIS_ASSERT(ptr);
-            _free_list.emplace_front(ptr, size);
+
+            _bytes_in_use -= size;
+
+            /*
+             * Keep the block in this thread's magazine if it fits, both there
+             * and within the limit. If the magazine is full, the block may
+             * instead take the place of a smaller one, which goes back to the
+             * shared bins.
+             */
+            auto cache = local_cache();
+            if (cache && _free_size+_cached_size+size <= _limit)
+            {
+                auto& mag = cache->mags[_id];
+                unsigned empty = magazine_size;
+                unsigned smallest = magazine_size;
+                size_t bytes = 0;
+
+                for (unsigned i = 0;i < magazine_size;i++)
+                {
+                    if (!mag.full(i))
+                    {
+                        empty = i;
+                        continue;
+                    }
+
+                    bytes += mag.size[i];
+                    if (smallest == magazine_size || mag.size[i] < mag.size[smallest])
+                        smallest = i;
+                }
+
+                if (empty != magazine_size && bytes+size <= magazine_bytes)
+                {
+                    _cached_size += size;
+                    mag.put(empty, ptr, size);
+                    return;
+                }
+
+                size_t old_size;
+                if (smallest != magazine_size && mag.size[smallest] < size &&
+                    bytes-mag.size[smallest]+size <= magazine_bytes)
+                {
+                    if (void* old_ptr = mag.take(smallest, old_size))
+                    {
+                        _cached_size += size-old_size;
+                        mag.put(smallest, ptr, size);
+                        ptr = old_ptr;
+                        size = old_size;
+                    }
+                }
+            }
+
+            release_shared(ptr, size);
+        }
+
+        void release_shared(void* ptr, size_t size)
+        {
+            std::lock_guard<mutex> guard(_lock);
+
+            if (_cached_size+size > _limit)
+            {
+                free_block(ptr, size);
+                return;
+            }
+
+            auto node = static_cast<free_node*>(ptr);
+            node->size = size;
+
+            auto& head = _free_blocks[size];
+            node->prev = nullptr;
+            node->next = head;
+            if (head) head->prev = node;
+            head = node;
+
+            node->newer = nullptr;
+            node->older = _newest;
+            if (_newest) _newest->newer = node;
+            else _oldest = node;
+            _newest = node;
+
+            _free_size += size;
+            trim();
+        }
+
+        void unlink(free_node* node)
+        {
+            if (node->prev) node->prev->next = node->next;
+            else _free_blocks[node->size] = node->next;
+            if (node->next) node->next->prev = node->prev;
+
+            if (node->newer) node->newer->older = node->older;
+            else _newest = node->older;
+            if (node->older) node->older->newer = node->newer;
+            else _oldest = node->newer;
+
+            _free_size -= node->size;
+        }
+
+        void flush_shared()
+        {
+            std::lock_guard<mutex> guard(_lock);
+
+            while (_oldest)
+            {
+                auto node = _oldest;
+                unlink(node);
+                free_block(node, node->size);
+            }
+        }
+
+        void trim()
+        {
+            while (_oldest && _free_size+_cached_size > _limit)
+            {
+                auto node = _oldest;
+                unlink(node);
+                free_block(node, node->size);
+            }
         }
 
-        std::list<std::pair<void*,size_t>> _free_list;
+        /*
+         * Free blocks binned by size class. Bins are never removed, so once
+         * the working set of sizes has been seen no further bookkeeping
+         * allocations are made.
+         */
+        std::map<size_t, free_node*> _free_blocks;
+        free_node* _newest = nullptr;
+        free_node* _oldest = nullptr;
+        std::atomic<size_t> _free_size{0};
+        std::atomic<size_t> _cached_size{0};
         mutex _lock;
         size_t _align;
+        std::atomic<size_t> _limit;
+        unsigned _id;
+        std::atomic<size_t> _bytes_held{0};
+        std::atomic<size_t> _bytes_in_use{0};
+        std::atomic<size_t> _peak_in_use{0};
+        std::atomic<size_t> _num_acquires{0};
+        std::atomic<size_t> _num_allocations{0};
 };
 
 }
@@ -0,0 +1,67 @@
+#include "memory_pools.h"
+#include "memory_pool.hpp"
+
+namespace tblis
+{
+namespace internal
+{
+
+MemoryPool BuffersForA(4096);
+MemoryPool BuffersForB(4096);
+MemoryPool BuffersForScatter(4096);
+MemoryPool BuffersForStaging(4096);
+
+}
+
+namespace
+{
+
+MemoryPool& get_pool(tblis_memory_pool pool)
+{
+    switch (pool)
+    {
+        case TBLIS_POOL_A:       return internal::BuffersForA;
+        case TBLIS_POOL_B:       return internal::BuffersForB;
+        case TBLIS_POOL_SCATTER: return internal::BuffersForScatter;
+        default:                 return internal::BuffersForStaging;
+    }
+}
+
+}
+
+extern "C"
+{
+
+void tblis_get_memory_pool_stats(tblis_memory_pool pool,
+                                 tblis_memory_pool_stats* stats)
+{
+    TBLIS_ASSERT(pool >= 0 && pool < TBLIS_NUM_POOLS);
+    *stats = get_pool(pool).stats();
+}
+
+void tblis_reset_memory_pool_peaks()
+{
+    for (int pool = 0;pool < TBLIS_NUM_POOLS;pool++)
+        get_pool(tblis_memory_pool(pool)).reset_peak();
+}
+
+size_t tblis_get_memory_pool_limit()
+{
+    return get_pool(TBLIS_POOL_A).limit();
+}
+
+void tblis_set_memory_pool_limit(size_t limit)
+{
+    for (int pool = 0;pool < TBLIS_NUM_POOLS;pool++)
+        get_pool(tblis_memory_pool(pool)).set_limit(limit);
+}
+
+void tblis_flush_memory_pools()
+{
+    for (int pool = 0;pool < TBLIS_NUM_POOLS;pool++)
+        get_pool(tblis_memory_pool(pool)).flush();
+}
+
+}
+
+}
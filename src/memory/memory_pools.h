@@ -0,0 +1,63 @@
+#ifndef _TBLIS_MEMORY_POOLS_H_
+#define _TBLIS_MEMORY_POOLS_H_
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*
+ * The pools of packing and scatter buffers used by tblis_matrix_mult and
+ * tblis_tensor_mult, and of the transposed copies made by tblis_tensor_mult
+ * when it falls back to transpose-GEMM-transpose.
+ */
+typedef enum
+{
+    TBLIS_POOL_A       = 0,
+    TBLIS_POOL_B       = 1,
+    TBLIS_POOL_SCATTER = 2,
+    TBLIS_POOL_STAGING = 3,
+    TBLIS_NUM_POOLS    = 4
+} tblis_memory_pool;
+
+typedef struct tblis_memory_pool_stats
+{
+    size_t bytes_held;      /* blocks owned by the pool, in use or not */
+    size_t bytes_in_use;    /* blocks currently handed out */
+    size_t peak_in_use;     /* high-water mark of bytes_in_use */
+    size_t num_acquires;
+    size_t num_allocations; /* acquires which had to allocate a new block */
+} tblis_memory_pool_stats;
+
+void tblis_get_memory_pool_stats(tblis_memory_pool pool,
+                                 tblis_memory_pool_stats* stats);
+
+/*
+ * Set peak_in_use of every pool to the current bytes_in_use.
+ */
+void tblis_reset_memory_pool_peaks();
+
+/*
+ * The number of bytes of unused blocks each pool may retain, including
+ * blocks cached by individual threads, after which the least recently
+ * released blocks are freed. A limit of 0 keeps no unused blocks at all, and
+ * SIZE_MAX is unlimited. The default is taken from TBLIS_MEMORY_POOL_LIMIT,
+ * with the same meaning, and is unlimited if that is unset.
+ */
+size_t tblis_get_memory_pool_limit();
+
+void tblis_set_memory_pool_limit(size_t limit);
+
+/*
+ * Free all unused blocks, e.g. between phases of a computation, including
+ * those cached by every thread.
+ */
+void tblis_flush_memory_pools();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
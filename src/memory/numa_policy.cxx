@@ -0,0 +1,176 @@
+#include "numa_policy.h"
+
+#include "util/thread.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#if TBLIS_HAVE_NUMA_H
+#include <numa.h>
+#include <numaif.h>
+#endif
+
+namespace tblis
+{
+
+namespace
+{
+
+struct numa_configuration
+{
+    tblis_numa_policy policy;
+
+    numa_configuration()
+    : policy{TBLIS_NUMA_DEFAULT, 0}
+    {
+        const char* str = getenv("TBLIS_NUMA_POLICY");
+        if (!str) return;
+
+        if (strcmp(str, "interleave") == 0)
+        {
+            policy.type = TBLIS_NUMA_INTERLEAVE;
+        }
+        else if (strncmp(str, "bind:", 5) == 0)
+        {
+            policy.type = TBLIS_NUMA_BIND;
+            policy.node = strtol(str+5, nullptr, 10);
+        }
+        else if (strcmp(str, "first_touch") == 0)
+        {
+            policy.type = TBLIS_NUMA_FIRST_TOUCH;
+        }
+    }
+};
+
+numa_configuration& get_numa_configuration()
+{
+    static numa_configuration cfg;
+    return cfg;
+}
+
+const tblis_numa_policy*& scoped_policy()
+{
+    static thread_local const tblis_numa_policy* policy = nullptr;
+    return policy;
+}
+
+void first_touch(void* ptr, size_t n, size_t size)
+{
+    /*
+     * A tensor stored densely is folded to a single index by
+     * tblis_tensor_set, which then splits it as below.
+     */
+    parallelize
+    (
+        [&](const communicator& comm)
+        {
+            len_type m_min, m_max;
+            std::tie(m_min, m_max, std::ignore,
+                     std::ignore, std::ignore, std::ignore) =
+                comm.distribute_over_threads_2d(n, 1);
+
+            memset(static_cast<char*>(ptr) + m_min*size, 0, (m_max-m_min)*size);
+        },
+        tblis_get_num_threads()
+    );
+}
+
+#if TBLIS_HAVE_NUMA_H
+
+void bind_pages(void* ptr, size_t size, const tblis_numa_policy& policy)
+{
+    if (numa_available() < 0) return;
+
+    /*
+     * Only the pages lying entirely within the allocation are placed, since
+     * the others may be shared with neighbouring allocations.
+     */
+    uintptr_t page = numa_pagesize();
+    uintptr_t begin = (reinterpret_cast<uintptr_t>(ptr)+page-1)/page*page;
+    uintptr_t end = (reinterpret_cast<uintptr_t>(ptr)+size)/page*page;
+    if (end <= begin) return;
+
+    bitmask* nodes;
+    int mode;
+
+    if (policy.type == TBLIS_NUMA_INTERLEAVE)
+    {
+        nodes = numa_get_mems_allowed();
+        mode = MPOL_INTERLEAVE;
+    }
+    else
+    {
+        if (policy.node < 0 || policy.node > numa_max_node()) return;
+        nodes = numa_allocate_nodemask();
+        numa_bitmask_setbit(nodes, policy.node);
+        mode = MPOL_BIND;
+    }
+
+    /*
+     * The memory may have been recycled by malloc, so move any pages which
+     * have already been touched. Failure leaves the pages where they are.
+     */
+    mbind(reinterpret_cast<void*>(begin), end-begin, mode,
+          nodes->maskp, nodes->size+1, MPOL_MF_MOVE);
+
+    numa_bitmask_free(nodes);
+}
+
+#endif
+
+}
+
+numa_scope::numa_scope(tblis_numa_policy policy)
+: _policy(policy), _prev(scoped_policy())
+{
+    scoped_policy() = &_policy;
+}
+
+numa_scope::~numa_scope()
+{
+    scoped_policy() = _prev;
+}
+
+tblis_numa_policy numa_policy()
+{
+    auto policy = scoped_policy();
+    return policy ? *policy : tblis_get_numa_policy();
+}
+
+void numa_place(void* ptr, size_t n, size_t size)
+{
+    auto policy = numa_policy();
+
+    switch (policy.type)
+    {
+        case TBLIS_NUMA_FIRST_TOUCH:
+            first_touch(ptr, n, size);
+            break;
+        case TBLIS_NUMA_INTERLEAVE:
+        case TBLIS_NUMA_BIND:
+            #if TBLIS_HAVE_NUMA_H
+            bind_pages(ptr, n*size, policy);
+            #endif
+            break;
+        default:
+            break;
+    }
+}
+
+extern "C"
+{
+
+tblis_numa_policy tblis_get_numa_policy()
+{
+    return get_numa_configuration().policy;
+}
+
+void tblis_set_numa_policy(tblis_numa_policy policy)
+{
+    get_numa_configuration().policy = policy;
+}
+
+}
+
+}
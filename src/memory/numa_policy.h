@@ -0,0 +1,100 @@
+#ifndef _TBLIS_NUMA_POLICY_H_
+#define _TBLIS_NUMA_POLICY_H_
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*
+ * Where the pages of large tensors (those allocated by aligned_allocator,
+ * i.e. tensor<T>, matrix<T>, row<T>, etc.) are placed on a NUMA system.
+ * Only allocations of at least 2 MiB are affected.
+ *
+ *  DEFAULT:     wherever they are first touched, which for a tensor which
+ *               is constructed with a value is the allocating thread
+ *  INTERLEAVE:  round-robin across all allowed nodes
+ *  BIND:        on the given node
+ *  FIRST_TOUCH: touched by tblis_get_num_threads() threads, each taking the
+ *               part it would be given by tblis_tensor_set (and by
+ *               tblis_tensor_add with the same layout), so that the pages
+ *               end up local to the threads which later use them
+ *
+ * INTERLEAVE and BIND need libnuma and are ignored without it. Memory from
+ * hbwmalloc is left where memkind puts it.
+ */
+typedef enum
+{
+    TBLIS_NUMA_DEFAULT     = 0,
+    TBLIS_NUMA_INTERLEAVE  = 1,
+    TBLIS_NUMA_BIND        = 2,
+    TBLIS_NUMA_FIRST_TOUCH = 3
+} tblis_numa_policy_type;
+
+typedef struct tblis_numa_policy
+{
+    tblis_numa_policy_type type;
+    int node; /* only for TBLIS_NUMA_BIND */
+} tblis_numa_policy;
+
+/*
+ * The global policy. The default is taken from TBLIS_NUMA_POLICY, which may
+ * be "interleave", "bind:<node>", or "first_touch".
+ */
+tblis_numa_policy tblis_get_numa_policy();
+
+void tblis_set_numa_policy(tblis_numa_policy policy);
+
+#ifdef __cplusplus
+}
+#endif
+
+#ifdef __cplusplus
+
+namespace tblis
+{
+
+/*
+ * Override the global policy for the tensors allocated by this thread while
+ * in scope, e.g.
+ *
+ *  tensor<double> T2;
+ *  {
+ *      numa_scope scope({TBLIS_NUMA_BIND, 1});
+ *      T2.reset({nv, nv, no, no});
+ *  }
+ */
+class numa_scope
+{
+    public:
+        numa_scope(tblis_numa_policy policy);
+
+        numa_scope(const numa_scope&) = delete;
+
+        ~numa_scope();
+
+        numa_scope& operator=(const numa_scope&) = delete;
+
+    protected:
+        tblis_numa_policy _policy;
+        const tblis_numa_policy* _prev;
+};
+
+/*
+ * The policy in effect on this thread.
+ */
+tblis_numa_policy numa_policy();
+
+/*
+ * Apply the current policy to a new, untouched allocation of n elements of
+ * the given size.
+ */
+void numa_place(void* ptr, size_t n, size_t size);
+
+}
+
+#endif
+
+#endif
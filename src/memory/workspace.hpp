@@ -0,0 +1,148 @@
+#ifndef _TBLIS_WORKSPACE_HPP_
+#define _TBLIS_WORKSPACE_HPP_
+
+#include "util/thread.h"
+#include "util/assert.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <mutex>
+
+namespace tblis
+{
+
+/*
+ * A caller-supplied buffer from which the packing, scatter, and staging
+ * buffers of one operation are carved instead of being taken from the
+ * memory pools.
+ *
+ * Allocations are made from the top of a stack. A released allocation is
+ * only marked as free, and is popped (along with any free allocations
+ * directly below it) once it is at the top, so the nested lifetimes of the
+ * buffers in a GEMM never leave holes behind.
+ */
+class Workspace
+{
+    public:
+        class Scope
+        {
+            public:
+                Scope(Workspace& ws)
+                : _prev(current())
+                {
+                    current() = &ws;
+                }
+
+                Scope(const Scope&) = delete;
+
+                ~Scope()
+                {
+                    current() = _prev;
+                }
+
+                Scope& operator=(const Scope&) = delete;
+
+            protected:
+                Workspace* _prev;
+        };
+
+        Workspace(void* ptr, size_t size)
+        : _base(reinterpret_cast<uintptr_t>(ptr)), _size(ptr ? size : 0) {}
+
+        Workspace(const Workspace&) = delete;
+
+        Workspace& operator=(const Workspace&) = delete;
+
+        /*
+         * The workspace used by allocations on this thread, if any.
+         */
+        static Workspace*& current()
+        {
+            static thread_local Workspace* ws = nullptr;
+            return ws;
+        }
+
+        /*
+         * The most space that an allocation of size bytes can take up.
+         */
+        static size_t footprint(size_t size, size_t alignment)
+        {
+            return size + sizeof(header) + std::max(alignment, alignof(header)) - 1;
+        }
+
+        /*
+         * Returns nullptr if there is not enough space left.
+         */
+        void* acquire(size_t size, size_t alignment)
+        {
+            std::lock_guard<mutex> guard(_lock);
+
+            alignment = std::max(alignment, alignof(header));
+            uintptr_t addr = _base + _top + sizeof(header);
+            addr = (addr + alignment - 1)/alignment*alignment;
+            if (addr + size > _base + _size) return nullptr;
+
+            auto hdr = reinterpret_cast<header*>(addr) - 1;
+            hdr->below = _last;
+            hdr->top = _top;
+            hdr->free = false;
+
+            _last = hdr;
+            _top = addr + size - _base;
+            _used = std::max(_used, _top);
+
+            return reinterpret_cast<void*>(addr);
+        }
+
+        void release(void* ptr)
+        {
+            std::lock_guard<mutex> guard(_lock);
+
+            TBLIS_ASSERT(owns(ptr));
+
+            static_cast<header*>(ptr)[-1].free = true;
+
+            while (_last && _last->free)
+            {
+                _top = _last->top;
+                _last = _last->below;
+            }
+        }
+
+        bool owns(const void* ptr) const
+        {
+            auto addr = reinterpret_cast<uintptr_t>(ptr);
+            return addr >= _base && addr < _base + _size;
+        }
+
+        /*
+         * The high-water mark of the space used so far.
+         */
+        size_t used() const
+        {
+            return _used;
+        }
+
+    protected:
+        /*
+         * Placed just before each allocation: the allocation below it on
+         * the stack and the top of the stack before it was made.
+         */
+        struct header
+        {
+            header* below;
+            size_t top;
+            bool free;
+        };
+
+        uintptr_t _base;
+        size_t _size;
+        size_t _top = 0;
+        size_t _used = 0;
+        header* _last = nullptr; // the allocation at the top of the stack
+        mutex _lock;
+};
+
+}
+
+#endif
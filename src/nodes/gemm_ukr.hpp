@@ -9,10 +9,10 @@
 namespace tblis
 {
 
-template <typename T>
+template <typename T, typename U>
 void accum_utile(len_type m, len_type n,
                  const T* TBLIS_RESTRICT p_ab, stride_type rs_ab, stride_type cs_ab,
-                 T beta, T* TBLIS_RESTRICT p_c, stride_type rs_c, stride_type cs_c)
+                 T beta, bool conj_c, U* TBLIS_RESTRICT p_c, stride_type rs_c, stride_type cs_c)
 {
     if (beta == T(0))
     {
@@ -20,7 +20,7 @@ void accum_utile(len_type m, len_type n,
         {
             for (len_type i = 0;i < m;i++)
             {
-                p_c[i*rs_c + j*cs_c] = p_ab[i*rs_ab + j*cs_ab];
+                p_c[i*rs_c + j*cs_c] = U(p_ab[i*rs_ab + j*cs_ab]);
             }
         }
     }
@@ -30,16 +30,16 @@ void accum_utile(len_type m, len_type n,
         {
             for (len_type i = 0;i < m;i++)
             {
-                p_c[i*rs_c + j*cs_c] = p_ab[i*rs_ab + j*cs_ab] + beta*p_c[i*rs_c + j*cs_c];
+                p_c[i*rs_c + j*cs_c] = U(p_ab[i*rs_ab + j*cs_ab] + beta*conj(conj_c, T(p_c[i*rs_c + j*cs_c])));
             }
         }
     }
 }
 
-template <typename T>
+template <typename T, typename U>
 void accum_utile(len_type m, len_type n,
                  const T* TBLIS_RESTRICT p_ab, stride_type rs_ab, stride_type cs_ab,
-                 T beta, T* TBLIS_RESTRICT p_c,
+                 T beta, bool conj_c, U* TBLIS_RESTRICT p_c,
                  const stride_type* TBLIS_RESTRICT rs_c, stride_type cs_c)
 {
     if (beta == T(0))
@@ -48,7 +48,7 @@ void accum_utile(len_type m, len_type n,
         {
             for (len_type i = 0;i < m;i++)
             {
-                p_c[rs_c[i] + j*cs_c] = p_ab[i*rs_ab + j*cs_ab];
+                p_c[rs_c[i] + j*cs_c] = U(p_ab[i*rs_ab + j*cs_ab]);
             }
         }
     }
@@ -58,16 +58,16 @@ void accum_utile(len_type m, len_type n,
         {
             for (len_type i = 0;i < m;i++)
             {
-                p_c[rs_c[i] + j*cs_c] = p_ab[i*rs_ab + j*cs_ab] + beta*p_c[rs_c[i] + j*cs_c];
+                p_c[rs_c[i] + j*cs_c] = U(p_ab[i*rs_ab + j*cs_ab] + beta*conj(conj_c, T(p_c[rs_c[i] + j*cs_c])));
             }
         }
     }
 }
 
-template <typename T>
+template <typename T, typename U>
 void accum_utile(len_type m, len_type n,
                  const T* TBLIS_RESTRICT p_ab, stride_type rs_ab, stride_type cs_ab,
-                 T beta, T* TBLIS_RESTRICT p_c,
+                 T beta, bool conj_c, U* TBLIS_RESTRICT p_c,
                  stride_type rs_c, const stride_type* TBLIS_RESTRICT cs_c)
 {
     if (beta == T(0))
@@ -76,7 +76,7 @@ void accum_utile(len_type m, len_type n,
         {
             for (len_type i = 0;i < m;i++)
             {
-                p_c[i*rs_c + cs_c[j]] = p_ab[i*rs_ab + j*cs_ab];
+                p_c[i*rs_c + cs_c[j]] = U(p_ab[i*rs_ab + j*cs_ab]);
             }
         }
     }
@@ -86,16 +86,16 @@ void accum_utile(len_type m, len_type n,
         {
             for (len_type i = 0;i < m;i++)
             {
-                p_c[i*rs_c + cs_c[j]] = p_ab[i*rs_ab + j*cs_ab] + beta*p_c[i*rs_c + cs_c[j]];
+                p_c[i*rs_c + cs_c[j]] = U(p_ab[i*rs_ab + j*cs_ab] + beta*conj(conj_c, T(p_c[i*rs_c + cs_c[j]])));
             }
         }
     }
 }
 
-template <typename T>
+template <typename T, typename U>
 void accum_utile(len_type m, len_type n,
                  const T* TBLIS_RESTRICT p_ab, stride_type rs_ab, stride_type cs_ab,
-                 T beta, T* TBLIS_RESTRICT p_c,
+                 T beta, bool conj_c, U* TBLIS_RESTRICT p_c,
                  const stride_type* TBLIS_RESTRICT rs_c,
                  const stride_type* TBLIS_RESTRICT cs_c)
 {
@@ -105,7 +105,7 @@ void accum_utile(len_type m, len_type n,
         {
             for (len_type i = 0;i < m;i++)
             {
-                p_c[rs_c[i] + cs_c[j]] = p_ab[i*rs_ab + j*cs_ab];
+                p_c[rs_c[i] + cs_c[j]] = U(p_ab[i*rs_ab + j*cs_ab]);
             }
         }
     }
@@ -115,12 +115,34 @@ void accum_utile(len_type m, len_type n,
         {
             for (len_type i = 0;i < m;i++)
             {
-                p_c[rs_c[i] + cs_c[j]] = p_ab[i*rs_ab + j*cs_ab] + beta*p_c[rs_c[i] + cs_c[j]];
+                p_c[rs_c[i] + cs_c[j]] = U(p_ab[i*rs_ab + j*cs_ab] + beta*conj(conj_c, T(p_c[rs_c[i] + cs_c[j]])));
             }
         }
     }
 }
 
+/*
+ * The accumulation is always done in the compute type T, but C may be stored
+ * in another type U, in which case the result is converted on write-back.
+ * Packed panels are normally also of type T, except for int8_t and int16_t
+ * operands, which are packed as int16_t and go to gemm_i16_ukr.
+ */
+
+template <typename T>
+void call_gemm_ukr(const config& cfg, stride_type k,
+                   const T* alpha, const T* p_a, const T* p_b,
+                   const T* beta, T* p_c, stride_type rs_c, stride_type cs_c)
+{
+    cfg.gemm_ukr.call<T>(k, alpha, p_a, p_b, beta, p_c, rs_c, cs_c);
+}
+
+inline void call_gemm_ukr(const config& cfg, stride_type k,
+                          const int32_t* alpha, const int16_t* p_a, const int16_t* p_b,
+                          const int32_t* beta, int32_t* p_c, stride_type rs_c, stride_type cs_c)
+{
+    cfg.gemm_i16_ukr(k, alpha, p_a, p_b, beta, p_c, rs_c, cs_c);
+}
+
 struct gemm_micro_kernel
 {
     template <typename T>
@@ -161,7 +183,7 @@ struct gemm_micro_kernel
                                  &zero, &p_ab[0], rs_ab, cs_ab);
 
             accum_utile(m, n, p_ab, rs_ab, cs_ab,
-                        beta, p_c, rs_c, cs_c);
+                        beta, false, p_c, rs_c, cs_c);
         }
     }
 
@@ -207,31 +229,31 @@ struct gemm_micro_kernel
             if (rs_c == 0 && cs_c == 0)
             {
                 accum_utile(m, n, p_ab, rs_ab, cs_ab,
-                            beta, p_c, rscat_c, cscat_c);
+                            beta, false, p_c, rscat_c, cscat_c);
             }
             else if (rs_c == 0)
             {
                 accum_utile(m, n, p_ab, rs_ab, cs_ab,
-                            beta, p_c, rscat_c, cs_c);
+                            beta, false, p_c, rscat_c, cs_c);
             }
             else if (cs_c == 0)
             {
                 accum_utile(m, n, p_ab, rs_ab, cs_ab,
-                            beta, p_c, rs_c, cscat_c);
+                            beta, false, p_c, rs_c, cscat_c);
             }
             else
             {
                 accum_utile(m, n, p_ab, rs_ab, cs_ab,
-                            beta, p_c, rs_c, cs_c);
+                            beta, false, p_c, rs_c, cs_c);
             }
         }
     }
 
-    template <typename T>
+    template <typename T, typename TP, typename U>
     void operator()(const communicator& comm, const config& cfg,
-                    T alpha,          matrix_view<T>& A,
-                                      matrix_view<T>& B,
-                    T  beta, block_scatter_matrix<T>& C) const
+                    T alpha,          matrix_view<TP>& A,
+                                      matrix_view<TP>& B,
+                    T  beta, block_scatter_matrix<U>& C) const
     {
         (void)comm;
 
@@ -241,9 +263,9 @@ struct gemm_micro_kernel
         const len_type rs_ab = (row_major ? NR : 1);
         const len_type cs_ab = (row_major ? 1 : MR);
 
-        const T* p_a = A.data();
-        const T* p_b = B.data();
-              T* p_c = C.data();
+        const TP* p_a = A.data();
+        const TP* p_b = B.data();
+              U* p_c = C.data();
 
         TBLIS_ASSERT(C.block_size(0) == MR &&
                      C.block_size(1) == NR);
@@ -256,38 +278,39 @@ struct gemm_micro_kernel
         const stride_type* rscat_c = C.scatter(0);
         const stride_type* cscat_c = C.scatter(1);
 
-        if (m == MR && n == NR && rs_c != 0 && cs_c != 0)
+        if (std::is_same<T,U>::value && !C.conj() &&
+            m == MR && n == NR && rs_c != 0 && cs_c != 0)
         {
-            cfg.gemm_ukr.call<T>(k, &alpha, p_a, p_b,
-                                 &beta, p_c, rs_c, cs_c);
+            call_gemm_ukr(cfg, k, &alpha, p_a, p_b,
+                          &beta, reinterpret_cast<T*>(p_c), rs_c, cs_c);
         }
         else
         {
             T p_ab[512] __attribute__((aligned(64)));
             static constexpr T zero = T(0);
 
-            cfg.gemm_ukr.call<T>(k, &alpha, p_a, p_b,
-                                 &zero, &p_ab[0], rs_ab, cs_ab);
+            call_gemm_ukr(cfg, k, &alpha, p_a, p_b,
+                          &zero, &p_ab[0], rs_ab, cs_ab);
 
             if (rs_c == 0 && cs_c == 0)
             {
                 accum_utile(m, n, p_ab, rs_ab, cs_ab,
-                            beta, p_c, rscat_c, cscat_c);
+                            beta, C.conj(), p_c, rscat_c, cscat_c);
             }
             else if (rs_c == 0)
             {
                 accum_utile(m, n, p_ab, rs_ab, cs_ab,
-                            beta, p_c, rscat_c, cs_c);
+                            beta, C.conj(), p_c, rscat_c, cs_c);
             }
             else if (cs_c == 0)
             {
                 accum_utile(m, n, p_ab, rs_ab, cs_ab,
-                            beta, p_c, rs_c, cscat_c);
+                            beta, C.conj(), p_c, rs_c, cscat_c);
             }
             else
             {
                 accum_utile(m, n, p_ab, rs_ab, cs_ab,
-                            beta, p_c, rs_c, cs_c);
+                            beta, C.conj(), p_c, rs_c, cs_c);
             }
         }
     }
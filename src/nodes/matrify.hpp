@@ -63,9 +63,11 @@ template <> struct matrify_and_run<matrix_constants::MAT_A>
         A.fill_block_scatter(0, parent.rscat, MB, parent.rbs);
         A.fill_block_scatter(1, parent.cscat, NB, parent.cbs);
 
-        block_scatter_matrix<T> M(A.length(0), A.length(1), A.data(),
-                                  parent.rscat, MB, parent.rbs,
-                                  parent.cscat, NB, parent.cbs);
+        block_scatter_matrix<typename MatrixA::value_type>
+            M(A.length(0), A.length(1), A.data(),
+              parent.rscat, MB, parent.rbs,
+              parent.cscat, NB, parent.cbs);
+        M.conj(A.conj());
 
         parent.child(comm, cfg, alpha, M, B, beta, C);
     }
@@ -86,9 +88,11 @@ template <> struct matrify_and_run<matrix_constants::MAT_B>
         B.fill_block_scatter(0, parent.rscat, MB, parent.rbs);
         B.fill_block_scatter(1, parent.cscat, NB, parent.cbs);
 
-        block_scatter_matrix<T> M(B.length(0), B.length(1), B.data(),
-                                  parent.rscat, MB, parent.rbs,
-                                  parent.cscat, NB, parent.cbs);
+        block_scatter_matrix<typename MatrixB::value_type>
+            M(B.length(0), B.length(1), B.data(),
+              parent.rscat, MB, parent.rbs,
+              parent.cscat, NB, parent.cbs);
+        M.conj(B.conj());
 
         parent.child(comm, cfg, alpha, A, M, beta, C);
     }
@@ -109,9 +113,11 @@ template <> struct matrify_and_run<matrix_constants::MAT_C>
         C.fill_block_scatter(0, parent.rscat, MB, parent.rbs);
         C.fill_block_scatter(1, parent.cscat, NB, parent.cbs);
 
-        block_scatter_matrix<T> M(C.length(0), C.length(1), C.data(),
-                                  parent.rscat, MB, parent.rbs,
-                                  parent.cscat, NB, parent.cbs);
+        block_scatter_matrix<typename MatrixC::value_type>
+            M(C.length(0), C.length(1), C.data(),
+              parent.rscat, MB, parent.rbs,
+              parent.cscat, NB, parent.cbs);
+        M.conj(C.conj());
 
         parent.child(comm, cfg, alpha, A, B, beta, M);
     }
@@ -19,6 +19,129 @@
 namespace tblis
 {
 
+/*
+ * int8_t and int16_t operands of integer contractions are packed as int16_t,
+ * with pairs of consecutive k interleaved (see gemm_i16_ukr_t). Everything
+ * else is packed in the compute type T.
+ */
+
+template <typename T, typename U> struct packed_type { typedef T type; };
+template <> struct packed_type<int32_t,  int8_t> { typedef int16_t type; };
+template <> struct packed_type<int32_t, int16_t> { typedef int16_t type; };
+
+template <typename TP> struct pack_k_group : std::integral_constant<len_type, 1> {};
+template <> struct pack_k_group<int16_t> : std::integral_constant<len_type, 2> {};
+
+template <typename TP>
+stride_type packed_offset(len_type ME, len_type mr, len_type kr)
+{
+    constexpr len_type G = pack_k_group<TP>::value;
+    return ME*(kr - kr%G) + G*mr + kr%G;
+}
+
+/*
+ * Packing of block-scattered panels. When the storage type U differs from the
+ * packed type T the elements are converted while packing, so that no
+ * converted copy of the whole operand is ever made. Conjugation is applied
+ * in the same pass; the packing microkernels do not conjugate, so conjugated
+ * panels of the compute type also use the converting loops.
+ */
+
+template <int Mat, typename T, typename U>
+void pack_nb_panel(const config& cfg, len_type MR, len_type ME, len_type KR,
+                   len_type m, len_type k, const U* p_a, stride_type rs_a,
+                   const stride_type* cscat_a, const stride_type* cbs_a,
+                   T* p_ap, bool conj_a)
+{
+    (void)cfg;
+
+    constexpr len_type G = pack_k_group<T>::value;
+
+    for (len_type p = 0;p < k;p += KR)
+    {
+        len_type k_loc = std::min(KR, k-p);
+        stride_type cs_a = *cbs_a;
+
+        for (len_type kr = 0;kr < k_loc;kr++)
+        {
+            const U* p_a_k = p_a + (cs_a ? cs_a*kr + cscat_a[0] : cscat_a[kr]);
+
+            for (len_type mr = 0;mr < m;mr++)
+                p_ap[packed_offset<T>(ME, mr, kr)] = conj(conj_a, T(p_a_k[rs_a*mr]));
+
+            for (len_type mr = m;mr < MR;mr++)
+                p_ap[packed_offset<T>(ME, mr, kr)] = T();
+        }
+
+        for (len_type kr = k_loc;kr < round_up(k_loc, G);kr++)
+            for (len_type mr = 0;mr < MR;mr++)
+                p_ap[packed_offset<T>(ME, mr, kr)] = T();
+
+        p_ap += ME*KR;
+        cscat_a += KR;
+        cbs_a++;
+    }
+}
+
+template <int Mat, typename T>
+typename std::enable_if<pack_k_group<T>::value == 1>::type
+pack_nb_panel(const config& cfg, len_type MR, len_type ME, len_type KR,
+              len_type m, len_type k, const T* p_a, stride_type rs_a,
+              const stride_type* cscat_a, const stride_type* cbs_a,
+              T* p_ap, bool conj_a)
+{
+    if (conj_a)
+        return pack_nb_panel<Mat,T,T>(cfg, MR, ME, KR, m, k, p_a, rs_a,
+                                      cscat_a, cbs_a, p_ap, conj_a);
+
+    if (Mat == matrix_constants::MAT_A)
+        cfg.pack_nb_mr_ukr.call<T>(m, k, p_a, rs_a, cscat_a, cbs_a, p_ap);
+    else
+        cfg.pack_nb_nr_ukr.call<T>(m, k, p_a, rs_a, cscat_a, cbs_a, p_ap);
+}
+
+template <int Mat, typename T, typename U>
+void pack_sb_panel(const config& cfg, len_type MR, len_type ME,
+                   len_type m, len_type k, const U* p_a,
+                   const stride_type* rscat_a, const stride_type* cscat_a,
+                   const stride_type* cbs_a, T* p_ap, bool conj_a)
+{
+    (void)cfg;
+    (void)cbs_a;
+
+    constexpr len_type G = pack_k_group<T>::value;
+
+    for (len_type p = 0;p < k;p++)
+    {
+        for (len_type mr = 0;mr < m;mr++)
+            p_ap[packed_offset<T>(ME, mr, p)] = conj(conj_a, T(p_a[rscat_a[mr] + cscat_a[p]]));
+
+        for (len_type mr = m;mr < MR;mr++)
+            p_ap[packed_offset<T>(ME, mr, p)] = T();
+    }
+
+    for (len_type p = k;p < round_up(k, G);p++)
+        for (len_type mr = 0;mr < MR;mr++)
+            p_ap[packed_offset<T>(ME, mr, p)] = T();
+}
+
+template <int Mat, typename T>
+typename std::enable_if<pack_k_group<T>::value == 1>::type
+pack_sb_panel(const config& cfg, len_type MR, len_type ME,
+              len_type m, len_type k, const T* p_a,
+              const stride_type* rscat_a, const stride_type* cscat_a,
+              const stride_type* cbs_a, T* p_ap, bool conj_a)
+{
+    if (conj_a)
+        return pack_sb_panel<Mat,T,T>(cfg, MR, ME, m, k, p_a, rscat_a,
+                                      cscat_a, cbs_a, p_ap, conj_a);
+
+    if (Mat == matrix_constants::MAT_A)
+        cfg.pack_sb_mr_ukr.call<T>(m, k, p_a, rscat_a, cscat_a, cbs_a, p_ap);
+    else
+        cfg.pack_sb_nr_ukr.call<T>(m, k, p_a, rscat_a, cscat_a, cbs_a, p_ap);
+}
+
 template <typename T, int Mat>
 struct pack_row_panel
 {
@@ -137,8 +260,9 @@ struct pack_row_panel
         }
     }
 
+    template <typename U, typename TP>
     void operator()(const communicator& comm, const config& cfg,
-                    block_scatter_matrix<T> A, matrix_view<T>& Ap) const
+                    block_scatter_matrix<U> A, matrix_view<TP>& Ap) const
     {
         const len_type MR = (!Trans ? cfg.gemm_mr.def<T>()
                                     : cfg.gemm_nr.def<T>());
@@ -148,24 +272,26 @@ struct pack_row_panel
 
         TBLIS_ASSERT(A.block_size(0) == (!Trans ? MR : KR));
         TBLIS_ASSERT(A.block_size(1) == (!Trans ? KR : MR));
+        TBLIS_ASSERT(KR%pack_k_group<TP>::value == 0);
 
         len_type m_a = A.length( Trans);
         len_type k_a = A.length(!Trans);
-        T* p_ap = Ap.data();
+        len_type k_p = Ap.length(!Trans);
+        TP* p_ap = Ap.data();
 
         len_type m_first, m_last, k_first, k_last;
         std::tie(m_first, m_last, std::ignore,
                  k_first, k_last, std::ignore) =
             comm.distribute_over_threads_2d(m_a, k_a, MR, KR);
 
-        p_ap += m_first*k_a + k_first*ME;
+        p_ap += (m_first/MR)*ME*k_p + k_first*ME;
 
         len_type off_m = m_first;
 
         A.length(Trans, MR);
         A.shift(Trans, off_m);
 
-        const T* p_a = A.raw_data();
+        const U* p_a = A.raw_data();
         const stride_type* cscat_a = A.scatter(!Trans) + k_first;
         const stride_type* cbs_a = A.block_scatter(!Trans) + k_first/KR;
 
@@ -179,20 +305,16 @@ struct pack_row_panel
 
             if (rs_a == 0)
             {
-                if (!Trans)
-                    cfg.pack_sb_mr_ukr.call<T>(m, k, p_a, rscat_a, cscat_a, cbs_a, p_ap);
-                else
-                    cfg.pack_sb_nr_ukr.call<T>(m, k, p_a, rscat_a, cscat_a, cbs_a, p_ap);
+                pack_sb_panel<Mat>(cfg, MR, ME, m, k, p_a, rscat_a,
+                                   cscat_a, cbs_a, p_ap, A.conj());
             }
             else
             {
-                if (!Trans)
-                    cfg.pack_nb_mr_ukr.call<T>(m, k, p_a+rscat_a[0], rs_a, cscat_a, cbs_a, p_ap);
-                else
-                    cfg.pack_nb_nr_ukr.call<T>(m, k, p_a+rscat_a[0], rs_a, cscat_a, cbs_a, p_ap);
+                pack_nb_panel<Mat>(cfg, MR, ME, KR, m, k, p_a+rscat_a[0], rs_a,
+                                   cscat_a, cbs_a, p_ap, A.conj());
             }
 
-            p_ap += ME*k_a;
+            p_ap += ME*k_p;
             A.shift_block(Trans, 1);
             off_m += MR;
         }
@@ -251,25 +373,29 @@ struct pack
         const len_type ME = (!Trans ? cfg.gemm_mr.extent<T>()
                                     : cfg.gemm_nr.extent<T>());
 
+        typedef typename std::conditional<!Trans, MatrixA, MatrixB>::type MatrixP;
+        typedef typename packed_type<T, typename MatrixP::value_type>::type TP;
+
         len_type m_p = ceil_div(!Trans ? A.length(0) : B.length(1), MR)*ME;
-        len_type k_p =         (!Trans ? A.length(1) : B.length(0));
+        len_type k_p = round_up(!Trans ? A.length(1) : B.length(0),
+                                pack_k_group<TP>::value);
 
         if (!pack_ptr)
         {
             if (comm.master())
             {
-                pack_buffer = Pool.allocate<T>(m_p*k_p+std::max(m_p,k_p)*TBLIS_MAX_UNROLL);
+                pack_buffer = Pool.allocate<TP>(m_p*k_p+std::max(m_p,k_p)*TBLIS_MAX_UNROLL);
                 pack_ptr = pack_buffer.get();
             }
 
             comm.broadcast(pack_ptr);
         }
 
-        matrix_view<T> P({!Trans ? m_p : k_p,
-                          !Trans ? k_p : m_p},
-                         static_cast<T*>(pack_ptr),
-                         {!Trans? k_p :   1,
-                          !Trans?   1 : k_p});
+        matrix_view<TP> P({!Trans ? m_p : k_p,
+                           !Trans ? k_p : m_p},
+                          static_cast<TP*>(pack_ptr),
+                          {!Trans? k_p :   1,
+                           !Trans?   1 : k_p});
 
         typedef pack_row_panel<T, Mat> Pack;
         pack_and_run<Pack, Mat>(child, comm, cfg, alpha, A, B, beta, C, P);
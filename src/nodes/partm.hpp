@@ -4,11 +4,31 @@
 #include "util/basic_types.h"
 #include "util/thread.h"
 
+#include "matrix/tensor_matrix.hpp"
+
 #include "configs/configs.hpp"
 
 namespace tblis
 {
 
+/*
+ * Swap in a new conjugation flag for C, if the matrix type carries one. C is
+ * only conjugated as it is read with the caller's beta, i.e. in the first
+ * block along k; after that C holds partial results.
+ */
+
+template <typename MatrixC>
+bool swap_conj(MatrixC&, bool)
+{
+    return false;
+}
+
+template <typename T>
+bool swap_conj(tensor_matrix<T>& C, bool conj)
+{
+    return C.conj(conj);
+}
+
 template <int Dim, blocksize config::*BS, typename Child>
 struct partition
 {
@@ -73,6 +93,7 @@ struct partition
         shift(m_off, m_off);
 
         len_type M_cur = (m_len%M_def <= M_over ? M_max : M_def);
+        bool conj_C = false;
 
         while (m_off < m_last)
         {
@@ -82,7 +103,11 @@ struct partition
             //printf("[%ld:%ld)\n", m_off, m_off+m_loc);
 
             child(subcomm, cfg, alpha, A, B, beta, C);
-            if (Dim == DIM_K) beta = 1.0;
+            if (Dim == DIM_K)
+            {
+                beta = 1.0;
+                conj_C = swap_conj(C, false) || conj_C;
+            }
 
             shift(M_cur, M_cur);
             m_off += M_cur;
@@ -91,6 +116,7 @@ struct partition
 
         shift(-m_off, -m_off);
         length(m_u, m_v);
+        if (conj_C) swap_conj(C, true);
 
         //printf("A after: %p %ld %ld %ld %ld\n", A.data(), A.length(0), A.length(1), A.stride(0), A.stride(1));
         //printf("B after: %p %ld %ld %ld %ld\n", B.data(), B.length(0), B.length(1), B.stride(0), B.stride(1));
@@ -1,6 +1,11 @@
 #ifndef _TBLIS_HPP_
 #define _TBLIS_HPP_
 
+#include "configs/configs.h"
+
+#include "memory/memory_pools.h"
+#include "memory/numa_policy.h"
+
 #include "iface/1v/add.h"
 #include "iface/1v/dot.h"
 #include "iface/1v/reduce.h"
@@ -15,6 +20,7 @@
 
 #include "iface/1t/add.h"
 #include "iface/1t/dot.h"
+#include "iface/1t/map.h"
 #include "iface/1t/reduce.h"
 #include "iface/1t/scale.h"
 #include "iface/1t/set.h"
@@ -22,5 +28,6 @@
 #include "iface/3m/mult.h"
 
 #include "iface/3t/mult.h"
+#include "iface/3t/mult_streamed.h"
 
 #endif
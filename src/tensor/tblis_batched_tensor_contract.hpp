@@ -81,18 +81,18 @@ class slot
 namespace internal
 {
 
-template <typename T>
+template <typename T, typename TA, typename TB, typename TC>
 void contract_blis(const communicator& comm, const config& cfg,
                    const std::vector<len_type>& len_AB,
                    const std::vector<len_type>& len_AC,
                    const std::vector<len_type>& len_BC,
-                   T alpha, const T* A,
+                   T alpha, const TA* A,
                    const std::vector<stride_type>& stride_A_AB,
                    const std::vector<stride_type>& stride_A_AC,
-                            const T* B,
+                            const TB* B,
                    const std::vector<stride_type>& stride_B_AB,
                    const std::vector<stride_type>& stride_B_BC,
-                   T  beta,       T* C,
+                   T  beta,       TC* C,
                    const std::vector<stride_type>& stride_C_AC,
                    const std::vector<stride_type>& stride_C_BC);
 
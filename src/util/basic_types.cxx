@@ -29,6 +29,12 @@ void tblis_init_scalar_z(tblis_scalar* s, dcomplex value)
     s->data.z = value;
 }
 
+void tblis_init_scalar_i(tblis_scalar* s, int32_t value)
+{
+    s->type = TYPE_INT32;
+    s->data.i = value;
+}
+
 void tblis_init_vector_scaled_s(tblis_vector* v, float scalar,
                                 len_type n, float* data,stride_type inc)
 {
@@ -261,6 +267,106 @@ void tblis_init_tensor_z(tblis_tensor* t,
     tblis_init_tensor_scaled_z(t, {1.0, 0.0}, ndim, len, data, stride);
 }
 
+void tblis_init_tensor_scaled_i8(tblis_tensor* t, int32_t scalar,
+                                 unsigned ndim, len_type* len, int8_t* data,
+                                 stride_type* stride)
+{
+    t->type = TYPE_INT8;
+    t->conj = 0;
+    t->scalar.data.i = scalar;
+    t->data = data;
+    t->ndim = ndim;
+    t->len = len;
+    t->stride = stride;
+}
+
+void tblis_init_tensor_scaled_i16(tblis_tensor* t, int32_t scalar,
+                                  unsigned ndim, len_type* len, int16_t* data,
+                                  stride_type* stride)
+{
+    t->type = TYPE_INT16;
+    t->conj = 0;
+    t->scalar.data.i = scalar;
+    t->data = data;
+    t->ndim = ndim;
+    t->len = len;
+    t->stride = stride;
+}
+
+void tblis_init_tensor_scaled_i32(tblis_tensor* t, int32_t scalar,
+                                  unsigned ndim, len_type* len, int32_t* data,
+                                  stride_type* stride)
+{
+    t->type = TYPE_INT32;
+    t->conj = 0;
+    t->scalar.data.i = scalar;
+    t->data = data;
+    t->ndim = ndim;
+    t->len = len;
+    t->stride = stride;
+}
+
+void tblis_init_tensor_scaled_h(tblis_tensor* t, float scalar,
+                                unsigned ndim, len_type* len, tblis_half* data,
+                                stride_type* stride)
+{
+    t->type = TYPE_HALF;
+    t->conj = 0;
+    t->scalar.data.s = scalar;
+    t->data = data;
+    t->ndim = ndim;
+    t->len = len;
+    t->stride = stride;
+}
+
+void tblis_init_tensor_scaled_b(tblis_tensor* t, float scalar,
+                                unsigned ndim, len_type* len, tblis_bfloat16* data,
+                                stride_type* stride)
+{
+    t->type = TYPE_BFLOAT16;
+    t->conj = 0;
+    t->scalar.data.s = scalar;
+    t->data = data;
+    t->ndim = ndim;
+    t->len = len;
+    t->stride = stride;
+}
+
+void tblis_init_tensor_i8(tblis_tensor* t,
+                          unsigned ndim, len_type* len, int8_t* data,
+                          stride_type* stride)
+{
+    tblis_init_tensor_scaled_i8(t, 1, ndim, len, data, stride);
+}
+
+void tblis_init_tensor_i16(tblis_tensor* t,
+                           unsigned ndim, len_type* len, int16_t* data,
+                           stride_type* stride)
+{
+    tblis_init_tensor_scaled_i16(t, 1, ndim, len, data, stride);
+}
+
+void tblis_init_tensor_i32(tblis_tensor* t,
+                           unsigned ndim, len_type* len, int32_t* data,
+                           stride_type* stride)
+{
+    tblis_init_tensor_scaled_i32(t, 1, ndim, len, data, stride);
+}
+
+void tblis_init_tensor_h(tblis_tensor* t,
+                         unsigned ndim, len_type* len, tblis_half* data,
+                         stride_type* stride)
+{
+    tblis_init_tensor_scaled_h(t, 1.0f, ndim, len, data, stride);
+}
+
+void tblis_init_tensor_b(tblis_tensor* t,
+                         unsigned ndim, len_type* len, tblis_bfloat16* data,
+                         stride_type* stride)
+{
+    tblis_init_tensor_scaled_b(t, 1.0f, ndim, len, data, stride);
+}
+
 #ifdef __cplusplus
 }
 }
@@ -24,11 +24,16 @@
 
 #include "../external/stl_ext/include/complex.hpp"
 
+#include "half.hpp"
+
 #define MARRAY_DEFAULT_LAYOUT COLUMN_MAJOR
 #undef assert
 #define assert TBLIS_ASSERT
 #include "../external/marray/include/varray.hpp"
 #include "../external/marray/include/marray.hpp"
+#if TBLIS_HAVE_SYS_MMAN_H
+#include "../external/marray/include/mapped_varray.hpp"
+#endif
 
 #endif
 
@@ -57,7 +62,12 @@ typedef enum
     TYPE_FLOAT    = TYPE_SINGLE,
     TYPE_DOUBLE   = 1,
     TYPE_SCOMPLEX = 2,
-    TYPE_DCOMPLEX = 3
+    TYPE_DCOMPLEX = 3,
+    TYPE_INT8     = 4,
+    TYPE_INT16    = 5,
+    TYPE_INT32    = 6,
+    TYPE_HALF     = 7,
+    TYPE_BFLOAT16 = 8
 } type_t;
 
 typedef TBLIS_LEN_TYPE len_type;
@@ -84,6 +94,32 @@ typedef fake_dcomplex dcomplex;
 
 #endif
 
+/*
+ * 16-bit floating point storage types. Arithmetic on these is done in float.
+ */
+
+typedef struct tblis_half
+{
+    uint16_t bits;
+
+#if defined(__cplusplus) && !defined(TBLIS_DONT_USE_CXX11)
+    tblis_half() = default;
+    tblis_half(float f) : bits(detail::float_to_half(f)) {}
+    operator float() const { return detail::half_to_float(bits); }
+#endif
+} tblis_half;
+
+typedef struct tblis_bfloat16
+{
+    uint16_t bits;
+
+#if defined(__cplusplus) && !defined(TBLIS_DONT_USE_CXX11)
+    tblis_bfloat16() = default;
+    tblis_bfloat16(float f) : bits(detail::float_to_bfloat16(f)) {}
+    operator float() const { return detail::bfloat16_to_float(bits); }
+#endif
+} tblis_bfloat16;
+
 #if defined(__cplusplus) && !defined(TBLIS_DONT_USE_CXX11)
 
 template <typename T> struct type_tag;
@@ -91,6 +127,23 @@ template <> struct type_tag<   float> { static constexpr type_t value =    TYPE_
 template <> struct type_tag<  double> { static constexpr type_t value =   TYPE_DOUBLE; };
 template <> struct type_tag<scomplex> { static constexpr type_t value = TYPE_SCOMPLEX; };
 template <> struct type_tag<dcomplex> { static constexpr type_t value = TYPE_DCOMPLEX; };
+template <> struct type_tag<  int8_t> { static constexpr type_t value =     TYPE_INT8; };
+template <> struct type_tag< int16_t> { static constexpr type_t value =    TYPE_INT16; };
+template <> struct type_tag< int32_t> { static constexpr type_t value =    TYPE_INT32; };
+template <> struct type_tag<    tblis_half> { static constexpr type_t value =     TYPE_HALF; };
+template <> struct type_tag<tblis_bfloat16> { static constexpr type_t value = TYPE_BFLOAT16; };
+
+/*
+ * Type of the scalar factor (and of the arithmetic) for tensors stored as T.
+ */
+template <typename T> struct scalar_type { typedef T type; };
+template <> struct scalar_type< int8_t> { typedef int32_t type; };
+template <> struct scalar_type<int16_t> { typedef int32_t type; };
+template <> struct scalar_type<    tblis_half> { typedef float type; };
+template <> struct scalar_type<tblis_bfloat16> { typedef float type; };
+
+template <typename T>
+using scalar_type_t = typename scalar_type<T>::type;
 
 struct single_t
 {
@@ -117,6 +170,15 @@ T conj(bool conjugate, T val)
     return (conjugate ? conj(val) : val);
 }
 
+/*
+ * Lengths and strides which are only needed for the duration of a call,
+ * and which are kept on the stack for tensors of up to MARRAY_OPT_NDIM
+ * dimensions.
+ */
+using MArray::dim_vector;
+typedef dim_vector<len_type> len_vector;
+typedef dim_vector<stride_type> stride_vector;
+
 template <typename T>
 using const_tensor_view = MArray::const_varray_view<T>;
 
@@ -126,6 +188,18 @@ using tensor_view = MArray::varray_view<T>;
 template <typename T, typename Allocator=aligned_allocator<T,64>>
 using tensor = MArray::varray<T, Allocator>;
 
+#if TBLIS_HAVE_SYS_MMAN_H
+
+using MArray::Access;
+using MArray::READ_ONLY;
+using MArray::READ_WRITE;
+using MArray::will_need;
+
+template <typename T, Access A=READ_ONLY>
+using mapped_tensor = MArray::mapped_varray<T, A>;
+
+#endif
+
 using MArray::const_marray_view;
 using MArray::marray_view;
 
@@ -179,12 +253,14 @@ typedef struct tblis_scalar
         scomplex c;
         dcomplex z;
 #endif
-        
+        int32_t i;
+
 #if defined(__cplusplus) && !defined(TBLIS_DONT_USE_CXX11)
         scalar(float    v) : s(v) {}
         scalar(double   v) : d(v) {}
         scalar(scomplex v) : c(v) {}
         scalar(dcomplex v) : z(v) {}
+        scalar(int32_t  v) : i(v) {}
 #endif
     } data;
     type_t type;
@@ -236,6 +312,9 @@ scomplex& tblis_scalar::get<scomplex>() { return data.c; }
 template <> inline
 dcomplex& tblis_scalar::get<dcomplex>() { return data.z; }
 
+template <> inline
+int32_t& tblis_scalar::get<int32_t>() { return data.i; }
+
 #endif
 
 #ifdef __cplusplus
@@ -251,6 +330,8 @@ void tblis_init_scalar_c(tblis_scalar* s, scomplex value);
 
 void tblis_init_scalar_z(tblis_scalar* s, dcomplex value);
 
+void tblis_init_scalar_i(tblis_scalar* s, int32_t value);
+
 #ifdef __cplusplus
 }
 #endif
@@ -480,28 +561,28 @@ typedef struct tblis_tensor
       stride(nullptr) {}
 
     template <typename T>
-    tblis_tensor(const_tensor_view<T>& view)
+    tblis_tensor(const const_tensor_view<T>& view)
     : type(type_tag<T>::value), conj(false), data(static_cast<void*>(const_cast<T*>(view.data()))),
       ndim(view.dimension()), len(const_cast<len_type*>(view.lengths().data())),
-      stride(const_cast<stride_type*>(view.strides().data())), scalar(T(1)) {}
+      stride(const_cast<stride_type*>(view.strides().data())), scalar(scalar_type_t<T>(1)) {}
 
     template <typename T>
     tblis_tensor(tensor_view<T>& view)
     : type(type_tag<T>::value), conj(false), data(static_cast<void*>(view.data())),
       ndim(view.dimension()), len(const_cast<len_type*>(view.lengths().data())),
-      stride(const_cast<stride_type*>(view.strides().data())), scalar(T(1)) {}
+      stride(const_cast<stride_type*>(view.strides().data())), scalar(scalar_type_t<T>(1)) {}
 
     template <typename T>
-    tblis_tensor(T alpha, const_tensor_view<T>& view)
+    tblis_tensor(T alpha, const const_tensor_view<T>& view)
     : type(type_tag<T>::value), conj(false), data(static_cast<void*>(const_cast<T*>(view.data()))),
       ndim(view.dimension()), len(const_cast<len_type*>(view.lengths().data())),
-      stride(const_cast<stride_type*>(view.strides().data())), scalar(alpha) {}
+      stride(const_cast<stride_type*>(view.strides().data())), scalar(scalar_type_t<T>(alpha)) {}
 
     template <typename T>
     tblis_tensor(T alpha, tensor_view<T>& view)
     : type(type_tag<T>::value), conj(false), data(static_cast<void*>(view.data())),
       ndim(view.dimension()), len(const_cast<len_type*>(view.lengths().data())),
-      stride(const_cast<stride_type*>(view.strides().data())), scalar(alpha) {}
+      stride(const_cast<stride_type*>(view.strides().data())), scalar(scalar_type_t<T>(alpha)) {}
 
     template <typename T>
     T& alpha()
@@ -573,6 +654,58 @@ void tblis_init_tensor_z(tblis_tensor* t,
                          unsigned ndim, len_type* len, dcomplex* data,
                          stride_type* stride);
 
+/*
+ * Integer tensors always carry an int32_t scalar, and may only be used as
+ * A and B (with C stored as int32_t) in tblis_tensor_mult.
+ */
+
+void tblis_init_tensor_scaled_i8(tblis_tensor* t, int32_t scalar,
+                                 unsigned ndim, len_type* len, int8_t* data,
+                                 stride_type* stride);
+
+void tblis_init_tensor_scaled_i16(tblis_tensor* t, int32_t scalar,
+                                  unsigned ndim, len_type* len, int16_t* data,
+                                  stride_type* stride);
+
+void tblis_init_tensor_scaled_i32(tblis_tensor* t, int32_t scalar,
+                                  unsigned ndim, len_type* len, int32_t* data,
+                                  stride_type* stride);
+
+void tblis_init_tensor_i8(tblis_tensor* t,
+                          unsigned ndim, len_type* len, int8_t* data,
+                          stride_type* stride);
+
+void tblis_init_tensor_i16(tblis_tensor* t,
+                           unsigned ndim, len_type* len, int16_t* data,
+                           stride_type* stride);
+
+void tblis_init_tensor_i32(tblis_tensor* t,
+                           unsigned ndim, len_type* len, int32_t* data,
+                           stride_type* stride);
+
+/*
+ * Half-precision and bfloat16 tensors carry a float scalar. They are widened
+ * to float when loaded and rounded once when stored, so the 1t operations
+ * and tblis_tensor_mult compute in float; reduce and dot results are floats
+ * in a scalar of the tensor's type.
+ */
+
+void tblis_init_tensor_scaled_h(tblis_tensor* t, float scalar,
+                                unsigned ndim, len_type* len, tblis_half* data,
+                                stride_type* stride);
+
+void tblis_init_tensor_scaled_b(tblis_tensor* t, float scalar,
+                                unsigned ndim, len_type* len, tblis_bfloat16* data,
+                                stride_type* stride);
+
+void tblis_init_tensor_h(tblis_tensor* t,
+                         unsigned ndim, len_type* len, tblis_half* data,
+                         stride_type* stride);
+
+void tblis_init_tensor_b(tblis_tensor* t,
+                         unsigned ndim, len_type* len, tblis_bfloat16* data,
+                         stride_type* stride);
+
 #ifdef __cplusplus
 }
 #endif
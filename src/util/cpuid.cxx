@@ -1,5 +1,7 @@
 #include "cpuid.hpp"
 
+#include <unistd.h>
+
 #if defined(__x86_64__) || defined(_M_X64) || defined(__i386) || defined(_M_IX86)
 
 namespace tblis
@@ -191,6 +193,161 @@ int get_cpu_type(int& family, int& model, int& features)
         return VENDOR_UNKNOWN;
 }
 
+
+/*
+ * Walk the deterministic cache parameter leaf (4 on Intel, 0x8000001D on AMD)
+ * and return the size of the data or unified cache at the given level, or of
+ * the highest-level one if level is 0.
+ */
+static long get_cache_size_from_leaf(unsigned leaf, unsigned want_level = 0)
+{
+    uint32_t eax, ebx, ecx, edx;
+
+    long size = 0;
+    unsigned max_level = 0;
+
+    for (unsigned i = 0;;i++)
+    {
+        __cpuid_count(leaf, i, eax, ebx, ecx, edx);
+
+        unsigned type = eax & 0x1f;
+        if (type == 0) break;
+        if (type == 2) continue; // instruction cache
+
+        unsigned level = (eax >> 5) & 0x7;
+        long ways = ((ebx >> 22) & 0x3ff) + 1;
+        long partitions = ((ebx >> 12) & 0x3ff) + 1;
+        long line_size = (ebx & 0xfff) + 1;
+        long sets = long(ecx) + 1;
+
+        if (want_level ? level == want_level : level >= max_level)
+        {
+            max_level = level;
+            size = ways*partitions*line_size*sets;
+        }
+    }
+
+    return size;
+}
+
+long get_llc_size()
+{
+    uint32_t eax, ebx, ecx, edx;
+
+    unsigned cpuid_max = __get_cpuid_max(0, 0);
+    unsigned cpuid_max_ext = __get_cpuid_max(0x80000000u, 0);
+
+    if (cpuid_max < 1) return 0;
+
+    uint32_t vendor_string[4] = {0};
+    __cpuid(0, eax, vendor_string[0],
+                    vendor_string[2],
+                    vendor_string[1]);
+
+    if (strcmp(reinterpret_cast<char*>(&vendor_string[0]), "GenuineIntel") == 0)
+    {
+        if (cpuid_max >= 4) return get_cache_size_from_leaf(4);
+    }
+    else if (strcmp(reinterpret_cast<char*>(&vendor_string[0]), "AuthenticAMD") == 0)
+    {
+        if (cpuid_max_ext >= 0x8000001Du)
+        {
+            __cpuid(0x80000001u, eax, ebx, ecx, edx);
+            if (ecx & (1u<<22)) // topology extensions
+                return get_cache_size_from_leaf(0x8000001Du);
+        }
+
+        if (cpuid_max_ext >= 0x80000006u)
+        {
+            __cpuid(0x80000006u, eax, ebx, ecx, edx);
+            long l3 = long(edx >> 18)*512*1024; // EDX[31:18] in 512 KiB units
+            long l2 = long(ecx >> 16)*1024; // ECX[31:16] in KiB
+            return (l3 > 0 ? l3 : l2);
+        }
+    }
+
+    return 0;
+}
+
+long get_l1d_size()
+{
+    uint32_t eax, ebx, ecx, edx;
+
+    unsigned cpuid_max = __get_cpuid_max(0, 0);
+    unsigned cpuid_max_ext = __get_cpuid_max(0x80000000u, 0);
+
+    if (cpuid_max < 1) return 0;
+
+    uint32_t vendor_string[4] = {0};
+    __cpuid(0, eax, vendor_string[0],
+                    vendor_string[2],
+                    vendor_string[1]);
+
+    if (strcmp(reinterpret_cast<char*>(&vendor_string[0]), "GenuineIntel") == 0)
+    {
+        if (cpuid_max >= 4) return get_cache_size_from_leaf(4, 1);
+    }
+    else if (strcmp(reinterpret_cast<char*>(&vendor_string[0]), "AuthenticAMD") == 0)
+    {
+        if (cpuid_max_ext >= 0x80000005u)
+        {
+            __cpuid(0x80000005u, eax, ebx, ecx, edx);
+            return long(ecx >> 24)*1024; // ECX[31:24] in KiB
+        }
+    }
+
+    return 0;
+}
+
+long get_dtlb_entries()
+{
+    uint32_t eax, ebx, ecx, edx;
+
+    unsigned cpuid_max = __get_cpuid_max(0, 0);
+    unsigned cpuid_max_ext = __get_cpuid_max(0x80000000u, 0);
+
+    if (cpuid_max < 1) return 0;
+
+    uint32_t vendor_string[4] = {0};
+    __cpuid(0, eax, vendor_string[0],
+                    vendor_string[2],
+                    vendor_string[1]);
+
+    if (strcmp(reinterpret_cast<char*>(&vendor_string[0]), "GenuineIntel") == 0)
+    {
+        if (cpuid_max < 0x18) return 0;
+
+        /*
+         * Deterministic address translation parameters: look for the
+         * first-level data (or unified) TLB which holds 4 KiB pages.
+         */
+        __cpuid_count(0x18, 0, eax, ebx, ecx, edx);
+        unsigned max_subleaf = eax;
+
+        for (unsigned i = 0;i <= max_subleaf;i++)
+        {
+            __cpuid_count(0x18, i, eax, ebx, ecx, edx);
+
+            unsigned type = edx & 0x1f;
+            unsigned level = (edx >> 5) & 0x7;
+            if (type != 1 && type != 3 && type != 4) continue; // data, unified or load
+            if (level != 1 || !(ebx & 1)) continue; // L1, 4 KiB pages
+
+            return long(ebx >> 16)*long(ecx); // ways*sets
+        }
+    }
+    else if (strcmp(reinterpret_cast<char*>(&vendor_string[0]), "AuthenticAMD") == 0)
+    {
+        if (cpuid_max_ext >= 0x80000005u)
+        {
+            __cpuid(0x80000005u, eax, ebx, ecx, edx);
+            return long((ebx >> 16) & 0xff); // EBX[23:16]
+        }
+    }
+
+    return 0;
+}
+
 }
 
 #elif defined(__aarch64__) || defined(__arm__) || defined(_M_ARM)
@@ -198,6 +355,33 @@ int get_cpu_type(int& family, int& model, int& features)
 namespace tblis
 {
 
+long get_llc_size()
+{
+    #ifdef _SC_LEVEL3_CACHE_SIZE
+    long l3 = sysconf(_SC_LEVEL3_CACHE_SIZE);
+    if (l3 > 0) return l3;
+    #endif
+    #ifdef _SC_LEVEL2_CACHE_SIZE
+    long l2 = sysconf(_SC_LEVEL2_CACHE_SIZE);
+    if (l2 > 0) return l2;
+    #endif
+    return 0;
+}
+
+long get_l1d_size()
+{
+    #ifdef _SC_LEVEL1_DCACHE_SIZE
+    long l1 = sysconf(_SC_LEVEL1_DCACHE_SIZE);
+    if (l1 > 0) return l1;
+    #endif
+    return 0;
+}
+
+long get_dtlb_entries()
+{
+    return 0;
+}
+
 int get_cpu_type(int& model, int& part, int& features)
 {
     model = MODEL_UNKNOWN;
@@ -247,4 +431,37 @@ int get_cpu_type(int& model, int& part, int& features)
 
 }
 
+#else
+
+namespace tblis
+{
+
+long get_llc_size()
+{
+    return 0;
+}
+
+long get_l1d_size()
+{
+    return 0;
+}
+
+long get_dtlb_entries()
+{
+    return 0;
+}
+
+}
+
 #endif
+
+namespace tblis
+{
+
+long get_page_size()
+{
+    long page = sysconf(_SC_PAGESIZE);
+    return (page > 0 ? page : 0);
+}
+
+}
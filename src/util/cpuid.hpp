@@ -52,4 +52,33 @@ int get_cpu_type(int& model, int& part, int& features);
 
 #endif
 
+namespace tblis
+{
+
+/*
+ * Size in bytes of the largest (last-level) data or unified cache, or 0 if it
+ * cannot be determined.
+ */
+long get_llc_size();
+
+/*
+ * Size in bytes of the first-level data cache, or 0 if it cannot be
+ * determined.
+ */
+long get_l1d_size();
+
+/*
+ * Number of 4 KiB-page entries in the first-level data TLB, or 0 if it cannot
+ * be determined.
+ */
+long get_dtlb_entries();
+
+/*
+ * Size in bytes of a (base) virtual memory page, or 0 if it cannot be
+ * determined.
+ */
+long get_page_size();
+
+}
+
 #endif
@@ -0,0 +1,113 @@
+#ifndef _TBLIS_HALF_HPP_
+#define _TBLIS_HALF_HPP_
+
+#include <stdint.h>
+#include <string.h>
+
+namespace tblis
+{
+namespace detail
+{
+
+/*
+ * IEEE binary16 <-> binary32 conversion with round-to-nearest-even, handling
+ * subnormals, infinities, and NaNs. These are plain integer/float operations
+ * so that they work for any target.
+ */
+
+inline uint16_t float_to_half(float f)
+{
+    const uint32_t f32_inf = 255u << 23;
+    const uint32_t f16_max = (127u + 16) << 23;
+    const uint32_t denorm_magic = ((127u - 15) + (23 - 10) + 1) << 23;
+
+    uint32_t u;
+    memcpy(&u, &f, sizeof(u));
+
+    uint32_t sign = u & 0x80000000u;
+    u ^= sign;
+
+    uint16_t h;
+
+    if (u >= f16_max)
+    {
+        h = (u > f32_inf ? 0x7e00 : 0x7c00);
+    }
+    else if (u < (113u << 23))
+    {
+        float a, magic;
+        memcpy(&a, &u, sizeof(a));
+        memcpy(&magic, &denorm_magic, sizeof(magic));
+        a += magic;
+        memcpy(&u, &a, sizeof(u));
+        h = static_cast<uint16_t>(u - denorm_magic);
+    }
+    else
+    {
+        uint32_t mant_odd = (u >> 13) & 1;
+        u += ((uint32_t)(15 - 127) << 23) + 0xfff + mant_odd;
+        h = static_cast<uint16_t>(u >> 13);
+    }
+
+    return static_cast<uint16_t>(h | (sign >> 16));
+}
+
+inline float half_to_float(uint16_t h)
+{
+    const uint32_t shifted_exp = 0x7c00u << 13;
+    const uint32_t denorm_magic = 113u << 23;
+
+    uint32_t u = (h & 0x7fffu) << 13;
+    uint32_t exp = u & shifted_exp;
+    u += (127u - 15) << 23;
+
+    if (exp == shifted_exp)
+    {
+        u += (128u - 16) << 23;
+    }
+    else if (exp == 0)
+    {
+        float a, magic;
+        u += 1u << 23;
+        memcpy(&a, &u, sizeof(a));
+        memcpy(&magic, &denorm_magic, sizeof(magic));
+        a -= magic;
+        memcpy(&u, &a, sizeof(u));
+    }
+
+    u |= (uint32_t)(h & 0x8000u) << 16;
+
+    float f;
+    memcpy(&f, &u, sizeof(f));
+    return f;
+}
+
+/*
+ * bfloat16 is the upper half of a binary32, so only rounding is needed.
+ */
+
+inline uint16_t float_to_bfloat16(float f)
+{
+    uint32_t u;
+    memcpy(&u, &f, sizeof(u));
+
+    if ((u & 0x7fffffffu) > 0x7f800000u)
+        return static_cast<uint16_t>((u >> 16) | 0x40);
+
+    u += 0x7fff + ((u >> 16) & 1);
+    return static_cast<uint16_t>(u >> 16);
+}
+
+inline float bfloat16_to_float(uint16_t b)
+{
+    uint32_t u = (uint32_t)b << 16;
+
+    float f;
+    memcpy(&f, &u, sizeof(f));
+    return f;
+}
+
+}
+}
+
+#endif
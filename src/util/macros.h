@@ -27,6 +27,99 @@ else \
     TBLIS_ASSERT(0, "Unknown type"); \
 }
 
+/*
+ * Storage types of A/B and C for which contraction is computed in a different
+ * (wider) type T, or for which A/B and C differ. T is always the widest of
+ * the storage types or the accumulation type of a narrow type.
+ */
+#define TBLIS_WITH_MIXED_TYPES_AS(type_AB, type_C, T, TAB, TC, ...) \
+if ((type_AB) == TYPE_INT8 && (type_C) == TYPE_INT32) \
+{ \
+    typedef int32_t T; typedef int8_t TAB; typedef int32_t TC; \
+    __VA_ARGS__ \
+} \
+else if ((type_AB) == TYPE_INT16 && (type_C) == TYPE_INT32) \
+{ \
+    typedef int32_t T; typedef int16_t TAB; typedef int32_t TC; \
+    __VA_ARGS__ \
+} \
+else if ((type_AB) == TYPE_INT32 && (type_C) == TYPE_INT32) \
+{ \
+    typedef int32_t T; typedef int32_t TAB; typedef int32_t TC; \
+    __VA_ARGS__ \
+} \
+else if ((type_AB) == TYPE_FLOAT && (type_C) == TYPE_DOUBLE) \
+{ \
+    typedef double T; typedef float TAB; typedef double TC; \
+    __VA_ARGS__ \
+} \
+else if ((type_AB) == TYPE_DOUBLE && (type_C) == TYPE_FLOAT) \
+{ \
+    typedef double T; typedef double TAB; typedef float TC; \
+    __VA_ARGS__ \
+} \
+else if ((type_AB) == TYPE_SCOMPLEX && (type_C) == TYPE_DCOMPLEX) \
+{ \
+    typedef dcomplex T; typedef scomplex TAB; typedef dcomplex TC; \
+    __VA_ARGS__ \
+} \
+else if ((type_AB) == TYPE_DCOMPLEX && (type_C) == TYPE_SCOMPLEX) \
+{ \
+    typedef dcomplex T; typedef dcomplex TAB; typedef scomplex TC; \
+    __VA_ARGS__ \
+} \
+else if ((type_AB) == TYPE_HALF && (type_C) == TYPE_HALF) \
+{ \
+    typedef float T; typedef tblis_half TAB; typedef tblis_half TC; \
+    __VA_ARGS__ \
+} \
+else if ((type_AB) == TYPE_BFLOAT16 && (type_C) == TYPE_BFLOAT16) \
+{ \
+    typedef float T; typedef tblis_bfloat16 TAB; typedef tblis_bfloat16 TC; \
+    __VA_ARGS__ \
+} \
+else \
+{ \
+    TBLIS_ASSERT(0, "Unsupported combination of types"); \
+}
+
+/*
+ * Storage types TS which are computed in the wider type T outside of
+ * tblis_tensor_mult. Their scalars are of type T.
+ */
+#define TBLIS_IS_NARROW_TYPE(type) \
+((type) == TYPE_HALF || (type) == TYPE_BFLOAT16)
+
+#define TBLIS_WITH_NARROW_TYPE_AS(type, T, TS, ...) \
+if ((type) == TYPE_HALF) \
+{ \
+    typedef float T; typedef tblis_half TS; \
+    __VA_ARGS__ \
+} \
+else if ((type) == TYPE_BFLOAT16) \
+{ \
+    typedef float T; typedef tblis_bfloat16 TS; \
+    __VA_ARGS__ \
+} \
+else \
+{ \
+    TBLIS_ASSERT(0, "Unknown type"); \
+}
+
+/*
+ * Like TBLIS_WITH_TYPE_AS, but also for the narrow types, where TS is the
+ * storage type and T the compute type. Otherwise TS is T.
+ */
+#define TBLIS_WITH_STORAGE_TYPE_AS(type, T, TS, ...) \
+if (TBLIS_IS_NARROW_TYPE(type)) \
+{ \
+    TBLIS_WITH_NARROW_TYPE_AS(type, T, TS, __VA_ARGS__) \
+} \
+else \
+{ \
+    TBLIS_WITH_TYPE_AS(type, T, typedef T TS; __VA_ARGS__) \
+}
+
 #define TBLIS_SPECIAL_CASE(condition, ...) \
 if (condition) { __VA_ARGS__ } \
 else           { __VA_ARGS__ }
@@ -1,13 +1,14 @@
 #ifndef _TBLIS_UTIL_TENSOR_HPP_
 #define _TBLIS_UTIL_TENSOR_HPP_
 
-#include "util/basic_types.h"
-#include "util/assert.h"
+#include "basic_types.h"
+#include "assert.h"
 
-#include "external/stl_ext/include/algorithm.hpp"
-#include "external/stl_ext/include/type_traits.hpp"
-#include "external/stl_ext/include/vector.hpp"
+#include "../external/stl_ext/include/algorithm.hpp"
+#include "../external/stl_ext/include/type_traits.hpp"
+#include "../external/stl_ext/include/vector.hpp"
 
+#include <cstdlib>
 #include <initializer_list>
 #include <string>
 
@@ -37,9 +38,9 @@ inline sort_by_idx_helper sort_by_idx(const label_type* idx)
 template <unsigned N>
 struct sort_by_stride_helper
 {
-    std::array<const std::vector<stride_type>*, N> strides;
+    std::array<const stride_type*, N> strides;
 
-    sort_by_stride_helper(std::initializer_list<const std::vector<stride_type>*> ilist)
+    sort_by_stride_helper(std::initializer_list<const stride_type*> ilist)
     {
         TBLIS_ASSERT(ilist.size() == N);
         std::copy_n(ilist.begin(), N, strides.begin());
@@ -49,8 +50,8 @@ struct sort_by_stride_helper
     {
         for (size_t k = 0;k < N;k++)
         {
-            auto s_i = (*strides[k])[i];
-            auto s_j = (*strides[k])[j];
+            auto s_i = strides[k][i];
+            auto s_j = strides[k][j];
             if (s_i < s_j) return true;
             if (s_i > s_j) return false;
         }
@@ -70,10 +71,11 @@ size_t check_sizes(const T& arg, const Ts&... args)
 }
 
 template <typename... Strides>
-std::vector<unsigned> sort_by_stride(const Strides&... strides)
+dim_vector<unsigned> sort_by_stride(const Strides&... strides)
 {
-    std::vector<unsigned> idx = MArray::range(static_cast<unsigned>(check_sizes(strides...)));
-    std::sort(idx.begin(), idx.end(), sort_by_stride_helper<sizeof...(Strides)>{&strides...});
+    auto range = MArray::range(static_cast<unsigned>(check_sizes(strides...)));
+    dim_vector<unsigned> idx(range.begin(), range.end());
+    std::sort(idx.begin(), idx.end(), sort_by_stride_helper<sizeof...(Strides)>{strides.data()...});
     return idx;
 }
 
@@ -110,10 +112,9 @@ bool are_congruent_along(const const_tensor_view<T>& A,
     return true;
 }
 
-inline bool are_compatible(const std::vector<len_type>& len_A,
-                           const std::vector<stride_type>& stride_A,
-                           const std::vector<len_type>& len_B,
-                           const std::vector<stride_type>& stride_B)
+template <typename LenA, typename StrideA, typename LenB, typename StrideB>
+bool are_compatible(const LenA& len_A, const StrideA& stride_A,
+                    const LenB& len_B, const StrideB& stride_B)
 {
     TBLIS_ASSERT(len_A.size() == stride_A.size());
     auto dims_A = detail::sort_by_stride(stride_A);
@@ -148,68 +149,53 @@ bool are_compatible(const const_tensor_view<T>& A,
 }
 
 template <size_t I, size_t N, typename... Strides>
-struct swap_strides_helper
+struct save_strides_helper
 {
-    swap_strides_helper(std::tuple<Strides&...>& strides,
-                        std::tuple<Strides...>& oldstrides)
+    save_strides_helper(std::tuple<Strides&...>& strides,
+                        std::array<stride_vector,N>& oldstrides)
     {
-        std::get<I>(strides).swap(std::get<I>(oldstrides));
-        swap_strides_helper<I+1, N, Strides...>(strides, oldstrides);
+        auto& stride = std::get<I>(strides);
+        oldstrides[I].assign(stride.begin(), stride.end());
+        stride.clear();
+        save_strides_helper<I+1, N, Strides...>(strides, oldstrides);
     }
 };
 
 template <size_t N, typename... Strides>
-struct swap_strides_helper<N, N, Strides...>
+struct save_strides_helper<N, N, Strides...>
 {
-    swap_strides_helper(std::tuple<Strides&...>&,
-                        std::tuple<Strides...>&) {}
+    save_strides_helper(std::tuple<Strides&...>&,
+                        std::array<stride_vector,N>&) {}
 };
 
+/*
+ * Move the strides into oldstrides, leaving the (still allocated) originals
+ * empty.
+ */
 template <typename... Strides>
-void swap_strides(std::tuple<Strides&...>& strides,
-                  std::tuple<Strides...>& oldstrides)
+void save_strides(std::tuple<Strides&...>& strides,
+                  std::array<stride_vector,sizeof...(Strides)>& oldstrides)
 {
-    swap_strides_helper<0, sizeof...(Strides), Strides...>(strides, oldstrides);
+    save_strides_helper<0, sizeof...(Strides), Strides...>(strides, oldstrides);
 }
 
-template <size_t I, size_t N, typename... Strides>
-struct are_contiguous_helper
-{
-    bool operator()(std::tuple<Strides...>& strides,
-                    const std::vector<len_type>& lengths,
-                    unsigned i, unsigned im1)
-    {
-        return std::get<I>(strides)[i] == std::get<I>(strides)[im1]*lengths[im1] &&
-            are_contiguous_helper<I+1, N, Strides...>()(strides, lengths, i, im1);
-    }
-};
-
-template <size_t N, typename... Strides>
-struct are_contiguous_helper<N, N, Strides...>
-{
-    bool operator()(std::tuple<Strides...>&,
-                    const std::vector<len_type>&,
-                    unsigned, unsigned)
-    {
-        return true;
-    }
-};
-
-template <typename... Strides>
-bool are_contiguous(std::tuple<Strides...>& strides,
-                    const std::vector<len_type>& lengths,
+template <size_t N>
+bool are_contiguous(const std::array<stride_vector,N>& strides,
+                    const len_vector& lengths,
                     unsigned i, unsigned im1)
 {
-    return are_contiguous_helper<0, sizeof...(Strides), Strides...>()(strides, lengths, i, im1);
+    for (auto& stride : strides)
+        if (stride[i] != stride[im1]*lengths[im1]) return false;
+    return true;
 }
 
 template <size_t I, size_t N, typename... Strides>
 struct push_back_strides_helper
 {
     push_back_strides_helper(std::tuple<Strides&...>& strides,
-                             std::tuple<Strides...>& oldstrides, unsigned i)
+                             const std::array<stride_vector,N>& oldstrides, unsigned i)
     {
-        std::get<I>(strides).push_back(std::get<I>(oldstrides)[i]);
+        std::get<I>(strides).push_back(oldstrides[I][i]);
         push_back_strides_helper<I+1, N, Strides...>(strides, oldstrides, i);
     }
 };
@@ -218,75 +204,125 @@ template <size_t N, typename... Strides>
 struct push_back_strides_helper<N, N, Strides...>
 {
     push_back_strides_helper(std::tuple<Strides&...>&,
-                             std::tuple<Strides...>&, unsigned) {}
+                             const std::array<stride_vector,N>&, unsigned) {}
 };
 
 template <typename... Strides>
 void push_back_strides(std::tuple<Strides&...>& strides,
-                       std::tuple<Strides...>& oldstrides, unsigned i)
+                       const std::array<stride_vector,sizeof...(Strides)>& oldstrides,
+                       unsigned i)
 {
     push_back_strides_helper<0, sizeof...(Strides), Strides...>(strides, oldstrides, i);
 }
 
 template <size_t I, size_t N, typename... Strides>
-struct are_compatible_helper
+struct are_all_compatible_helper
 {
-    bool operator()(const std::vector<len_type>& len_A,
-                    const std::tuple<Strides...>& stride_A,
-                    const std::vector<len_type>& len_B,
+    template <typename LenB>
+    bool operator()(const len_vector& len_A,
+                    const std::array<stride_vector,N>& stride_A,
+                    const LenB& len_B,
                     const std::tuple<Strides&...>& stride_B)
     {
-        return are_compatible(len_A, std::get<I>(stride_A),
+        return are_compatible(len_A, stride_A[I],
                               len_B, std::get<I>(stride_B)) &&
-            are_compatible_helper<I+1, N, Strides...>()(len_A, stride_A,
-                                                        len_B, stride_B);
+            are_all_compatible_helper<I+1, N, Strides...>()(len_A, stride_A,
+                                                            len_B, stride_B);
     }
 };
 
 template <size_t N, typename... Strides>
-struct are_compatible_helper<N, N, Strides...>
+struct are_all_compatible_helper<N, N, Strides...>
 {
-    bool operator()(const std::vector<len_type>&,
-                    const std::tuple<Strides...>&,
-                    const std::vector<len_type>&,
+    template <typename LenB>
+    bool operator()(const len_vector&,
+                    const std::array<stride_vector,N>&,
+                    const LenB&,
                     const std::tuple<Strides&...>&)
     {
         return true;
     }
 };
 
-template <typename... Strides>
-bool are_compatible(const std::vector<len_type>& len_A,
-                    const std::tuple<Strides...>& stride_A,
-                    const std::vector<len_type>& len_B,
-                    const std::tuple<Strides&...>& stride_B)
+template <typename LenB, typename... Strides>
+bool are_all_compatible(const len_vector& len_A,
+                        const std::array<stride_vector,sizeof...(Strides)>& stride_A,
+                        const LenB& len_B,
+                        const std::tuple<Strides&...>& stride_B)
 {
-    return are_compatible_helper<0, sizeof...(Strides), Strides...>()(
+    return are_all_compatible_helper<0, sizeof...(Strides), Strides...>()(
         len_A, stride_A, len_B, stride_B);
 }
 
 }
 
-template <typename... Strides>
-void fold(std::vector<len_type>& lengths, std::vector<label_type>& idx,
-          Strides&... _strides)
+template <typename Lengths, typename Idx, typename... Strides>
+void fold(Lengths& lengths, Idx& idx, Strides&... _strides)
 {
     std::tuple<Strides&...> strides(_strides...);
 
     auto ndim = lengths.size();
     auto inds = detail::sort_by_stride(std::get<0>(strides));
 
+    /*
+     * The old values are kept on the stack, and the outputs reuse their
+     * existing storage.
+     */
+    dim_vector<label_type> oldidx(idx.begin(), idx.end());
+    len_vector oldlengths(lengths.begin(), lengths.end());
+    std::array<stride_vector,sizeof...(Strides)> oldstrides;
+
+    idx.clear();
+    lengths.clear();
+    detail::save_strides(strides, oldstrides);
+
+    for (unsigned i = 0;i < ndim;i++)
+    {
+        if (i != 0 && detail::are_contiguous(oldstrides, oldlengths, inds[i], inds[i-1]))
+        {
+            lengths.back() *= oldlengths[inds[i]];
+        }
+        else
+        {
+            idx.push_back(oldidx[inds[i]]);
+            lengths.push_back(oldlengths[inds[i]]);
+            detail::push_back_strides(strides, oldstrides, inds[i]);
+        }
+    }
+
+    TBLIS_ASSERT(detail::are_all_compatible(oldlengths, oldstrides,
+                                            lengths, strides));
+}
+
+/*
+ * As above, but for a number of tensors only known at runtime. The indices
+ * are ordered by the strides of the first tensor.
+ */
+inline void fold(std::vector<len_type>& lengths, std::vector<label_type>& idx,
+                 std::vector<std::vector<stride_type>>& strides)
+{
+    TBLIS_ASSERT(!strides.empty());
+
+    auto ndim = lengths.size();
+    auto inds = detail::sort_by_stride(strides[0]);
+
     std::vector<label_type> oldidx;
     std::vector<len_type> oldlengths;
-    std::tuple<Strides...> oldstrides;
+    std::vector<std::vector<stride_type>> oldstrides(strides.size());
 
     oldidx.swap(idx);
     oldlengths.swap(lengths);
-    detail::swap_strides(strides, oldstrides);
+    for (unsigned k = 0;k < strides.size();k++)
+        oldstrides[k].swap(strides[k]);
 
     for (unsigned i = 0;i < ndim;i++)
     {
-        if (i != 0 && detail::are_contiguous(oldstrides, oldlengths, inds[i], inds[i-1]))
+        bool contiguous = i != 0;
+        for (unsigned k = 0;contiguous && k < strides.size();k++)
+            contiguous = oldstrides[k][inds[i]] ==
+                         oldstrides[k][inds[i-1]]*oldlengths[inds[i-1]];
+
+        if (contiguous)
         {
             lengths.back() *= oldlengths[inds[i]];
         }
@@ -294,28 +330,65 @@ void fold(std::vector<len_type>& lengths, std::vector<label_type>& idx,
         {
             idx.push_back(oldidx[inds[i]]);
             lengths.push_back(oldlengths[inds[i]]);
-            detail::push_back_strides(strides, oldstrides, inds[i]);
+            for (unsigned k = 0;k < strides.size();k++)
+                strides[k].push_back(oldstrides[k][inds[i]]);
         }
     }
+}
+
+/*
+ * Return the index with the smallest stride, ignoring indices of length 1
+ * unless all of them are.
+ */
+template <typename Lengths, typename Strides>
+unsigned unit_index(const Lengths& len, const Strides& stride)
+{
+    unsigned idx = 0;
+    for (unsigned i = 1;i < len.size();i++)
+        if (len[i] > 1 && (len[idx] == 1 ||
+            std::abs(stride[i]) < std::abs(stride[idx]))) idx = i;
+    return idx;
+}
+
+/*
+ * Gather the entries of v for the labels in match (looked up in s) into
+ * out, which may be of a different container type than v.
+ */
+template <typename Out, typename T, typename Labels>
+void select_into(Out& out, const T& v, const Labels& s, const Labels& match)
+{
+    out.clear();
+    out.reserve(match.size());
 
-    TBLIS_ASSERT(detail::are_compatible(oldlengths, oldstrides,
-                                        lengths, strides));
+    for (auto& m : match)
+    {
+        for (size_t i = 0;i < s.size();i++)
+        {
+            if (s[i] == m)
+            {
+                out.push_back(v[i]);
+                break;
+            }
+        }
+    }
 }
 
-inline void diagonal(unsigned& ndim,
-                     const len_type* len_in,
-                     const stride_type* stride_in,
-                     const label_type* idx_in,
-                     std::vector<len_type>& len_out,
-                     std::vector<stride_type>& stride_out,
-                     std::vector<label_type>& idx_out)
+template <typename Lengths, typename Strides, typename Idx>
+void diagonal(unsigned& ndim,
+              const len_type* len_in,
+              const stride_type* stride_in,
+              const label_type* idx_in,
+              Lengths& len_out,
+              Strides& stride_out,
+              Idx& idx_out)
 {
     len_out.reserve(ndim);
     stride_out.reserve(ndim);
     idx_out.reserve(ndim);
 
-    std::vector<unsigned> inds = MArray::range(ndim);
-    stl_ext::sort(inds, detail::sort_by_idx(idx_in));
+    auto range = MArray::range(ndim);
+    dim_vector<unsigned> inds(range.begin(), range.end());
+    std::sort(inds.begin(), inds.end(), detail::sort_by_idx(idx_in));
 
     unsigned ndim_in = ndim;
 
@@ -23,10 +23,14 @@ namespace
 struct thread_configuration
 {
     unsigned num_threads;
+    bool reproducible;
 
     thread_configuration()
-    : num_threads(1)
+    : num_threads(1), reproducible(false)
     {
+        const char* repro = getenv("TBLIS_REPRODUCIBLE");
+        if (repro) reproducible = strtol(repro, NULL, 10) != 0;
+
         const char* str = getenv("TBLIS_NUM_THREADS");
         if (!str) str = getenv("OMP_NUM_THREADS");
 
@@ -101,4 +105,14 @@ void tblis_set_num_threads(unsigned num_threads)
     get_thread_configuration().num_threads = num_threads;
 }
 
+int tblis_get_reproducible()
+{
+    return get_thread_configuration().reproducible;
+}
+
+void tblis_set_reproducible(int reproducible)
+{
+    get_thread_configuration().reproducible = reproducible;
+}
+
 }
@@ -22,6 +22,15 @@ unsigned tblis_get_num_threads();
 
 void tblis_set_num_threads(unsigned num_threads);
 
+/*
+ * In reproducible mode, reductions and dot products give bitwise-identical
+ * results for any number of threads. The default is taken from
+ * TBLIS_REPRODUCIBLE (off unless set to a non-zero value).
+ */
+int tblis_get_reproducible();
+
+void tblis_set_reproducible(int reproducible);
+
 #ifdef __cplusplus
 }
 #endif
@@ -29,6 +38,7 @@ void tblis_set_num_threads(unsigned num_threads);
 #if defined(__cplusplus) && !defined(TBLIS_DONT_USE_CXX11)
 
 #include <vector>
+#include <system_error>
 #include <utility>
 
 namespace tblis
@@ -61,91 +71,173 @@ void reduce_init(reduce_t op, T& value, len_type& idx)
     idx = -1;
 }
 
+/*
+ * Combine a partial result (value2, idx2) into (value, idx).
+ */
 template <typename T>
-void reduce(const communicator& comm, reduce_t op, T& value, len_type& idx)
+void reduce_combine(reduce_t op, T& value, len_type& idx,
+                    const T& value2, len_type idx2)
 {
-    if (comm.num_threads() == 1)
+    switch (op)
     {
-        if (op == REDUCE_NORM_2) value = sqrt(value);
-        return;
+        case REDUCE_SUM:
+        case REDUCE_SUM_ABS:
+        case REDUCE_NORM_2:
+            value += value2;
+            break;
+        case REDUCE_MAX:
+            if (value2 > value) { value = value2; idx = idx2; }
+            break;
+        case REDUCE_MAX_ABS:
+            if (std::abs(value2) > std::abs(value)) { value = value2; idx = idx2; }
+            break;
+        case REDUCE_MIN:
+            if (value2 < value) { value = value2; idx = idx2; }
+            break;
+        case REDUCE_MIN_ABS:
+            if (std::abs(value2) < std::abs(value)) { value = value2; idx = idx2; }
+            break;
     }
+}
 
-    std::pair<T,len_type>* vals;
-    std::vector<std::pair<T,len_type>> val_buffer;
+namespace detail
+{
 
-    if (comm.master())
-    {
-        val_buffer.resize(comm.num_threads());
-        vals = val_buffer.data();
-    }
+template <typename T>
+struct reduce_ops
+{
+    unsigned nop;
+    const reduce_t* op;
 
-    comm.broadcast_nowait(vals);
+    static void combine(void* accum_, const void* other_, void* user)
+    {
+        auto& self = *static_cast<reduce_ops*>(user);
+        auto accum = static_cast<std::pair<T,len_type>*>(accum_);
+        auto other = static_cast<const std::pair<T,len_type>*>(other_);
 
-    vals[comm.thread_num()] = {value, idx};
+        for (unsigned k = 0;k < self.nop;k++)
+            reduce_combine(self.op[k], accum[k].first, accum[k].second,
+                           other[k].first, other[k].second);
+    }
+};
 
-    comm.barrier();
+}
 
-    if (comm.master())
+/*
+ * Combine the partial results of nop reductions over all threads, with a
+ * single tree reduction in the communicator. On return every thread has the
+ * final values.
+ */
+template <typename T>
+void reduce(const communicator& comm, unsigned nop, const reduce_t* op,
+            T* value, len_type* idx)
+{
+    if (comm.num_threads() > 1)
     {
-        if (op == REDUCE_SUM)
-        {
-            for (unsigned i = 1;i < comm.num_threads();i++)
-            {
-                vals[0].first += vals[i].first;
-            }
-        }
-        else if (op == REDUCE_SUM_ABS)
-        {
-            vals[0].first = std::abs(vals[0].first);
-            for (unsigned i = 1;i < comm.num_threads();i++)
-            {
-                vals[0].first += std::abs(vals[i].first);
-            }
-        }
-        else if (op == REDUCE_MAX)
-        {
-            for (unsigned i = 1;i < comm.num_threads();i++)
-            {
-                if (vals[i].first > vals[0].first) vals[0] = vals[i];
-            }
-        }
-        else if (op == REDUCE_MAX_ABS)
-        {
-            for (unsigned i = 1;i < comm.num_threads();i++)
-            {
-                if (std::abs(vals[i].first) >
-                    std::abs(vals[0].first)) vals[0] = vals[i];
-            }
-        }
-        else if (op == REDUCE_MIN)
-        {
-            for (unsigned i = 1;i < comm.num_threads();i++)
-            {
-                if (vals[i].first < vals[0].first) vals[0] = vals[i];
-            }
-        }
-        else if (op == REDUCE_MIN_ABS)
+        std::pair<T,len_type> local_vals[8];
+        std::vector<std::pair<T,len_type>> heap_vals;
+        auto vals = local_vals;
+
+        if (nop > 8)
         {
-            for (unsigned i = 1;i < comm.num_threads();i++)
-            {
-                if (std::abs(vals[i].first) <
-                    std::abs(vals[0].first)) vals[0] = vals[i];
-            }
+            heap_vals.resize(nop);
+            vals = heap_vals.data();
         }
-        else if (op == REDUCE_NORM_2)
+
+        for (unsigned k = 0;k < nop;k++)
+            vals[k] = {value[k], idx[k]};
+
+        detail::reduce_ops<T> ops{nop, op};
+        int ret = tci_comm_reduce(comm, vals,
+                                  nop*sizeof(std::pair<T,len_type>),
+                                  &detail::reduce_ops<T>::combine, &ops);
+        if (ret != 0) throw std::system_error(ret, std::system_category());
+
+        for (unsigned k = 0;k < nop;k++)
         {
-            for (unsigned i = 1;i < comm.num_threads();i++)
-            {
-                vals[0].first += vals[i].first;
-            }
-            vals[0].first = std::sqrt(vals[0].first);
+            value[k] = vals[k].first;
+            idx[k] = vals[k].second;
         }
     }
 
-    comm.barrier();
+    for (unsigned k = 0;k < nop;k++)
+        if (op[k] == REDUCE_NORM_2) value[k] = sqrt(value[k]);
+}
+
+template <typename T>
+void reduce(const communicator& comm, reduce_t op, T& value, len_type& idx)
+{
+    reduce(comm, 1, &op, &value, &idx);
+}
+
+namespace detail
+{
+
+/*
+ * Combine block i+s into block i for each of the nop reductions.
+ */
+template <typename T>
+void combine_blocks(unsigned nop, const reduce_t* op,
+                    std::pair<T,len_type>* partial, len_type i, len_type s)
+{
+    for (unsigned k = 0;k < nop;k++)
+    {
+        auto& accum = partial[i*nop+k];
+        auto& other = partial[(i+s)*nop+k];
+        reduce_combine(op[k], accum.first, accum.second,
+                              other.first, other.second);
+    }
+}
+
+}
+
+/*
+ * Combine the partial results of nop reductions over nblock blocks, stored
+ * one block after another in partial, into partial[0], ..., partial[nop-1].
+ * The blocks are combined pairwise in a fixed order, so that the result
+ * does not depend on how the blocks were divided among threads. Levels of
+ * the tree below s0 must already have been combined.
+ */
+template <typename T>
+void reduce_blocks(unsigned nop, const reduce_t* op, len_type nblock,
+                   std::pair<T,len_type>* partial, len_type s0 = 1)
+{
+    for (len_type s = s0;s < nblock;s *= 2)
+        for (len_type i = 0;i+s < nblock;i += 2*s)
+            detail::combine_blocks(nop, op, partial, i, s);
+
+    for (unsigned k = 0;k < nop;k++)
+        if (op[k] == REDUCE_NORM_2) partial[k].first = sqrt(partial[k].first);
+}
+
+/*
+ * The same, but the threads of comm (which all see partial) share the pairs
+ * of each level of the tree. The tree has the same shape for any number of
+ * threads, so the result is the same as above. Once a level has fewer pairs
+ * than threads the master finishes alone.
+ */
+template <typename T>
+void reduce_blocks(const communicator& comm, unsigned nop, const reduce_t* op,
+                   len_type nblock, std::pair<T,len_type>* partial)
+{
+    len_type s = 1;
+
+    for (;s < nblock;s *= 2)
+    {
+        len_type npair = (nblock+s-1)/(2*s);
+        if (npair < comm.num_threads()) break;
+
+        len_type pair_min, pair_max;
+        std::tie(pair_min, pair_max, std::ignore) =
+            comm.distribute_over_threads(npair);
+
+        for (len_type pair = pair_min;pair < pair_max;pair++)
+            detail::combine_blocks(nop, op, partial, 2*s*pair, s);
+
+        comm.barrier();
+    }
 
-    value = vals[0].first;
-    idx = vals[0].second;
+    if (comm.master()) reduce_blocks(nop, op, nblock, partial, s);
 
     comm.barrier();
 }
@@ -18,6 +18,10 @@
 #include "util/tensor.hpp"
 #include "util/random.hpp"
 #include "internal/3t/mult.hpp"
+#include "memory/huge_pages.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
 
 using namespace std;
 using namespace tblis;
@@ -141,9 +145,9 @@ double run_kernel(len_type R, const Kernel & kernel, Args &&...args)
 
 template<typename Experiment>
 void iterate_over_ranges_helper(const Experiment & experiment,
-                                const map<char,range_t<stride_type>> &ranges,
-                                map<char,range_t<stride_type>>::const_iterator range,
-                                map<char,len_type> &values)
+                                const std::map<char,range_t<stride_type>> &ranges,
+                                std::map<char,range_t<stride_type>>::const_iterator range,
+                                std::map<char,len_type> &values)
 {
     if (range == ranges.end())
     {
@@ -181,9 +185,9 @@ void iterate_over_ranges_helper(const Experiment & experiment,
 
 template<typename Experiment>
 void iterate_over_ranges(const Experiment & experiment,
-                         const map<char,range_t<stride_type>> &ranges)
+                         const std::map<char,range_t<stride_type>> &ranges)
 {
-    map<char, len_type> values;
+    std::map<char, len_type> values;
     iterate_over_ranges_helper(experiment, ranges, ranges.begin(), values);
 }
 
@@ -208,7 +212,7 @@ struct gemm_experiment
         iterate_over_ranges(*this, {{'m', m_range}, {'n', n_range}, {'k', k_range}});
     }
 
-    void operator()(const map<char, len_type> &values) const
+    void operator()(const std::map<char, len_type> &values) const
     {
         stride_type m = values.at('m');
         stride_type n = values.at('n');
@@ -278,7 +282,7 @@ struct random_contraction
         iterate_over_ranges(*this, {{'m', m_range}, {'n', n_range}, {'k', k_range}});
     }
 
-    void operator()(const map<char, len_type> &values) const
+    void operator()(const std::map<char, len_type> &values) const
     {
         len_type m = values.at('m');
         len_type n = values.at('n');
@@ -297,7 +301,7 @@ struct random_contraction
             vector<len_type> len_A, len_B, len_C;
             char idx = 'a';
 
-            map<char,len_type> lengths;
+            std::map<char,len_type> lengths;
 
             stride_type tm = 1;
             for (len_type len : len_m)
@@ -386,13 +390,13 @@ struct regular_contraction
     regular_contraction(len_type R, const vector<label_type> &idx_A,
                         const vector<label_type> &idx_B,
                         const vector<label_type> &idx_C,
-                        const map<char,range_t<stride_type>> &ranges)
+                        const std::map<char,range_t<stride_type>> &ranges)
     : R(R), idx_A(idx_A), idx_B(idx_B), idx_C(idx_C)
     {
         iterate_over_ranges(*this, ranges);
     }
 
-    void operator()(const map<char, len_type> &lengths) const
+    void operator()(const std::map<char, len_type> &lengths) const
     {
         vector<len_type> len_A, len_B, len_C;
 
@@ -441,6 +445,153 @@ struct regular_contraction
     }
 };
 
+/*
+ * Show the effect of huge pages on the TLB: a buffer of n elements is
+ * allocated with each huge page mode, and then read one element per 4 KiB
+ * page in a scattered order (reported as ns per access) and read in full
+ * in order (reported as GB/s). Run other experiments with TBLIS_HUGE_PAGES
+ * set to see the effect on the packing buffers.
+ */
+template<typename T>
+struct tlb_experiment
+{
+    tlb_experiment(len_type R, const range_t<stride_type> &n)
+    {
+        for (auto ni : n) (*this)(R, ni);
+    }
+
+    void operator()(len_type R, len_type n) const
+    {
+        size_t size = n*sizeof(T);
+        len_type page = 4096/sizeof(T);
+        len_type npage = (n+page-1)/page;
+
+        len_type step = npage/2+npage/8+1;
+        while (gcd(step, npage) != 1) step++;
+
+        for (auto mode : {HUGE_PAGES_NONE, HUGE_PAGES_MADVISE, HUGE_PAGES_HUGETLB})
+        {
+            T* A = nullptr;
+            if (mode == HUGE_PAGES_NONE)
+            {
+                void* ptr;
+                if (posix_memalign(&ptr, 4096, size) != 0) abort();
+                A = static_cast<T*>(ptr);
+            }
+            else
+            {
+                A = static_cast<T*>(huge_page_alloc(size, mode));
+                if (!A) abort();
+            }
+
+            std::fill(A, A+n, T(1));
+
+            volatile real_type_t<T> sink;
+
+            double dt_scatter = run_kernel(R,
+            [&]
+            {
+                T sum = T();
+                len_type p = 0;
+                for (len_type i = 0;i < npage;i++)
+                {
+                    sum += A[p*page];
+                    p = (p+step)%npage;
+                }
+                sink = std::real(sum);
+            });
+
+            double dt_stream = run_kernel(R,
+            [&]
+            {
+                T sum = T();
+                for (len_type i = 0;i < n;i++) sum += A[i];
+                sink = std::real(sum);
+            });
+
+            (void)sink;
+
+            const char* name[] = {"none", "madvise", "hugetlb"};
+            printf("%e %e -- tlb %c %s %ld\n", dt_scatter/npage*1e9,
+                   size/dt_stream*1e-9, type_char<T>::value, name[mode], n);
+            fflush(stdout);
+
+            if (mode == HUGE_PAGES_NONE) free(A);
+            else huge_page_free(A, size);
+        }
+    }
+
+    static len_type gcd(len_type a, len_type b)
+    {
+        while (b != 0)
+        {
+            len_type t = a%b;
+            a = b;
+            b = t;
+        }
+        return a;
+    }
+};
+
+/*
+ * Run mult_streamed for C_mn = A_kn B_mk, with A read from a temporary file
+ * (under $TMPDIR, or /tmp) in slices of n. The file is dropped from the page
+ * cache before each run. Reported are the total time, the time spent reading
+ * A and in mult, the time mult waited for reads, and the fraction of the
+ * read time which was overlapped with computation.
+ */
+template<typename T>
+struct ooc_experiment
+{
+    ooc_experiment(len_type R, const range_t<stride_type> &m,
+                               const range_t<stride_type> &n,
+                               const range_t<stride_type> &k,
+                               len_type slice_len)
+    {
+        for (auto mi : m)
+            for (auto ni : n)
+                for (auto ki : k)
+                    (*this)(R, mi, ni, ki, slice_len);
+    }
+
+    void operator()(len_type R, len_type m, len_type n, len_type k, len_type slice_len) const
+    {
+        const char* tmpdir = getenv("TMPDIR");
+        string path = string(tmpdir ? tmpdir : "/tmp") + "/tblis_bench_XXXXXX";
+        int fd = mkstemp(&path[0]);
+        if (fd < 0) abort();
+        unlink(path.c_str());
+
+        tensor<T> A({k, n}), B({m, k}), C({m, n});
+        A = T(1);
+        B = T(1);
+
+        size_t size = k*n*sizeof(T);
+        if (pwrite(fd, A.data(), size, 0) != ssize_t(size)) abort();
+        A.reset();
+        fsync(fd);
+
+        mult_streamed_stats best = {};
+        best.total_time = numeric_limits<double>::max();
+
+        for (len_type r = 0;r < R;r++)
+        {
+            posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+            auto stats = mult_streamed(T(1), fd, 0, {k, n}, "kn", B, "mk", T(0), C, "mn", slice_len);
+            if (stats.total_time < best.total_time) best = stats;
+        }
+
+        close(fd);
+
+        double overlap = best.read_time > 0 ? 1 - best.wait_time/best.read_time : 0;
+
+        printf("%e %e %e %e %f -- ooc %c %ld %ld %ld %ld\n", best.total_time,
+               best.read_time, best.compute_time, best.wait_time, overlap,
+               type_char<T>::value, m, n, k, slice_len);
+        fflush(stdout);
+    }
+};
+
 int main(int argc, char** argv)
 {
     int R = 10;
@@ -535,6 +686,39 @@ int main(int argc, char** argv)
                     break;
             }
         }
+        else if (algo == "tlb")
+        {
+            string n_range;
+            iss >> n_range;
+
+            auto n = parse_range(n_range);
+
+            switch (dt)
+            {
+                case 's': tlb_experiment<   float>(R, n); break;
+                case 'd': tlb_experiment<  double>(R, n); break;
+                case 'c': tlb_experiment<scomplex>(R, n); break;
+                case 'z': tlb_experiment<dcomplex>(R, n); break;
+            }
+        }
+        else if (algo == "ooc")
+        {
+            string m_range, n_range, k_range;
+            len_type slice_len;
+            iss >> m_range >> n_range >> k_range >> slice_len;
+
+            auto m = parse_range(m_range);
+            auto n = parse_range(n_range);
+            auto k = parse_range(k_range);
+
+            switch (dt)
+            {
+                case 's': ooc_experiment<   float>(R, m, n, k, slice_len); break;
+                case 'd': ooc_experiment<  double>(R, m, n, k, slice_len); break;
+                case 'c': ooc_experiment<scomplex>(R, m, n, k, slice_len); break;
+                case 'z': ooc_experiment<dcomplex>(R, m, n, k, slice_len); break;
+            }
+        }
         else if (algo == "reg_blas" || algo == "reg_blis")
         {
             string idx_A_, idx_B_, idx_C_;
@@ -545,7 +729,7 @@ int main(int argc, char** argv)
             for (char c : idx_B_) labels.insert(c);
             for (char c : idx_C_) labels.insert(c);
 
-            map<char,range_t<stride_type>> ranges;
+            std::map<char,range_t<stride_type>> ranges;
             for (char c : labels)
             {
                 string range;
@@ -1,5 +1,9 @@
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <fstream>
 #include <limits>
+#include <new>
 #include <numeric>
 #include <getopt.h>
 #include <sstream>
@@ -7,7 +11,14 @@
 
 #include "tblis.h"
 
+#if TBLIS_HAVE_NUMA_H
+#include <numa.h>
+#include <numaif.h>
+#endif
+
+#include "configs/configs.hpp"
 #include "internal/3t/mult.hpp"
+#include "memory/memory_pool.hpp"
 #include "util/random.hpp"
 #include "external/stl_ext/include/algorithm.hpp"
 #include "external/stl_ext/include/iostream.hpp"
@@ -19,6 +30,46 @@ using namespace tblis::internal;
 
 constexpr int ulp_factor = 32;
 
+/*
+ * Count the heap allocations made while count_allocations is set, so that
+ * calls which are promised not to allocate can be checked.
+ */
+std::atomic<bool> count_allocations{false};
+std::atomic<long> num_allocations{0};
+
+void* operator new(size_t size)
+{
+    if (count_allocations) num_allocations++;
+    void* ptr = malloc(size ? size : 1);
+    if (!ptr) throw std::bad_alloc();
+    return ptr;
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+    free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+    free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept
+{
+    free(ptr);
+}
+
 template <typename T>
 double ceil2(T x)
 {
@@ -156,6 +207,18 @@ template <> const string& type_name<dcomplex>()
     return name;
 }
 
+template <> const string& type_name<tblis_half>()
+{
+    static string name = "half";
+    return name;
+}
+
+template <> const string& type_name<tblis_bfloat16>()
+{
+    static string name = "bfloat16";
+    return name;
+}
+
 /*
  * Creates a matrix whose total storage size is between N/4
  * and N entries, and with edge lengths of at least those given. The number
@@ -191,6 +254,18 @@ void random_matrix(stride_type N, matrix<T>& t)
     random_matrix(N, 0, 0, t);
 }
 
+/*
+ * Sets the referencable elements of t to random values from the interior of
+ * the unit circle.
+ */
+template <typename T>
+void random_fill(tensor_view<T> t)
+{
+    T* data = t.data();
+    MArray::viterator<> it(t.lengths(), t.strides());
+    while (it.next(data)) *data = random_unit<T>();
+}
+
 /*
  * Creates a tensor of d dimensions, whose total storage size is between N/2^d
  * and N entries, and with edge lengths of at least those given. The number
@@ -210,10 +285,7 @@ void random_tensor(stride_type N, unsigned d, vector<len_type> len_min, tensor<T
     }
 
     t.reset(len);
-
-    T* data = t.data();
-    MArray::viterator<> it(t.lengths(), t.strides());
-    while (it.next(data)) *data = random_unit<T>();
+    random_fill<T>(t);
 }
 
 /*
@@ -238,6 +310,68 @@ void random_tensor(stride_type N, tensor<T>& t)
     random_tensor(N, random_number(1,8), t);
 }
 
+/*
+ * The operands of C = A*B + beta*C for random A and B of the given shapes,
+ * where C holds the result of an ordinary mult and D (of the same shape) is
+ * left for the result under test. If beta is nonzero, C starts out random
+ * and D holds a copy of its starting value.
+ */
+struct mult_case
+{
+    const label_type* idx_A;
+    const label_type* idx_B;
+    const label_type* idx_C;
+    tensor<double> A, B, C, D;
+
+    mult_case(const label_type* idx_A, const vector<len_type>& len_A,
+              const label_type* idx_B, const vector<len_type>& len_B,
+              const label_type* idx_C, const vector<len_type>& len_C,
+              double beta = 0)
+    : idx_A(idx_A), idx_B(idx_B), idx_C(idx_C),
+      A(len_A), B(len_B), C(len_C), D(len_C)
+    {
+        random_fill<double>(A);
+        random_fill<double>(B);
+
+        if (beta != 0)
+        {
+            random_fill<double>(C);
+            D = C;
+        }
+
+        mult(1.0, A, idx_A, B, idx_B, beta, C, idx_C);
+    }
+
+    /*
+     * Checks that D matches C to within ulps, leaving the difference in D.
+     */
+    void check(const string& label, double ulps = 0)
+    {
+        add(-1.0, C, idx_C, 1.0, D, idx_C);
+        passfail(label, reduce(REDUCE_NORM_2, D, idx_C).first, 0.0, ulps);
+    }
+};
+
+typedef std::array<tblis_memory_pool_stats,TBLIS_NUM_POOLS> pool_stats;
+
+pool_stats get_pool_stats()
+{
+    pool_stats stats;
+    for (int i = 0;i < TBLIS_NUM_POOLS;i++)
+        tblis_get_memory_pool_stats(tblis_memory_pool(i), &stats[i]);
+    return stats;
+}
+
+/*
+ * Checks that the given statistic of each pool is unchanged.
+ */
+void check_pools(const string& label, const pool_stats& before,
+                 const pool_stats& after, size_t tblis_memory_pool_stats::*field)
+{
+    for (int i = 0;i < TBLIS_NUM_POOLS;i++)
+        passfail(label, stride_type(after[i].*field), stride_type(before[i].*field), 0);
+}
+
 enum index_type
 {
     TYPE_A,
@@ -1060,175 +1194,663 @@ void test_contract(stride_type N)
     passfail("BLIS", error, 0, ulp_factor*ceil2(scale*neps));
 }
 
+/*
+ * Integer contraction with A and B stored as T and C as int32_t, which must
+ * agree exactly with the reference algorithm.
+ */
 template <typename T>
-void test_weight(stride_type N)
+void test_contract_int(stride_type N)
 {
-    tensor<T> A, B, C, D, E;
+    tensor<double> A0, B0, C0;
     std::vector<label_type> idx_A, idx_B, idx_C;
 
-    random_weight(N, A, idx_A, B, idx_B, C, idx_C);
+    random_contract(N, A0, idx_A, B0, idx_B, C0, idx_C);
+
+    tensor<T> A(A0.lengths()), B(B0.lengths());
+    tensor<int32_t> C(C0.lengths()), D, E;
+
+    auto fill = [](T* data, stride_type n)
+    {
+        for (stride_type i = 0;i < n;i++) data[i] = random_number(-8, 8);
+    };
+
+    fill(A.data(), prod(A.lengths()));
+    fill(B.data(), prod(B.lengths()));
+    for (stride_type i = 0;i < prod(C.lengths());i++)
+        C.data()[i] = random_number(-8, 8);
+
+    int32_t scale = random_number(1, 4);
 
     cout << endl;
-    cout << "Testing weight (" << type_name<T>() << "):" << endl;
+    cout << "Testing contract (int" << 8*sizeof(T) << "->int32):" << endl;
     cout << "len_A    = " << A.lengths() << endl;
-    cout << "stride_A = " << A.strides() << endl;
     cout << "idx_A    = " << idx_A << endl;
     cout << "len_B    = " << B.lengths() << endl;
-    cout << "stride_B = " << B.strides() << endl;
     cout << "idx_B    = " << idx_B << endl;
     cout << "len_C    = " << C.lengths() << endl;
-    cout << "stride_C = " << C.strides() << endl;
     cout << "idx_C    = " << idx_C << endl;
     cout << endl;
 
-    auto neps = ceil2(prod(C.lengths()));
+    auto contract = [&](tensor<int32_t>& C)
+    {
+        tensor_view<T> Av(A), Bv(B);
+        tensor_view<int32_t> Cv(C);
+        tblis_tensor A_s(Av), B_s(Bv), C_s(Cv);
+        A_s.alpha<int32_t>() = scale;
+        C_s.alpha<int32_t>() = scale;
 
-    T scale(10.0*random_unit<T>());
+        tblis_tensor_mult(nullptr, nullptr, &A_s, idx_A.data(), &B_s, idx_B.data(),
+                          &C_s, idx_C.data());
+    };
 
-    impl = BLAS_BASED;
+    impl = REFERENCE;
     D.reset(C);
-    mult(scale, A, idx_A.data(), B, idx_B.data(), scale, D, idx_C.data());
+    contract(D);
 
-    impl = REFERENCE;
+    impl = BLIS_BASED;
     E.reset(C);
-    mult(scale, A, idx_A.data(), B, idx_B.data(), scale, E, idx_C.data());
+    contract(E);
 
-    add(T(-1), D, idx_C.data(), T(1), E, idx_C.data());
-    T error = reduce(REDUCE_NORM_2, E, idx_C.data()).first;
+    double error = 0;
+    for (stride_type i = 0;i < prod(C.lengths());i++)
+        error = max(error, (double)std::abs(D.data()[i] - E.data()[i]));
 
-    passfail("BLAS", error, 0, ulp_factor*ceil2(scale*neps));
+    passfail("BLIS", error, 0, 0);
 }
 
-template <typename T>
-void test_outer_prod(stride_type N)
+/*
+ * Contraction with A and B stored as TAB and C as TC, computed in a wider
+ * type. Both algorithms round C to TC once, so the error is bounded by
+ * twice the epsilon of TC plus the usual accumulation error in the compute
+ * type, both relative to the magnitude of the partial sums.
+ */
+template <typename TAB, typename TC>
+void check_contract_mixed(const len_vector& len_A, const std::vector<label_type>& idx_A,
+                          const len_vector& len_B, const std::vector<label_type>& idx_B,
+                          const len_vector& len_C, const std::vector<label_type>& idx_C,
+                          double eps_C, double eps_T)
 {
-    tensor<T> A, B, C, D, E;
-    std::vector<label_type> idx_A, idx_B, idx_C;
+    typedef scalar_type_t<TAB> SAB;
+    typedef scalar_type_t<TC> SC;
 
-    random_outer_prod(N, A, idx_A, B, idx_B, C, idx_C);
+    tensor<TAB> A(len_A), B(len_B);
+    tensor<TC> C(len_C), D, E;
+    tensor<double> Aa(len_A), Ba(len_B), Ca(len_C);
+
+    for (stride_type i = 0;i < prod(A.lengths());i++)
+    {
+        A.data()[i] = TAB(random_unit<SAB>());
+        Aa.data()[i] = std::abs(SAB(A.data()[i]));
+    }
+
+    for (stride_type i = 0;i < prod(B.lengths());i++)
+    {
+        B.data()[i] = TAB(random_unit<SAB>());
+        Ba.data()[i] = std::abs(SAB(B.data()[i]));
+    }
+
+    for (stride_type i = 0;i < prod(C.lengths());i++)
+    {
+        C.data()[i] = TC(random_unit<SC>());
+        Ca.data()[i] = std::abs(SC(C.data()[i]));
+    }
+
+    double scale = random_number(1, 4);
 
     cout << endl;
-    cout << "Testing outer prod (" << type_name<T>() << "):" << endl;
+    cout << "Testing contract (" << type_name<TAB>() << "->" << type_name<TC>() << "):" << endl;
     cout << "len_A    = " << A.lengths() << endl;
-    cout << "stride_A = " << A.strides() << endl;
     cout << "idx_A    = " << idx_A << endl;
     cout << "len_B    = " << B.lengths() << endl;
-    cout << "stride_B = " << B.strides() << endl;
     cout << "idx_B    = " << idx_B << endl;
     cout << "len_C    = " << C.lengths() << endl;
-    cout << "stride_C = " << C.strides() << endl;
     cout << "idx_C    = " << idx_C << endl;
     cout << endl;
 
-    auto neps = ceil(prod(C.lengths()));
-
-    T scale(10.0*random_unit<T>());
+    auto contract = [&](tensor<TAB>& A, bool conj_A, tensor<TAB>& B, bool conj_B,
+                        tensor<TC>& C, bool conj_C)
+    {
+        tensor_view<TAB> Av(A), Bv(B);
+        tensor_view<TC> Cv(C);
+        tblis_tensor A_s(Av), B_s(Bv), C_s(Cv);
+        A_s.alpha<SAB>() = SAB(scale);
+        C_s.alpha<SC>() = SC(scale);
+        A_s.conj = conj_A;
+        B_s.conj = conj_B;
+        C_s.conj = conj_C;
+
+        tblis_tensor_mult(nullptr, nullptr, &A_s, idx_A.data(), &B_s, idx_B.data(),
+                          &C_s, idx_C.data());
+    };
 
-    impl = BLAS_BASED;
+    impl = REFERENCE;
     D.reset(C);
-    mult(scale, A, idx_A.data(), B, idx_B.data(), scale, D, idx_C.data());
+    contract(A, false, B, false, D, false);
 
-    impl = REFERENCE;
+    impl = BLIS_BASED;
     E.reset(C);
-    mult(scale, A, idx_A.data(), B, idx_B.data(), scale, E, idx_C.data());
+    contract(A, false, B, false, E, false);
 
-    add(T(-1), D, idx_C.data(), T(1), E, idx_C.data());
-    T error = reduce(REDUCE_NORM_2, E, idx_C.data()).first;
+    /*
+     * random_contract only generates AB, AC, and BC indices.
+     */
+    double k = std::sqrt((double)prod(A.lengths())*prod(B.lengths())/
+                         prod(C.lengths()));
 
-    passfail("BLAS", error, 0, ulp_factor*ceil2(scale*neps));
-}
+    impl = REFERENCE;
+    mult(scale, Aa, idx_A.data(), Ba, idx_B.data(), scale, Ca, idx_C.data());
 
-template <typename T>
-void test_add(stride_type N)
-{
-    tensor<T> A, B, C;
-    std::vector<label_type> idx_A, idx_B;
+    auto max_error = [&](const tensor<TC>& D, const tensor<TC>& E)
+    {
+        double error = 0;
+        for (stride_type i = 0;i < prod(C.lengths());i++)
+        {
+            double bound = (2*eps_C + eps_T*(k+2))*Ca.data()[i];
+            error = max(error, std::abs(SC(D.data()[i]) - SC(E.data()[i]))/
+                               max(bound, std::numeric_limits<double>::min()));
+        }
+        return error;
+    };
 
-    T scale(10.0*random_unit<T>());
+    passfail("BLIS", max_error(D, E), 0, 1/std::numeric_limits<double>::epsilon());
 
-    cout << endl;
-    cout << "Testing add (" << type_name<T>() << "):" << endl;
+    /*
+     * Conjugation is applied while converting, so compare against the
+     * unconjugated contraction of explicitly conjugated operands.
+     */
+    int conj_mask = random_number(1,7);
+    bool conj_A = conj_mask&1, conj_B = conj_mask&2, conj_C = conj_mask&4;
 
-    random_add(1000, A, idx_A, B, idx_B);
+    tensor<TAB> Ac, Bc;
+    Ac.reset(A);
+    Bc.reset(B);
+    tensor<TC> F, G(C.lengths());
 
-    cout << endl;
-    cout << "len_A    = " << A.lengths() << endl;
-    cout << "stride_A = " << A.strides() << endl;
-    cout << "idx_A    = " << idx_A << endl;
-    cout << "len_B    = " << B.lengths() << endl;
-    cout << "stride_B = " << B.strides() << endl;
-    cout << "idx_B    = " << idx_B << endl;
-    cout << endl;
+    for (stride_type i = 0;i < prod(A.lengths());i++)
+        Ac.data()[i] = tblis::conj(conj_A, A.data()[i]);
 
-    auto idx_B_only = exclusion(idx_B, idx_A);
-    stride_type NB = prod(select_from(B.lengths(), idx_B, idx_B_only));
-    auto neps = prod(A.lengths())*NB;
+    for (stride_type i = 0;i < prod(B.lengths());i++)
+        Bc.data()[i] = tblis::conj(conj_B, B.data()[i]);
 
-    T ref_val = reduce(REDUCE_SUM, A, idx_A.data()).first;
-    T add_b = reduce(REDUCE_SUM, B, idx_B.data()).first;
-    add(scale, A, idx_A.data(), scale, B, idx_B.data());
-    T calc_val = reduce(REDUCE_SUM, B, idx_B.data()).first;
-    passfail("SUM", scale*(NB*ref_val+add_b), calc_val, ulp_factor*ceil2(neps*scale));
+    for (stride_type i = 0;i < prod(C.lengths());i++)
+        G.data()[i] = tblis::conj(conj_C, C.data()[i]);
+
+    cout << "conj     = " << conj_A << conj_B << conj_C << endl;
+
+    impl = REFERENCE;
+    contract(Ac, false, Bc, false, G, false);
+
+    D.reset(C);
+    contract(A, conj_A, B, conj_B, D, conj_C);
+
+    passfail("REF_CONJ", max_error(D, G), 0, 1/std::numeric_limits<double>::epsilon());
+
+    impl = BLIS_BASED;
+    F.reset(C);
+    contract(A, conj_A, B, conj_B, F, conj_C);
+
+    passfail("BLIS_CONJ", max_error(F, G), 0, 1/std::numeric_limits<double>::epsilon());
 }
 
-template <typename T>
-void test_trace(stride_type N)
+template <typename TAB, typename TC>
+void test_contract_mixed(stride_type N, double eps_C, double eps_T)
 {
-    tensor<T> A, B;
+    tensor<double> A, B, C;
+    std::vector<label_type> idx_A, idx_B, idx_C;
+
+    random_contract(N, A, idx_A, B, idx_B, C, idx_C);
+
+    check_contract_mixed<TAB,TC>(A.lengths(), idx_A, B.lengths(), idx_B,
+                                 C.lengths(), idx_C, eps_C, eps_T);
+}
+
+/*
+ * A contracted dimension several times the largest block size, so that the
+ * BLIS-based algorithm splits it.
+ */
+template <typename TAB, typename TC>
+void test_contract_mixed_long(double eps_C, double eps_T)
+{
+    auto& kc = get_default_config().gemm_kc;
+    len_type k = 4*std::max({kc.max<float>(), kc.max<double>(),
+                             kc.max<scomplex>(), kc.max<dcomplex>()})+17;
+    len_type m = random_number(1, 20);
+    len_type n = random_number(1, 20);
+
+    check_contract_mixed<TAB,TC>({m, k}, {'a','b'}, {k, n}, {'b','c'},
+                                 {m, n}, {'a','c'}, eps_C, eps_T);
+}
+
+/*
+ * Half-precision and bfloat16 tensors are widened to float when loaded and
+ * rounded once when stored. Each result is compared against the same
+ * operation in double on the (exactly representable) stored values.
+ */
+template <typename TS>
+void test_narrow_1t(stride_type N, double eps_S)
+{
+    const double feps = std::numeric_limits<float>::epsilon();
+
+    tensor<double> A0, B0;
     std::vector<label_type> idx_A, idx_B;
 
-    random_trace(1000, A, idx_A, B, idx_B);
+    random_add(N, A0, idx_A, B0, idx_B);
+
+    stride_type NA = prod(A0.lengths());
+    stride_type NB = prod(B0.lengths());
+
+    tensor<TS> A(A0.lengths()), B(B0.lengths()), C;
+    tensor<double> Ad(A0.lengths()), Bd(B0.lengths()), Aa(A0.lengths()), Ba(B0.lengths());
+
+    for (stride_type i = 0;i < NA;i++)
+    {
+        A.data()[i] = TS(random_unit<float>());
+        Ad.data()[i] = float(A.data()[i]);
+        Aa.data()[i] = std::abs(Ad.data()[i]);
+    }
+
+    for (stride_type i = 0;i < NB;i++)
+    {
+        B.data()[i] = TS(random_unit<float>());
+        Bd.data()[i] = float(B.data()[i]);
+        Ba.data()[i] = std::abs(Bd.data()[i]);
+    }
+
+    float alpha = random_number(1, 4)*random_unit<float>();
+    float beta = random_number(1, 4)*random_unit<float>();
 
     cout << endl;
-    cout << "Testing trace (" << type_name<T>() << "):" << endl;
+    cout << "Testing 1t operations (" << type_name<TS>() << "):" << endl;
     cout << "len_A    = " << A.lengths() << endl;
-    cout << "stride_A = " << A.strides() << endl;
     cout << "idx_A    = " << idx_A << endl;
     cout << "len_B    = " << B.lengths() << endl;
-    cout << "stride_B = " << B.strides() << endl;
     cout << "idx_B    = " << idx_B << endl;
     cout << endl;
 
-    auto neps = prod(A.lengths());
+    /*
+     * Allow one rounding to TS and float accumulation over n terms. Half
+     * precision is subnormal below 2^-14.
+     */
+    auto max_error = [&](const tensor<TS>& C, const tensor<double>& R,
+                         const tensor<double>& Ra, double n)
+    {
+        double error = 0;
+        for (stride_type i = 0;i < prod(R.lengths());i++)
+        {
+            double bound = eps_S*max(std::abs(R.data()[i]), std::ldexp(1.0, -14)) +
+                           feps*(n+2)*Ra.data()[i];
+            error = max(error, std::abs(float(C.data()[i]) - R.data()[i])/
+                               max(bound, std::numeric_limits<double>::min()));
+        }
+        return error;
+    };
 
-    T scale(10.0*random_unit<T>());
+    auto check = [&](const string& label, double a, double b, double bound)
+    {
+        passfail(label, std::abs(a-b)/max(bound, std::numeric_limits<double>::min()), 0,
+                 1/std::numeric_limits<double>::epsilon());
+    };
 
-    T ref_val = reduce(REDUCE_SUM, A, idx_A.data()).first;
-    T add_b = reduce(REDUCE_SUM, B, idx_B.data()).first;
-    add(scale, A, idx_A.data(), scale, B, idx_B.data());
-    T calc_val = reduce(REDUCE_SUM, B, idx_B.data()).first;
-    passfail("SUM", scale*(ref_val+add_b), calc_val, ulp_factor*ceil2(neps*scale));
+    tensor<double> R, Ra;
+
+    C.reset(B);
+    {
+        tensor_view<TS> Cv(C);
+        tblis_scalar alpha_s(alpha);
+        alpha_s.type = type_tag<TS>::value;
+        tblis_tensor C_s(Cv);
+        tblis_tensor_set(nullptr, nullptr, &alpha_s, &C_s, idx_B.data());
+    }
+    R.reset(Bd);
+    R = double(float(TS(alpha)));
+    passfail("SET", max_error(C, R, Ba, 0), 0, 1/std::numeric_limits<double>::epsilon());
+
+    C.reset(B);
+    {
+        tensor_view<TS> Cv(C);
+        tblis_tensor C_s(Cv);
+        C_s.alpha<float>() = alpha;
+        tblis_tensor_scale(nullptr, nullptr, &C_s, idx_B.data());
+    }
+    R.reset(Bd);
+    scale(double(alpha), R, idx_B.data());
+    Ra.reset(Ba);
+    scale(double(std::abs(alpha)), Ra, idx_B.data());
+    passfail("SCALE", max_error(C, R, Ra, 0), 0, 1/std::numeric_limits<double>::epsilon());
+
+    auto idx_A_only = exclusion(idx_A, idx_B);
+    double n_A_only = prod(select_from(A.lengths(), idx_A, idx_A_only));
+
+    C.reset(B);
+    {
+        tensor_view<TS> Av(A), Cv(C);
+        tblis_tensor A_s(Av), C_s(Cv);
+        A_s.alpha<float>() = alpha;
+        C_s.alpha<float>() = beta;
+        tblis_tensor_add(nullptr, nullptr, &A_s, idx_A.data(), &C_s, idx_B.data());
+    }
+    R.reset(Bd);
+    add(double(alpha), Ad, idx_A.data(), double(beta), R, idx_B.data());
+    Ra.reset(Ba);
+    add(double(std::abs(alpha)), Aa, idx_A.data(), double(std::abs(beta)), Ra, idx_B.data());
+    passfail("ADD", max_error(C, R, Ra, n_A_only), 0, 1/std::numeric_limits<double>::epsilon());
+
+    tensor<TS> D(B);
+    for (stride_type i = 0;i < NB;i++) D.data()[i] = TS(random_unit<float>());
+    tensor<double> Dd(B.lengths()), Da(B.lengths());
+    for (stride_type i = 0;i < NB;i++)
+    {
+        Dd.data()[i] = float(D.data()[i]);
+        Da.data()[i] = std::abs(Dd.data()[i]);
+    }
+
+    C.reset(B);
+    {
+        tensor_view<TS> Bv(B), Cv(C), Dv(D);
+        tblis_tensor A_s[2] = {tblis_tensor(Bv), tblis_tensor(Dv)};
+        tblis_tensor C_s(Cv);
+        A_s[0].alpha<float>() = alpha;
+        A_s[1].alpha<float>() = beta;
+        C_s.alpha<float>() = 0;
+        const label_type* idx[2] = {idx_B.data(), idx_B.data()};
+        tblis_tensor_add_many(nullptr, nullptr, 2, A_s, idx, &C_s, idx_B.data());
+    }
+    R.reset(Dd);
+    scale(double(beta), R, idx_B.data());
+    add(double(alpha), Bd, idx_B.data(), 1.0, R, idx_B.data());
+    Ra.reset(Da);
+    scale(double(std::abs(beta)), Ra, idx_B.data());
+    add(double(std::abs(alpha)), Ba, idx_B.data(), 1.0, Ra, idx_B.data());
+    passfail("ADD_MANY", max_error(C, R, Ra, 2), 0, 1/std::numeric_limits<double>::epsilon());
+
+    {
+        reduce_t ops[] = {REDUCE_SUM, REDUCE_SUM_ABS, REDUCE_NORM_2, REDUCE_MAX_ABS};
+        tblis_scalar result[4];
+        len_type idx[4];
+        for (auto& r : result) r.type = type_tag<TS>::value;
+
+        tensor_view<TS> Av(A);
+        tblis_tensor A_s(Av);
+        tblis_tensor_reduce_multi(nullptr, nullptr, 4, ops, &A_s, idx_A.data(), result, idx);
+
+        double sum = 0, sum_abs = 0, sum_sq = 0, max_abs = 0;
+        for (stride_type i = 0;i < NA;i++)
+        {
+            sum += Ad.data()[i];
+            sum_abs += Aa.data()[i];
+            sum_sq += Aa.data()[i]*Aa.data()[i];
+            max_abs = max(max_abs, Aa.data()[i]);
+        }
+
+        check("REDUCE_SUM", result[0].get<float>(), sum, feps*(NA+2)*sum_abs);
+        check("REDUCE_SUM_ABS", result[1].get<float>(), sum_abs, feps*(NA+2)*sum_abs);
+        check("REDUCE_NORM_2", result[2].get<float>(), std::sqrt(sum_sq), feps*(NA+2)*std::sqrt(sum_sq));
+        passfail("REDUCE_MAX_ABS", result[3].get<float>(), max_abs, 0);
+        passfail("REDUCE_MAX_ABS_IDX", Aa.data()[idx[3]], max_abs, 0);
+
+        tblis_scalar single;
+        single.type = type_tag<TS>::value;
+        len_type single_idx;
+        tblis_tensor_reduce(nullptr, nullptr, REDUCE_SUM, &A_s, idx_A.data(), &single, &single_idx);
+        check("REDUCE", single.get<float>(), sum, feps*(NA+2)*sum_abs);
+    }
+
+    {
+        tensor_view<TS> Av(A), Bv(B);
+        tblis_tensor A_s(Av), B_s(Bv);
+        tblis_scalar result;
+        result.type = type_tag<TS>::value;
+        tblis_tensor_dot(nullptr, nullptr, &A_s, idx_A.data(), &B_s, idx_B.data(), &result);
+
+        double ref = dot<double>(Ad, idx_A.data(), Bd, idx_B.data());
+        double ref_abs = dot<double>(Aa, idx_A.data(), Ba, idx_B.data());
+        auto idx_AB = intersection(idx_A, idx_B);
+        double n = double(NA)*NB/prod(select_from(A.lengths(), idx_A, idx_AB));
+
+        check("DOT", result.get<float>(), ref, feps*(n+2)*ref_abs);
+    }
 }
 
 template <typename T>
-void test_replicate(stride_type N)
+void test_weight(stride_type N)
 {
-    tensor<T> A, B;
-    std::vector<label_type> idx_A, idx_B;
+    tensor<T> A, B, C, D, E;
+    std::vector<label_type> idx_A, idx_B, idx_C;
 
-    random_replicate(1000, A, idx_A, B, idx_B);
+    random_weight(N, A, idx_A, B, idx_B, C, idx_C);
 
     cout << endl;
-    cout << "Testing replicate (" << type_name<T>() << "):" << endl;
+    cout << "Testing weight (" << type_name<T>() << "):" << endl;
     cout << "len_A    = " << A.lengths() << endl;
     cout << "stride_A = " << A.strides() << endl;
     cout << "idx_A    = " << idx_A << endl;
     cout << "len_B    = " << B.lengths() << endl;
     cout << "stride_B = " << B.strides() << endl;
     cout << "idx_B    = " << idx_B << endl;
+    cout << "len_C    = " << C.lengths() << endl;
+    cout << "stride_C = " << C.strides() << endl;
+    cout << "idx_C    = " << idx_C << endl;
     cout << endl;
 
-    auto idx_B_only = exclusion(idx_B, idx_A);
-    stride_type NB = prod(select_from(B.lengths(), idx_B, idx_B_only));
-    auto neps = prod(B.lengths());
+    auto neps = ceil2(prod(C.lengths()));
 
     T scale(10.0*random_unit<T>());
 
-    T ref_val = reduce(REDUCE_SUM, A, idx_A.data()).first;
+    impl = BLAS_BASED;
+    D.reset(C);
+    mult(scale, A, idx_A.data(), B, idx_B.data(), scale, D, idx_C.data());
+
+    impl = REFERENCE;
+    E.reset(C);
+    mult(scale, A, idx_A.data(), B, idx_B.data(), scale, E, idx_C.data());
+
+    add(T(-1), D, idx_C.data(), T(1), E, idx_C.data());
+    T error = reduce(REDUCE_NORM_2, E, idx_C.data()).first;
+
+    passfail("BLAS", error, 0, ulp_factor*ceil2(scale*neps));
+
+    impl = BLIS_BASED;
+    D.reset(C);
+    mult(scale, A, idx_A.data(), B, idx_B.data(), scale, D, idx_C.data());
+
+    impl = REFERENCE;
+    E.reset(C);
+    mult(scale, A, idx_A.data(), B, idx_B.data(), scale, E, idx_C.data());
+
+    add(T(-1), D, idx_C.data(), T(1), E, idx_C.data());
+    error = reduce(REDUCE_NORM_2, E, idx_C.data()).first;
+
+    passfail("VECTOR", error, 0, ulp_factor*ceil2(scale*neps));
+
+    random_tensors(N,
+                   0, 0, 0,
+                   0, 0, 0,
+                   random_number(1,8),
+                   A, idx_A,
+                   B, idx_B,
+                   C, idx_C);
+
+    cout << endl;
+    cout << "len_A    = " << A.lengths() << endl;
+    cout << "len_B    = " << B.lengths() << endl;
+    cout << "len_C    = " << C.lengths() << endl;
+    cout << endl;
+
+    neps = ceil2(prod(C.lengths()));
+
+    impl = BLIS_BASED;
+    D.reset(C);
+    mult(scale, A, idx_A.data(), B, idx_B.data(), scale, D, idx_C.data());
+
+    impl = REFERENCE;
+    E.reset(C);
+    mult(scale, A, idx_A.data(), B, idx_B.data(), scale, E, idx_C.data());
+
+    add(T(-1), D, idx_C.data(), T(1), E, idx_C.data());
+    error = reduce(REDUCE_NORM_2, E, idx_C.data()).first;
+
+    passfail("HADAMARD", error, 0, ulp_factor*ceil2(scale*neps));
+}
+
+template <typename T>
+void test_outer_prod(stride_type N)
+{
+    tensor<T> A, B, C, D, E;
+    std::vector<label_type> idx_A, idx_B, idx_C;
+
+    random_outer_prod(N, A, idx_A, B, idx_B, C, idx_C);
+
+    cout << endl;
+    cout << "Testing outer prod (" << type_name<T>() << "):" << endl;
+    cout << "len_A    = " << A.lengths() << endl;
+    cout << "stride_A = " << A.strides() << endl;
+    cout << "idx_A    = " << idx_A << endl;
+    cout << "len_B    = " << B.lengths() << endl;
+    cout << "stride_B = " << B.strides() << endl;
+    cout << "idx_B    = " << idx_B << endl;
+    cout << "len_C    = " << C.lengths() << endl;
+    cout << "stride_C = " << C.strides() << endl;
+    cout << "idx_C    = " << idx_C << endl;
+    cout << endl;
+
+    auto neps = ceil(prod(C.lengths()));
+
+    T scale(10.0*random_unit<T>());
+
+    impl = BLAS_BASED;
+    D.reset(C);
+    mult(scale, A, idx_A.data(), B, idx_B.data(), scale, D, idx_C.data());
+
+    impl = REFERENCE;
+    E.reset(C);
+    mult(scale, A, idx_A.data(), B, idx_B.data(), scale, E, idx_C.data());
+
+    add(T(-1), D, idx_C.data(), T(1), E, idx_C.data());
+    T error = reduce(REDUCE_NORM_2, E, idx_C.data()).first;
+
+    passfail("BLAS", error, 0, ulp_factor*ceil2(scale*neps));
+}
+
+template <typename T>
+void test_add(stride_type N)
+{
+    tensor<T> A, B, C;
+    std::vector<label_type> idx_A, idx_B;
+
+    T scale(10.0*random_unit<T>());
+
+    cout << endl;
+    cout << "Testing add (" << type_name<T>() << "):" << endl;
+
+    random_add(1000, A, idx_A, B, idx_B);
+
+    cout << endl;
+    cout << "len_A    = " << A.lengths() << endl;
+    cout << "stride_A = " << A.strides() << endl;
+    cout << "idx_A    = " << idx_A << endl;
+    cout << "len_B    = " << B.lengths() << endl;
+    cout << "stride_B = " << B.strides() << endl;
+    cout << "idx_B    = " << idx_B << endl;
+    cout << endl;
+
+    auto idx_B_only = exclusion(idx_B, idx_A);
+    stride_type NB = prod(select_from(B.lengths(), idx_B, idx_B_only));
+    auto neps = prod(A.lengths())*NB;
+
+    T ref_val = reduce(REDUCE_SUM, A, idx_A.data()).first;
     T add_b = reduce(REDUCE_SUM, B, idx_B.data()).first;
     add(scale, A, idx_A.data(), scale, B, idx_B.data());
     T calc_val = reduce(REDUCE_SUM, B, idx_B.data()).first;
     passfail("SUM", scale*(NB*ref_val+add_b), calc_val, ulp_factor*ceil2(neps*scale));
+}
+
+template <typename T>
+void test_trace(stride_type N)
+{
+    tensor<T> A, B;
+    std::vector<label_type> idx_A, idx_B;
+
+    random_trace(1000, A, idx_A, B, idx_B);
+
+    cout << endl;
+    cout << "Testing trace (" << type_name<T>() << "):" << endl;
+    cout << "len_A    = " << A.lengths() << endl;
+    cout << "stride_A = " << A.strides() << endl;
+    cout << "idx_A    = " << idx_A << endl;
+    cout << "len_B    = " << B.lengths() << endl;
+    cout << "stride_B = " << B.strides() << endl;
+    cout << "idx_B    = " << idx_B << endl;
+    cout << endl;
+
+    auto neps = prod(A.lengths());
+
+    T scale(10.0*random_unit<T>());
+
+    /*
+     * Check each element against a contraction with a tensor of ones.
+     */
+    auto idx_A_only = exclusion(idx_A, idx_B);
+    tensor<T> ones(select_from(A.lengths(), idx_A, idx_A_only)), D;
+    std::fill(ones.data(), ones.data()+prod(ones.lengths()), T(1));
+    D.reset(B);
+    mult(scale, A, idx_A.data(), ones, idx_A_only.data(), scale, D, idx_B.data());
+
+    T ref_val = reduce(REDUCE_SUM, A, idx_A.data()).first;
+    T add_b = reduce(REDUCE_SUM, B, idx_B.data()).first;
+    add(scale, A, idx_A.data(), scale, B, idx_B.data());
+    T calc_val = reduce(REDUCE_SUM, B, idx_B.data()).first;
+    passfail("SUM", scale*(ref_val+add_b), calc_val, ulp_factor*ceil2(neps*scale));
+
+    add(T(-1), D, idx_B.data(), T(1), B, idx_B.data());
+    T error = reduce(REDUCE_NORM_2, B, idx_B.data()).first;
+    passfail("ELEMENTS", error, 0, ulp_factor*ceil2(neps*scale));
+}
+
+template <typename T>
+void test_replicate(stride_type N)
+{
+    tensor<T> A, B;
+    std::vector<label_type> idx_A, idx_B;
+
+    random_replicate(1000, A, idx_A, B, idx_B);
+
+    cout << endl;
+    cout << "Testing replicate (" << type_name<T>() << "):" << endl;
+    cout << "len_A    = " << A.lengths() << endl;
+    cout << "stride_A = " << A.strides() << endl;
+    cout << "idx_A    = " << idx_A << endl;
+    cout << "len_B    = " << B.lengths() << endl;
+    cout << "stride_B = " << B.strides() << endl;
+    cout << "idx_B    = " << idx_B << endl;
+    cout << endl;
+
+    auto idx_B_only = exclusion(idx_B, idx_A);
+    stride_type NB = prod(select_from(B.lengths(), idx_B, idx_B_only));
+    auto neps = prod(B.lengths());
+
+    T scale(10.0*random_unit<T>());
+
+    /*
+     * Check each element by summing over the replicated indices with a
+     * contraction against a tensor of ones, before and after.
+     */
+    tensor<T> ones(select_from(B.lengths(), idx_B, idx_B_only)), C, D;
+    std::fill(ones.data(), ones.data()+prod(ones.lengths()), T(1));
+    C.reset(A);
+    D.reset(A);
+    mult(T(1), B, idx_B.data(), ones, idx_B_only.data(), T(0), C, idx_A.data());
+
+    T ref_val = reduce(REDUCE_SUM, A, idx_A.data()).first;
+    T add_b = reduce(REDUCE_SUM, B, idx_B.data()).first;
+    add(scale, A, idx_A.data(), scale, B, idx_B.data());
+    T calc_val = reduce(REDUCE_SUM, B, idx_B.data()).first;
+    passfail("SUM", scale*(NB*ref_val+add_b), calc_val, ulp_factor*ceil2(neps*scale));
+
+    mult(T(1), B, idx_B.data(), ones, idx_B_only.data(), T(0), D, idx_A.data());
+    add(-scale*T(NB), A, idx_A.data(), T(1), D, idx_A.data());
+    add(-scale, C, idx_A.data(), T(1), D, idx_A.data());
+    T error = reduce(REDUCE_NORM_2, D, idx_A.data()).first;
+    passfail("ELEMENTS", error, 0, ulp_factor*ceil2(neps*scale));
 
     ref_val = reduce(REDUCE_NORM_1, A, idx_A.data()).first;
     add(scale, A, idx_A.data(), T(0.0), B, idx_B.data());
@@ -1268,6 +1890,51 @@ void test_dot(stride_type N)
     B = T(0);
     calc_val = dot(A, idx_A.data(), B, idx_B.data());
     passfail("ZERO", calc_val, 0, ulp_factor*ceil2(neps));
+
+    random_tensors(N,
+                   random_number(0,2), random_number(0,2),
+                   random_number(0,4),
+                   A, idx_A,
+                   B, idx_B);
+
+    cout << endl;
+    cout << "len_A    = " << A.lengths() << endl;
+    cout << "stride_A = " << A.strides() << endl;
+    cout << "idx_A    = " << idx_A << endl;
+    cout << "len_B    = " << B.lengths() << endl;
+    cout << "stride_B = " << B.strides() << endl;
+    cout << "idx_B    = " << idx_B << endl;
+    cout << endl;
+
+    neps = prod(A.lengths())*prod(B.lengths());
+
+    auto idx_AB = intersection(idx_A, idx_B);
+    tensor<T> A_AB(select_from(A.lengths(), idx_A, idx_AB));
+    tensor<T> B_AB(select_from(B.lengths(), idx_B, idx_AB));
+    add(T(1), A, idx_A.data(), T(0), A_AB, idx_AB.data());
+    add(T(1), B, idx_B.data(), T(0), B_AB, idx_AB.data());
+
+    ref_val = dot(A_AB, idx_AB.data(), B_AB, idx_AB.data());
+    calc_val = dot(A, idx_A.data(), B, idx_B.data());
+    passfail("TRACE", ref_val, calc_val, ulp_factor*ceil2(neps));
+
+    int reproducible = tblis_get_reproducible();
+    tblis_set_reproducible(1);
+    ref_val = dot(single, A, idx_A.data(), B, idx_B.data());
+    for (int nt : {2, 3, 5})
+    {
+        parallelize
+        (
+            [&](const communicator& comm)
+            {
+                T val = dot(comm, A, idx_A.data(), B, idx_B.data());
+                if (comm.master()) calc_val = val;
+            },
+            nt
+        );
+        passfail("REPRODUCIBLE", ref_val, calc_val, 0);
+    }
+    tblis_set_reproducible(reproducible);
 }
 
 template <typename T>
@@ -1300,6 +1967,29 @@ void test_transpose(stride_type N)
     T error = reduce(REDUCE_NORM_2, C, idx_A.data()).first;
     passfail("INVERSE", error, 0, ulp_factor*ceil2(2*scale*neps));
 
+    /*
+     * Each configuration has its own transpose microkernels, so check all of
+     * them against the default configuration.
+     */
+    for (auto name = tblis_list_configs();*name;name++)
+    {
+        for (T beta : {T(0), scale})
+        {
+            C.reset(B);
+            add(scale, A, idx_A.data(), beta, C, idx_B.data());
+
+            tensor<T> D(B);
+            tensor_view<T> Av(A), Dv(D);
+            tblis_tensor A_s(scale, Av), D_s(beta, Dv);
+            tblis_tensor_add(nullptr, tblis_get_config(*name),
+                             &A_s, idx_A.data(), &D_s, idx_B.data());
+
+            add(T(-1), C, idx_B.data(), T(1), D, idx_B.data());
+            error = reduce(REDUCE_NORM_2, D, idx_B.data()).first;
+            passfail(string("CONFIG_") + *name, error, 0, ulp_factor*ceil2(2*scale*neps));
+        }
+    }
+
     B.reset(A);
     idx_B = idx_A;
     vector<label_type> idx_C(ndim);
@@ -1324,6 +2014,90 @@ void test_transpose(stride_type N)
     passfail("CYCLE", error, 0, ulp_factor*ceil2(neps));
 }
 
+template <typename T>
+void test_add_many(stride_type N)
+{
+    tensor<T> A, B, C, D;
+    std::vector<label_type> idx_A, idx_B;
+
+    random_transpose(1000, A, idx_A, B, idx_B);
+
+    cout << endl;
+    cout << "Testing add_many (" << type_name<T>() << "):" << endl;
+    cout << "len_A    = " << A.lengths() << endl;
+    cout << "stride_A = " << A.strides() << endl;
+    cout << "idx_A    = " << idx_A << endl;
+    cout << "len_B    = " << B.lengths() << endl;
+    cout << "stride_B = " << B.strides() << endl;
+    cout << "idx_B    = " << idx_B << endl;
+    cout << endl;
+
+    auto neps = prod(A.lengths());
+
+    T scale(10.0*random_unit<T>());
+
+    const_tensor_view<T> inputs[] = {A, B, A};
+    const label_type* idx_inputs[] = {idx_A.data(), idx_B.data(), idx_A.data()};
+    T alpha[] = {scale, -scale, T(2)};
+
+    C.reset(B);
+    D.reset(B);
+    add_many(3, alpha, inputs, idx_inputs, scale, C, idx_B.data());
+    for (unsigned i = 0;i < 3;i++)
+        add(alpha[i], inputs[i], idx_inputs[i], (i == 0 ? scale : T(1)), D, idx_B.data());
+    add(T(-1), C, idx_B.data(), T(1), D, idx_B.data());
+    T error = reduce(REDUCE_NORM_2, D, idx_B.data()).first;
+    passfail("SUM", error, 0, ulp_factor*ceil2(4*scale*neps));
+
+    C.reset(A);
+    add_many(2, alpha+1, inputs+1, idx_inputs+1, T(0), C, idx_A.data());
+    D.reset(A);
+    add(-scale, B, idx_B.data(), T(2), D, idx_A.data());
+    add(T(-1), C, idx_A.data(), T(1), D, idx_A.data());
+    error = reduce(REDUCE_NORM_2, D, idx_A.data()).first;
+    passfail("ZERO_BETA", error, 0, ulp_factor*ceil2(2*scale*neps));
+}
+
+template <typename T>
+void test_map(stride_type N)
+{
+    tensor<T> A, B, C;
+    std::vector<label_type> idx_A, idx_B;
+
+    random_transpose(1000, A, idx_A, B, idx_B);
+
+    cout << endl;
+    cout << "Testing map (" << type_name<T>() << "):" << endl;
+    cout << "len_A    = " << A.lengths() << endl;
+    cout << "stride_A = " << A.strides() << endl;
+    cout << "idx_A    = " << idx_A << endl;
+    cout << "len_B    = " << B.lengths() << endl;
+    cout << "stride_B = " << B.strides() << endl;
+    cout << "idx_B    = " << idx_B << endl;
+    cout << endl;
+
+    auto neps = prod(A.lengths());
+
+    T scale(10.0*random_unit<T>());
+
+    tblis::map([&](T a) { return scale*a; }, A, idx_A.data(), B, idx_B.data());
+    C.reset(B);
+    add(-scale, A, idx_A.data(), T(1), C, idx_B.data());
+    T error = reduce(REDUCE_NORM_2, C, idx_B.data()).first;
+    passfail("MAP", error, 0, ulp_factor*ceil2(scale*neps));
+
+    T ref_val = reduce(REDUCE_SUM, A, idx_A.data()).first;
+    C.reset(A);
+    tblis::map([](T c) { return c + T(1); }, C, idx_A.data());
+    T calc_val = reduce(REDUCE_SUM, C, idx_A.data()).first;
+    passfail("IN_PLACE", ref_val + T(neps), calc_val, ulp_factor*ceil2(neps));
+
+    tblis::zip([&](T a, T b) { return b - scale*a; },
+               A, idx_A.data(), B, idx_B.data(), C, idx_A.data());
+    error = reduce(REDUCE_NORM_2, C, idx_A.data()).first;
+    passfail("ZIP", error, 0, ulp_factor*ceil2(scale*neps));
+}
+
 template <typename T>
 void test_scale(stride_type N)
 {
@@ -1457,9 +2231,488 @@ void test_reduce(stride_type N)
     blas_val = sqrt(real(blas_val));
     passfail("REDUCE_NORM_2", ref_val, blas_val, ulp_factor*ceil2(NA));
 
+    reduce_t ops[] = {REDUCE_SUM, REDUCE_NORM_2, REDUCE_MAX_ABS, REDUCE_SUM_ABS};
+    T multi_val[4];
+    stride_type multi_idx[4];
+    reduce(4, ops, A, idx_A.data(), multi_val, multi_idx);
+    for (int i = 0;i < 4;i++)
+    {
+        reduce(ops[i], A, idx_A.data(), ref_val, ref_idx);
+        passfail("REDUCE_MULTI", multi_idx[i], ops[i] == REDUCE_MAX_ABS ? ref_idx : multi_idx[i],
+                 multi_val[i], ref_val, ulp_factor*ceil2(NA));
+    }
+
     A = T(1);
     reduce(REDUCE_SUM, A, idx_A.data(), ref_val, ref_idx);
     passfail("COUNT", ref_val, NA, ulp_factor*ceil2(NA));
+
+    /*
+     * In reproducible mode the results do not depend on the number of
+     * threads, also when there are many blocks.
+     */
+    random_tensor(N, A);
+    idx_A = range<label_type>('a', static_cast<label_type>('a'+A.dimension()));
+
+    int reproducible = tblis_get_reproducible();
+    tblis_set_reproducible(1);
+    T ref_vals[4], calc_vals[4];
+    stride_type ref_idxs[4], calc_idxs[4];
+    reduce(single, 4, ops, A, idx_A.data(), ref_vals, ref_idxs);
+    for (int nt : {2, 3, 5})
+    {
+        parallelize
+        (
+            [&](const communicator& comm)
+            {
+                T vals[4];
+                stride_type idxs[4];
+                reduce(comm, 4, ops, A, idx_A.data(), vals, idxs);
+                if (comm.master())
+                {
+                    std::copy_n(vals, 4, calc_vals);
+                    std::copy_n(idxs, 4, calc_idxs);
+                }
+            },
+            nt
+        );
+
+        for (int i = 0;i < 4;i++)
+            passfail("REPRODUCIBLE", ref_idxs[i], calc_idxs[i], ref_vals[i], calc_vals[i], 0);
+    }
+    tblis_set_reproducible(reproducible);
+}
+
+void test_configs()
+{
+    cout << endl;
+    cout << "Testing configuration names:" << endl;
+
+    for (auto name = tblis_list_configs();*name;name++)
+    {
+        passfail("FOUND", tblis_get_config(*name) != nullptr, true, 0);
+        passfail("LOOKUP", lookup_config(*name) ==
+                           reinterpret_cast<const config*>(tblis_get_config(*name)), true, 0);
+    }
+
+    /*
+     * The base name of a configuration selects one of its usable variants.
+     */
+    for (auto base = tblis_list_base_configs();*base;base++)
+    {
+        auto cfg = tblis_get_config(*base);
+        passfail("BASE_NAME", cfg != nullptr, true, 0);
+
+        bool listed = false;
+        for (auto name = tblis_list_configs();*name;name++)
+            if (tblis_get_config(*name) == cfg) listed = true;
+        passfail("BASE_VARIANT", listed, true, 0);
+    }
+
+    passfail("UNKNOWN", tblis_get_config("no_such_config") == nullptr, true, 0);
+    passfail("UNKNOWN_LOOKUP", lookup_config("no_such_config") == nullptr, true, 0);
+
+    /*
+     * Autotuning writes its choice to the cache, and a later lookup takes
+     * whatever the cache holds.
+     */
+    char dir[] = "/tmp/tblis_cache_XXXXXX";
+    if (!mkdtemp(dir)) return;
+
+    const char* old_xdg = getenv("XDG_CACHE_HOME");
+    string saved_xdg = old_xdg ? old_xdg : "";
+    setenv("XDG_CACHE_HOME", dir, 1);
+
+    string path = string(dir) + "/tblis/config";
+    auto tuned = lookup_config("autotune");
+    passfail("AUTOTUNE", tuned != nullptr, true, 0);
+
+    string key, name;
+    {
+        ifstream ifs(path);
+        getline(ifs, key);
+        getline(ifs, name);
+    }
+    passfail("CACHE_WRITTEN", tuned && name == tuned->name, true, 0);
+
+    const char* other = tblis_list_configs()[0];
+    for (auto cfg_name = tblis_list_configs();*cfg_name;cfg_name++)
+        if (tuned && strcmp(*cfg_name, tuned->name) != 0) other = *cfg_name;
+
+    {
+        ofstream ofs(path);
+        ofs << key << '\n' << other << '\n';
+    }
+    passfail("CACHE_READ", lookup_config("autotune") == lookup_config(other), true, 0);
+
+    unlink(path.c_str());
+    rmdir((string(dir) + "/tblis").c_str());
+    rmdir(dir);
+
+    if (old_xdg) setenv("XDG_CACHE_HOME", saved_xdg.c_str(), 1);
+    else unsetenv("XDG_CACHE_HOME");
+}
+
+void test_memory_pools()
+{
+    cout << endl;
+    cout << "Testing memory pools:" << endl;
+
+    tensor<double> A({300, 200}), B({200, 300}), C({300, 300});
+    A = 1.0;
+    B = 1.0;
+
+    impl = BLIS_BASED;
+    tblis_reset_memory_pool_peaks();
+    auto before = get_pool_stats();
+    mult(single, 1.0, A, "ab", B, "bc", 0.0, C, "ac");
+    auto after = get_pool_stats();
+
+    for (int i : {TBLIS_POOL_A, TBLIS_POOL_B})
+    {
+        passfail("ACQUIRE", after[i].num_acquires > before[i].num_acquires, true, 0);
+        passfail("PEAK", after[i].peak_in_use >= after[i].bytes_in_use &&
+                         after[i].peak_in_use > 0, true, 0);
+        passfail("IN_USE", stride_type(after[i].bytes_in_use),
+                           stride_type(before[i].bytes_in_use), 0);
+        passfail("HELD", after[i].bytes_held >= after[i].bytes_in_use +
+                         after[i].peak_in_use - before[i].bytes_in_use, true, 0);
+    }
+
+    tblis_flush_memory_pools();
+    before = get_pool_stats();
+
+    for (int i : {TBLIS_POOL_A, TBLIS_POOL_B})
+        passfail("FLUSH", before[i].bytes_held < after[i].bytes_held, true, 0);
+
+    auto limit = tblis_get_memory_pool_limit();
+    tblis_set_memory_pool_limit(0);
+    mult(single, 1.0, A, "ab", B, "bc", 0.0, C, "ac");
+    auto middle = get_pool_stats();
+    mult(single, 1.0, A, "ab", B, "bc", 0.0, C, "ac");
+    after = get_pool_stats();
+    tblis_set_memory_pool_limit(limit);
+
+    for (int i : {TBLIS_POOL_A, TBLIS_POOL_B})
+    {
+        passfail("REALLOCATE", middle[i].num_allocations > before[i].num_allocations, true, 0);
+        passfail("NO_REUSE", after[i].num_allocations > middle[i].num_allocations, true, 0);
+        passfail("NOTHING_HELD", stride_type(after[i].bytes_held),
+                                 stride_type(after[i].bytes_in_use), 0);
+    }
+
+    /*
+     * Blocks cached by worker threads count against the limit, and are
+     * freed by a flush.
+     */
+    auto threaded_mult = [&]
+    {
+        parallelize
+        (
+            [&](const communicator& comm)
+            {
+                mult(comm, 1.0, A, "ab", B, "bc", 0.0, C, "ac");
+            },
+            4
+        );
+    };
+
+    tblis_set_memory_pool_limit(0);
+    threaded_mult();
+    after = get_pool_stats();
+    tblis_set_memory_pool_limit(limit);
+
+    for (int i : {TBLIS_POOL_A, TBLIS_POOL_B})
+        passfail("THREADS_LIMIT", stride_type(after[i].bytes_held),
+                                  stride_type(after[i].bytes_in_use), 0);
+
+    threaded_mult();
+    tblis_flush_memory_pools();
+    after = get_pool_stats();
+
+    for (int i : {TBLIS_POOL_A, TBLIS_POOL_B})
+        passfail("THREADS_FLUSH", stride_type(after[i].bytes_held),
+                                  stride_type(after[i].bytes_in_use), 0);
+
+    /*
+     * A free block is only reused for requests of at least half its size.
+     */
+    MemoryPool pool(4096);
+    pool.allocate<char>(1 << 16);
+    pool.allocate<char>(1 << 12);
+    passfail("OVERSIZE", stride_type(pool.stats().num_allocations), 2, 0);
+    pool.allocate<char>(3 << 14);
+    passfail("BEST_FIT", stride_type(pool.stats().num_allocations), 2, 0);
+
+    /*
+     * Blocks cached by one thread are freed when another flushes the pool.
+     */
+    size_t held = 0;
+    pool.flush();
+    parallelize
+    (
+        [&](const communicator& comm)
+        {
+            if (comm.master()) pool.allocate<char>(1 << 12);
+            comm.barrier();
+            if (comm.thread_num() == comm.num_threads()-1)
+            {
+                pool.flush();
+                held = pool.stats().bytes_held;
+            }
+            comm.barrier();
+        },
+        2
+    );
+    passfail("FLUSH_CACHED", stride_type(held), 0, 0);
+
+    /*
+     * TBLIS_MEMORY_POOL_LIMIT=0 means the same as a limit of 0.
+     */
+    setenv("TBLIS_MEMORY_POOL_LIMIT", "0", 1);
+    MemoryPool env_pool(4096);
+    unsetenv("TBLIS_MEMORY_POOL_LIMIT");
+    MemoryPool default_pool(4096);
+    passfail("ENV_LIMIT", stride_type(env_pool.limit()), 0, 0);
+    passfail("NO_LIMIT", default_pool.limit() == std::numeric_limits<size_t>::max(), true, 0);
+}
+
+void test_workspace()
+{
+    cout << endl;
+    cout << "Testing caller-supplied workspace:" << endl;
+
+    auto check = [](mult_case t)
+    {
+        size_t size = mult_workspace_size<double>(t.A, t.idx_A, t.B, t.idx_B, t.D, t.idx_C);
+        vector<char> ws(size);
+
+        auto before = get_pool_stats();
+        mult(1.0, t.A, t.idx_A, t.B, t.idx_B, 0.0, t.D, t.idx_C, ws.data(), size);
+        check_pools("NO_POOL", before, get_pool_stats(), &tblis_memory_pool_stats::num_acquires);
+        t.check("RESULT");
+
+        /*
+         * With too little workspace the remaining buffers come from the
+         * pools instead.
+         */
+        mult(1.0, t.A, t.idx_A, t.B, t.idx_B, 0.0, t.D, t.idx_C, ws.data(), size/4);
+        t.check("FALLBACK");
+    };
+
+    for (auto i : {BLIS_BASED, BLAS_BASED})
+    {
+        impl = i;
+        check({"ab", {150, 100}, "bc", {100, 120}, "ac", {150, 120}});
+        check({"ab", {150, 100}, "bc", {100, 120}, "ca", {120, 150}});
+        check({"abd", {150, 100, 3}, "bcd", {100, 120, 3}, "acd", {150, 120, 3}});
+        check({"a", {150}, "c", {120}, "ac", {150, 120}});
+    }
+
+    impl = BLIS_BASED;
+
+    /*
+     * Apart from the workspace itself, tblis_tensor_mult_ws does not touch
+     * the heap.
+     */
+    auto check_no_heap = [](mult_case t)
+    {
+        tensor_view<double> Av(t.A), Bv(t.B), Dv(t.D);
+        tblis_tensor A_s(Av), B_s(Bv), D_s(Dv);
+        D_s.alpha<double>() = 0;
+
+        size_t size = tblis_tensor_mult_workspace_size(tblis_single, nullptr,
+                                                       &A_s, t.idx_A, &B_s, t.idx_B,
+                                                       &D_s, t.idx_C);
+        vector<char> ws(size);
+
+        num_allocations = 0;
+        count_allocations = true;
+        tblis_tensor_mult_ws(tblis_single, nullptr, &A_s, t.idx_A, &B_s, t.idx_B,
+                             &D_s, t.idx_C, ws.data(), size);
+        count_allocations = false;
+
+        passfail("NO_HEAP", stride_type(num_allocations), 0, 0);
+        t.check("NO_HEAP_RESULT");
+    };
+
+    check_no_heap({"ab", {150, 100}, "bc", {100, 120}, "ac", {150, 120}});
+    check_no_heap({"ab", {150, 100}, "bc", {100, 120}, "ca", {120, 150}});
+    check_no_heap({"abd", {15, 10, 3}, "bcde", {10, 12, 3, 4}, "acde", {15, 12, 3, 4}});
+    check_no_heap({"abcd", {15, 10, 6, 4}, "bed", {10, 5, 4}, "acde", {15, 6, 4, 5}});
+
+    /*
+     * Threads sharing a communicator also share the workspace.
+     */
+    mult_case t("ab", {300, 200}, "bc", {200, 300}, "ac", {300, 300});
+    vector<char> ws;
+
+    auto before = get_pool_stats();
+
+    parallelize
+    (
+        [&](const communicator& comm)
+        {
+            size_t size = mult_workspace_size<double>(comm, t.A, "ab", t.B, "bc", t.D, "ac");
+            if (comm.master()) ws.resize(size);
+            comm.barrier();
+
+            mult(comm, 1.0, t.A, "ab", t.B, "bc", 0.0, t.D, "ac", ws.data(), size);
+        },
+        4
+    );
+
+    check_pools("NO_POOL_THREADS", before, get_pool_stats(), &tblis_memory_pool_stats::num_acquires);
+    t.check("THREADS");
+}
+
+void test_numa_policy()
+{
+    cout << endl;
+    cout << "Testing NUMA placement:" << endl;
+
+    auto global = tblis_get_numa_policy();
+
+    for (auto policy : {tblis_numa_policy{TBLIS_NUMA_INTERLEAVE, 0},
+                        tblis_numa_policy{TBLIS_NUMA_BIND, 0},
+                        tblis_numa_policy{TBLIS_NUMA_FIRST_TOUCH, 0}})
+    {
+        {
+            numa_scope scope(policy);
+            passfail("SCOPE", stride_type(numa_policy().type), stride_type(policy.type), 0);
+
+            tensor<double> A({512, 1024}, 1.0);
+            passfail("VALUE", reduce(REDUCE_SUM, A, "ab").first, 512.0*1024.0, 0);
+
+            tensor<double> B({512, 1024}, uninitialized);
+
+            /*
+             * The pages are touched (and zeroed) as soon as they are
+             * allocated.
+             */
+            if (policy.type == TBLIS_NUMA_FIRST_TOUCH)
+                passfail("TOUCHED", reduce(REDUCE_NORM_1, B, "ab").first, 0.0, 0);
+
+            set(2.0, B, "ab");
+            passfail("SET", reduce(REDUCE_SUM, B, "ab").first, 2.0*512.0*1024.0, 0);
+
+            #if TBLIS_HAVE_NUMA_H
+            if (policy.type == TBLIS_NUMA_BIND && numa_available() >= 0)
+            {
+                int node = -1;
+                get_mempolicy(&node, nullptr, 0, B.data() + 512*512,
+                              MPOL_F_NODE|MPOL_F_ADDR);
+                passfail("NODE", stride_type(node), stride_type(0), 0);
+            }
+            #endif
+        }
+
+        passfail("RESTORE", stride_type(numa_policy().type), stride_type(global.type), 0);
+    }
+}
+
+#if TBLIS_HAVE_SYS_MMAN_H
+
+void test_mapped_tensor()
+{
+    cout << endl;
+    cout << "Testing memory-mapped tensors:" << endl;
+
+    char path[] = "/tmp/tblis_test_XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0) return;
+    close(fd);
+
+    mult_case t("ab", {60, 40}, "bc", {40, 50}, "ac", {60, 50});
+
+    /*
+     * Store A after a small header, which is not page-aligned.
+     */
+    {
+        mapped_tensor<double,READ_WRITE> M(path, {60, 40}, DEFAULT, 64);
+        M = t.A;
+        M.sync();
+    }
+
+    mapped_tensor<double> MA(path, {60, 40}, DEFAULT, 64, MADV_SEQUENTIAL);
+    mapped_tensor<double,READ_WRITE> MC(path, {60, 50}, DEFAULT, 64+60*40*sizeof(double));
+
+    /*
+     * A read-only mapping can only be used as a const view.
+     */
+    passfail("READ_ONLY", std::is_base_of<tensor_view<double>,
+                                          mapped_tensor<double>>::value, false, 0);
+    passfail("READ_WRITE", std::is_base_of<tensor_view<double>,
+                                           mapped_tensor<double,READ_WRITE>>::value, true, 0);
+
+    tensor<double> E(t.A);
+    add(-1.0, MA, "ab", 1.0, E, "ab");
+    passfail("CONTENTS", reduce(REDUCE_NORM_2, E, "ab").first, 0.0, 0);
+
+    will_need(MA);
+    will_need(tensor_view<double>({60, 10}, MC.data() + 60*20, MC.strides()));
+
+    mult(1.0, MA, "ab", t.B, "bc", 0.0, MC, "ac");
+    t.D = MC;
+    t.check("MULT");
+
+    MA.reset();
+    MC.reset();
+    unlink(path);
+}
+
+#endif
+
+void test_mult_streamed()
+{
+    cout << endl;
+    cout << "Testing out-of-core mult:" << endl;
+
+    char path[] = "/tmp/tblis_test_XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0) return;
+    unlink(path);
+
+    auto check = [&](const label_type* idx_A, const vector<len_type>& len_A,
+                     const label_type* idx_B, const vector<len_type>& len_B,
+                     const label_type* idx_C, const vector<len_type>& len_C,
+                     len_type slice_len, len_type num_slices, double ulps)
+    {
+        mult_case t(idx_A, len_A, idx_B, len_B, idx_C, len_C, 0.5);
+
+        /*
+         * Store A after a small header.
+         */
+        size_t size = stl_ext::prod(len_A)*sizeof(double);
+        if (pwrite(fd, t.A.data(), size, 64) != ssize_t(size)) abort();
+
+        auto stats = mult_streamed(1.0, fd, 64, len_A, idx_A, t.B, idx_B, 0.5, t.D, idx_C, slice_len);
+        passfail("SLICES", stats.num_slices, num_slices, 0);
+        t.check("RESULT", ulps);
+    };
+
+    for (auto i : {BLIS_BASED, BLAS_BASED})
+    {
+        impl = i;
+        check("abk", {40, 30, 50}, "bc", {30, 20}, "ack", {40, 20, 50}, 7, 8, 0);
+        check("abk", {40, 30, 50}, "bck", {30, 20, 50}, "ack", {40, 20, 50}, 16, 4, 0);
+
+        /*
+         * The outermost index of A is contracted or summed over, so A is
+         * split along an inner index which is in C.
+         */
+        check("ak", {40, 300}, "kc", {300, 20}, "ac", {40, 20}, 8, 5, 0);
+        check("abk", {40, 30, 5}, "bc", {30, 20}, "ac", {40, 20}, 16, 3, 1e3);
+        check("abk", {40, 6, 30}, "kc", {30, 20}, "bc", {6, 20}, 4, 2, 1e3);
+
+        /*
+         * No index of A is in C, so the slices are summed.
+         */
+        check("bk", {30, 200}, "kbc", {200, 30, 20}, "c", {20}, 16, 13, 1e3);
+    }
+
+    impl = BLIS_BASED;
+
+    close(fd);
 }
 
 template <typename T>
@@ -1471,17 +2724,117 @@ void test(stride_type N_in_bytes, int R)
 
     for (int i = 0;i < R;i++) test_reduce<T>(N);
     for (int i = 0;i < R;i++) test_scale<T>(N);
+    for (int i = 0;i < R;i++) test_map<T>(N);
     for (int i = 0;i < R;i++) test_transpose<T>(N);
     for (int i = 0;i < R;i++) test_dot<T>(N);
     for (int i = 0;i < R;i++) test_replicate<T>(N);
     for (int i = 0;i < R;i++) test_trace<T>(N);
     for (int i = 0;i < R;i++) test_add<T>(N);
+    for (int i = 0;i < R;i++) test_add_many<T>(N);
     for (int i = 0;i < R;i++) test_outer_prod<T>(N);
     for (int i = 0;i < R;i++) test_weight<T>(N);
     for (int i = 0;i < R;i++) test_contract<T>(N);
     for (int i = 0;i < R;i++) test_mult<T>(N);
 }
 
+void test_warmup()
+{
+    cout << endl;
+    cout << "Testing memory pool warm-up:" << endl;
+
+    auto check = [](mult_case t)
+    {
+        tblis_flush_memory_pools();
+        mult_warmup<double>(t.A, t.idx_A, t.B, t.idx_B, t.D, t.idx_C);
+
+        auto before = get_pool_stats();
+        mult(1.0, t.A, t.idx_A, t.B, t.idx_B, 0.0, t.D, t.idx_C);
+        check_pools("NO_ALLOC", before, get_pool_stats(), &tblis_memory_pool_stats::num_allocations);
+        t.check("RESULT");
+    };
+
+    for (auto i : {BLIS_BASED, BLAS_BASED})
+    {
+        impl = i;
+        check({"ab", {300, 200}, "bc", {200, 300}, "ac", {300, 300}});
+        check({"ab", {300, 200}, "bc", {200, 300}, "ca", {300, 300}});
+        check({"abd", {150, 100, 3}, "bcd", {100, 120, 3}, "acd", {150, 120, 3}});
+    }
+
+    impl = BLIS_BASED;
+
+    /*
+     * Warming up for several shapes at once covers each of them.
+     */
+    tensor<double> A1({300, 200}), B1({200, 300}), C1({300, 300});
+    tensor<double> A2({50, 800}), B2({800, 60}), C2({50, 60});
+    random_fill<double>(A1);
+    random_fill<double>(B1);
+    random_fill<double>(A2);
+    random_fill<double>(B2);
+
+    tensor_view<double> A1v(A1), B1v(B1), C1v(C1), A2v(A2), B2v(B2), C2v(C2);
+    tblis_tensor A_s[] = {tblis_tensor(A1v), tblis_tensor(A2v)};
+    tblis_tensor B_s[] = {tblis_tensor(B1v), tblis_tensor(B2v)};
+    tblis_tensor C_s[] = {tblis_tensor(C1v), tblis_tensor(C2v)};
+    const label_type* idx_A[] = {"ab", "ab"};
+    const label_type* idx_B[] = {"bc", "bc"};
+    const label_type* idx_C[] = {"ac", "ac"};
+
+    tblis_flush_memory_pools();
+    tblis_tensor_mult_warmup(nullptr, nullptr, 2, A_s, idx_A, B_s, idx_B, C_s, idx_C);
+
+    auto before = get_pool_stats();
+    mult(1.0, A1, "ab", B1, "bc", 0.0, C1, "ac");
+    mult(1.0, A2, "ab", B2, "bc", 0.0, C2, "ac");
+    check_pools("NO_ALLOC_MANY", before, get_pool_stats(), &tblis_memory_pool_stats::num_allocations);
+
+    /*
+     * A mixed-precision mult long enough that C is accumulated in a
+     * temporary of the compute type.
+     */
+    tensor<double> A3({40, 2000}), B3({2000, 30});
+    tensor<float> C3({40, 30});
+    random_fill<double>(A3);
+    random_fill<double>(B3);
+
+    tensor_view<double> A3v(A3), B3v(B3);
+    tensor_view<float> C3v(C3);
+    tblis_tensor A3_s(A3v), B3_s(B3v), C3_s(C3v);
+
+    tblis_flush_memory_pools();
+    tblis_tensor_mult_warmup(nullptr, nullptr, 1, &A3_s, idx_A, &B3_s, idx_B, &C3_s, idx_C);
+
+    before = get_pool_stats();
+    tblis_tensor_mult(nullptr, nullptr, &A3_s, "ab", &B3_s, "bc", &C3_s, "ac");
+    check_pools("NO_ALLOC_MIXED", before, get_pool_stats(), &tblis_memory_pool_stats::num_allocations);
+}
+
+template <typename T>
+void test_int(stride_type N_in_bytes, int R)
+{
+    stride_type N = N_in_bytes/sizeof(T);
+
+    for (int i = 0;i < R;i++) test_contract_int<T>(N);
+}
+
+template <typename TAB, typename TC>
+void test_mixed(stride_type N_in_bytes, int R, double eps_C, double eps_T)
+{
+    stride_type N = N_in_bytes/sizeof(TC);
+
+    for (int i = 0;i < R;i++) test_contract_mixed<TAB,TC>(N, eps_C, eps_T);
+    test_contract_mixed_long<TAB,TC>(eps_C, eps_T);
+}
+
+template <typename TS>
+void test_narrow(stride_type N_in_bytes, int R, double eps_S)
+{
+    stride_type N = N_in_bytes/sizeof(TS);
+
+    for (int i = 0;i < R;i++) test_narrow_1t<TS>(N, eps_S);
+}
+
 int main(int argc, char **argv)
 {
     stride_type N = 10*1024*1024;
@@ -1525,5 +2878,32 @@ int main(int argc, char **argv)
     test<scomplex>(N, R);
     test<dcomplex>(N, R);
 
+    test_int< int8_t>(N, R);
+    test_int<int16_t>(N, R);
+    test_int<int32_t>(N, R);
+
+    const double feps = std::numeric_limits<float>::epsilon();
+    const double deps = std::numeric_limits<double>::epsilon();
+
+    test_mixed<    tblis_half,     tblis_half>(N, R, std::ldexp(1.0, -10), feps);
+    test_mixed<tblis_bfloat16, tblis_bfloat16>(N, R, std::ldexp(1.0,  -7), feps);
+    test_mixed<         float,         double>(N, R, deps, deps);
+    test_mixed<        double,          float>(N, R, feps, deps);
+    test_mixed<      scomplex,       dcomplex>(N, R, deps, deps);
+    test_mixed<      dcomplex,       scomplex>(N, R, feps, deps);
+
+    test_narrow<    tblis_half>(N, R, std::ldexp(1.0, -10));
+    test_narrow<tblis_bfloat16>(N, R, std::ldexp(1.0,  -7));
+
+    test_configs();
+    test_memory_pools();
+    test_workspace();
+    test_numa_policy();
+#if TBLIS_HAVE_SYS_MMAN_H
+    test_mapped_tensor();
+#endif
+    test_mult_streamed();
+    test_warmup();
+
     return 0;
 }